@@ -1,4 +1,4 @@
 APP_PROJECT_PATH := $(call my-dir)/gogoc-1_2-RELEASE
 APP_BUILD_SCRIPT := $(APP_PROJECT_PATH)/Android.mk
-APP_MODULES      := gogoc
+APP_MODULES      := gogoc gogoc-logdecode
 APP_ABI          := all
@@ -22,6 +22,7 @@ LOCAL_SRC_FILES := \
 		gogoc-tsp/src/net/net_cksm.c \
 		gogoc-tsp/src/net/net_tcp6.c \
 		gogoc-tsp/src/net/net_echo_request.c \
+		gogoc-tsp/src/net/net_resolv.c \
 		gogoc-tsp/src/net/icmp_echo_engine.c \
 		gogoc-tsp/src/tsp/tsp_auth.c \
 		gogoc-tsp/src/tsp/tsp_cap.c \
@@ -31,12 +32,20 @@ LOCAL_SRC_FILES := \
 		gogoc-tsp/src/tsp/tsp_lease.c \
 		gogoc-tsp/src/tsp/tsp_redirect.c \
 		gogoc-tsp/src/tsp/tsp_tun_mgt.c \
+		gogoc-tsp/src/tsp/tsp_trace.c \
 		gogoc-tsp/src/xml/xmlparse.c \
 		gogoc-tsp/src/xml/xml_req.c \
 		gogoc-tsp/src/xml/xml_tun.c \
 		gogoc-tsp/platform/unix-common/unix-main.c \
 		gogoc-tsp/platform/linux/tsp_local.c \
-		gogoc-tsp/platform/linux/tsp_tun.c
+		gogoc-tsp/platform/linux/tsp_tun.c \
+		gogoc-tsp/platform/linux/tsp_netlink.c \
+		gogoc-tsp/platform/linux/tsp_rtadv.c \
+		gogoc-tsp/platform/linux/tsp_pmtu.c \
+		gogoc-tsp/platform/linux/tsp_standby.c \
+		gogoc-tsp/platform/linux/log_ring.c \
+		gogoc-tsp/platform/linux/log_event.c \
+		gogoc-tsp/platform/linux/log_memory.c
 
 LOCAL_C_INCLUDES := \
 		$(LOCAL_PATH)/gogoc-pal/defs \
@@ -57,6 +66,10 @@ LOCAL_CFLAGS = \
 
 LOCAL_CFLAGS += -Wall -Wextra
 
+# Leave the messages above a log level out of the build, e.g. the
+# LOG_LEVEL_3 traces (see gogoc-tsp/include/log.h).
+# LOCAL_CFLAGS += -DLOG_LEVEL_BUILD=2
+
 ifeq ($(HAVE_OPENSSL),true)
 LOCAL_C_INCLUDES += external/openssl/include
 LOCAL_SHARED_LIBRARIES += libcrypto
@@ -69,12 +82,46 @@ endif
 
 LOCAL_MODULE := gogoc
 LOCAL_SYSTEM_SHARED_LIBRARIES := libc
+LOCAL_LDLIBS := -lz
 # LOCAL_STATIC_LIBRARIES := libc
 # LOCAL_FORCE_STATIC_EXECUTABLE := true
 LOCAL_MODULE_PATH := $(TARGET_ROOT_OUT_BIN)
 include $(BUILD_EXECUTABLE)
 
+GOGOC_C_INCLUDES := $(LOCAL_C_INCLUDES)
+GOGOC_CFLAGS := $(LOCAL_CFLAGS)
+
+# Reader of the event log and of the memory log ring (log_event.h,
+# log_memory.h). Its table of formats, log_strings.h, is generated from
+# hex_strings.h as the platform Makefile does.
+include $(CLEAR_VARS)
+LOCAL_SRC_FILES := \
+		gogoc-tsp/platform/linux/log_decode.c \
+		gogoc-tsp/platform/linux/log_event.c \
+		gogoc-tsp/platform/linux/log_ring.c
+
+LOGDECODE_GEN := $(TARGET_OBJS)/gogoc-logdecode/gen
+
+$(LOGDECODE_GEN)/log_strings.h: $(LOCAL_PATH)/gogoc-tsp/include/hex_strings.h
+	mkdir -p $(dir $@)
+	sed -n 's/^#define[ \t]*\(\(GOGO_\)\{0,1\}STR_[A-Za-z0-9_]*\)[ \t]*".*/  { "\1", \1, 0 },/p' $< > $@
+
+$(TARGET_OBJS)/gogoc-logdecode/gogoc-tsp/platform/linux/log_decode.o: $(LOGDECODE_GEN)/log_strings.h
+
+LOCAL_C_INCLUDES := $(GOGOC_C_INCLUDES) $(LOGDECODE_GEN)
+LOCAL_CFLAGS = $(GOGOC_CFLAGS)
+LOCAL_MODULE := gogoc-logdecode
+LOCAL_SYSTEM_SHARED_LIBRARIES := libc
+LOCAL_MODULE_PATH := $(TARGET_ROOT_OUT_BIN)
+include $(BUILD_EXECUTABLE)
+
+# The app runs the executables from its library directory, where only
+# lib*.so files are installed.
 $(NDK_APP_LIBS_OUT)/%/libgogoc_exec.so: $(NDK_APP_LIBS_OUT)/%/gogoc
 	$(call host-mv, $<, $@)
 
+$(NDK_APP_LIBS_OUT)/%/libgogoc_logdecode.so: $(NDK_APP_LIBS_OUT)/%/gogoc-logdecode
+	$(call host-mv, $<, $@)
+
 all: $(foreach _abi,$(NDK_APP_ABI),$(NDK_APP_LIBS_OUT)/$(_abi)/libgogoc_exec.so)
+all: $(foreach _abi,$(NDK_APP_ABI),$(NDK_APP_LIBS_OUT)/$(_abi)/libgogoc_logdecode.so)
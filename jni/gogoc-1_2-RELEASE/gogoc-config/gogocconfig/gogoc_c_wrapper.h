@@ -54,6 +54,8 @@ void                set_server            ( char * );
 void                get_host_type         ( char** );
 void                get_prefixlen         ( int* );
 void                get_ifprefix          ( char** );
+void                get_ra_min_interval   ( int* );
+void                get_ra_max_interval   ( int* );
 void                get_dns_server        ( char** );
 void                get_gogoc_dir         ( char** );
 void                get_auth_method       ( char** );
@@ -69,6 +71,12 @@ void                get_if_tun_v4v6       ( char** );
 void                get_client_v4         ( char** );
 void                get_client_v6         ( char** );
 void                get_template          ( char** );
+void                get_use_template      ( tBoolean* );
+void                get_keep_tunnel       ( tBoolean* );
+void                get_route_table       ( int* );
+void                get_route_fwmark      ( int* );
+void                get_if_tun_standby    ( char** );
+void                get_standby_server    ( char** );
 void                get_proxy_client      ( tBoolean* );
 void                get_broker_list_file  ( char** );
 void                get_last_server_file  ( char** );
@@ -78,6 +86,16 @@ void                get_log_filename      ( char** );
 void                get_log_rotation      ( tBoolean* );
 void                get_log_rotation_sz   ( int* );
 void                get_log_rotation_del  ( tBoolean* );
+void                get_log_rotation_count ( int* );
+void                get_log_rotation_compress ( tBoolean* );
+void                get_log_event_filename ( char** );
+void                get_log_event_size    ( int* );
+void                get_log_memory_filename ( char** );
+void                get_log_memory_size   ( int* );
+void                get_log_timestamp_precision ( int* );
+void                get_log_timestamp_iso8601 ( tBoolean* );
+void                get_log_async         ( tBoolean* );
+void                get_log_flush_interval ( int* );
 void                get_syslog_facility   ( char** );
 void                get_haccess_proxy_enabled( tBoolean* );
 void                get_haccess_web_enabled  ( tBoolean* );
@@ -83,6 +83,12 @@ namespace gogocconfig
     void              Get_IfPrefix        ( string& sIfPrefix ) const;
     void              Set_IfPrefix        ( const string& sIfPrefix );
 
+    void              Get_RaMinInterval   ( string& sRaMinInterval ) const;
+    void              Set_RaMinInterval   ( const string& sRaMinInterval );
+
+    void              Get_RaMaxInterval   ( string& sRaMaxInterval ) const;
+    void              Set_RaMaxInterval   ( const string& sRaMaxInterval );
+
     void              Get_DnsServer       ( string& sDnsServer ) const;
     void              Set_DnsServer       ( const string& sDnsServer );
 
@@ -128,6 +134,24 @@ namespace gogocconfig
     void              Get_Template        ( string& sTemplate ) const;
     void              Set_Template        ( const string& sTemplate );
 
+    void              Get_UseTemplate     ( string& sUseTemplate ) const;
+    void              Set_UseTemplate     ( const string& sUseTemplate );
+
+    void              Get_KeepTunnel      ( string& sKeepTunnel ) const;
+    void              Set_KeepTunnel      ( const string& sKeepTunnel );
+
+    void              Get_RouteTable      ( string& sRouteTable ) const;
+    void              Set_RouteTable      ( const string& sRouteTable );
+
+    void              Get_RouteFwmark     ( string& sRouteFwmark ) const;
+    void              Set_RouteFwmark     ( const string& sRouteFwmark );
+
+    void              Get_IfTunStandby    ( string& sIfTunStandby ) const;
+    void              Set_IfTunStandby    ( const string& sIfTunStandby );
+
+    void              Get_StandbyServer   ( string& sStandbyServer ) const;
+    void              Set_StandbyServer   ( const string& sStandbyServer );
+
     void              Get_ProxyClient     ( string& sProxyClient ) const;
     void              Set_ProxyClient     ( const string& sProxyClient );
 
@@ -155,6 +179,36 @@ namespace gogocconfig
     void              Get_LogRotationDel  ( string& sLogRotationDel ) const;
     void              Set_LogRotationDel  ( const string& sLogRotationDel );
 
+    void              Get_LogRotationCount ( string& sLogRotationCount ) const;
+    void              Set_LogRotationCount ( const string& sLogRotationCount );
+
+    void              Get_LogRotationCompress ( string& sLogRotationCompress ) const;
+    void              Set_LogRotationCompress ( const string& sLogRotationCompress );
+
+    void              Get_LogEventFileName ( string& sLogEventFileName ) const;
+    void              Set_LogEventFileName ( const string& sLogEventFileName );
+
+    void              Get_LogEventSize    ( string& sLogEventSize ) const;
+    void              Set_LogEventSize    ( const string& sLogEventSize );
+
+    void              Get_LogMemoryFileName ( string& sLogMemoryFileName ) const;
+    void              Set_LogMemoryFileName ( const string& sLogMemoryFileName );
+
+    void              Get_LogMemorySize   ( string& sLogMemorySize ) const;
+    void              Set_LogMemorySize   ( const string& sLogMemorySize );
+
+    void              Get_LogTimestampPrecision ( string& sLogTimestampPrecision ) const;
+    void              Set_LogTimestampPrecision ( const string& sLogTimestampPrecision );
+
+    void              Get_LogTimestampIso8601 ( string& sLogTimestampIso8601 ) const;
+    void              Set_LogTimestampIso8601 ( const string& sLogTimestampIso8601 );
+
+    void              Get_LogAsync        ( string& sLogAsync ) const;
+    void              Set_LogAsync        ( const string& sLogAsync );
+
+    void              Get_LogFlushInterval ( string& sLogFlushInterval ) const;
+    void              Set_LogFlushInterval ( const string& sLogFlushInterval );
+
     void              Get_SysLogFacility  ( string& sSysLogFacility ) const;
     void              Set_SysLogFacility  ( const string& sSysLogFacility );
 
@@ -98,6 +98,25 @@ typedef signed int error_t;
 #define GOGOC_UIS__G6C_PROXYANDKEEPALIVE                (error_t)0x00040030
 #define GOGOC_UIS__G6V_RETRYDELAYMAXINVALIDVALUE        (error_t)0x00040031
 #define GOGOC_UIS__G6V_RETRYDELAYGREATERRETRYDELAYMAX   (error_t)0x00040032
+#define GOGOC_UIS__G6V_USETEMPLATEINVALIDVALUE          (error_t)0x00040033
+#define GOGOC_UIS__G6V_RAMININTERVALINVALIDVALUE        (error_t)0x00040034
+#define GOGOC_UIS__G6V_RAMAXINTERVALINVALIDVALUE        (error_t)0x00040035
+#define GOGOC_UIS__G6V_RAMININTERVALGREATERRAMAXINTERVAL (error_t)0x00040036
+#define GOGOC_UIS__G6V_KEEPTUNNELINVALIDVALUE           (error_t)0x00040037
+#define GOGOC_UIS__G6V_ROUTETABLEINVALIDVALUE           (error_t)0x00040038
+#define GOGOC_UIS__G6V_ROUTEFWMARKINVALIDVALUE          (error_t)0x00040039
+#define GOGOC_UIS__G6V_IFTUNSTANDBYINVALIDCHRS          (error_t)0x0004003A
+#define GOGOC_UIS__G6V_STANDBYSERVERINVALID             (error_t)0x0004003B
+#define GOGOC_UIS__G6V_LOGASYNCINVALIDVALUE             (error_t)0x0004003C
+#define GOGOC_UIS__G6V_LOGFLUSHINTERVALINVALIDVALUE     (error_t)0x0004003D
+#define GOGOC_UIS__G6V_LOGROTCOUNTINVALIDVALUE          (error_t)0x0004003E
+#define GOGOC_UIS__G6V_LOGROTCOMPRESSINVALIDVALUE       (error_t)0x0004003F
+#define GOGOC_UIS__G6V_LOGEVENTFILENAMEINVALID          (error_t)0x00040040
+#define GOGOC_UIS__G6V_LOGEVENTSIZEINVALIDVALUE         (error_t)0x00040041
+#define GOGOC_UIS__G6V_LOGMEMORYFILENAMEINVALID         (error_t)0x00040042
+#define GOGOC_UIS__G6V_LOGMEMORYSIZEINVALIDVALUE        (error_t)0x00040043
+#define GOGOC_UIS__G6V_LOGTSPRECISIONINVALIDVALUE       (error_t)0x00040044
+#define GOGOC_UIS__G6V_LOGTSISO8601INVALIDVALUE         (error_t)0x00040045
 
 /* ----------------------------------------------------------------------- */
 /* Get string function.                                                    */
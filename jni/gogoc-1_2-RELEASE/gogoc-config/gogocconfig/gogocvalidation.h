@@ -43,6 +43,8 @@ using namespace std;
 #define STR_LOGDEV_STDERR           "stderr"
 #define STR_LOGDEV_FILE             "file"
 #define STR_LOGDEV_SYSLOG           "syslog"
+#define STR_LOGDEV_EVENT            "event"
+#define STR_LOGDEV_MEMORY           "memory"
 #define STR_HOSTTYPE_HOST           "host"
 #define STR_HOSTTYPE_ROUTER         "router"
 #define STR_TEMPL_WINDOWS           "windows"
@@ -70,6 +72,10 @@ namespace gogocconfig
 
   bool Validate_IfPrefix        ( const string& sIfPrefix );
 
+  bool Validate_RaMinInterval   ( const string& sRaMinInterval );
+
+  bool Validate_RaMaxInterval   ( const string& sRaMaxInterval );
+
   bool Validate_DnsServer       ( const string& sDnsServer );
 
   bool Validate_gogocDir         ( const string& sgogocDir );
@@ -100,6 +106,18 @@ namespace gogocconfig
 
   bool Validate_Template        ( const string& sTemplate );
 
+  bool Validate_UseTemplate     ( const string& sUseTemplate );
+
+  bool Validate_KeepTunnel      ( const string& sKeepTunnel );
+
+  bool Validate_RouteTable      ( const string& sRouteTable );
+
+  bool Validate_RouteFwmark     ( const string& sRouteFwmark );
+
+  bool Validate_IfTunStandby    ( const string& sIfTunStandby );
+
+  bool Validate_StandbyServer   ( const string& sStandbyServer );
+
   bool Validate_ProxyClient     ( const string& sProxyClient );
 
   bool Validate_BrokerLstFile   ( const string& sBrokerLstFile );
@@ -119,6 +137,26 @@ namespace gogocconfig
 
   bool Validate_LogRotationDel  ( const string& sLogRotationDel );
 
+  bool Validate_LogRotationCount ( const string& sLogRotationCount );
+
+  bool Validate_LogRotationCompress ( const string& sLogRotationCompress );
+
+  bool Validate_LogEventFileName ( const string& sLogEventFileName );
+
+  bool Validate_LogEventSize    ( const string& sLogEventSize );
+
+  bool Validate_LogMemoryFileName ( const string& sLogMemoryFileName );
+
+  bool Validate_LogMemorySize   ( const string& sLogMemorySize );
+
+  bool Validate_LogTimestampPrecision ( const string& sLogTimestampPrecision );
+
+  bool Validate_LogTimestampIso8601 ( const string& sLogTimestampIso8601 );
+
+  bool Validate_LogAsync        ( const string& sLogAsync );
+
+  bool Validate_LogFlushInterval ( const string& sLogFlushInterval );
+
   bool Validate_SysLogFacility  ( const string& sSysLogFacility );
 
   bool Validate_haccessProxyEnabled( const string& shaccessProxyEnabled );
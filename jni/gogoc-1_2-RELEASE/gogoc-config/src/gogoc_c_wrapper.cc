@@ -283,6 +283,26 @@ extern "C" void get_ifprefix( char** szIfPrefix )
   *szIfPrefix = pal_strdup( sValue.c_str() );
 }
 
+// --------------------------------------------------------------------------
+extern "C" void get_ra_min_interval( int* piRaMinInterval )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_RaMinInterval( sValue ) );
+  *piRaMinInterval = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_ra_max_interval( int* piRaMaxInterval )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_RaMaxInterval( sValue ) );
+  *piRaMaxInterval = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
 // --------------------------------------------------------------------------
 extern "C" void get_dns_server( char** szDnsServer )
 {
@@ -465,6 +485,68 @@ extern "C" void get_template( char** szTemplate )
   *szTemplate = pal_strdup( sValue.c_str() );
 }
 
+// --------------------------------------------------------------------------
+extern "C" void get_use_template( tBoolean* pbUseTemplate )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_UseTemplate( sValue ) );
+  *pbUseTemplate = (tBoolean)(( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_keep_tunnel( tBoolean* pbKeepTunnel )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_KeepTunnel( sValue ) );
+  *pbKeepTunnel = (tBoolean)(( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_route_table( int* piRouteTable )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_RouteTable( sValue ) );
+  *piRouteTable = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_route_fwmark( int* piRouteFwmark )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_RouteFwmark( sValue ) );
+  *piRouteFwmark = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_if_tun_standby( char** szIf )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+  assert( *szIf == NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_IfTunStandby( sValue ) );
+  *szIf = pal_strdup( sValue.c_str() );
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_standby_server( char** szServer )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+  assert( *szServer == NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_StandbyServer( sValue ) );
+  *szServer = pal_strdup( sValue.c_str() );
+}
+
 // --------------------------------------------------------------------------
 extern "C" void get_proxy_client( tBoolean* pbProxyClient )
 {
@@ -559,6 +641,115 @@ extern "C" void get_log_rotation_del( tBoolean* pbLogRotDel )
   *pbLogRotDel = ( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE;
 }
 
+// --------------------------------------------------------------------------
+extern "C" void get_log_rotation_count( int* piLogRotationCount )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogRotationCount( sValue ) );
+  *piLogRotationCount = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_rotation_compress( tBoolean* pbLogRotationCompress )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogRotationCompress( sValue ) );
+  *pbLogRotationCompress = ( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE;
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_event_filename( char** szLogEventFileName )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+  assert( *szLogEventFileName == NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogEventFileName( sValue ) );
+  *szLogEventFileName = pal_strdup( sValue.c_str() );
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_event_size( int* piLogEventSize )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogEventSize( sValue ) );
+  *piLogEventSize = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_memory_filename( char** szLogMemoryFileName )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+  assert( *szLogMemoryFileName == NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogMemoryFileName( sValue ) );
+  *szLogMemoryFileName = pal_strdup( sValue.c_str() );
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_memory_size( int* piLogMemorySize )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogMemorySize( sValue ) );
+  *piLogMemorySize = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_timestamp_precision( int* piLogTimestampPrecision )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogTimestampPrecision( sValue ) );
+
+  // Digits of the fraction of a second.
+  if( sValue == "us" )
+    *piLogTimestampPrecision = 6;
+  else if( sValue == "ms" )
+    *piLogTimestampPrecision = 3;
+  else
+    *piLogTimestampPrecision = 0;
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_timestamp_iso8601( tBoolean* pbLogTimestampIso8601 )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogTimestampIso8601( sValue ) );
+  *pbLogTimestampIso8601 = ( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE;
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_async( tBoolean* pbLogAsync )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogAsync( sValue ) );
+  *pbLogAsync = ( pal_strcasecmp( sValue.c_str(), "yes" ) == 0 ) ? TRUE : FALSE;
+}
+
+// --------------------------------------------------------------------------
+extern "C" void get_log_flush_interval( int* piLogFlushInterval )
+{
+  string sValue;
+  assert( gpConfig != NULL );
+
+  TRY_OR_CLEAR( gpConfig->Get_LogFlushInterval( sValue ) );
+  *piLogFlushInterval = (int)strtol(sValue.c_str(), (char**)NULL, 10);
+}
+
 // --------------------------------------------------------------------------
 extern "C" void get_syslog_facility( char** szSyslog )
 {
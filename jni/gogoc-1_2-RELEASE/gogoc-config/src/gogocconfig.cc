@@ -33,6 +33,8 @@
 #define CFG_STR_HOSTTYPE          "host_type"
 #define CFG_STR_PREFIXLEN         "prefixlen"
 #define CFG_STR_IFPREFIX          "if_prefix"
+#define CFG_STR_RAMININTERVAL     "ra_min_interval"
+#define CFG_STR_RAMAXINTERVAL     "ra_max_interval"
 #define CFG_STR_DNSSERVER         "dns_server"
 #define CFG_STR_GOGOCDIR           "gogoc_dir"
 #define CFG_STR_AUTHMETHOD        "auth_method"
@@ -48,6 +50,12 @@
 #define CFG_STR_CLIENTV4          "client_v4"
 #define CFG_STR_CLIENTV6          "client_v6"
 #define CFG_STR_TEMPLATE          "template"
+#define CFG_STR_USETEMPLATE       "use_template"
+#define CFG_STR_KEEPTUNNEL        "keep_tunnel"
+#define CFG_STR_ROUTETABLE        "route_table"
+#define CFG_STR_ROUTEFWMARK       "route_fwmark"
+#define CFG_STR_IFTUNSTANDBY      "if_tunnel_standby"
+#define CFG_STR_STANDBYSERVER     "standby_server"
 #define CFG_STR_PROXYCLIENT       "proxy_client"
 #define CFG_STR_BROKERLIST        "broker_list"
 #define CFG_STR_LASTSERVER        "last_server"
@@ -57,6 +65,16 @@
 #define CFG_STR_LOGROTATION       "log_rotation"
 #define CFG_STR_LOGROTATIONSZ     "log_rotation_size"
 #define CFG_STR_LOGROTATIONDEL    "log_rotation_delete"
+#define CFG_STR_LOGROTATIONCOUNT  "log_rotation_count"
+#define CFG_STR_LOGROTATIONCOMPRESS "log_rotation_compress"
+#define CFG_STR_LOGEVENTFILENAME  "log_event_filename"
+#define CFG_STR_LOGEVENTSIZE      "log_event_size"
+#define CFG_STR_LOGMEMORYFILENAME "log_memory_filename"
+#define CFG_STR_LOGMEMORYSIZE     "log_memory_size"
+#define CFG_STR_LOGTIMESTAMPPRECISION "log_timestamp_precision"
+#define CFG_STR_LOGTIMESTAMPISO8601 "log_timestamp_iso8601"
+#define CFG_STR_LOGASYNC          "log_async"
+#define CFG_STR_LOGFLUSHINTERVAL  "log_flush_interval"
 #define CFG_STR_SYSLOGFACILITY    "syslog_facility"
 #define CFG_STR_HACCESSPROXYENABLED  "haccess_proxy_enabled"
 #define CFG_STR_HACCESSWEBENABLED    "haccess_web_enabled"
@@ -71,6 +89,8 @@
 #define CFG_DFLT_HOSTTYPE         "host"
 #define CFG_DFLT_PREFIXLEN        "64"
 #define CFG_DFLT_IFPREFIX         ""
+#define CFG_DFLT_RAMININTERVAL    "198"
+#define CFG_DFLT_RAMAXINTERVAL    "600"
 #define CFG_DFLT_GOGOCDIR          ""
 #define CFG_DFLT_AUTHMETHOD       STR_ANY
 #define CFG_DFLT_AUTORETRYCONNECT STR_YES
@@ -81,6 +101,10 @@
 #define CFG_DFLT_TUNNELMODE       "v6anyv4"
 #define CFG_DFLT_CLIENTV4         "auto"
 #define CFG_DFLT_CLIENTV6         "auto"
+#define CFG_DFLT_USETEMPLATE      STR_NO
+#define CFG_DFLT_KEEPTUNNEL       STR_NO
+#define CFG_DFLT_ROUTETABLE       "0"
+#define CFG_DFLT_ROUTEFWMARK      "0"
 #define CFG_DFLT_PROXYCLIENT      STR_NO
 #define CFG_DFLT_BROKERLIST       "tsp-broker-list.txt"
 #define CFG_DFLT_LASTSERVER       "tsp-last-server.txt"
@@ -89,6 +113,16 @@
 #define CFG_DFLT_LOGROTATION      STR_YES
 #define CFG_DFLT_LOGROTATIONSZ    "32"
 #define CFG_DFLT_LOGROTATIONDEL   STR_NO
+#define CFG_DFLT_LOGROTATIONCOUNT "4"
+#define CFG_DFLT_LOGROTATIONCOMPRESS STR_NO
+#define CFG_DFLT_LOGEVENTFILENAME "gogoc.evt"
+#define CFG_DFLT_LOGEVENTSIZE     "256"
+#define CFG_DFLT_LOGMEMORYFILENAME "/dev/shm/gogoc.ring"
+#define CFG_DFLT_LOGMEMORYSIZE    "64"
+#define CFG_DFLT_LOGTIMESTAMPPRECISION "ms"
+#define CFG_DFLT_LOGTIMESTAMPISO8601 STR_NO
+#define CFG_DFLT_LOGASYNC         STR_NO
+#define CFG_DFLT_LOGFLUSHINTERVAL "200"
 #define CFG_DFLT_SYSLOGFACILITY   "USER"
 #define CFG_DFLT_HACCESSPROXYENABLED STR_NO        // HACCESS defaults
 #define CFG_DFLT_HACCESSWEBENABLED   STR_NO
@@ -107,6 +141,8 @@
 #define CFG_DFLT_LOGLEVEL_CONSOLE "0"
 #define CFG_DFLT_LOGLEVEL_FILE    "0"
 #endif
+#define CFG_DFLT_LOGLEVEL_EVENT   "0"
+#define CFG_DFLT_LOGLEVEL_MEMORY  "0"
 #define CFG_DFLT_LOGLEVEL         "1"   // When unknown device.
 
 
@@ -166,6 +202,12 @@ string GetDfltLogLevelForDevice( const string& sLogDevice )
   if( sLogDevice == STR_LOGDEV_SYSLOG )
     return CFG_DFLT_LOGLEVEL_SYSLOG;
 
+  if( sLogDevice == STR_LOGDEV_EVENT )
+    return CFG_DFLT_LOGLEVEL_EVENT;
+
+  if( sLogDevice == STR_LOGDEV_MEMORY )
+    return CFG_DFLT_LOGLEVEL_MEMORY;
+
   // Should assert(false) - here -
   return CFG_DFLT_LOGLEVEL;
 }
@@ -400,6 +442,8 @@ bool GOGOCConfig::ValidateConfigData( void )
   VALIDATE_LOGERRMSG( HostType, CFG_STR_HOSTTYPE );
   VALIDATE_LOGERRMSG( PrefixLen, CFG_STR_PREFIXLEN );
   VALIDATE_LOGERRMSG( IfPrefix, CFG_STR_IFPREFIX );
+  VALIDATE_LOGERRMSG( RaMinInterval, CFG_STR_RAMININTERVAL );
+  VALIDATE_LOGERRMSG( RaMaxInterval, CFG_STR_RAMAXINTERVAL );
   VALIDATE_LOGERRMSG( DnsServer, CFG_STR_DNSSERVER );
   VALIDATE_LOGERRMSG( gogocDir, CFG_STR_GOGOCDIR );
   VALIDATE_LOGERRMSG( AuthMethod, CFG_STR_AUTHMETHOD );
@@ -414,6 +458,12 @@ bool GOGOCConfig::ValidateConfigData( void )
   VALIDATE_LOGERRMSG( ClientV4, CFG_STR_CLIENTV4 );
   VALIDATE_LOGERRMSG( ClientV6, CFG_STR_CLIENTV6 );
   VALIDATE_LOGERRMSG( Template, CFG_STR_TEMPLATE );
+  VALIDATE_LOGERRMSG( UseTemplate, CFG_STR_USETEMPLATE );
+  VALIDATE_LOGERRMSG( KeepTunnel, CFG_STR_KEEPTUNNEL );
+  VALIDATE_LOGERRMSG( RouteTable, CFG_STR_ROUTETABLE );
+  VALIDATE_LOGERRMSG( RouteFwmark, CFG_STR_ROUTEFWMARK );
+  VALIDATE_LOGERRMSG( IfTunStandby, CFG_STR_IFTUNSTANDBY );
+  VALIDATE_LOGERRMSG( StandbyServer, CFG_STR_STANDBYSERVER );
   VALIDATE_LOGERRMSG( ProxyClient, CFG_STR_PROXYCLIENT );
   VALIDATE_LOGERRMSG( BrokerLstFile, CFG_STR_BROKERLIST );
   VALIDATE_LOGERRMSG( LastServFile, CFG_STR_LASTSERVER );
@@ -422,10 +472,22 @@ bool GOGOCConfig::ValidateConfigData( void )
   VALIDATE_LOGERRMSG( LogLevel, (string)"log_" + STR_LOGDEV_STDERR );
   VALIDATE_LOGERRMSG( LogLevel, (string)"log_" + STR_LOGDEV_SYSLOG );
   VALIDATE_LOGERRMSG( LogLevel, (string)"log_" + STR_LOGDEV_FILE );
+  VALIDATE_LOGERRMSG( LogLevel, (string)"log_" + STR_LOGDEV_EVENT );
+  VALIDATE_LOGERRMSG( LogLevel, (string)"log_" + STR_LOGDEV_MEMORY );
   VALIDATE_LOGERRMSG( LogFileName, CFG_STR_LOGFILENAME );
   VALIDATE_LOGERRMSG( LogRotation, CFG_STR_LOGROTATION );
   VALIDATE_LOGERRMSG( LogRotationSz, CFG_STR_LOGROTATIONSZ );
   VALIDATE_LOGERRMSG( LogRotationDel, CFG_STR_LOGROTATIONDEL );
+  VALIDATE_LOGERRMSG( LogRotationCount, CFG_STR_LOGROTATIONCOUNT );
+  VALIDATE_LOGERRMSG( LogRotationCompress, CFG_STR_LOGROTATIONCOMPRESS );
+  VALIDATE_LOGERRMSG( LogEventFileName, CFG_STR_LOGEVENTFILENAME );
+  VALIDATE_LOGERRMSG( LogEventSize, CFG_STR_LOGEVENTSIZE );
+  VALIDATE_LOGERRMSG( LogMemoryFileName, CFG_STR_LOGMEMORYFILENAME );
+  VALIDATE_LOGERRMSG( LogMemorySize, CFG_STR_LOGMEMORYSIZE );
+  VALIDATE_LOGERRMSG( LogTimestampPrecision, CFG_STR_LOGTIMESTAMPPRECISION );
+  VALIDATE_LOGERRMSG( LogTimestampIso8601, CFG_STR_LOGTIMESTAMPISO8601 );
+  VALIDATE_LOGERRMSG( LogAsync, CFG_STR_LOGASYNC );
+  VALIDATE_LOGERRMSG( LogFlushInterval, CFG_STR_LOGFLUSHINTERVAL );
   VALIDATE_LOGERRMSG( SysLogFacility, CFG_STR_SYSLOGFACILITY );
   VALIDATE_LOGERRMSG( haccessProxyEnabled, CFG_STR_HACCESSPROXYENABLED );
   VALIDATE_LOGERRMSG( haccessWebEnabled, CFG_STR_HACCESSWEBENABLED  );
@@ -618,6 +680,29 @@ bool GOGOCConfig::ValidateConfigData( void )
     return m_bValid;
   }
 
+  // -------------------------------------------------------------
+  // 7. Check that ra_min_interval <= 0.75 * ra_max_interval.
+  try
+  {
+    long v1, v2;
+    Get_RaMinInterval( sValue );
+    Get_RaMaxInterval( sValue2 );
+
+    v1 = atol( sValue.c_str() );
+    v2 = atol( sValue2.c_str() );
+
+    if( v1 * 4 > v2 * 3 )
+    {
+      m_lsValidationErrors.push_back( GOGOC_UIS__G6V_RAMININTERVALGREATERRAMAXINTERVAL );
+      m_bValid = false;
+    }
+  }
+  catch(...)
+  { // Catched an invalid configuration exception.
+    m_bValid = false;
+    return m_bValid;
+  }
+
 #ifdef HACCESS
   // --------------------------------------------------------------
   // 7. If HACCESS Web is enabled, the document root cannot be empty.
@@ -763,6 +848,42 @@ void GOGOCConfig::Set_IfPrefix( const string& sIfPrefix )
 }
 
 
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_RaMinInterval( string& sRaMinInterval ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_RAMININTERVAL, sRaMinInterval );
+
+  // Push default value, if not present.
+  if( sRaMinInterval.size() == 0 )
+    sRaMinInterval = CFG_DFLT_RAMININTERVAL;
+}
+
+void GOGOCConfig::Set_RaMinInterval( const string& sRaMinInterval )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( RaMinInterval, CFG_STR_RAMININTERVAL );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_RaMaxInterval( string& sRaMaxInterval ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_RAMAXINTERVAL, sRaMaxInterval );
+
+  // Push default value, if not present.
+  if( sRaMaxInterval.size() == 0 )
+    sRaMaxInterval = CFG_DFLT_RAMAXINTERVAL;
+}
+
+void GOGOCConfig::Set_RaMaxInterval( const string& sRaMaxInterval )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( RaMaxInterval, CFG_STR_RAMAXINTERVAL );
+}
+
+
 // --------------------------------------------------------------------------
 void GOGOCConfig::Get_DnsServer( string& sDnsServer ) const
 {
@@ -1049,6 +1170,106 @@ void GOGOCConfig::Set_Template( const string& sTemplate )
 }
 
 
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_UseTemplate( string& sUseTemplate ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_USETEMPLATE, sUseTemplate );
+
+  // Push default value, if not present.
+  if( sUseTemplate.size() == 0 )
+    sUseTemplate = CFG_DFLT_USETEMPLATE;
+}
+
+void GOGOCConfig::Set_UseTemplate( const string& sUseTemplate )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( UseTemplate, CFG_STR_USETEMPLATE );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_KeepTunnel( string& sKeepTunnel ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_KEEPTUNNEL, sKeepTunnel );
+
+  // Push default value, if not present.
+  if( sKeepTunnel.size() == 0 )
+    sKeepTunnel = CFG_DFLT_KEEPTUNNEL;
+}
+
+void GOGOCConfig::Set_KeepTunnel( const string& sKeepTunnel )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( KeepTunnel, CFG_STR_KEEPTUNNEL );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_RouteTable( string& sRouteTable ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_ROUTETABLE, sRouteTable );
+
+  // Push default value, if not present.
+  if( sRouteTable.size() == 0 )
+    sRouteTable = CFG_DFLT_ROUTETABLE;
+}
+
+void GOGOCConfig::Set_RouteTable( const string& sRouteTable )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( RouteTable, CFG_STR_ROUTETABLE );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_RouteFwmark( string& sRouteFwmark ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_ROUTEFWMARK, sRouteFwmark );
+
+  // Push default value, if not present.
+  if( sRouteFwmark.size() == 0 )
+    sRouteFwmark = CFG_DFLT_ROUTEFWMARK;
+}
+
+void GOGOCConfig::Set_RouteFwmark( const string& sRouteFwmark )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( RouteFwmark, CFG_STR_ROUTEFWMARK );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_IfTunStandby( string& sIfTunStandby ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_IFTUNSTANDBY, sIfTunStandby );
+}
+
+void GOGOCConfig::Set_IfTunStandby( const string& sIfTunStandby )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( IfTunStandby, CFG_STR_IFTUNSTANDBY );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_StandbyServer( string& sStandbyServer ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_STANDBYSERVER, sStandbyServer );
+}
+
+void GOGOCConfig::Set_StandbyServer( const string& sStandbyServer )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( StandbyServer, CFG_STR_STANDBYSERVER );
+}
+
+
 // --------------------------------------------------------------------------
 void GOGOCConfig::Get_ProxyClient( string& sProxyClient ) const
 {
@@ -1239,6 +1460,186 @@ void GOGOCConfig::Set_LogRotationDel( const string& sLogRotationDel )
 }
 
 
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogRotationCount( string& sLogRotationCount ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGROTATIONCOUNT, sLogRotationCount );
+
+  // Push default value, if not present.
+  if( sLogRotationCount.size() == 0 )
+    sLogRotationCount = CFG_DFLT_LOGROTATIONCOUNT;
+}
+
+void GOGOCConfig::Set_LogRotationCount( const string& sLogRotationCount )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogRotationCount, CFG_STR_LOGROTATIONCOUNT );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogRotationCompress( string& sLogRotationCompress ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGROTATIONCOMPRESS, sLogRotationCompress );
+
+  // Push default value, if not present.
+  if( sLogRotationCompress.size() == 0 )
+    sLogRotationCompress = CFG_DFLT_LOGROTATIONCOMPRESS;
+}
+
+void GOGOCConfig::Set_LogRotationCompress( const string& sLogRotationCompress )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogRotationCompress, CFG_STR_LOGROTATIONCOMPRESS );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogEventFileName( string& sLogEventFileName ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGEVENTFILENAME, sLogEventFileName );
+
+  // Push default value, if not present.
+  if( sLogEventFileName.size() == 0 )
+    sLogEventFileName = CFG_DFLT_LOGEVENTFILENAME;
+}
+
+void GOGOCConfig::Set_LogEventFileName( const string& sLogEventFileName )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogEventFileName, CFG_STR_LOGEVENTFILENAME );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogEventSize( string& sLogEventSize ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGEVENTSIZE, sLogEventSize );
+
+  // Push default value, if not present.
+  if( sLogEventSize.size() == 0 )
+    sLogEventSize = CFG_DFLT_LOGEVENTSIZE;
+}
+
+void GOGOCConfig::Set_LogEventSize( const string& sLogEventSize )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogEventSize, CFG_STR_LOGEVENTSIZE );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogMemoryFileName( string& sLogMemoryFileName ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGMEMORYFILENAME, sLogMemoryFileName );
+
+  // Push default value, if not present.
+  if( sLogMemoryFileName.size() == 0 )
+    sLogMemoryFileName = CFG_DFLT_LOGMEMORYFILENAME;
+}
+
+void GOGOCConfig::Set_LogMemoryFileName( const string& sLogMemoryFileName )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogMemoryFileName, CFG_STR_LOGMEMORYFILENAME );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogMemorySize( string& sLogMemorySize ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGMEMORYSIZE, sLogMemorySize );
+
+  // Push default value, if not present.
+  if( sLogMemorySize.size() == 0 )
+    sLogMemorySize = CFG_DFLT_LOGMEMORYSIZE;
+}
+
+void GOGOCConfig::Set_LogMemorySize( const string& sLogMemorySize )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogMemorySize, CFG_STR_LOGMEMORYSIZE );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogTimestampPrecision( string& sLogTimestampPrecision ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGTIMESTAMPPRECISION, sLogTimestampPrecision );
+
+  // Push default value, if not present.
+  if( sLogTimestampPrecision.size() == 0 )
+    sLogTimestampPrecision = CFG_DFLT_LOGTIMESTAMPPRECISION;
+}
+
+void GOGOCConfig::Set_LogTimestampPrecision( const string& sLogTimestampPrecision )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogTimestampPrecision, CFG_STR_LOGTIMESTAMPPRECISION );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogTimestampIso8601( string& sLogTimestampIso8601 ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGTIMESTAMPISO8601, sLogTimestampIso8601 );
+
+  // Push default value, if not present.
+  if( sLogTimestampIso8601.size() == 0 )
+    sLogTimestampIso8601 = CFG_DFLT_LOGTIMESTAMPISO8601;
+}
+
+void GOGOCConfig::Set_LogTimestampIso8601( const string& sLogTimestampIso8601 )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogTimestampIso8601, CFG_STR_LOGTIMESTAMPISO8601 );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogAsync( string& sLogAsync ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGASYNC, sLogAsync );
+
+  // Push default value, if not present.
+  if( sLogAsync.size() == 0 )
+    sLogAsync = CFG_DFLT_LOGASYNC;
+}
+
+void GOGOCConfig::Set_LogAsync( const string& sLogAsync )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogAsync, CFG_STR_LOGASYNC );
+}
+
+
+// --------------------------------------------------------------------------
+void GOGOCConfig::Get_LogFlushInterval( string& sLogFlushInterval ) const
+{
+  ASSERT_VALID_CONFIG;
+  m_pConfig->GetVariableValue( CFG_STR_LOGFLUSHINTERVAL, sLogFlushInterval );
+
+  // Push default value, if not present.
+  if( sLogFlushInterval.size() == 0 )
+    sLogFlushInterval = CFG_DFLT_LOGFLUSHINTERVAL;
+}
+
+void GOGOCConfig::Set_LogFlushInterval( const string& sLogFlushInterval )
+{
+  ASSERT_VALID_CONFIG;
+  VERIFY_AND_SET( LogFlushInterval, CFG_STR_LOGFLUSHINTERVAL );
+}
+
+
 // --------------------------------------------------------------------------
 void GOGOCConfig::Get_SysLogFacility( string& sSysLogFacility ) const
 {
@@ -147,7 +147,7 @@ static const tgogocUIStrings gogocUIStrings[] = {
   { GOGOC_UIS__G6V_LOGLEVELINVALIDVALUE,
     "(log=)Log level must be between 0 and 3." },
   { GOGOC_UIS__G6V_LOGDEVICEINVALIDVALUE,
-    "(log=)Log device must be: <console|stderr|file|syslog>" },
+    "(log=)Log device must be: <console|stderr|file|syslog|event|memory>" },
   { GOGOC_UIS__G6V_LOGFILENAMETOOLONG,
     "(log_filename=)Log filename cannot be greater than 256 characters." },
   { GOGOC_UIS__G6V_LOGFILENAMEINVALIDCHRS,
@@ -178,7 +178,45 @@ static const tgogocUIStrings gogocUIStrings[] = {
   { GOGOC_UIS__G6V_RETRYDELAYMAXINVALIDVALUE,
     "(retry_delay_max=)Retry delay max must be between 0 and 3600." },
   { GOGOC_UIS__G6V_RETRYDELAYGREATERRETRYDELAYMAX,
-    "(retry_delay_max=)Retry delay max must be greater than retry delay." }
+    "(retry_delay_max=)Retry delay max must be greater than retry delay." },
+  { GOGOC_UIS__G6V_USETEMPLATEINVALIDVALUE,
+    "(use_template=)Use template must be: <yes|no>" },
+  { GOGOC_UIS__G6V_RAMININTERVALINVALIDVALUE,
+    "(ra_min_interval=)Router advertisement min interval must be between 3 and 1350." },
+  { GOGOC_UIS__G6V_RAMAXINTERVALINVALIDVALUE,
+    "(ra_max_interval=)Router advertisement max interval must be between 4 and 1800." },
+  { GOGOC_UIS__G6V_RAMININTERVALGREATERRAMAXINTERVAL,
+    "(ra_min_interval=)Router advertisement min interval must not exceed 3/4 of the max interval." },
+  { GOGOC_UIS__G6V_KEEPTUNNELINVALIDVALUE,
+    "(keep_tunnel=)Keep tunnel must be: <yes|no>" },
+  { GOGOC_UIS__G6V_ROUTETABLEINVALIDVALUE,
+    "(route_table=)Route table must be between 0 and 252." },
+  { GOGOC_UIS__G6V_ROUTEFWMARKINVALIDVALUE,
+    "(route_fwmark=)Route fwmark must be between 0 and 2147483647." },
+  { GOGOC_UIS__G6V_IFTUNSTANDBYINVALIDCHRS,
+    "(if_tunnel_standby=)Invalid characters found in interface name." },
+  { GOGOC_UIS__G6V_STANDBYSERVERINVALID,
+    "(standby_server=)Server name is too long or contains invalid characters." },
+  { GOGOC_UIS__G6V_LOGASYNCINVALIDVALUE,
+    "(log_async=)Asynchronous logging must be: <yes|no>" },
+  { GOGOC_UIS__G6V_LOGFLUSHINTERVALINVALIDVALUE,
+    "(log_flush_interval=)Log flush interval must be between 10 and 10000." },
+  { GOGOC_UIS__G6V_LOGROTCOUNTINVALIDVALUE,
+    "(log_rotation_count=)Log rotation count must be between 1 and 99." },
+  { GOGOC_UIS__G6V_LOGROTCOMPRESSINVALIDVALUE,
+    "(log_rotation_compress=)Log rotation compression must be: <yes|no>" },
+  { GOGOC_UIS__G6V_LOGEVENTFILENAMEINVALID,
+    "(log_event_filename=)Invalid event log file name." },
+  { GOGOC_UIS__G6V_LOGEVENTSIZEINVALIDVALUE,
+    "(log_event_size=)Event log size must be: <16|64|256|1024>" },
+  { GOGOC_UIS__G6V_LOGMEMORYFILENAMEINVALID,
+    "(log_memory_filename=)Invalid memory log file name." },
+  { GOGOC_UIS__G6V_LOGMEMORYSIZEINVALIDVALUE,
+    "(log_memory_size=)Memory log size must be: <16|64|256|1024>" },
+  { GOGOC_UIS__G6V_LOGTSPRECISIONINVALIDVALUE,
+    "(log_timestamp_precision=)Log timestamp precision must be: <s|ms|us>" },
+  { GOGOC_UIS__G6V_LOGTSISO8601INVALIDVALUE,
+    "(log_timestamp_iso8601=)Log timestamp ISO 8601 format must be: <yes|no>" }
 };
 
 
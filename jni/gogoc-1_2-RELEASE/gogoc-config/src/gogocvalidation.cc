@@ -34,9 +34,21 @@
 #define CFG_MAX_RETRYDELAY                3600
 #define CFG_MIN_RETRYDELAYMAX             0
 #define CFG_MAX_RETRYDELAYMAX             3600
+#define CFG_MIN_RAMININTERVAL             3
+#define CFG_MAX_RAMININTERVAL             1350
+#define CFG_MIN_RAMAXINTERVAL             4
+#define CFG_MAX_RAMAXINTERVAL             1800
+#define CFG_MIN_ROUTETABLE                0
+#define CFG_MAX_ROUTETABLE                252
+#define CFG_MIN_ROUTEFWMARK               0
+#define CFG_MAX_ROUTEFWMARK               2147483647
 #define CFG_MAX_FILENAME_LEN              256
 #define CFG_MIN_LOG_LEVEL                 0
 #define CFG_MAX_LOG_LEVEL                 3
+#define CFG_MIN_LOGROTATIONCOUNT          1
+#define CFG_MAX_LOGROTATIONCOUNT          99
+#define CFG_MIN_LOGFLUSHINTERVAL          10
+#define CFG_MAX_LOGFLUSHINTERVAL          10000
 
 // Domain values.
 static const char* cfgHOSTTYPE_values[]         = { STR_HOSTTYPE_HOST, STR_HOSTTYPE_ROUTER };
@@ -45,12 +57,20 @@ static const char* cfgAUTORETRYCONNECT_values[] = { STR_YES, STR_NO };
 static const char* cfgKEEPALIVE_values[]        = { STR_YES, STR_NO };
 static const char* cfgTUNNELMODE_values[]       = { STR_V6ANYV4, STR_V6V4, STR_V6UDPV4, STR_V4V6, STR_DSLITE };
 static const char* cfgTEMPLATE_values[]         = { "freebsd","netbsd","linux",STR_TEMPL_WINDOWS,"darwin","cisco","sunos","openbsd","openwrt", "gogocpe" };
+static const char* cfgUSETEMPLATE_values[]      = { STR_YES, STR_NO };
+static const char* cfgKEEPTUNNEL_values[]       = { STR_YES, STR_NO };
 static const char* cfgPROXYCLIENT_values[]      = { STR_YES, STR_NO };
 static const char* cfgALWAYSUSELASTSVR_values[] = { STR_YES, STR_NO };
-static const char* cfgLOGDEVICE_values[]        = { STR_LOGDEV_CONSOLE,STR_LOGDEV_STDERR,STR_LOGDEV_FILE,STR_LOGDEV_SYSLOG };
+static const char* cfgLOGDEVICE_values[]        = { STR_LOGDEV_CONSOLE,STR_LOGDEV_STDERR,STR_LOGDEV_FILE,STR_LOGDEV_SYSLOG,STR_LOGDEV_EVENT,STR_LOGDEV_MEMORY };
 static const char* cfgLOGROTATION_values[]      = { STR_YES, STR_NO };
 static const char* cfgLOGROTATIONSZ_values[]    = { STR_LOGROTSZ_16K, STR_LOGROTSZ_32K, STR_LOGROTSZ_128K, STR_LOGROTSZ_1024K };
 static const char* cfgLOGROTATIONDEL_values[]   = { STR_YES, STR_NO };
+static const char* cfgLOGROTATIONCOMPRESS_values[] = { STR_YES, STR_NO };
+static const char* cfgLOGEVENTSIZE_values[]     = { "16", "64", "256", "1024" };
+static const char* cfgLOGMEMORYSIZE_values[]    = { "16", "64", "256", "1024" };
+static const char* cfgLOGTIMESTAMPPRECISION_values[] = { "s", "ms", "us" };
+static const char* cfgLOGTIMESTAMPISO8601_values[] = { STR_YES, STR_NO };
+static const char* cfgLOGASYNC_values[]         = { STR_YES, STR_NO };
 static const char* cfgSYSLOGFACILITY_values[]   = { "USER","LOCAL0","LOCAL1","LOCAL2","LOCAL3","LOCAL4","LOCAL5","LOCAL6","LOCAL7" };
 static const char* cfgHACCESSPROXYENABLED_values[] = { STR_YES, STR_NO };
 static const char* cfgHACCESSWEBENABLED_values[]   = { STR_YES, STR_NO };
@@ -256,6 +276,52 @@ bool Validate_IfPrefix( const string& sIfPrefix )
   return true;
 }
 
+// --------------------------------------------------------------------------
+bool Validate_RaMinInterval( const string& sRaMinInterval )
+{
+  // Facultative
+  if( sRaMinInterval.size() == 0 ) return true;
+
+  // Check characters are all numeric.
+  if( sRaMinInterval.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_RAMININTERVALINVALIDVALUE;
+    return false;
+  }
+
+  long _RaMinInterval = strtol(sRaMinInterval.c_str(), (char**)NULL, 10);
+  if( _RaMinInterval < CFG_MIN_RAMININTERVAL || _RaMinInterval > CFG_MAX_RAMININTERVAL)
+  {
+    gssLastError = GOGOC_UIS__G6V_RAMININTERVALINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_RaMaxInterval( const string& sRaMaxInterval )
+{
+  // Facultative
+  if( sRaMaxInterval.size() == 0 ) return true;
+
+  // Check characters are all numeric.
+  if( sRaMaxInterval.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_RAMAXINTERVALINVALIDVALUE;
+    return false;
+  }
+
+  long _RaMaxInterval = strtol(sRaMaxInterval.c_str(), (char**)NULL, 10);
+  if( _RaMaxInterval < CFG_MIN_RAMAXINTERVAL || _RaMaxInterval > CFG_MAX_RAMAXINTERVAL)
+  {
+    gssLastError = GOGOC_UIS__G6V_RAMAXINTERVALINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
 // --------------------------------------------------------------------------
 bool Validate_DnsServer( const string& sDnsServer )
 {
@@ -585,6 +651,120 @@ bool Validate_Template( const string& sTemplate )
   return false;
 }
 
+// --------------------------------------------------------------------------
+bool Validate_UseTemplate( const string& sUseTemplate )
+{
+  // Facultative
+  if( sUseTemplate.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgUSETEMPLATE_values)/sizeof(cfgUSETEMPLATE_values[0])); i++)
+  {
+    if( sUseTemplate == cfgUSETEMPLATE_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_USETEMPLATEINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_KeepTunnel( const string& sKeepTunnel )
+{
+  // Facultative
+  if( sKeepTunnel.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgKEEPTUNNEL_values)/sizeof(cfgKEEPTUNNEL_values[0])); i++)
+  {
+    if( sKeepTunnel == cfgKEEPTUNNEL_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_KEEPTUNNELINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_RouteTable( const string& sRouteTable )
+{
+  // Facultative
+  if( sRouteTable.size() == 0 ) return true;
+
+  // Check characters are all numeric.
+  if( sRouteTable.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_ROUTETABLEINVALIDVALUE;
+    return false;
+  }
+
+  long _RouteTable = strtol(sRouteTable.c_str(), (char**)NULL, 10);
+  if( _RouteTable < CFG_MIN_ROUTETABLE || _RouteTable > CFG_MAX_ROUTETABLE )
+  {
+    gssLastError = GOGOC_UIS__G6V_ROUTETABLEINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_RouteFwmark( const string& sRouteFwmark )
+{
+  // Facultative
+  if( sRouteFwmark.size() == 0 ) return true;
+
+  // Check characters are all numeric, and not too many of them.
+  if( sRouteFwmark.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos ||
+      sRouteFwmark.size() > 10 )
+  {
+    gssLastError = GOGOC_UIS__G6V_ROUTEFWMARKINVALIDVALUE;
+    return false;
+  }
+
+  long long _RouteFwmark = strtoll(sRouteFwmark.c_str(), (char**)NULL, 10);
+  if( _RouteFwmark < CFG_MIN_ROUTEFWMARK || _RouteFwmark > CFG_MAX_ROUTEFWMARK )
+  {
+    gssLastError = GOGOC_UIS__G6V_ROUTEFWMARKINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_IfTunStandby( const string& sIfTunStandby )
+{
+  // Facultative
+  if( sIfTunStandby.size() == 0 ) return true;
+
+  // Check for invalid characters
+  if( sIfTunStandby.find_first_not_of( CFG_DNS_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_IFTUNSTANDBYINVALIDCHRS;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_StandbyServer( const string& sStandbyServer )
+{
+  // Facultative
+  if( sStandbyServer.size() == 0 ) return true;
+
+  // Check string length and characters.
+  if( sStandbyServer.size() > CFG_MAX_SERVER ||
+      sStandbyServer.find_first_not_of( CFG_SERVER_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_STANDBYSERVERINVALID;
+    return false;
+  }
+
+  return true;
+}
+
 // --------------------------------------------------------------------------
 bool Validate_ProxyClient( const string& sProxyClient )
 {
@@ -761,6 +941,188 @@ bool Validate_LogRotationDel( const string& sLogRotationDel )
   return false;
 }
 
+// --------------------------------------------------------------------------
+bool Validate_LogRotationCount( const string& sLogRotationCount )
+{
+  // Facultative
+  if( sLogRotationCount.size() == 0 ) return true;
+
+  // Check characters are all numeric.
+  if( sLogRotationCount.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGROTCOUNTINVALIDVALUE;
+    return false;
+  }
+
+  long _LogRotationCount = strtol(sLogRotationCount.c_str(), (char**)NULL, 10);
+  if( _LogRotationCount < CFG_MIN_LOGROTATIONCOUNT || _LogRotationCount > CFG_MAX_LOGROTATIONCOUNT )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGROTCOUNTINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogRotationCompress( const string& sLogRotationCompress )
+{
+  // Facultative
+  if( sLogRotationCompress.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGROTATIONCOMPRESS_values)/sizeof(cfgLOGROTATIONCOMPRESS_values[0])); i++)
+  {
+    if( sLogRotationCompress == cfgLOGROTATIONCOMPRESS_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGROTCOMPRESSINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogEventFileName( const string& sLogEventFileName )
+{
+  // Facultative
+  if( sLogEventFileName.size() == 0 ) return true;
+
+  // Check string length and characters.
+  if( sLogEventFileName.size() > CFG_MAX_FILENAME_LEN ||
+      sLogEventFileName.find_first_not_of( CFG_FILENAME_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGEVENTFILENAMEINVALID;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogEventSize( const string& sLogEventSize )
+{
+  // Facultative
+  if( sLogEventSize.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGEVENTSIZE_values)/sizeof(cfgLOGEVENTSIZE_values[0])); i++)
+  {
+    if( sLogEventSize == cfgLOGEVENTSIZE_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGEVENTSIZEINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogMemoryFileName( const string& sLogMemoryFileName )
+{
+  // Facultative
+  if( sLogMemoryFileName.size() == 0 ) return true;
+
+  // Check string length and characters.
+  if( sLogMemoryFileName.size() > CFG_MAX_FILENAME_LEN ||
+      sLogMemoryFileName.find_first_not_of( CFG_FILENAME_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGMEMORYFILENAMEINVALID;
+    return false;
+  }
+
+  return true;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogMemorySize( const string& sLogMemorySize )
+{
+  // Facultative
+  if( sLogMemorySize.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGMEMORYSIZE_values)/sizeof(cfgLOGMEMORYSIZE_values[0])); i++)
+  {
+    if( sLogMemorySize == cfgLOGMEMORYSIZE_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGMEMORYSIZEINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogTimestampPrecision( const string& sLogTimestampPrecision )
+{
+  // Facultative
+  if( sLogTimestampPrecision.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGTIMESTAMPPRECISION_values)/sizeof(cfgLOGTIMESTAMPPRECISION_values[0])); i++)
+  {
+    if( sLogTimestampPrecision == cfgLOGTIMESTAMPPRECISION_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGTSPRECISIONINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogTimestampIso8601( const string& sLogTimestampIso8601 )
+{
+  // Facultative
+  if( sLogTimestampIso8601.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGTIMESTAMPISO8601_values)/sizeof(cfgLOGTIMESTAMPISO8601_values[0])); i++)
+  {
+    if( sLogTimestampIso8601 == cfgLOGTIMESTAMPISO8601_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGTSISO8601INVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogAsync( const string& sLogAsync )
+{
+  // Facultative
+  if( sLogAsync.size() == 0 ) return true;
+
+  // Check against domain values.
+  for(unsigned int i=0; i<(sizeof(cfgLOGASYNC_values)/sizeof(cfgLOGASYNC_values[0])); i++)
+  {
+    if( sLogAsync == cfgLOGASYNC_values[i] )
+      return true;
+  }
+  gssLastError = GOGOC_UIS__G6V_LOGASYNCINVALIDVALUE;
+
+  return false;
+}
+
+// --------------------------------------------------------------------------
+bool Validate_LogFlushInterval( const string& sLogFlushInterval )
+{
+  // Facultative
+  if( sLogFlushInterval.size() == 0 ) return true;
+
+  // Check characters are all numeric.
+  if( sLogFlushInterval.find_first_not_of( CFG_NUMERIC_CHRS ) != string::npos )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGFLUSHINTERVALINVALIDVALUE;
+    return false;
+  }
+
+  long _LogFlushInterval = strtol(sLogFlushInterval.c_str(), (char**)NULL, 10);
+  if( _LogFlushInterval < CFG_MIN_LOGFLUSHINTERVAL || _LogFlushInterval > CFG_MAX_LOGFLUSHINTERVAL )
+  {
+    gssLastError = GOGOC_UIS__G6V_LOGFLUSHINTERVALINVALIDVALUE;
+    return false;
+  }
+
+  return true;
+}
+
 // --------------------------------------------------------------------------
 bool Validate_SysLogFacility( const string& sSysLogFacility )
 {
@@ -49,6 +49,7 @@ namespace gogocmessaging
     error_t         Recv_BrokerListRequest( void );
     error_t         Recv_HACCESSConfigInfo   ( const HACCESSConfigInfo* aHACCESSConfigInfo );
     error_t         Recv_HACCESSStatusInfoRequest( void );
+    error_t         Recv_LogConfigInfo    ( const gogocLogConfigInfo* aLogConfigInfo );
 
     // Overrides from the ServerMsgSender:
     void            PostMessage           ( Message* pMsg );
@@ -34,11 +34,13 @@ error_t   RetrieveStatusInfo    ( gogocStatusInfo** ppStatusInfo );
 error_t   RetrieveTunnelInfo    ( gogocTunnelInfo** ppTunnelInfo );
 error_t   RetrieveBrokerList    ( gogocBrokerList** ppBrokerList );
 error_t   RetrieveHACCESSStatusInfo( HACCESSStatusInfo** ppHACCESSStatusInfo );
+error_t   RetrieveConnTrace     ( gogocConnTrace** ppConnTrace );
 
 void      FreeStatusInfo        ( gogocStatusInfo** ppStatusInfo );
 void      FreeTunnelInfo        ( gogocTunnelInfo** ppTunnelInfo );
 void      FreeBrokerList        ( gogocBrokerList** ppBrokerList );
 void      FreeHACCESSStatusInfo    ( HACCESSStatusInfo** ppHACCESSStatusInfo );
+void      FreeConnTrace         ( gogocConnTrace** ppConnTrace );
 
 #ifdef __cplusplus
 }
@@ -21,6 +21,7 @@
 
 
 #include <gogocmessaging/haccessmsgdata.h>
+#include <gogocmessaging/gogocmsgdata.h>
 #include <gogocmessaging/gogocuistrings.h>      // error_t definition & codes.
 
 
@@ -30,6 +31,7 @@ extern "C" {
 
 
 error_t   NotifyhaccessConfigInfo  ( const HACCESSConfigInfo* aHACCESSConfigInfo );
+error_t   NotifyLogConfigInfo      ( const gogocLogConfigInfo* aLogConfigInfo );
 
 
 #ifdef __cplusplus
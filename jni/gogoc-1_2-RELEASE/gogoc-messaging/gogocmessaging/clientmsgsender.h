@@ -19,6 +19,7 @@
 
 #include <gogocmessaging/messagesender.h>
 #include <gogocmessaging/haccessmsgdata.h>
+#include <gogocmessaging/gogocmsgdata.h>
 #include <gogocmessaging/gogocuistrings.h>
 #undef PostMessage
 
@@ -40,6 +41,7 @@ namespace gogocmessaging
     void            Send_BrokerListRequest( void );
     void            Send_HACCESSConfigInfo   ( const HACCESSConfigInfo* aHACCESSCfgInfo );
     void            Send_HACCESSStatusInfoRequest( void );
+    void            Send_LogConfigInfo    ( const gogocLogConfigInfo* aLogConfigInfo );
 
   protected:
     virtual void    PostMessage           ( Message* pMsg )=0;
@@ -44,6 +44,7 @@ namespace gogocmessaging
     virtual error_t Recv_TunnelInfo       ( const gogocTunnelInfo* aTunnelInfo )=0;
     virtual error_t Recv_BrokerList       ( const gogocBrokerList* aBrokerList )=0;
     virtual error_t Recv_HACCESSStatusInfo   ( const HACCESSStatusInfo* aHACCESSStatusInfo )=0;
+    virtual error_t Recv_ConnTrace        ( const gogocConnTrace* aConnTrace )=0;
 
   private:
     // Message data translators.
@@ -51,6 +52,7 @@ namespace gogocmessaging
     error_t         TranslateTunnelInfo   ( uint8_t* pData, const uint16_t nDataLen );
     error_t         TranslateBrokerList   ( uint8_t* pData, const uint16_t nDataLen );
     error_t         TranslateHACCESSStatusInfo( uint8_t* pData, const uint16_t nDataLen );
+    error_t         TranslateConnTrace    ( uint8_t* pData, const uint16_t nDataLen );
   };
 
 }
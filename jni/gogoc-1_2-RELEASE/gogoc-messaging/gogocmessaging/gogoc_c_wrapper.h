@@ -38,6 +38,7 @@ error_t             send_status_info      ( void );
 error_t             send_tunnel_info      ( void );
 error_t             send_broker_list      ( void );
 error_t             send_haccess_status_info ( void );
+error_t             send_conn_trace       ( void );
 
 
 // Will be declared in: tsp_client.c
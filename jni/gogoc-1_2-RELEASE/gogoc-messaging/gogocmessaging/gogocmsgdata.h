@@ -107,4 +107,46 @@ typedef struct __BROKER_LIST
 } gogocBrokerList;
 
 
+// gogoCLIENT connection attempt trace: gogocConnTrace - (Data structure)
+//   - nAttempt: Sequence number of the connection attempt.
+//   - attemptTime: c-time at which the attempt started.
+//   - nTransport: Transport used for the TSP session.
+//   - szBrokerName: The name of the broker contacted.
+//   - nStatus: Outcome of the attempt (a gogoc_status value).
+//   - nPhaseMs: Duration of each setup phase, in milliseconds, in this order:
+//       connect, capabilities, authentication, tunnel negotiation, interface
+//       setup, first keepalive reply. -1 if the phase was not reached.
+//   - nTotalMs: Duration of the whole attempt, in milliseconds.
+//
+#define GOGOC_CONNTRACE_PHASES  6
+
+typedef struct __CONN_TRACE
+{
+  unsigned int nAttempt;
+  time_t attemptTime;
+  int nTransport;
+  char* szBrokerName;
+  unsigned int nStatus;
+  int nPhaseMs[GOGOC_CONNTRACE_PHASES];
+  int nTotalMs;
+} gogocConnTrace;
+
+
+// gogoCLIENT log levels: gogocLogConfigInfo - (Data structure)
+//   - nLogLevelConsole: New log level of the console (0 to 3), -1 to keep it.
+//   - nLogLevelFile: New log level of the log file (0 to 3), -1 to keep it.
+//   - nLogLevelSyslog: New log level of syslog (0 to 3), -1 to keep it.
+//   - nDuration: Seconds after which the previous levels are restored (debug
+//       burst), or 0 to keep the new levels.
+//   A destination disabled in the configuration file cannot be enabled.
+//
+typedef struct __LOG_CONFIG_INFO
+{
+  int nLogLevelConsole;
+  int nLogLevelFile;
+  int nLogLevelSyslog;
+  unsigned int nDuration;
+} gogocLogConfigInfo;
+
+
 #endif
@@ -36,6 +36,7 @@ namespace gogocmessaging
     typedef void    (*RecvTunnelInfo)     ( const gogocTunnelInfo* );
     typedef void    (*RecvBrokerList)     ( const gogocBrokerList* );
     typedef void    (*RecvHACCESSStatusInfo) ( const HACCESSStatusInfo* );
+    typedef void    (*RecvConnTrace)      ( const gogocConnTrace* );
 
   public:
     // Handling functions.
@@ -43,6 +44,7 @@ namespace gogocmessaging
     RecvTunnelInfo  m_RecvTunnelInfo;
     RecvBrokerList  m_RecvBrokerList;
     RecvHACCESSStatusInfo m_RecvHACCESSStatusInfo;
+    RecvConnTrace   m_RecvConnTrace;
   private:
     CommunicationsManager m_CommManager;
 
@@ -62,6 +64,7 @@ namespace gogocmessaging
     error_t         Recv_TunnelInfo       ( const gogocTunnelInfo* aTunnelInfo );
     error_t         Recv_BrokerList       ( const gogocBrokerList* aBrokerList );
     error_t         Recv_HACCESSStatusInfo   ( const HACCESSStatusInfo* aHACCESSStatusInfo );
+    error_t         Recv_ConnTrace        ( const gogocConnTrace* aConnTrace );
 
     // Overrides from the ClientMsgSender:
     void            PostMessage           ( Message* pMsg );
@@ -39,12 +39,14 @@
 #define MESSAGEID_REQUEST_BROKERLIST      0x0003  // Request for broker list
 #define MESSAGEID_HACCESSCONFIGINFO          0x0004  // Send HACCESS config info
 #define MESSAGEID_REQUEST_HACCESSSTATUSINFO  0x0005  // Request for HACCESS status info
+#define MESSAGEID_LOGCONFIGINFO           0x0006  // Set log levels
 
 // Sent from gogoCLIENT - received by gogoCLIENT GUI
 #define MESSAGEID_STATUSINFO              0x0101  // Status info message
 #define MESSAGEID_TUNNELINFO              0x0102  // Tunnel info message
 #define MESSAGEID_BROKERLIST              0x0103  // Broker list message
 #define MESSAGEID_HACCESSSTATUSINFO          0x0104  // Send HACCESS status info
+#define MESSAGEID_CONNTRACE               0x0105  // Connection attempt trace
 
 
 #if defined(WIN32) || defined(WINCE)
@@ -40,6 +40,7 @@ namespace gogocmessaging
     void            Send_TunnelInfo       ( const gogocTunnelInfo* aTunnelInfo );
     void            Send_BrokerList       ( const gogocBrokerList* aBrokerList );
     void            Send_HACCESSStatusInfo   ( const HACCESSStatusInfo* aHACCESSStatusInfo );
+    void            Send_ConnTrace        ( const gogocConnTrace* aConnTrace );
 
   protected:
     virtual void    PostMessage           ( Message* pMsg )=0;
@@ -21,6 +21,7 @@
 #include <gogocmessaging/messageprocessor.h>
 #include <gogocmessaging/gogocuistrings.h>
 #include <gogocmessaging/haccessmsgdata.h>
+#include <gogocmessaging/gogocmsgdata.h>
 
 
 namespace gogocmessaging
@@ -44,6 +45,7 @@ namespace gogocmessaging
     virtual error_t Recv_BrokerListRequest( void )=0;
     virtual error_t Recv_HACCESSConfigInfo   ( const HACCESSConfigInfo* aHACCESSConfigInfo )=0;
     virtual error_t Recv_HACCESSStatusInfoRequest( void )=0;
+    virtual error_t Recv_LogConfigInfo    ( const gogocLogConfigInfo* aLogConfigInfo )=0;
 
   private:
     // Message data translators.
@@ -52,6 +54,7 @@ namespace gogocmessaging
     error_t         TranslateBrokerListReq( uint8_t* pData, const uint16_t nDataLen );
     error_t         TranslateHACCESSConfigInfo( uint8_t* pData, const uint16_t nDataLen );
     error_t         TranslateHACCESSStatusInfoReq( uint8_t* pData, const uint16_t nDataLen );
+    error_t         TranslateLogConfigInfo( uint8_t* pData, const uint16_t nDataLen );
   };
 
 }
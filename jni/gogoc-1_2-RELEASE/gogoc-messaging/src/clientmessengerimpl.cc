@@ -232,6 +232,28 @@ error_t ClientMessengerImpl::Recv_HACCESSStatusInfoRequest( void )
 }
 
 
+// --------------------------------------------------------------------------
+// Function : Recv_LogConfigInfo
+//
+// Description:
+//   Will call the C function that is implemented in the GOGOC.
+//
+// Arguments:
+//   aLogConfigInfo: gogocLogConfigInfo* [IN], The new log levels.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Indicates success receiving message.
+//
+// --------------------------------------------------------------------------
+error_t ClientMessengerImpl::Recv_LogConfigInfo( const gogocLogConfigInfo* aLogConfigInfo )
+{
+  // C++ -> C bridge
+
+  // This C function is implemented in the gogoCLIENT.
+  return NotifyLogConfigInfo( aLogConfigInfo );
+}
+
+
 // --------------------------------------------------------------------------
 // Function : PostMessage
 //
@@ -213,4 +213,54 @@ void ClientMsgSender::Send_HACCESSStatusInfoRequest( void )
   PostMessage( pMsg );
 }
 
+
+// --------------------------------------------------------------------------
+// Function : Send_LogConfigInfo
+//
+// Description:
+//   Will post a message to change the log levels of the gogoCLIENT, for
+//   good or for a number of seconds.
+//
+// Arguments:
+//   aLogConfigInfo: gogocLogConfigInfo* [IN], The new log levels.
+//
+// Return values: (none)
+//
+// --------------------------------------------------------------------------
+void ClientMsgSender::Send_LogConfigInfo( const gogocLogConfigInfo* aLogConfigInfo )
+{
+  Message* pMsg;
+  uint8_t pData[MSG_MAX_USERDATA];
+  uint32_t nDataLen = 0;
+
+  assert( aLogConfigInfo != NULL );
+
+
+  // Insert console, file and syslog levels.
+  memcpy( pData + nDataLen, (void*)&(aLogConfigInfo->nLogLevelConsole), sizeof(aLogConfigInfo->nLogLevelConsole) );
+  nDataLen += sizeof(aLogConfigInfo->nLogLevelConsole);
+
+  memcpy( pData + nDataLen, (void*)&(aLogConfigInfo->nLogLevelFile), sizeof(aLogConfigInfo->nLogLevelFile) );
+  nDataLen += sizeof(aLogConfigInfo->nLogLevelFile);
+
+  memcpy( pData + nDataLen, (void*)&(aLogConfigInfo->nLogLevelSyslog), sizeof(aLogConfigInfo->nLogLevelSyslog) );
+  nDataLen += sizeof(aLogConfigInfo->nLogLevelSyslog);
+
+  // Append duration.
+  memcpy( pData + nDataLen, (void*)&(aLogConfigInfo->nDuration), sizeof(aLogConfigInfo->nDuration) );
+  nDataLen += sizeof(aLogConfigInfo->nDuration);
+
+
+  assert( nDataLen <= MSG_MAX_USERDATA );       // Buffer overflow has occured.
+
+
+  // Create Message.
+  pMsg = Message::CreateMessage( MESSAGEID_LOGCONFIGINFO, nDataLen, pData );
+  assert( pMsg != NULL );
+
+
+  // Post the message.
+  PostMessage( pMsg );
+}
+
 } // namespace
@@ -103,6 +103,10 @@ error_t ClientMsgTranslator::ProcessMessage( Message* pMsg )
       retCode = TranslateHACCESSStatusInfo( pMsg->msg._data, pMsg->msg.header._datalen );
       break;
 
+    case MESSAGEID_CONNTRACE:
+      retCode = TranslateConnTrace( pMsg->msg._data, pMsg->msg.header._datalen );
+      break;
+
     default:
       retCode = GOGOCM_UIS_MESSAGENOTIMPL; // Unknown / invalid message.
       break;
@@ -437,4 +441,80 @@ error_t ClientMsgTranslator::TranslateHACCESSStatusInfo( uint8_t* pData, const u
 }
 
 
+
+// --------------------------------------------------------------------------
+// Function : TranslateConnTrace
+//
+// Description:
+//   Will extract the connection attempt trace from the byte buffer and
+//   invoke the handler.
+//
+// Arguments:
+//   pData: uint8_t* [IN], The raw data.
+//   nDataLen: uint16_t [IN], The length of the raw data.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Successful operation.
+//   any other value on error.
+//
+// --------------------------------------------------------------------------
+error_t ClientMsgTranslator::TranslateConnTrace( uint8_t* pData, const uint16_t nDataLen )
+{
+  gogocConnTrace connTrace;
+  uint32_t nCursor = 0;
+  error_t retCode;
+
+
+  // -- D A T A   E X T R A C T I O N --
+
+  // Extract attempt number and start time from data buffer.
+  memcpy( (void*)&(connTrace.nAttempt), pData + nCursor, sizeof(connTrace.nAttempt) );
+  nCursor += sizeof(connTrace.nAttempt);
+
+  memcpy( (void*)&(connTrace.attemptTime), pData + nCursor, sizeof(time_t) );
+  nCursor += sizeof(time_t);
+
+  // Extract transport from data buffer.
+  memcpy( (void*)&(connTrace.nTransport), pData + nCursor, sizeof(connTrace.nTransport) );
+  nCursor += sizeof(connTrace.nTransport);
+
+  // Extract broker name from data buffer.
+  connTrace.szBrokerName = pal_strdup( (char*)(pData + nCursor) );
+  nCursor += pal_strlen( (char*)(pData + nCursor) ) + 1;
+
+  // Extract outcome, phase durations and total duration from data buffer.
+  memcpy( (void*)&(connTrace.nStatus), pData + nCursor, sizeof(connTrace.nStatus) );
+  nCursor += sizeof(connTrace.nStatus);
+
+  memcpy( (void*)connTrace.nPhaseMs, pData + nCursor, sizeof(connTrace.nPhaseMs) );
+  nCursor += sizeof(connTrace.nPhaseMs);
+
+  memcpy( (void*)&(connTrace.nTotalMs), pData + nCursor, sizeof(connTrace.nTotalMs) );
+  nCursor += sizeof(connTrace.nTotalMs);
+
+
+  // -----------------------------------------------------------------------
+  // Sanity check. Verify that the bytes of data we extracted match that of
+  // what was expected.
+  // -----------------------------------------------------------------------
+  assert( nCursor == nDataLen );
+
+
+  // ---------------------------------
+  // Invoke derived function handler.
+  // ---------------------------------
+  retCode = Recv_ConnTrace( &connTrace );
+
+
+  // -----------------------------------------------
+  // Clean up allocated memory used for extraction.
+  // -----------------------------------------------
+  free( connTrace.szBrokerName );
+
+
+  // Return completion code.
+  return retCode;
+}
+
+
 } // namespace
@@ -236,4 +236,40 @@ extern "C" error_t send_haccess_status_info( void )
 }
 
 
+// --------------------------------------------------------------------------
+// Function : send_conn_trace
+//
+// Description:
+//   Sends the trace of the last connection attempt to the GUI (or whichever
+//   client that's connected).
+//
+// Arguments: (none)
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Successful completion.
+//   GOGOCM_UIS_CWRAPNOTINIT: Messenger not initialized.
+//
+// --------------------------------------------------------------------------
+extern "C" error_t send_conn_trace( void )
+{
+  gogocConnTrace* pConnTrace = NULL;
+  error_t retCode = GOGOCM_UIS__NOERROR;
 
+
+  // Verify if messenger object has been initialized.
+  if( pMessenger == NULL )
+    return GOGOCM_UIS_CWRAPNOTINIT;
+
+  // Callback to the gogoCLIENT process, to gather required information.
+  retCode = RetrieveConnTrace( &pConnTrace );
+  if( retCode == GOGOCM_UIS__NOERROR )
+  {
+    // Send the connection trace to the other side.
+    pMessenger->Send_ConnTrace( pConnTrace );
+
+    // Frees the memory used by the ConnTrace object.
+    FreeConnTrace( &pConnTrace );
+  }
+
+  return retCode;
+}
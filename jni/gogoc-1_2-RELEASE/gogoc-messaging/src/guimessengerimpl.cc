@@ -37,6 +37,7 @@ GUIMessengerImpl::GUIMessengerImpl( void ) :
   m_RecvTunnelInfo(NULL),
   m_RecvBrokerList(NULL),
   m_RecvHACCESSStatusInfo(NULL),
+  m_RecvConnTrace(NULL),
   m_CommManager( CLIENT_MANAGER, this )
 {
   // Message processing is enabled by default in ClientMsgTranslator.
@@ -192,6 +193,31 @@ error_t GUIMessengerImpl::Recv_HACCESSStatusInfo( const HACCESSStatusInfo* aHACC
 }
 
 
+// --------------------------------------------------------------------------
+// Function : Recv_ConnTrace
+//
+// Description:
+//   Invoked upon reception of a ConnTrace message from the Communications
+//   Manager. The information contains the phase durations of a connection
+//   attempt.
+//
+// Arguments:
+//   aConnTrace: gogocConnTrace* [IN], The connection attempt trace.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Indicates success replying to request.
+//
+// --------------------------------------------------------------------------
+error_t GUIMessengerImpl::Recv_ConnTrace( const gogocConnTrace* aConnTrace )
+{
+  // Callback the provided function.
+  if( m_RecvConnTrace != NULL )
+    (*m_RecvConnTrace)(aConnTrace);
+
+  return GOGOCM_UIS__NOERROR;
+}
+
+
 // --------------------------------------------------------------------------
 // Function : PostMessage
 //
@@ -339,4 +339,72 @@ void ServerMsgSender::Send_HACCESSStatusInfo( const HACCESSStatusInfo* aHACCESSS
   PostMessage( pMsg );
 }
 
+
+
+// --------------------------------------------------------------------------
+// Function : Send_ConnTrace
+//
+// Description:
+//   Will send the trace of a connection attempt.
+//   A message is created with the information and posted to the send queue.
+//
+// Arguments:
+//   aConnTrace: gogocConnTrace* [IN], The connection attempt trace.
+//
+// Return values: (none)
+//
+// --------------------------------------------------------------------------
+void ServerMsgSender::Send_ConnTrace( const gogocConnTrace* aConnTrace )
+{
+  Message* pMsg;
+  uint8_t pData[MSG_MAX_USERDATA];
+  uint16_t nDataLen = 0;
+
+
+  assert( aConnTrace != NULL );
+
+
+  // Write attempt number and start time to data buffer.
+  memcpy( pData + nDataLen, (void*)&(aConnTrace->nAttempt), sizeof(aConnTrace->nAttempt) );
+  nDataLen += sizeof(aConnTrace->nAttempt);
+
+  memcpy( pData + nDataLen, (void*)&(aConnTrace->attemptTime), sizeof(time_t) );
+  nDataLen += sizeof(time_t);
+
+  // Append transport to data buffer.
+  memcpy( pData + nDataLen, (void*)&(aConnTrace->nTransport), sizeof(aConnTrace->nTransport) );
+  nDataLen += sizeof(aConnTrace->nTransport);
+
+  // Append broker name to data buffer.
+  if( aConnTrace->szBrokerName ) {
+    memcpy( pData + nDataLen, aConnTrace->szBrokerName, strlen(aConnTrace->szBrokerName) + 1 );
+    nDataLen += (uint16_t)strlen(aConnTrace->szBrokerName) + 1;
+  }
+  else {
+    memset( pData + nDataLen, 0x00, 1 );
+    ++nDataLen;
+  }
+
+  // Append outcome, phase durations and total duration to data buffer.
+  memcpy( pData + nDataLen, (void*)&(aConnTrace->nStatus), sizeof(aConnTrace->nStatus) );
+  nDataLen += sizeof(aConnTrace->nStatus);
+
+  memcpy( pData + nDataLen, (void*)aConnTrace->nPhaseMs, sizeof(aConnTrace->nPhaseMs) );
+  nDataLen += sizeof(aConnTrace->nPhaseMs);
+
+  memcpy( pData + nDataLen, (void*)&(aConnTrace->nTotalMs), sizeof(aConnTrace->nTotalMs) );
+  nDataLen += sizeof(aConnTrace->nTotalMs);
+
+  assert( nDataLen <= MSG_MAX_USERDATA );       // Buffer overflow has occured.
+
+
+  // Create Message.
+  pMsg = Message::CreateMessage( MESSAGEID_CONNTRACE, nDataLen, pData );
+  assert( pMsg != NULL );
+
+
+  // Post the message.
+  PostMessage( pMsg );
+}
+
 } // namespace
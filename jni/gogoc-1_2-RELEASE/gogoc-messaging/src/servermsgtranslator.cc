@@ -104,6 +104,10 @@ error_t ServerMsgTranslator::ProcessMessage( Message* pMsg )
       retCode = TranslateHACCESSStatusInfoReq( pMsg->msg._data, pMsg->msg.header._datalen );
       break;
 
+    case MESSAGEID_LOGCONFIGINFO:
+      retCode = TranslateLogConfigInfo( pMsg->msg._data, pMsg->msg.header._datalen );
+      break;
+
     default:
       retCode = GOGOCM_UIS_MESSAGENOTIMPL; // Unknown / invalid message.
       break;
@@ -277,4 +281,57 @@ error_t ServerMsgTranslator::TranslateHACCESSStatusInfoReq( uint8_t* pData, cons
   return Recv_HACCESSStatusInfoRequest();
 }
 
+
+// --------------------------------------------------------------------------
+// Function : TranslateLogConfigInfo
+//
+// Description:
+//   Will translate the log levels message data and call the handler with
+//   the translated information.
+//
+// Arguments:
+//   pData: uint8_t* [IN], The raw data.
+//   nDataLen: uint16_t [IN], The length of the raw data.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Successful operation.
+//   any other value on error.
+//
+// --------------------------------------------------------------------------
+error_t ServerMsgTranslator::TranslateLogConfigInfo( uint8_t* pData, const uint16_t nDataLen )
+{
+  gogocLogConfigInfo logConfigInfo;
+  uint16_t nCursor = 0;
+
+
+  // -- D A T A   E X T R A C T I O N --
+
+  // Extract console, file and syslog levels from data buffer.
+  memcpy( (void*)&(logConfigInfo.nLogLevelConsole), pData + nCursor, sizeof(logConfigInfo.nLogLevelConsole) );
+  nCursor += sizeof(logConfigInfo.nLogLevelConsole);
+
+  memcpy( (void*)&(logConfigInfo.nLogLevelFile), pData + nCursor, sizeof(logConfigInfo.nLogLevelFile) );
+  nCursor += sizeof(logConfigInfo.nLogLevelFile);
+
+  memcpy( (void*)&(logConfigInfo.nLogLevelSyslog), pData + nCursor, sizeof(logConfigInfo.nLogLevelSyslog) );
+  nCursor += sizeof(logConfigInfo.nLogLevelSyslog);
+
+  // Extract duration from data buffer.
+  memcpy( (void*)&(logConfigInfo.nDuration), pData + nCursor, sizeof(logConfigInfo.nDuration) );
+  nCursor += sizeof(logConfigInfo.nDuration);
+
+
+  // -----------------------------------------------------------------------
+  // Sanity check. Verify that the bytes of data we extracted match that of
+  // what was expected.
+  // -----------------------------------------------------------------------
+  assert( nCursor == nDataLen );
+
+
+  // ---------------------------------
+  // Invoke derived function handler.
+  // ---------------------------------
+  return Recv_LogConfigInfo( &logConfigInfo );
+}
+
 } // namespace
@@ -32,6 +32,7 @@ extern "C" {
 #include "pal_process.h"
 #include "pal_time.h"
 #include "pal_criticalsection.h"
+#include "pal_atomic.h"
 #include "pal_thread.h"
 #include "pal_syslog.h"
 
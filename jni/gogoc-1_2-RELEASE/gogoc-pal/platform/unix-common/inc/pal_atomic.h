@@ -0,0 +1,32 @@
+/*
+-----------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+-----------------------------------------------------------------------------
+
+  Platform abstraction layer atomic operations definitions.
+
+-----------------------------------------------------------------------------
+*/
+#ifndef __PAL_ATOMIC_H__
+#define __PAL_ATOMIC_H__
+
+
+// Atomic API definitions.
+#include "pal_atomic.def"
+
+
+// Atomic operations are provided by the compiler (GCC builtins).
+#undef pal_atomic_add
+#define pal_atomic_add(P, V)        __sync_add_and_fetch(P, V)
+
+#undef pal_atomic_get
+#define pal_atomic_get(P)           __sync_add_and_fetch(P, 0)
+
+#undef pal_atomic_set
+#define pal_atomic_set(P, V)        do { __sync_synchronize(); *(P) = (V); __sync_synchronize(); } while(0)
+
+#undef pal_atomic_cas
+#define pal_atomic_cas(P, O, N)     __sync_bool_compare_and_swap(P, O, N)
+
+
+#endif
@@ -30,6 +30,9 @@ Copyright (c) 2007 gogo6 Inc. All rights reserved.
 #undef pal_malloc
 #define pal_malloc malloc
 
+#undef pal_realloc
+#define pal_realloc realloc
+
 #undef pal_putenv
 #define pal_putenv putenv
 
@@ -28,7 +28,13 @@ Copyright (c) 2007 gogo6 Inc. All rights reserved.
 #undef pal_localtime
 #define pal_localtime localtime
 
+#undef pal_gmtime
+#define pal_gmtime gmtime
+
 #undef pal_time
 #define pal_time time
 
+#undef pal_gettime_monotonic
+#define pal_gettime_monotonic(X) clock_gettime(CLOCK_MONOTONIC, X)
+
 #endif
@@ -65,31 +65,52 @@ typedef struct stConf {
        *if_tunnel_v6v4,
        *if_tunnel_v6udpv4,
        *if_tunnel_v4v6,
+       *if_tunnel_standby,
+       *standby_server,
        *dns_server,
        *routing_info,
        *if_prefix,
        *template,
        *host_type,
        *log_filename,
+       *log_event_filename,
+       *log_memory_filename,
        *last_server_file,
        *haccess_document_root,
-       *broker_list_file;
+       *broker_list_file,
+       *resolv_cache_file;
   sint32_t keepalive_interval;
   sint32_t prefixlen;
+  sint32_t ra_min_interval;
+  sint32_t ra_max_interval;
+  sint32_t route_table;
+  sint32_t route_fwmark;
   sint32_t retry_delay;
   sint32_t retry_delay_max;
   sint32_t syslog_facility;
   sint32_t transport;
   sint32_t log_rotation_size;
+  sint32_t log_rotation_count;
+  sint32_t log_event_size;
+  sint32_t log_memory_size;
+  sint32_t log_flush_interval;
+  sint32_t log_timestamp_precision;
   sint16_t log_level_stderr;
   sint16_t log_level_syslog;
   sint16_t log_level_console;
   sint16_t log_level_file;
+  sint16_t log_level_event;
+  sint16_t log_level_memory;
   tBoolean keepalive;
   tBoolean syslog;
   tBoolean proxy_client;
+  tBoolean use_template;
+  tBoolean keep_tunnel;
   tBoolean log_rotation;
   tBoolean log_rotation_delete;
+  tBoolean log_rotation_compress;
+  tBoolean log_async;
+  tBoolean log_timestamp_iso8601;
   tBoolean always_use_same_server;
   tBoolean auto_retry_connect;
   tTunnelMode tunnel_mode;
@@ -132,6 +153,8 @@ typedef struct syslog_facility
 #define STR_CONFIG_LOG_DESTINATION_SYSLOG   "syslog"
 #define STR_CONFIG_LOG_DESTINATION_CONSOLE  "console"
 #define STR_CONFIG_LOG_DESTINATION_FILE     "file"
+#define STR_CONFIG_LOG_DESTINATION_EVENT    "event"
+#define STR_CONFIG_LOG_DESTINATION_MEMORY   "memory"
 
 
 /* imports defined in the platform dependant file */
@@ -35,6 +35,8 @@
 #define GOGO_STR_GOGOTUN_V4V6_NOT_INSTALLED                "gogo6 Multi-Tunnel Virtual Adapter is missing and is required for V4V6 tunneling."
 #define GOGO_STR_GOGOTUN_V6UDPV4_NOT_INSTALLED             "gogo6 Multi-Tunnel Virtual Adapter is missing and is required for V6UDPV4 tunneling."
 #define GOGO_STR_CANNOT_OPEN_LOG_FILE                      "Failed to open log file %s."
+#define GOGO_STR_CANNOT_OPEN_EVENT_LOG                     "Failed to open event log file %s."
+#define GOGO_STR_CANNOT_OPEN_MEMORY_LOG                    "Failed to open memory log file %s."
 #define GOGO_STR_CHECKING_LINUX_IPV6_SUPPORT               "Checking for Linux IPv6 support..."
 #define GOGO_STR_SETUP_PROXY                               "Client proxying is %s."
 #define GOGO_STR_CANT_DELETE_SERVICE                       "Failed to delete service %s: %i."
@@ -66,8 +68,12 @@
 #define GOGO_STR_NO_IPV6_SUPPORT_FOUND                     "No IPv6 support found."
 #define GOGO_STR_BAD_SIG_FROM_SERVER                       "Incorrect signature from server."
 #define GOGO_STR_INVALID_PAYLOAD_SIZE                      "Invalid payload size."
+#define GOGO_STR_PAYLOAD_TOO_LARGE                         "Payload size %ld exceeds the limit of %d bytes."
+#define GOGO_STR_XML_NAME_MISPLACED                        "XML name \"%s\" is not at the slot of its hash."
 #define GOGO_STR_INVALID_RESPONSE_RECEIVED                 "Invalid response received."
 #define GOGO_STR_INVALID_VAL_FOR_LOG                       "Config: Invalid value for log: %s."
+#define GOGO_STR_INVALID_VAL_FOR_KEY                       "Config: Invalid value for %s: %s."
+#define GOGO_STR_RA_MIN_INTERVAL_TOO_LARGE                 "Config: ra_min_interval must not exceed 3/4 of ra_max_interval."
 #define GOGO_STR_LOG_FILE_CLOSED                           "Log file %s closed while it should be open."
 #define GOGO_STR_MATCHING_KEY_FOUND_USED                   "Matching server key found and used."
 #define GOGO_STR_NO_RUDP_REPLY                             "No RUDP reply."
@@ -99,6 +105,9 @@
 #define GOGO_STR_TRY_MODPROBE_IPV6                         "Try \"modprobe ipv6\"."
 #define GOGO_STR_TRY_MODPROBE_TUN                          "Try \"modprobe tun\"."
 #define GOGO_STR_CANT_FORK                                 "Failed to fork."
+#define GOGO_STR_CANT_SPAWN                                "Failed to start the script: %s."
+#define GOGO_STR_SCRIPT_TIMEOUT                            "Script did not complete within %d seconds and was killed."
+#define GOGO_STR_SCRIPT_ENV                                "Script environment: %s=%s"
 #define GOGO_STR_CANT_READ_TEMPLATE_FROM_CFG               "Failed to read the template name from the config file. Is it specified? Do you have %s in the current directory?"
 #define GOGO_STR_CANT_ROTATE_LOG_NO_FILENAME               "Failed to rotate the log file: No file name specified."
 #define GOGO_STR_CANT_ROTATE_LOG_CANT_FLUSH                "Failed to rotate the log file: Could not flush contents."
@@ -107,6 +116,17 @@
 #define GOGO_STR_CANT_ROTATE_LOG_CANT_OPEN_NEW             "Failed to rotate the log file: Could not open new empty log file."
 #define GOGO_STR_CANT_WRITE_LOG_BUFFER_TO_FILE             "Failed to write the log buffer to file. Some logs may be lost."
 #define GOGO_STR_CANT_FPRINTF_TO_LOG                       "Failed to write to the log file."
+#define GOGO_STR_LOG_DROPPED                               "%u log messages dropped: the log queue was full."
+#define GOGO_STR_LOG_EARLY_DROPPED                         "%u log messages dropped: the log buffer was full before the log file was opened."
+#define GOGO_STR_LOG_REPEATED                              "%s: message repeated %u times, not logged."
+#define GOGO_STR_LOG_RATE_DROPPED                          "%u log messages of severity %c dropped: more than %u per second."
+#define GOGO_STR_LOG_CANT_START_WRITER                     "Failed to start the log writer: logging synchronously."
+#define GOGO_STR_LOG_LEVELS_SET                            "Log levels set to console %d, file %d, syslog %d."
+#define GOGO_STR_LOG_LEVELS_REJECTED                       "Log levels not changed: console %d, file %d, syslog %d is out of range or enables a destination disabled in the configuration."
+#define GOGO_STR_LOG_BURST_STARTED                         "Log levels set to console %d, file %d, syslog %d for %d seconds."
+#define GOGO_STR_LOG_LEVELS_CANT_READ                      "Log levels not changed: cannot read %s."
+#define GOGO_STR_LOG_LEVELS_BAD_FILE                       "Log levels not changed: %s does not hold the console, file and syslog levels and a duration."
+#define GOGO_STR_LOG_BURST_ENDED                           "Log levels restored to console %d, file %d, syslog %d."
 #define GOGO_STR_USING_AUTH_ANONYMOUS                      "Using AUTH-ANONYMOUS authentication mechanism."
 #define GOGO_STR_USING_AUTH_PLAIN                          "Using AUTH-PLAIN authentication mechanism."
 #define GOGO_STR_USING_AUTH_DIGEST_MD5                     "Using DIGEST-MD5 authentication mechanism."
@@ -142,6 +162,7 @@
 #define GOGO_STR_RDR_ADD_BROKER_NO_MEM                     "Failed to allocate memory for a new server address in the server redirection list."
 #define GOGO_STR_RDR_ADD_BROKER_ADDRESS_TRUNC              "Failed to set server Address in server redirection list: address too long."
 #define GOGO_STR_RDR_CREATE_LIST_CANT_ADD                  "Failed to add a new server address while creating the server redirection list."
+#define GOGO_STR_RDR_NOT_FOLLOWED                          "Server redirection not followed."
 #define GOGO_STR_RDR_SORTING_BROKER_LIST                   "Sorting the server redirection list."
 #define GOGO_STR_RDR_SORT_LIST_CANT_GET_DIST               "Failed to get server timing information while sorting the server redirection list."
 #define GOGO_STR_RDR_SORT_LIST_CANT_ALLOC                  "Failed to allocate memory for a new server address while sorting the server redirection list."
@@ -204,6 +225,49 @@
 #define GOGO_STR_RDR_CANT_MALLOC_THREAD_ARRAY              "Failed to allocate memory for the server timing threads."
 #define GOGO_STR_RDR_CANT_MALLOC_THREAD_ARGS               "Failed to allocate memory for the server timing thread arguments."
 #define GOGO_STR_RDR_WRONG_ADDRESS_FAMILY                  "Server address %s is not compatible with the configured tunnel mode."
+#define GOGO_STR_RESOLV_LOADED_CACHE                       "Loaded %d cached server name(s) from %s."
+#define GOGO_STR_RESOLV_CANT_SAVE_CACHE                    "Failed to save the server name cache to %s."
+#define GOGO_STR_RESOLV_USING_CACHE                        "Using cached address(es) for %s."
+#define GOGO_STR_RESOLV_USING_STALE_CACHE                  "Using expired cached address(es) for %s while it is resolved again."
+#define GOGO_STR_RESOLV_PREFETCH                           "Resolving %s in the background."
+#define GOGO_STR_RESOLV_CANT_CREATE_THREAD                 "Failed to create the resolver thread for %s."
+#define GOGO_STR_TRACE_ATTEMPT_OK                          "Connection attempt #%u to %s over %s succeeded in %d ms."
+#define GOGO_STR_TRACE_ATTEMPT_REDIRECTED                  "Connection attempt #%u to %s over %s was redirected after %d ms."
+#define GOGO_STR_TRACE_ATTEMPT_FAILED                      "Connection attempt #%u to %s over %s failed after %d ms (status %u in context: %s)."
+#define GOGO_STR_TRACE_PHASES                              "Connection attempt #%u phases (ms, -1 if not reached): connect %d, capabilities %d, authentication %d, negotiation %d, interface setup %d, first keepalive %d."
+#define GOGO_STR_NETLINK_SETUP                             "Configuring interface %s through netlink."
+#define GOGO_STR_NETLINK_SETUP_DONE                        "Interface %s configured through netlink."
+#define GOGO_STR_NETLINK_TEARDOWN                          "Removing the configuration of interface %s through netlink."
+#define GOGO_STR_NETLINK_CANT_OPEN                         "Failed to open the netlink socket: %s."
+#define GOGO_STR_NETLINK_REQUEST_FAILED                    "Netlink request failed (%s): %s."
+#define GOGO_STR_NETLINK_NO_REPLY                          "No reply to the netlink request (%s)."
+#define GOGO_STR_NETLINK_NO_INTERFACE                      "Interface %s not found."
+#define GOGO_STR_NETLINK_BAD_ADDRESS                       "Invalid address: %s."
+#define GOGO_STR_NETLINK_CANT_SET_SYSCTL                   "Failed to set %s: %s."
+#define GOGO_STR_NETLINK_RECONCILED                        "Interface %s reconciled through netlink: %d change(s) applied."
+#define GOGO_STR_TUNNEL_KEPT                               "Keeping the configuration of interface %s for the next connection."
+#define GOGO_STR_TUNNEL_RELEASED                           "Releasing the configuration of interface %s kept from the last connection."
+#define GOGO_STR_TUN_REUSED                                "Reusing the tun device of interface %s kept from the last connection."
+#define GOGO_STR_RTADV_START                               "Advertising prefix %s/64 on interface %s."
+#define GOGO_STR_RTADV_UPDATE                              "Now advertising prefix %s/64 on interface %s."
+#define GOGO_STR_RTADV_STOP                                "Stopped the router advertisements on interface %s."
+#define GOGO_STR_RTADV_CANT_OPEN                           "Failed to start the router advertisements on interface %s: %s."
+#define GOGO_STR_RTADV_CANT_SEND                           "Failed to send a router advertisement on interface %s: %s."
+#define GOGO_STR_PMTU_START                                "Discovering the path MTU to %s."
+#define GOGO_STR_PMTU_FOUND                                "Path MTU to %s is %d bytes: MTU of interface %s set to %d."
+#define GOGO_STR_PMTU_TOO_BIG                              "Packet too big on the path to %s (next hop MTU %d): discovering the path MTU again."
+#define GOGO_STR_PMTU_CANT_START                           "Failed to start the path MTU discovery: %s."
+#define GOGO_STR_STANDBY_NEGOTIATING                       "Negotiating the standby tunnel with %s."
+#define GOGO_STR_STANDBY_UP                                "Standby tunnel to %s up on interface %s, address %s."
+#define GOGO_STR_STANDBY_FAILED                            "Failed to bring the standby tunnel up with %s: retrying in %d seconds."
+#define GOGO_STR_STANDBY_LOST                              "Standby tunnel to %s lost: keepalive timeout."
+#define GOGO_STR_STANDBY_SAME_SERVER                       "The active tunnel is now to %s, the server of the standby tunnel: choosing another broker."
+#define GOGO_STR_STANDBY_NO_BROKER                         "No broker other than %s for the standby tunnel: retrying in %d seconds."
+#define GOGO_STR_STANDBY_TAKEOVER                          "Active tunnel lost: the standby tunnel to %s takes over."
+#define GOGO_STR_STANDBY_DEMOTED                           "Tunnel to %s up: the tunnel to %s is the standby tunnel again."
+#define GOGO_STR_STANDBY_HOST_ONLY                         "The standby tunnel is only available in host mode."
+#define GOGO_STR_STANDBY_CANT_START                        "Failed to start the standby tunnel: %s."
+#define GOGO_STR_STANDBY_ACTIVE_SILENT                     "No reply from the active tunnel to %s for %d echo requests."
 #define GOGO_STR_INIT_MESSAGING_FAILED                     "Failed to initialize the messaging subsystem. Communication with GUI unavailable."
 #define GOGO_STR_UNINIT_MESSAGING_FAILED                   "Failed to uninitialize the messaging subsystem."
 
@@ -322,6 +386,7 @@
 #define STR_KA_INIT_INFO                              "Keepalive initialized with peer %s. Interval=%dms. Timeout=%dms. General timeout at %d consecutive timeouts."
 #define STR_KA_SEND_INFO                              "Keepalive request sent."
 #define STR_KA_RECV_INFO                              "Keepalive reply received. Roundtrip time: %.3fms"
+#define STR_KA_LOST_INFO                              "Keepalive reply timed out (%d consecutive)."
 #define STR_KA_STOP_INFO_CAUSE                        "Keepalive processing stopped: "
 
 #define STR_KA_ERR_ALREADY_INIT                       "Already initialized."
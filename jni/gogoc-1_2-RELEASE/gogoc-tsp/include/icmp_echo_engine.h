@@ -50,6 +50,7 @@ typedef enum {
 
 typedef void        (*iee_send_clbk)      ( void );
 typedef void        (*iee_recv_clbk)      ( double rtt );
+typedef void        (*iee_lost_clbk)      ( uint32_t consec_late );
 
 // Public function prototypes.
 iee_ret_t           IEE_init              ( void** pp_config,
@@ -60,7 +61,8 @@ iee_ret_t           IEE_init              ( void** pp_config,
                                             uint8_t echo_timeout_threshold,
                                             char* src, char* dst, sint32_t af,
                                             iee_send_clbk send_clbk,
-                                            iee_recv_clbk recv_clbk );
+                                            iee_recv_clbk recv_clbk,
+                                            iee_lost_clbk lost_clbk );
 
 iee_ret_t           IEE_destroy           ( void** pp_config );
 
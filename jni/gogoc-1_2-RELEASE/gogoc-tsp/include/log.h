@@ -19,12 +19,32 @@
 
 #define LOG_LEVEL_MIN           LOG_LEVEL_DISABLED
 #define LOG_LEVEL_MAX           LOG_LEVEL_3
+
+// Messages above this level are not compiled in. A release build may set
+// it lower, e.g. -DLOG_LEVEL_BUILD=LOG_LEVEL_2 drops the LOG_LEVEL_3 traces.
+#ifndef LOG_LEVEL_BUILD
+#define LOG_LEVEL_BUILD         LOG_LEVEL_MAX
+#endif
 #define LOG_IDENTITY_MAX_LENGTH 32
 #define LOG_FILENAME_MAX_LENGTH 255
 #define MAX_LOG_LINE_LENGTH     4096
+#define MAX_LOG_MESSAGE_LENGTH  5000      // Of a message formatted by Display()
 #define LOG_IDENTITY            "gogoc"
 #define DEFAULT_LOG_FILENAME    "gogoc.log"
 #define DEFAULT_LOG_ROTATION_SIZE 32
+#define DEFAULT_LOG_ROTATION_COUNT 4       // Rotated log files kept
+#define LOG_COMPRESSED_SUFFIX   ".gz"
+#define DEFAULT_LOG_FLUSH_INTERVAL 200    // Milliseconds between batches of the log writer
+#define LOG_ASYNC_SLOTS         256       // Messages queued for the log writer, power of 2
+#define LOG_ASYNC_SLOT_SIZE     512       // Longer messages take several slots
+#define LOG_FILE_BUFFER_SIZE    16384
+#define LOG_EARLY_BUFFER_SIZE   8192      // Lines kept until the log file is known
+#define LOG_CLOCK_SYNC          60        // Seconds between readings of the wall clock
+#define LOG_SITE_BURST          100       // Messages of a call site per LOG_SITE_PERIOD
+#define LOG_SITE_PERIOD         10        // Seconds
+#define LOG_RATE_PER_SECOND     100       // Messages of a severity per second...
+#define LOG_RATE_BURST          500       // ...in bursts of up to this many
+#define LOG_BURST_MAX           86400     // Seconds a change of the log levels may last
 
 enum tSeverityLevel
 {
@@ -34,6 +54,13 @@ enum tSeverityLevel
   ELDebug
 };
 
+// Debug messages are only compiled in debug builds.
+#if defined(_DEBUG) || defined(DEBUG)
+#define LOG_SEVERITY_BUILD(S)   1
+#else
+#define LOG_SEVERITY_BUILD(S)   ((S) != ELDebug)
+#endif
+
 typedef struct stLogConfiguration {
   char *    identity;
   char *    log_filename;
@@ -41,16 +68,57 @@ typedef struct stLogConfiguration {
   sint32_t  log_level_console;
   sint32_t  log_level_syslog;
   sint32_t  log_level_file;
+  sint32_t  log_level_event;          // Binary event log, see log_event.h.
+  char *    event_filename;
+  sint32_t  event_size;               // Kilobytes.
+  sint32_t  log_level_memory;         // Memory ring, see log_memory.h.
+  char *    memory_filename;
+  sint32_t  memory_size;              // Kilobytes.
   sint32_t  syslog_facility;
   sint32_t  log_rotation_size;
   sint32_t  log_rotation;
   sint32_t  buffer;
   sint32_t  delete_rotated_log;       // 0 = FALSE
+  sint32_t  rotation_count;           // Rotated log files kept.
+  sint32_t  compress_rotated_log;     // 0 = FALSE
+  sint32_t  async;                    // Write from the log writer thread.
+  sint32_t  flush_interval;           // Milliseconds between batches of the log writer.
+  sint32_t  timestamp_digits;         // Of the fraction of a second: 0, 3 or 6.
+  sint32_t  timestamp_iso8601;        // 0 = FALSE
 } tLogConfiguration;
 
+// Rate limit of a Display() call site. A call site writes at most
+// LOG_SITE_BURST messages every LOG_SITE_PERIOD seconds; the messages over
+// the limit are counted, and the count is logged with the next message of
+// the call site that gets through.
+typedef struct stLogSite
+{
+  volatile uint32_t   period;           // Second the current period started.
+  volatile uint32_t   count;            // Messages in the current period.
+  volatile uint32_t   suppressed;       // Messages over the limit, not reported yet.
+} tLogSite;
+
+// Highest level a destination logs, 0 until the log system is configured.
+extern volatile sint32_t LogLevelEnabled;
+
+#define LOG_ENABLED(L, S) \
+  ( (L) <= LOG_LEVEL_BUILD && LOG_SEVERITY_BUILD(S) && (L) <= LogLevelEnabled )
+
+// Display( level, severity, function, format, ... )
+// The level is checked before the arguments are evaluated and the message
+// formatted: a disabled message costs one comparison, and none at all when
+// it is above LOG_LEVEL_BUILD. Each call site has its own rate limit.
+#define Display(L, S, ...) \
+  do { \
+    static tLogSite log_site_; \
+    if( LOG_ENABLED(L, S) ) LogDisplay(&log_site_, L, S, __VA_ARGS__); \
+  } while(0)
+
 sint32_t            DirectErrorMessage    (char *message, ...);
-void                Display               (sint32_t, enum tSeverityLevel, const char *, char *, ...);
+void                LogDisplay            (tLogSite *, sint32_t, enum tSeverityLevel, const char *, char *, ...);
 sint32_t            LogConfigure          (tLogConfiguration *);
+sint32_t            LogSetLevels          (sint32_t, sint32_t, sint32_t, sint32_t);
+void                LogBurstCheck         (void);
 void                LogClose              (void);
 sint32_t            DumpBufferToFile      (char *filename);
 
@@ -0,0 +1,43 @@
+/*
+-----------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _NET_RESOLV_H_
+#define _NET_RESOLV_H_
+
+/*
+ * Broker name resolver.
+ *
+ * Resolved names are kept in a small cache that is saved to a file, so that
+ * a restart or a reconnection does not have to go through DNS again. Entries
+ * past their lifetime are still answered for RESOLV_STALE_GRACE seconds while
+ * a lookup refreshes them in the background. Lookups can be started ahead of
+ * time with NetResolvPrefetch, each in its own thread.
+ */
+
+#define RESOLV_CACHE_SIZE     32      /* Number of names kept in the cache */
+#define RESOLV_MAX_ADDRS      8       /* Addresses kept per name */
+#define RESOLV_NAME_SIZE      256
+
+#define RESOLV_TTL            3600    /* Lifetime of a resolved name, in seconds */
+#define RESOLV_NEGATIVE_TTL   30      /* Lifetime of a failed lookup, in seconds */
+#define RESOLV_STALE_GRACE    86400   /* Expired names are used this long while refreshed */
+
+#define RESOLV_POLL_INTERVAL  20      /* Wait for a running lookup, in milliseconds */
+
+typedef struct stResolvAddr {
+  sint32_t family;                    /* AF_INET or AF_INET6 */
+  union {
+    struct in_addr  in;
+    struct in6_addr in6;
+  } u;
+} tResolvAddr;
+
+void                NetResolvInit         ( const char *cache_file );
+void                NetResolvDestroy      ( void );
+void                NetResolvPrefetch     ( const char *name );
+sint32_t            NetResolv             ( const char *name, sint32_t family, tResolvAddr *addrs, sint32_t max );
+
+#endif
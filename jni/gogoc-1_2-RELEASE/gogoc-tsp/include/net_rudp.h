@@ -60,9 +60,9 @@ extern rttengine_stat_t rttengine_stats;
 
 /* rudp engine functions */
 extern sint32_t     rttengine_init        (rttengine_stat_t *);
-extern sint32_t     rttengine_deinit      (rttengine_stat_t *, void *, void *);
-extern void *       internal_prepare_message(rudp_msghdr_t **, size_t);
-extern void         internal_discard_message(void *);
+extern sint32_t     rttengine_deinit      (rttengine_stat_t *);
+extern sint32_t     internal_send_message (pal_socket_t, rudp_msghdr_t *, void *, sint32_t);
+extern sint32_t     internal_recv_message (pal_socket_t, rudp_msghdr_t *, void *, sint32_t);
 extern float        rttengine_update      (rttengine_stat_t *, uint32_t);
 extern uint32_t     internal_get_timestamp(rttengine_stat_t *);
 extern float        internal_get_adjusted_rto(float);
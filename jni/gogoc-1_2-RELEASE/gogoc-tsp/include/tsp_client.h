@@ -46,6 +46,15 @@ sint32_t            tspMain               ( sint32_t, char *[] );
 sint32_t            tspExtractPayload     ( char *, tTunnel * );
 sint32_t            tspGetStatusCode      ( char * );
 const char*         tspGetTspStatusStr    ( sint32_t );
+void                InitNetToolsArray     ( net_tools_t nt_array[] );
+int                 FormatBrokerListAddr  ( tBrokerList* listElement, char **ppAddr );
+gogoc_status        tspNegotiateTunnel    ( tConf *, net_tools_t *,
+                                            sint32_t version_index,
+                                            tBrokerList **broker_list,
+                                            pal_socket_t *p_socket,
+                                            tTunnel *tunnel_params,
+                                            tFrame *frame,
+                                            tBoolean trace );
 
 // Implemented in each platform tsp_local.c
 extern uint16_t     tspGetLocalPort       ( pal_socket_t );
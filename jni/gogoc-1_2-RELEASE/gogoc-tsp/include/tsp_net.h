@@ -22,6 +22,7 @@
 #define PROTOCOLMAXPAYLOADCHUNK 2048
 #define PROTOCOLFRAMESIZE       4096
 #define PROTOCOLMAXHEADER       70
+#define PROTOCOLMAXPAYLOAD      65536   // Largest Content-length accepted from the server.
 
 enum { 
   PROTOCOL_OK, 
@@ -39,14 +40,26 @@ typedef struct stPayload {
   char *payload;
 } tPayload;
 
+// Receive buffer of a TSP session. It is allocated on first use, grown when
+// a reply does not fit and reused for every reply of the session.
+// After tspSendRecv(), 'payload' points in 'buffer' right after the
+// Content-length line and is nul-terminated.
+typedef struct stFrame {
+  char *buffer;
+  long capacity, length;
+  char *payload;
+  long size;
+} tFrame;
+
 
 // Public function prototypes.
 gogoc_status         tspConnect            ( pal_socket_t*, char *, uint16_t, net_tools_t * );
 gogoc_status         tspClose              ( pal_socket_t, net_tools_t * );
 
-sint32_t            tspSendRecv           ( pal_socket_t, tPayload *, tPayload *, net_tools_t * );
+sint32_t            tspSendRecv           ( pal_socket_t, tPayload *, tFrame *, net_tools_t * );
 sint32_t            tspSend               ( pal_socket_t, tPayload *, net_tools_t * );
 sint32_t            tspReceive            ( pal_socket_t, tPayload *, net_tools_t * );
+void                tspFreeFrame          ( tFrame * );
 
 #endif
 
@@ -63,7 +63,8 @@ typedef enum {
   TSP_REDIRECT_ECHO_REQUEST_TIMEOUT,
   TSP_REDIRECT_ECHO_REQUEST_ERROR,
   TSP_REDIRECT_CANT_MALLOC_THREAD_ARRAY,
-  TSP_REDIRECT_CANT_MALLOC_THREAD_ARGS
+  TSP_REDIRECT_CANT_MALLOC_THREAD_ARGS,
+  TSP_REDIRECT_NOT_FOLLOWED
 } tRedirectStatus;
 
 typedef enum {
@@ -90,6 +91,8 @@ extern tRedirectStatus tspGetBrokerDistances(tBrokerList *broker_list, int broke
 extern int tspIsRedirectStatus(int status);
 extern tRedirectStatus tspLogRedirectionList(tBrokerList *broker_list, int sorted);
 extern tRedirectStatus tspFreeBrokerList(tBrokerList *broker_list);
+extern tRedirectStatus tspPrefetchBrokerList(tBrokerList *broker_list);
+/* With a NULL broker_list, the redirection is only logged, and not followed */
 extern tRedirectStatus tspHandleRedirect(char *payload, tConf *conf, tBrokerList **broker_list);
 extern tRedirectStatus tspReadLastServerFromFile(char *last_server_file, char *buffer);
 extern tRedirectStatus tspWriteLastServerToFile(char *last_server_file, char *last_server);
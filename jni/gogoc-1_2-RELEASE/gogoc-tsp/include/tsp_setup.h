@@ -14,8 +14,28 @@
 #include "config.h"
 #include "xml_tun.h"
 
-sint32_t            execScript            ( const char *cmd );
+#define SCRIPT_ENV_MAX      32      /* Variables set for a script */
+#define SCRIPT_ENV_SIZE     4096    /* Bytes of "NAME=value" strings */
+#define SCRIPT_TIMEOUT      60      /* Seconds before a script is killed */
+#define SCRIPT_POLL_INTERVAL 200    /* Milliseconds between checks of the script exit */
+
+// Environment of a template script run: "NAME=value" strings, given to the
+// script on top of the environment of the client. Where scripts are not
+// spawned (SPAWN_SUPPORT), the variables are set in the environment of the
+// client instead, and this stays empty.
+typedef struct stScriptEnv
+{
+  char*       vars[SCRIPT_ENV_MAX + 1];   // NULL terminated.
+  sint32_t    count;
+  size_t      len;                        // Bytes used in buf.
+  char        buf[SCRIPT_ENV_SIZE];
+} tScriptEnv;
+
+sint32_t            execScript            ( const char *cmd, const tScriptEnv *env );
 gogoc_status         tspSetupInterface     ( tConf *c, tTunnel *t );
 gogoc_status         tspTearDownTunnel     ( tConf* pConf, tTunnel* pTunInfo );
+sint32_t             tspKeepTunnel         ( tConf* pConf, tTunnel* pTunInfo );
+void                 tspReleaseTunnel      ( void );
+uint32_t             tspKeptTunnelSerial   ( void );
 
 #endif
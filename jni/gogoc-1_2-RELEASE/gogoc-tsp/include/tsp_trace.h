@@ -0,0 +1,51 @@
+/*
+-----------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _TSP_TRACE_H_
+#define _TSP_TRACE_H_
+
+/*
+ * Connection attempt tracing.
+ *
+ * Each call to tspSetupTunnel is one attempt. The time spent in each setup
+ * phase is measured with a monotonic clock, from the end of the previous
+ * phase. When the attempt is over (the tunnel is up and answered its first
+ * keepalive, or something failed), the record is logged and kept in a ring
+ * of the last TRACE_RING_SIZE attempts. It is also sent to the GUI, but only
+ * where the messaging library is linked (Windows): on the other platforms
+ * send_conn_trace() is a dummy and the log is the only place to read it.
+ */
+
+#define TRACE_RING_SIZE       16
+#define TRACE_BROKER_SIZE     256
+
+typedef enum {
+  TRACE_PHASE_CONNECT = 0,
+  TRACE_PHASE_CAPABILITIES,
+  TRACE_PHASE_AUTHENTICATION,
+  TRACE_PHASE_NEGOTIATION,
+  TRACE_PHASE_INTERFACE_SETUP,
+  TRACE_PHASE_FIRST_KEEPALIVE,
+  TRACE_PHASE_COUNT
+} tTracePhase;
+
+typedef struct stTraceRecord {
+  uint32_t      attempt;                        /* Attempt number, from 1 */
+  time_t        started;                        /* Wall clock time of the start */
+  sint32_t      transport;                      /* NET_TOOLS_T_xxx */
+  char          broker[TRACE_BROKER_SIZE];
+  gogoc_status  status;                         /* Outcome */
+  sint32_t      phase_ms[TRACE_PHASE_COUNT];    /* -1 if the phase was not reached */
+  sint32_t      total_ms;
+} tTraceRecord;
+
+void                tspTraceInit          ( void );
+void                tspTraceBegin         ( const char *broker, sint32_t transport );
+void                tspTracePhase         ( tTracePhase phase );
+void                tspTraceEnd           ( gogoc_status status );
+sint32_t            tspTraceGetRecords    ( tTraceRecord *records, sint32_t max );
+
+#endif
@@ -48,12 +48,22 @@ typedef struct stTunnel {
               *broker_redirect_ipv4,
               *broker_redirect_ipv6,
               *broker_redirect_dn;
+
+  /* All the strings and list elements above are allocated in this single
+     arena, which is released by tspClearTunnelInfo(). */
+  char *arena;
+  size_t arena_size,
+         arena_used;
 } tTunnel;
 
 
-ACCESS sint32_t     tspXMLParse           ( char *Data, tTunnel *Tunnel );
+ACCESS sint32_t     tspXMLParse           ( const char *Data, tTunnel *Tunnel );
 ACCESS void         tspClearTunnelInfo    ( tTunnel *Tunnel );
 
+ACCESS sint32_t     tspTunnelAllocArena   ( tTunnel *Tunnel, size_t size );
+ACCESS char *       tspTunnelStrdup       ( tTunnel *Tunnel, const char *str );
+ACCESS sint32_t     tspCopyTunnelInfo     ( tTunnel *Dst, const tTunnel *Src );
+
 #undef ACCESS
 #endif
 
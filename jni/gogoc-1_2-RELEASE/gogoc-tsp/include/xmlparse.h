@@ -18,69 +18,109 @@
 #endif
 
 /*
- * In the node structure, the following identify how many attributes a node can
- * have max. It can be adjusted at compile time.
+ * The following identify how many attributes an element can have max, and
+ * how deeply elements can be nested. They can be adjusted at compile time.
  */
 
 #define MAX_ATTRIBUTES 5
+#define MAX_DEPTH      16
 
 /*
- * The following identify the format of a node processing function that must be
- * supplied in the node structure to take care of the information supplied in the
- * structure.
+ * Tag and attribute names the caller does not know about are reported with
+ * this identifier.
  */
 
-struct stNode;
+#define XML_UNKNOWN    -1
 
-typedef sint32_t processNode(struct stNode *n, char *content);
+/*
+ * Hash used to map tag and attribute names to identifiers. The caller builds
+ * a table of XML_HASH_SIZE entries indexed by this hash, in which every known
+ * name occupies its own slot (a perfect hash for that vocabulary), so the
+ * lookup is one hash and one comparison.
+ */
+
+#define XML_HASH_SIZE  32
+#define XML_SLOT(l, first, last) ( ((l) + (first) + 14 * (last)) & (XML_HASH_SIZE - 1) )
+#define XML_HASH(s, l) XML_SLOT((l), (s)[0], (s)[(l) - 1])
+
+/*
+ * A table is built from a list of XML_NAME(name, first, last, id) entries,
+ * 'first' and 'last' being the first and last characters of 'name': the
+ * slot of each name is computed at compile time (XML_TABLE_ENTRY), and
+ * XML_CHECK_SLOTS fails the build when two names of the list share a slot.
+ */
+
+#define XML_NAME_SLOT(name, first, last) XML_SLOT((sint32_t)sizeof(name) - 1, (first), (last))
+#define XML_TABLE_ENTRY(name, first, last, id) [XML_NAME_SLOT(name, first, last)] = { name, id },
+#define XML_SLOT_SUM(name, first, last, id) + (1ULL << XML_NAME_SLOT(name, first, last))
+#define XML_SLOT_OR(name, first, last, id)  | (1ULL << XML_NAME_SLOT(name, first, last))
+#define XML_CHECK_SLOTS(table, list) \
+  typedef char table##SlotsCheck[((0 list(XML_SLOT_SUM)) == (0 list(XML_SLOT_OR))) ? 1 : -1]
 
 /*
- * The node structure contains the relevant information of each node to be
- * parsed by each invocation of the parser.
+ * A span refers to characters in the buffer being parsed. It is NOT nul
+ * terminated; the tokenizer never modifies nor copies the input buffer.
  */
 
-typedef struct stAttribute {
-  char *name;
-  char *value;
-} tAttribute;
+typedef struct stXMLSpan {
+  const char *ptr;
+  sint32_t    len;
+} tXMLSpan;
 
-typedef struct stNode {
-  char *name;
-  processNode *p;
-  tAttribute attributes[MAX_ATTRIBUTES + 1];
-} tNode;
+typedef struct stXMLAttribute {
+  sint32_t id;
+  tXMLSpan value;
+} tXMLAttribute;
 
 /*
- * The XMLParser function is responsible of parsing the contain of a string,
- * calling the appropriate processNode function when a node token is recognized.
+ * Name lookup table entry. A table holds XML_HASH_SIZE entries, and unused
+ * slots have a NULL name.
+ */
+
+typedef struct stXMLName {
+  const char *name;
+  sint32_t    id;
+} tXMLName;
+
+/*
+ * Event handlers called by the tokenizer. 'stack' contains the identifiers
+ * of the enclosing elements, stack[depth - 1] being the immediate parent.
  *
- * Parameters:
+ * - start: called on an opening tag, with its recognized attributes.
+ * - text : called with the content of an element that has no child element.
  *
+ * A non-zero return value stops the tokenizer, which returns that value.
+ */
+
+typedef struct stXMLHandler {
+  const tXMLName *tags;
+  const tXMLName *attributes;
+  sint32_t (*start)(void *ctx, const sint32_t *stack, sint32_t depth, sint32_t tag, const tXMLAttribute *attrs, sint32_t nattrs);
+  sint32_t (*text) (void *ctx, const sint32_t *stack, sint32_t depth, sint32_t tag, const tXMLSpan *content);
+} tXMLHandler;
+
+/*
+ * The XMLTokenize function walks the nul-terminated string in place and
+ * calls the handlers as elements are recognized.
  *
  * Return value:
  *
  *    0 - Success
- *   -1 - Memory allocation error
+ *   -1 - Error returned by a handler
  *    n - Parsing error at position n in the string
  */
 
-ACCESS sint32_t XMLParse(char *str, tNode nodes[]);
+ACCESS sint32_t XMLTokenize(const char *str, const tXMLHandler *h, void *ctx);
+
+ACCESS sint32_t XMLLookup(const tXMLName table[], const char *name, sint32_t len);
 
 /*
- * The following macros are usefull to declare the node structures
- *
- * They assume that the event functions will be named the same as the
- * XML tags, prefixed with p_
- *
+ * Returns -1 if every name of a table is at the slot of its hash, or the
+ * index of the first one that is not: the first or last character given
+ * to XML_NAME is not the one of the name.
  */
 
-#define NODE(n) { #n, p_##n, {
-#define ENDNODE { "", 0 } } },
-#define ATTR(a) { #a, 0 },
-#define ENDLIST { "", 0, { { "", 0 } } } };
-#define STARTLIST {
-
-#define PROC(pr) sint32_t p_##pr (tNode *n, char *content)
+ACCESS sint32_t XMLCheckNames(const tXMLName table[]);
 
 #undef ACCESS
 
@@ -0,0 +1,381 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+/*
+ * gogoc-logbench: measures the cost of Display() when several threads log
+ * at once, as the main loop, the keepalive engine and the messaging threads
+ * do, for each destination of the log system.
+ *
+ *   gogoc-logbench [-t threads] [-n calls] [-d directory]
+ *
+ * Each destination is configured at LOG_LEVEL_2, and the threads log
+ * 'calls' messages each at LOG_LEVEL_1, LOG_LEVEL_2 and LOG_LEVEL_3: the
+ * last ones are stopped by the level check of the Display() macro. For
+ * each run, the tool prints the mean time of a call, its 50th and 99th
+ * percentiles and maximum, and the allocations made per call. The log
+ * files are written in 'directory'.
+ *
+ * The messages go through LogDisplay() without the rate limits of a call
+ * site, which would drop all but the first ones; the "limited" run goes
+ * through Display() and measures the cost of the messages it drops.
+ *
+ * The allocations are counted by wrapping malloc, calloc, realloc and
+ * strdup at link time (ld --wrap), so that only those of the client code
+ * are counted, not those made inside the C library.
+ */
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "config.h"            // TRUE, FALSE
+
+#define BENCH_THREADS             4
+#define BENCH_CALLS               20000           /* Per thread and level */
+#define BENCH_DIRECTORY           "/tmp"
+#define BENCH_LEVEL               LOG_LEVEL_2     /* Of the destinations */
+
+// Display() without the rate limit of the call site.
+#define BenchDisplay(L, S, ...) \
+  do { if( LOG_ENABLED(L, S) ) LogDisplay(NULL, L, S, __VA_ARGS__); } while(0)
+
+// Destinations.
+enum tBenchSink
+{
+  SINK_DISABLED,
+  SINK_FILE,
+  SINK_ROTATION,
+  SINK_ASYNC,
+  SINK_LIMITED,
+  SINK_SYSLOG,
+#ifdef LOG_MEMORY_SUPPORT
+  SINK_MEMORY,
+#endif
+#ifdef LOG_EVENT_SUPPORT
+  SINK_EVENT,
+#endif
+  SINK_COUNT
+};
+
+static const char *sink_names[SINK_COUNT] = {
+  "disabled",
+  "file",
+  "file, rotation",
+  "file, async",
+  "file, limited",
+  "syslog",
+#ifdef LOG_MEMORY_SUPPORT
+  "memory",
+#endif
+#ifdef LOG_EVENT_SUPPORT
+  "event",
+#endif
+};
+
+typedef struct stBenchThread
+{
+  pal_thread_t        thread;
+  sint32_t            id;
+  sint32_t            level;
+  sint32_t            limited;          // Through Display(), with its rate limits.
+  uint32_t            calls;
+  uint32_t *          samples;          // Nanoseconds of each call.
+} tBenchThread;
+
+static volatile uint32_t  bench_start = 0;
+static volatile uint32_t  bench_allocs = 0;
+
+
+// --------------------------------------------------------------------------
+// Allocations of the client code, see the --wrap options of the Makefile.
+//
+void *__real_malloc( size_t size );
+void *__real_calloc( size_t count, size_t size );
+void *__real_realloc( void *ptr, size_t size );
+char *__real_strdup( const char *s );
+
+void *__wrap_malloc( size_t size )
+{
+  pal_atomic_add( &bench_allocs, 1 );
+  return __real_malloc( size );
+}
+
+void *__wrap_calloc( size_t count, size_t size )
+{
+  pal_atomic_add( &bench_allocs, 1 );
+  return __real_calloc( count, size );
+}
+
+void *__wrap_realloc( void *ptr, size_t size )
+{
+  pal_atomic_add( &bench_allocs, 1 );
+  return __real_realloc( ptr, size );
+}
+
+char *__wrap_strdup( const char *s )
+{
+  pal_atomic_add( &bench_allocs, 1 );
+  return __real_strdup( s );
+}
+
+
+// --------------------------------------------------------------------------
+// Returns nanoseconds of the monotonic clock.
+//
+static uint64_t BenchNow( void )
+{
+  struct timespec now;
+
+  pal_gettime_monotonic( &now );
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+// --------------------------------------------------------------------------
+// Logs the messages of a thread once all threads are started, and times
+// each call.
+//
+static pal_thread_ret_t PAL_THREAD_CALL BenchThread( void *arg )
+{
+  tBenchThread *bench = (tBenchThread *)arg;
+  uint64_t start, end;
+  uint32_t i;
+
+  while( pal_atomic_get( &bench_start ) == 0 );
+
+  for( i = 0; i < bench->calls; i++ )
+  {
+    start = BenchNow();
+    if( bench->limited )
+    {
+      Display( bench->level, ELInfo, "BenchThread", "Thread %d: keepalive %u sent to %s.", bench->id, i, "2001:db8::1" );
+    }
+    else
+    {
+      BenchDisplay( bench->level, ELInfo, "BenchThread", "Thread %d: keepalive %u sent to %s.", bench->id, i, "2001:db8::1" );
+    }
+    end = BenchNow();
+
+    bench->samples[i] = (end - start > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)(end - start);
+  }
+
+  return (pal_thread_ret_t)0;
+}
+
+
+// --------------------------------------------------------------------------
+// Returns a new log configuration for a destination, in the form
+// LogConfigure takes.
+//
+static tLogConfiguration* BenchConfiguration( enum tBenchSink sink, const char *directory )
+{
+  tLogConfiguration *configuration;
+  char filename[LOG_FILENAME_MAX_LENGTH + 1];
+
+  configuration = (tLogConfiguration *)calloc( 1, sizeof(tLogConfiguration) );
+  if( configuration == NULL )
+  {
+    return NULL;
+  }
+
+  configuration->identity = pal_strdup( "gogoc-logbench" );
+  configuration->syslog_facility = LOG_USER;
+  configuration->log_rotation_size = DEFAULT_LOG_ROTATION_SIZE;
+  configuration->rotation_count = DEFAULT_LOG_ROTATION_COUNT;
+  configuration->delete_rotated_log = FALSE;
+  configuration->compress_rotated_log = FALSE;
+  configuration->flush_interval = DEFAULT_LOG_FLUSH_INTERVAL;
+  configuration->timestamp_digits = 3;
+
+  pal_snprintf( filename, sizeof(filename), "%s/gogoc-logbench.log", directory );
+
+  switch( sink )
+  {
+  case SINK_DISABLED:
+    break;
+
+  case SINK_ROTATION:
+    configuration->log_rotation = TRUE;
+    // Fall through.
+  case SINK_FILE:
+  case SINK_LIMITED:
+    configuration->log_level_file = BENCH_LEVEL;
+    configuration->log_filename = pal_strdup( filename );
+    break;
+
+  case SINK_ASYNC:
+    configuration->log_level_file = BENCH_LEVEL;
+    configuration->log_filename = pal_strdup( filename );
+    configuration->async = TRUE;
+    break;
+
+  case SINK_SYSLOG:
+    configuration->log_level_syslog = BENCH_LEVEL;
+    break;
+
+#ifdef LOG_MEMORY_SUPPORT
+  case SINK_MEMORY:
+    pal_snprintf( filename, sizeof(filename), "%s/gogoc-logbench.ring", directory );
+    configuration->log_level_memory = BENCH_LEVEL;
+    configuration->memory_filename = pal_strdup( filename );
+    configuration->memory_size = 1024;
+    break;
+#endif
+
+#ifdef LOG_EVENT_SUPPORT
+  case SINK_EVENT:
+    pal_snprintf( filename, sizeof(filename), "%s/gogoc-logbench.evt", directory );
+    configuration->log_level_event = BENCH_LEVEL;
+    configuration->event_filename = pal_strdup( filename );
+    configuration->event_size = 1024;
+    break;
+#endif
+
+  default:
+    break;
+  }
+
+  return configuration;
+}
+
+
+// --------------------------------------------------------------------------
+static int CompareSample( const void *a, const void *b )
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+
+// --------------------------------------------------------------------------
+// Logs from all the threads at one level, and prints the results.
+//
+// Returns 0, or -1 if a thread could not be started.
+//
+static int BenchRun( enum tBenchSink sink, sint32_t level, tBenchThread *threads, sint32_t count, uint32_t calls, uint32_t *samples )
+{
+  uint64_t sum = 0;
+  uint32_t allocs, total = (uint32_t)count * calls, i;
+  sint32_t t;
+
+  pal_atomic_set( &bench_start, 0 );
+  for( t = 0; t < count; t++ )
+  {
+    threads[t].id = t;
+    threads[t].level = level;
+    threads[t].limited = (sink == SINK_LIMITED);
+    threads[t].calls = calls;
+    threads[t].samples = samples + (size_t)t * calls;
+
+    if( pal_thread_create( &threads[t].thread, &BenchThread, &threads[t] ) != 0 )
+    {
+      // Let the started threads go, and wait for them.
+      pal_atomic_set( &bench_start, 1 );
+      while( --t >= 0 )
+      {
+        pal_thread_join( threads[t].thread, NULL );
+      }
+      return -1;
+    }
+  }
+
+  allocs = pal_atomic_get( &bench_allocs );
+  pal_atomic_set( &bench_start, 1 );
+
+  for( t = 0; t < count; t++ )
+  {
+    pal_thread_join( threads[t].thread, NULL );
+  }
+  allocs = pal_atomic_get( &bench_allocs ) - allocs;
+
+  for( i = 0; i < total; i++ )
+  {
+    sum += samples[i];
+  }
+  qsort( samples, total, sizeof(uint32_t), CompareSample );
+
+  printf( "%-16s %5d %9.1f %8u %8u %9u %11.3f\n",
+    sink_names[sink], level, (double)sum / total,
+    samples[total / 2], samples[(uint32_t)((uint64_t)total * 99 / 100)], samples[total - 1],
+    (double)allocs / total );
+  fflush( stdout );
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+  tLogConfiguration *configuration;
+  tBenchThread *threads;
+  uint32_t *samples;
+  sint32_t count = BENCH_THREADS, level, sink;
+  uint32_t calls = BENCH_CALLS;
+  const char *directory = BENCH_DIRECTORY;
+  int option;
+
+  while( (option = getopt( argc, argv, "t:n:d:" )) != -1 )
+  {
+    switch( option )
+    {
+    case 't': count = atoi( optarg ); break;
+    case 'n': calls = (uint32_t)atoi( optarg ); break;
+    case 'd': directory = optarg; break;
+    default:  count = 0; break;
+    }
+  }
+
+  if( count <= 0 || calls == 0 || optind != argc )
+  {
+    fprintf( stderr, "Usage: %s [-t threads] [-n calls] [-d directory]\n", argv[0] );
+    return 1;
+  }
+
+  threads = (tBenchThread *)calloc( count, sizeof(tBenchThread) );
+  samples = (uint32_t *)malloc( (size_t)count * calls * sizeof(uint32_t) );
+  if( threads == NULL || samples == NULL )
+  {
+    fprintf( stderr, "%s: not enough memory.\n", argv[0] );
+    return 1;
+  }
+
+  printf( "%d threads, %u calls per thread and level, destinations at level %d.\n\n", count, calls, BENCH_LEVEL );
+  printf( "%-16s %5s %9s %8s %8s %9s %11s\n", "destination", "level", "ns/call", "p50", "p99", "max", "allocs/call" );
+
+  for( sink = 0; sink < SINK_COUNT; sink++ )
+  {
+    configuration = BenchConfiguration( (enum tBenchSink)sink, directory );
+    if( configuration == NULL || LogConfigure( configuration ) != 0 )
+    {
+      fprintf( stderr, "%s: cannot configure the %s destination.\n", argv[0], sink_names[sink] );
+      continue;
+    }
+
+    for( level = LOG_LEVEL_1; level <= LOG_LEVEL_3; level++ )
+    {
+      if( BenchRun( (enum tBenchSink)sink, level, threads, count, calls, samples ) != 0 )
+      {
+        fprintf( stderr, "%s: cannot start the threads.\n", argv[0] );
+        LogClose();
+        return 1;
+      }
+    }
+
+    LogClose();
+  }
+
+  free( samples );
+  free( threads );
+  return 0;
+}
@@ -0,0 +1,374 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+/*
+ * gogoc-logdecode: prints a ring file of the client, the event log
+ * (log_event.h) or the memory log (log_memory.h), as text from the oldest
+ * record to the newest one. With -f, it then waits for new records and
+ * prints them as they come, like tail -f.
+ *
+ *   gogoc-logdecode [-f] <log_event_filename|log_memory_filename>
+ *
+ * The format strings of the events are those of hex_strings.h, listed in
+ * log_strings.h when the tool is built. An event of a format that is not
+ * in the list is printed with its id.
+ */
+
+#include "platform.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "log_event.h"
+#include "log_memory.h"
+#include "hex_strings.h"
+
+
+typedef struct stLogString
+{
+  const char *        name;
+  const char *        format;
+  uint32_t            id;
+} tLogString;
+
+static tLogString log_strings[] = {
+#include "log_strings.h"
+};
+
+#define LOG_STRINGS_COUNT         (sizeof(log_strings) / sizeof(log_strings[0]))
+#define DECODE_LINE_LENGTH        4096
+#define DECODE_FOLLOW_INTERVAL    200             /* Milliseconds */
+
+
+// --------------------------------------------------------------------------
+static int CompareId( const void *a, const void *b )
+{
+  uint32_t x = ((const tLogString *)a)->id;
+  uint32_t y = ((const tLogString *)b)->id;
+
+  return (x > y) - (x < y);
+}
+
+
+// --------------------------------------------------------------------------
+// Returns the format string of an event id, or NULL.
+//
+static const char* FindFormat( uint32_t id )
+{
+  tLogString key, *found;
+
+  key.id = id;
+  found = (tLogString *)bsearch( &key, log_strings, LOG_STRINGS_COUNT, sizeof(tLogString), CompareId );
+
+  return found != NULL ? found->format : NULL;
+}
+
+
+// --------------------------------------------------------------------------
+// Renders the arguments of an event with its format string.
+//
+// Returns 0, or -1 if the arguments end before the format.
+//
+static int RenderEvent( const char *format, const uint8_t *args, const uint8_t *end, char *line, size_t size )
+{
+  char spec[64];
+  char text[LOG_EVENT_MAX_STRING + 1];
+  const char *p = format, *next;
+  size_t len = 0, n;
+  sint32_t stars, kind, star[2];
+  uint32_t u32;
+  uint64_t u64;
+  uint16_t slen;
+  double d;
+  int i;
+
+  line[0] = '\0';
+
+  while( *p != '\0' && len < size - 1 )
+  {
+    if( *p != '%' )
+    {
+      line[len++] = *p++;
+      continue;
+    }
+    if( p[1] == '%' )
+    {
+      line[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    next = LogEventScan( p, &stars, &kind );
+    if( next == NULL || (size_t)(next - p) >= sizeof(spec) - 2 )
+    {
+      // Unknown conversion: the rest was not recorded.
+      line[len] = '\0';
+      return -1;
+    }
+
+    // The conversion, with the length modifiers of the recorded argument.
+    for( i = 0, n = 0; p + i < next - 1; i++ )
+    {
+      if( strchr( "hlLqjzt", p[i] ) == NULL )
+        spec[n++] = p[i];
+    }
+    if( kind == LOG_EVENT_ARG_LONG || kind == LOG_EVENT_ARG_INT64 )
+    {
+      spec[n++] = 'l';
+      spec[n++] = 'l';
+    }
+    spec[n++] = next[-1];
+    spec[n] = '\0';
+    p = next;
+
+    for( i = 0; i < stars; i++ )
+    {
+      if( end - args < 4 ) goto truncated;
+      memcpy( &u32, args, 4 );  args += 4;
+      star[i & 1] = (sint32_t)u32;
+    }
+
+    n = size - len;
+    switch( kind )
+    {
+    case LOG_EVENT_ARG_INT32:
+      if( end - args < 4 ) goto truncated;
+      memcpy( &u32, args, 4 );  args += 4;
+      if( stars == 2 )      n = snprintf( line + len, n, spec, star[0], star[1], (int)u32 );
+      else if( stars == 1 ) n = snprintf( line + len, n, spec, star[0], (int)u32 );
+      else                  n = snprintf( line + len, n, spec, (int)u32 );
+      break;
+
+    case LOG_EVENT_ARG_LONG:
+    case LOG_EVENT_ARG_INT64:
+      if( end - args < 8 ) goto truncated;
+      memcpy( &u64, args, 8 );  args += 8;
+      if( stars == 2 )      n = snprintf( line + len, n, spec, star[0], star[1], (long long)u64 );
+      else if( stars == 1 ) n = snprintf( line + len, n, spec, star[0], (long long)u64 );
+      else                  n = snprintf( line + len, n, spec, (long long)u64 );
+      break;
+
+    case LOG_EVENT_ARG_DOUBLE:
+      if( end - args < 8 ) goto truncated;
+      memcpy( &d, args, 8 );  args += 8;
+      if( stars == 2 )      n = snprintf( line + len, n, spec, star[0], star[1], d );
+      else if( stars == 1 ) n = snprintf( line + len, n, spec, star[0], d );
+      else                  n = snprintf( line + len, n, spec, d );
+      break;
+
+    case LOG_EVENT_ARG_POINTER:
+      if( end - args < 8 ) goto truncated;
+      memcpy( &u64, args, 8 );  args += 8;
+      n = snprintf( line + len, n, "0x%llx", (unsigned long long)u64 );
+      break;
+
+    case LOG_EVENT_ARG_STRING:
+      if( end - args < 2 ) goto truncated;
+      memcpy( &slen, args, 2 );  args += 2;
+      if( slen > LOG_EVENT_MAX_STRING || end - args < slen ) goto truncated;
+      memcpy( text, args, slen );  args += slen;
+      text[slen] = '\0';
+      if( stars == 2 )      n = snprintf( line + len, n, spec, star[0], star[1], text );
+      else if( stars == 1 ) n = snprintf( line + len, n, spec, star[0], text );
+      else                  n = snprintf( line + len, n, spec, text );
+      break;
+
+    default:
+      n = 0;
+      break;
+    }
+
+    len += (n < size - len) ? n : size - len - 1;
+  }
+
+  line[len] = '\0';
+  return 0;
+
+truncated:
+  line[len] = '\0';
+  return -1;
+}
+
+
+// --------------------------------------------------------------------------
+// Prints an event.
+//
+static void PrintEvent( const tLogRingHeader *header, const tLogEvent *event )
+{
+  char line[DECODE_LINE_LENGTH];
+  const uint8_t *args = (const uint8_t *)(event + 1);
+  const uint8_t *end = (const uint8_t *)event + event->record.length;
+  const char *format;
+  struct tm *tm;
+  time_t t;
+  uint32_t usec;
+  int complete = 0;
+
+  // Wall clock of the event.
+  usec = header->epoch_usec + event->usec;
+  t = (time_t)header->epoch_sec + event->sec + usec / 1000000;
+  usec %= 1000000;
+  tm = localtime( &t );
+
+  format = FindFormat( event->id );
+  if( format != NULL )
+  {
+    complete = RenderEvent( format, args, end, line, sizeof(line) ) == 0;
+  }
+  else
+  {
+    snprintf( line, sizeof(line), "Event %08X", event->id );
+  }
+
+  printf( "%04d/%02d/%02d %02d:%02d:%02d.%06u %c %d: %s%s\n",
+    tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
+    tm->tm_hour, tm->tm_min, tm->tm_sec, usec,
+    event->severity == ELError ? 'E' : event->severity == ELWarning ? 'W' : event->severity == ELInfo ? 'I' : 'D',
+    event->level, line,
+    (format != NULL && (!complete || (event->flags & LOG_EVENT_TRUNCATED))) ? " [...]" : "" );
+}
+
+
+// --------------------------------------------------------------------------
+// Prints a log line of the memory log.
+//
+static void PrintText( const tLogRingRecord *record )
+{
+  const char *text = (const char *)(record + 1);
+  size_t length = record->length - sizeof(tLogRingRecord);
+
+  fwrite( text, 1, strnlen( text, length ), stdout );
+}
+
+
+// --------------------------------------------------------------------------
+// Prints the records from 'pos' up to the head of the ring.
+//
+// Returns the position after the last record printed.
+//
+static uint32_t PrintRecords( const tLogRingHeader *header, const uint8_t *data, uint32_t pos )
+{
+  const tLogRingRecord *record;
+  uint32_t head, tail, offset;
+
+  head = header->head;
+  tail = header->tail;
+
+  // Skip what the client wrote over.
+  if( (sint32_t)(tail - pos) > 0 )
+  {
+    pos = tail;
+  }
+  if( head - pos > header->size )
+  {
+    pos = (head - header->size + LOG_RING_BLOCK - 1) & ~(LOG_RING_BLOCK - 1);
+  }
+
+  while( (sint32_t)(head - pos) > 0 )
+  {
+    offset = pos & (header->size - 1);
+    record = (const tLogRingRecord *)(data + offset);
+
+    // Anything but a complete record ends the block.
+    if( LOG_RING_BLOCK - (offset & (LOG_RING_BLOCK - 1)) < sizeof(tLogRingRecord) ||
+        record->position != pos || record->length < sizeof(tLogRingRecord) ||
+        (offset & (LOG_RING_BLOCK - 1)) + record->length > LOG_RING_BLOCK )
+    {
+      // In the block of the head, it is a record still being written.
+      if( ((pos ^ head) & ~(LOG_RING_BLOCK - 1)) == 0 )
+      {
+        break;
+      }
+      pos = (pos + LOG_RING_BLOCK) & ~(LOG_RING_BLOCK - 1);
+      continue;
+    }
+
+    if( record->type == LOG_RING_EVENT && record->length >= sizeof(tLogEvent) )
+    {
+      PrintEvent( header, (const tLogEvent *)record );
+    }
+    else if( record->type == LOG_RING_TEXT )
+    {
+      PrintText( record );
+    }
+
+    pos += record->length;
+  }
+
+  return pos;
+}
+
+
+// --------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+  const tLogRingHeader *header;
+  struct stat st;
+  uint32_t pos, i;
+  int follow = 0;
+  void *map;
+  int fd;
+
+  if( argc == 3 && strcmp( argv[1], "-f" ) == 0 )
+  {
+    follow = 1;
+    argv++;
+    argc--;
+  }
+
+  if( argc != 2 )
+  {
+    fprintf( stderr, "Usage: %s [-f] <log ring file>\n", argv[0] );
+    return 1;
+  }
+
+  fd = open( argv[1], O_RDONLY );
+  if( fd == -1 || fstat( fd, &st ) != 0 || st.st_size < LOG_RING_DATA )
+  {
+    fprintf( stderr, "%s: cannot read %s.\n", argv[0], argv[1] );
+    return 1;
+  }
+
+  map = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  if( map == MAP_FAILED )
+  {
+    fprintf( stderr, "%s: cannot map %s.\n", argv[0], argv[1] );
+    return 1;
+  }
+
+  header = (const tLogRingHeader *)map;
+  if( header->magic != LOG_RING_MAGIC || header->version != LOG_RING_VERSION ||
+      header->block != LOG_RING_BLOCK || header->size < LOG_RING_BLOCK ||
+      (header->size & (header->size - 1)) != 0 ||
+      (off_t)LOG_RING_DATA + header->size > st.st_size )
+  {
+    fprintf( stderr, "%s: %s is not a log ring.\n", argv[0], argv[1] );
+    return 1;
+  }
+
+  for( i = 0; i < LOG_STRINGS_COUNT; i++ )
+  {
+    log_strings[i].id = LogEventId( log_strings[i].format );
+  }
+  qsort( log_strings, LOG_STRINGS_COUNT, sizeof(tLogString), CompareId );
+
+  // Start at the oldest block that was not written over.
+  pos = PrintRecords( header, (const uint8_t *)map + LOG_RING_DATA, header->tail );
+
+  while( follow )
+  {
+    fflush( stdout );
+    pal_sleep( DECODE_FOLLOW_INTERVAL );
+    pos = PrintRecords( header, (const uint8_t *)map + LOG_RING_DATA, pos );
+  }
+
+  munmap( map, st.st_size );
+  close( fd );
+  return 0;
+}
@@ -0,0 +1,279 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+
+#include <time.h>
+
+#include "log_event.h"
+
+#define FNV1A_BASIS               2166136261U
+#define FNV1A_PRIME               16777619U
+
+
+// --------------------------------------------------------------------------
+// The event ring. 'users' counts the threads writing to it, so that
+// LogEventClose does not unmap it under them.
+//
+static tLogRing           event_ring;
+static volatile uint32_t  event_open = 0;
+static volatile uint32_t  event_users = 0;
+
+
+// --------------------------------------------------------------------------
+// Returns the id of a format string.
+//
+uint32_t LogEventId( const char *format )
+{
+  uint32_t hash = FNV1A_BASIS;
+
+  while( *format != '\0' )
+  {
+    hash ^= (uint8_t)*format++;
+    hash *= FNV1A_PRIME;
+  }
+
+  return hash;
+}
+
+
+// --------------------------------------------------------------------------
+// Finds the next conversion of a format string, and the kind of argument
+// it takes. The encoder and the decoder both walk the format with this.
+//
+// Parameters:
+//   stars: set to the number of '*' (int arguments) before the argument.
+//   kind:  set to one of LOG_EVENT_ARG_*.
+//
+// Returns where to continue the scan, or NULL with LOG_EVENT_ARG_END.
+//
+const char* LogEventScan( const char *format, sint32_t *stars, sint32_t *kind )
+{
+  sint32_t longs = 0;
+
+  *stars = 0;
+  *kind = LOG_EVENT_ARG_END;
+
+  for( ;; )
+  {
+    format = strchr( format, '%' );
+    if( format == NULL )
+    {
+      return NULL;
+    }
+
+    if( format[1] != '%' )
+    {
+      break;
+    }
+    format += 2;
+  }
+  format++;
+
+  // Flags, width and precision.
+  while( *format != '\0' && strchr( "-+ #0'", *format ) != NULL )
+    format++;
+  for( ; (*format >= '0' && *format <= '9') || *format == '*' || *format == '.'; format++ )
+  {
+    if( *format == '*' )
+      (*stars)++;
+  }
+
+  // Length modifiers: l, z and t are as wide as a long, the others as
+  // wide as a long long.
+  for( ; *format != '\0' && strchr( "hlLqjzt", *format ) != NULL; format++ )
+  {
+    if( *format == 'l' || *format == 'z' || *format == 't' )
+      longs++;
+    else if( *format != 'h' )
+      longs = 2;
+  }
+
+  switch( *format )
+  {
+  case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+    *kind = (longs == 0) ? LOG_EVENT_ARG_INT32 : (longs == 1) ? LOG_EVENT_ARG_LONG : LOG_EVENT_ARG_INT64;
+    break;
+
+  case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+    *kind = LOG_EVENT_ARG_DOUBLE;
+    break;
+
+  case 'p':
+    *kind = LOG_EVENT_ARG_POINTER;
+    break;
+
+  case 's':
+    *kind = LOG_EVENT_ARG_STRING;
+    break;
+
+  case 'n':
+    *kind = LOG_EVENT_ARG_NONE;
+    break;
+
+  default:
+    *kind = LOG_EVENT_ARG_UNKNOWN;
+    return NULL;
+  }
+
+  return format + 1;
+}
+
+
+// --------------------------------------------------------------------------
+// Creates the event ring file.
+//
+// Parameter:
+//   size: kilobytes of events.
+//
+// Returns 0 on success, -1 otherwise.
+//
+sint32_t LogEventOpen( const char *filename, sint32_t size )
+{
+  LogEventClose();
+
+  if( LogRingOpen( &event_ring, filename, (uint32_t)size * 1024 ) != 0 )
+  {
+    return -1;
+  }
+
+  pal_atomic_set( &event_open, 1 );
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Writes an event to the ring. Safe to call from any thread; it takes no
+// lock and does not format anything.
+//
+void LogEventWrite( sint32_t level, enum tSeverityLevel severity, const char *format, va_list args )
+{
+  uint8_t buffer[LOG_EVENT_MAX_RECORD];
+  tLogEvent *event = (tLogEvent *)buffer;
+  tLogRingRecord *record;
+  struct timespec now;
+  const char *scan = format;
+  const char *s;
+  uint32_t length = sizeof(tLogEvent);
+  uint32_t position;
+  uint16_t n;
+  uint32_t u32;
+  uint64_t u64;
+  double d;
+  sint32_t stars, kind;
+
+  pal_atomic_add( &event_users, 1 );
+  if( pal_atomic_get( &event_open ) == 0 )
+  {
+    pal_atomic_add( &event_users, -1 );
+    return;
+  }
+
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  event->id = LogEventId( format );
+  event->level = (uint8_t)level;
+  event->severity = (uint8_t)severity;
+  event->flags = 0;
+  event->reserved = 0;
+  event->sec = (uint32_t)now.tv_sec;
+  event->usec = (uint32_t)(now.tv_nsec / 1000);
+
+  // Copy the arguments, as the format says they are.
+  while( (scan = LogEventScan( scan, &stars, &kind )) != NULL )
+  {
+    // The largest argument is a string; anything after it is lost.
+    if( length + (uint32_t)stars * 4 + 2 + LOG_EVENT_MAX_STRING > sizeof(buffer) )
+    {
+      event->flags |= LOG_EVENT_TRUNCATED;
+      break;
+    }
+
+    for( ; stars > 0; stars-- )
+    {
+      u32 = (uint32_t)va_arg( args, int );
+      memcpy( buffer + length, &u32, 4 );  length += 4;
+    }
+
+    switch( kind )
+    {
+    case LOG_EVENT_ARG_INT32:
+      u32 = (uint32_t)va_arg( args, int );
+      memcpy( buffer + length, &u32, 4 );  length += 4;
+      break;
+
+    case LOG_EVENT_ARG_LONG:
+      u64 = (uint64_t)va_arg( args, long );
+      memcpy( buffer + length, &u64, 8 );  length += 8;
+      break;
+
+    case LOG_EVENT_ARG_INT64:
+      u64 = (uint64_t)va_arg( args, long long );
+      memcpy( buffer + length, &u64, 8 );  length += 8;
+      break;
+
+    case LOG_EVENT_ARG_DOUBLE:
+      d = va_arg( args, double );
+      memcpy( buffer + length, &d, 8 );  length += 8;
+      break;
+
+    case LOG_EVENT_ARG_POINTER:
+      u64 = (uint64_t)(uintptr_t)va_arg( args, void * );
+      memcpy( buffer + length, &u64, 8 );  length += 8;
+      break;
+
+    case LOG_EVENT_ARG_STRING:
+      s = va_arg( args, const char * );
+      if( s == NULL )
+      {
+        s = "(null)";
+      }
+      for( n = 0; n < LOG_EVENT_MAX_STRING && s[n] != '\0'; n++ );
+      memcpy( buffer + length, &n, 2 );
+      memcpy( buffer + length + 2, s, n );
+      length += 2 + n;
+      break;
+
+    case LOG_EVENT_ARG_NONE:
+      (void)va_arg( args, void * );
+      break;
+    }
+  }
+
+  if( kind == LOG_EVENT_ARG_UNKNOWN )
+  {
+    event->flags |= LOG_EVENT_TRUNCATED;
+  }
+
+  record = LogRingReserve( &event_ring, length, LOG_RING_EVENT, &position );
+  if( record != NULL )
+  {
+    memcpy( (uint8_t *)record + sizeof(tLogRingRecord), buffer + sizeof(tLogRingRecord), length - sizeof(tLogRingRecord) );
+    LogRingCommit( record, position );
+  }
+
+  pal_atomic_add( &event_users, -1 );
+}
+
+
+// --------------------------------------------------------------------------
+// Closes the event ring, once the threads writing to it are done.
+//
+void LogEventClose( void )
+{
+  if( pal_atomic_get( &event_open ) == 0 )
+  {
+    return;
+  }
+
+  pal_atomic_set( &event_open, 0 );
+  while( pal_atomic_get( &event_users ) != 0 )
+  {
+    pal_sleep( 1 );
+  }
+
+  LogRingClose( &event_ring );
+}
@@ -0,0 +1,74 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef LOG_EVENT_H
+#define LOG_EVENT_H
+
+#include <stdarg.h>
+
+#include "log.h"
+#include "log_ring.h"
+
+/*
+ * Binary event log.
+ *
+ * With log_event set, the messages of that level and below are also
+ * written to a ring file (log_ring.h), without being formatted: an event
+ * holds the id of the format string, the raw arguments and a monotonic
+ * timestamp. It costs a few stores per message, so the event log can stay
+ * on at level 3 while the text destinations log less. gogoc-logdecode
+ * renders the events with the strings of hex_strings.h.
+ *
+ * The id of a format string is the FNV-1a hash of its text, so that it
+ * does not depend on the build. The arguments follow the conversions of
+ * the format, in the byte order of the client:
+ *   - '*' width or precision, and integers: 4 bytes, or 8 bytes with the
+ *     l, ll, q, j, z or t modifiers. %c is an integer.
+ *   - %p: 8 bytes.
+ *   - %e, %f, %g, %a: 8 bytes, a double.
+ *   - %s: 2 bytes of length, then the characters, at most
+ *     LOG_EVENT_MAX_STRING of them and no terminating null.
+ * An event that does not fit in LOG_EVENT_MAX_RECORD bytes is cut short at
+ * an argument, and flagged LOG_EVENT_TRUNCATED.
+ */
+
+#define LOG_EVENT_MAX_RECORD      512             /* Bytes, header included */
+#define LOG_EVENT_MAX_STRING      160             /* Characters of a %s argument */
+
+// Event flags.
+#define LOG_EVENT_TRUNCATED       0x01
+
+// Kinds of arguments, from LogEventScan.
+#define LOG_EVENT_ARG_END         0               /* No more conversions */
+#define LOG_EVENT_ARG_INT32       1
+#define LOG_EVENT_ARG_LONG        2               /* l, z, t */
+#define LOG_EVENT_ARG_INT64       3               /* ll, q, j */
+#define LOG_EVENT_ARG_DOUBLE      4
+#define LOG_EVENT_ARG_POINTER     5
+#define LOG_EVENT_ARG_STRING      6
+#define LOG_EVENT_ARG_NONE        7               /* %n, nothing recorded */
+#define LOG_EVENT_ARG_UNKNOWN     8               /* Unknown conversion, the rest is lost */
+
+typedef struct stLogEvent
+{
+  tLogRingRecord      record;         // type LOG_RING_EVENT
+  uint32_t            id;             // Of the format string.
+  uint8_t             level;
+  uint8_t             severity;
+  uint8_t             flags;
+  uint8_t             reserved;
+  uint32_t            sec;            // Monotonic clock.
+  uint32_t            usec;
+} tLogEvent;
+
+uint32_t            LogEventId            ( const char *format );
+const char*         LogEventScan          ( const char *format, sint32_t *stars, sint32_t *kind );
+sint32_t            LogEventOpen          ( const char *filename, sint32_t size );
+void                LogEventWrite         ( sint32_t level, enum tSeverityLevel severity, const char *format, va_list args );
+void                LogEventClose         ( void );
+
+#endif /* LOG_EVENT_H */
@@ -0,0 +1,72 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+
+#include "log_memory.h"
+
+
+// --------------------------------------------------------------------------
+// The memory ring. The log mutex serializes the calls to this module, so
+// that the ring is never closed under a writer.
+//
+static tLogRing           memory_ring;
+
+
+// --------------------------------------------------------------------------
+// Creates the memory ring file.
+//
+// Parameter:
+//   size: kilobytes of log lines.
+//
+// Returns 0 on success, -1 otherwise.
+//
+sint32_t LogMemoryOpen( const char *filename, sint32_t size )
+{
+  LogMemoryClose();
+
+  return LogRingOpen( &memory_ring, filename, (uint32_t)size * 1024 );
+}
+
+
+// --------------------------------------------------------------------------
+// Writes a log line to the ring.
+//
+void LogMemoryWrite( const char *line, size_t length )
+{
+  tLogRingRecord *record;
+  uint32_t position, size;
+
+  if( memory_ring.header == NULL )
+  {
+    return;
+  }
+
+  if( length > LOG_MEMORY_MAX_LINE )
+  {
+    length = LOG_MEMORY_MAX_LINE;
+  }
+
+  size = sizeof(tLogRingRecord) + (uint32_t)length;
+  record = LogRingReserve( &memory_ring, size, LOG_RING_TEXT, &position );
+  if( record != NULL )
+  {
+    // Zero the padding, the readers stop at the first null.
+    memcpy( record + 1, line, length );
+    memset( (char *)(record + 1) + length, 0, record->length - size );
+    LogRingCommit( record, position );
+  }
+}
+
+
+// --------------------------------------------------------------------------
+// Closes the memory ring. The file stays, for a reader to look at.
+//
+void LogMemoryClose( void )
+{
+  LogRingClose( &memory_ring );
+}
@@ -0,0 +1,33 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef LOG_MEMORY_H
+#define LOG_MEMORY_H
+
+#include "log_ring.h"
+
+/*
+ * Memory log.
+ *
+ * With log_memory set, the log lines of that level and below are written
+ * to a ring file (log_ring.h), meant to be on tmpfs: nothing goes to the
+ * disk, and the last lines are still there when the client crashed. The
+ * user interface, or a collector, follows the log by reading the ring
+ * while the client writes it, without locking: see gogoc-logdecode -f.
+ *
+ * A record of type LOG_RING_TEXT holds a line as it is written to the log
+ * file, newline included, padded with zeros to the record length. Longer
+ * lines are cut at LOG_MEMORY_MAX_LINE characters.
+ */
+
+#define LOG_MEMORY_MAX_LINE       (LOG_RING_BLOCK - sizeof(tLogRingRecord) - 1)
+
+sint32_t            LogMemoryOpen         ( const char *filename, sint32_t size );
+void                LogMemoryWrite        ( const char *line, size_t length );
+void                LogMemoryClose        ( void );
+
+#endif /* LOG_MEMORY_H */
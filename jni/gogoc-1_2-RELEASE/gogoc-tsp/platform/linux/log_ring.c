@@ -0,0 +1,170 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "log_ring.h"
+#include "log.h"            // LOG_FILENAME_MAX_LENGTH
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC                 0
+#endif
+
+#define LOG_RING_OLD_SUFFIX       ".old"
+
+
+// --------------------------------------------------------------------------
+// Creates the ring file and maps it. A previous ring file is kept with
+// LOG_RING_OLD_SUFFIX appended, to look at what led to a restart.
+//
+// Parameter:
+//   size: bytes of records, rounded down to a power of 2.
+//
+// Returns 0 on success, or -1 with the ring left closed.
+//
+sint32_t LogRingOpen( tLogRing *ring, const char *filename, uint32_t size )
+{
+  char old_filename[LOG_FILENAME_MAX_LENGTH + sizeof(LOG_RING_OLD_SUFFIX)];
+  struct timespec mono;
+  struct timeval now;
+  uint32_t bytes;
+  void *map;
+  int fd;
+
+  ring->header = NULL;
+  ring->data = NULL;
+  ring->fd = -1;
+
+  // Keep the highest power of 2.
+  for( bytes = LOG_RING_MIN_SIZE; bytes <= size / 2; bytes *= 2 );
+
+  pal_snprintf( old_filename, sizeof(old_filename), "%s%s", filename, LOG_RING_OLD_SUFFIX );
+  rename( filename, old_filename );
+
+  fd = open( filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+  if( fd == -1 )
+  {
+    return -1;
+  }
+
+  if( ftruncate( fd, LOG_RING_DATA + bytes ) != 0 )
+  {
+    close( fd );
+    return -1;
+  }
+
+  map = mmap( NULL, LOG_RING_DATA + bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  if( map == MAP_FAILED )
+  {
+    close( fd );
+    return -1;
+  }
+
+  ring->fd = fd;
+  ring->length = LOG_RING_DATA + bytes;
+  ring->data = (uint8_t *)map + LOG_RING_DATA;
+
+  // The wall clock when the monotonic clock read 0.
+  clock_gettime( CLOCK_MONOTONIC, &mono );
+  gettimeofday( &now, NULL );
+  if( now.tv_usec < mono.tv_nsec / 1000 )
+  {
+    now.tv_sec--;
+    now.tv_usec += 1000000;
+  }
+
+  ring->header = (tLogRingHeader *)map;
+  ring->header->version = LOG_RING_VERSION;
+  ring->header->size = bytes;
+  ring->header->block = LOG_RING_BLOCK;
+  ring->header->head = bytes;
+  ring->header->tail = bytes;
+  ring->header->epoch_sec = (uint32_t)(now.tv_sec - mono.tv_sec);
+  ring->header->epoch_usec = (uint32_t)(now.tv_usec - mono.tv_nsec / 1000);
+  pal_atomic_set( &ring->header->magic, LOG_RING_MAGIC );
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Reserves a record of 'length' bytes, header included, for the caller to
+// fill in and commit with LogRingCommit. Safe to call from any thread.
+//
+// Returns the record, or NULL if it is larger than a block.
+//
+tLogRingRecord* LogRingReserve( tLogRing *ring, uint32_t length, uint16_t type, uint32_t *position )
+{
+  tLogRingRecord *record;
+  uint32_t head, room, pos, tail, oldest;
+
+  length = (length + 3) & ~3;
+  if( length < sizeof(tLogRingRecord) || length > LOG_RING_BLOCK )
+  {
+    return NULL;
+  }
+
+  do
+  {
+    head = ring->header->head;
+
+    // Go to the next block if this one is too full.
+    room = LOG_RING_BLOCK - (head & (LOG_RING_BLOCK - 1));
+    pos = (length <= room) ? head : head + room;
+  }
+  while( !pal_atomic_cas( &ring->header->head, head, pos + length ) );
+
+  // The first record of a block writes over the oldest one: move the tail
+  // past it, unless another writer already moved it further.
+  if( (pos & (LOG_RING_BLOCK - 1)) == 0 && pos - ring->header->size >= ring->header->size )
+  {
+    oldest = pos - ring->header->size + LOG_RING_BLOCK;
+    do
+    {
+      tail = ring->header->tail;
+    }
+    while( (sint32_t)(oldest - tail) > 0 && !pal_atomic_cas( &ring->header->tail, tail, oldest ) );
+  }
+
+  record = (tLogRingRecord *)(ring->data + (pos & (ring->header->size - 1)));
+  record->length = (uint16_t)length;
+  record->type = type;
+
+  *position = pos;
+  return record;
+}
+
+
+// --------------------------------------------------------------------------
+// Makes a filled in record visible to the readers.
+//
+void LogRingCommit( tLogRingRecord *record, uint32_t position )
+{
+  pal_atomic_set( &record->position, position );
+}
+
+
+// --------------------------------------------------------------------------
+// Unmaps and closes the ring file. The records stay in the file.
+//
+void LogRingClose( tLogRing *ring )
+{
+  if( ring->header != NULL )
+  {
+    munmap( ring->header, ring->length );
+    close( ring->fd );
+
+    ring->header = NULL;
+    ring->data = NULL;
+    ring->fd = -1;
+  }
+}
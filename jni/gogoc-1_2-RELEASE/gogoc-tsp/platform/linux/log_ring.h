@@ -0,0 +1,76 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+/*
+ * Ring of log records in a memory-mapped file.
+ *
+ * The file starts with a tLogRingHeader, and the records follow at
+ * LOG_RING_DATA. A position counts the bytes written since the file was
+ * created: the record at position P is at offset P % size of the records,
+ * 'head' is the position of the next one, and 'tail' that of the oldest
+ * block that was not written over. The records are split in
+ * blocks of LOG_RING_BLOCK bytes, and never straddle two blocks: a record
+ * that does not fit in what is left of a block goes to the next one.
+ *
+ * Threads reserve their record with a compare-and-swap on 'head', fill it
+ * in, and commit it by writing its position last. A reader walks the
+ * blocks from the oldest one, and takes a record only if it holds the
+ * position it is at: anything else, an old record or one being written,
+ * ends the block. Positions start at 'size', so that the zeros of a new
+ * file never pass for a record. A reader that follows the ring keeps its
+ * position, and goes on from 'tail' if the writers went past it.
+ *
+ * The file can be read while the client runs, or after it crashed or
+ * stopped, with gogoc-logdecode.
+ */
+
+#define LOG_RING_MAGIC            0x676C6F67      /* "golg" */
+#define LOG_RING_VERSION          1
+#define LOG_RING_BLOCK            4096            /* Bytes, power of 2 */
+#define LOG_RING_DATA             4096            /* Offset of the records in the file */
+#define LOG_RING_MIN_SIZE         (4 * LOG_RING_BLOCK)
+
+// Types of records.
+#define LOG_RING_EVENT            1               /* Binary event, see log_event.h */
+#define LOG_RING_TEXT             2               /* Log line, see log_memory.h */
+
+typedef struct stLogRingHeader
+{
+  uint32_t            magic;
+  uint32_t            version;
+  uint32_t            size;           // Bytes of records, a power of 2.
+  uint32_t            block;
+  volatile uint32_t   head;           // Position of the next record.
+  uint32_t            epoch_sec;      // Wall clock when the monotonic clock
+  uint32_t            epoch_usec;     // read 0, for the record timestamps.
+  volatile uint32_t   tail;           // Position of the oldest block.
+} tLogRingHeader;
+
+typedef struct stLogRingRecord
+{
+  volatile uint32_t   position;       // Written last: the record is complete.
+  uint16_t            length;         // Bytes, this header included.
+  uint16_t            type;
+} tLogRingRecord;
+
+typedef struct stLogRing
+{
+  int                 fd;
+  uint32_t            length;         // Bytes mapped.
+  tLogRingHeader *    header;         // NULL when the ring is closed.
+  uint8_t *           data;
+} tLogRing;
+
+sint32_t            LogRingOpen           ( tLogRing *ring, const char *filename, uint32_t size );
+tLogRingRecord *    LogRingReserve        ( tLogRing *ring, uint32_t length, uint16_t type, uint32_t *position );
+void                LogRingCommit         ( tLogRingRecord *record, uint32_t position );
+void                LogRingClose          ( tLogRing *ring );
+
+#endif /* LOG_RING_H */
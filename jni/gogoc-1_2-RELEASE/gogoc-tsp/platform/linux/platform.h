@@ -17,4 +17,33 @@ This source code copyright (c) gogo6 Inc. 2002-2007.
 
 #define SCRIPT_TMP_FILE                   "/tmp/gogoc-tmp.log"
 
+/* The tunnel interface can be configured through netlink (tsp_netlink.c). */
+#define NETLINK_SUPPORT
+
+/* The tunnel MTU follows the path MTU to the server (tsp_pmtu.c). */
+#define PMTU_SUPPORT
+
+/* A standby tunnel to a second broker takes over a lost tunnel
+   (tsp_standby.c). */
+#define STANDBY_SUPPORT
+
+/* Rotated log files can be compressed with zlib (log.c). */
+#define LOG_COMPRESS_SUPPORT
+
+/* Display() messages can go to a binary event log (log_event.c). */
+#define LOG_EVENT_SUPPORT
+
+/* Log lines can go to a ring file on tmpfs, for the UI (log_memory.c). */
+#define LOG_MEMORY_SUPPORT
+
+/* SIGUSR1 changes the log levels, from a file next to the configuration
+   file (tsp_local.c). */
+#define LOG_LEVELS_SIGNAL
+
+/* Scripts are run with posix_spawn (tsp_setup.c), which older Android C
+   libraries lack. */
+#if !defined(ANDROID) || (defined(__ANDROID_API__) && __ANDROID_API__ >= 28)
+#define SPAWN_SUPPORT
+#endif
+
 #endif
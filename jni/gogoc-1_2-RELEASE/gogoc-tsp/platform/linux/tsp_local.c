@@ -12,7 +12,7 @@ This source code copyright (c) gogo6 Inc. 2002-2007.
 /* LINUX */
 
 #include <sys/types.h>
-#include <sys/wait.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 
 #include "platform.h"
@@ -30,6 +30,10 @@ This source code copyright (c) gogo6 Inc. 2002-2007.
 #include "tsp_client.h"     // tspSetupInterfaceLocal()
 #include "tsp_setup.h"      // tspSetupInterface()
 #include "tsp_tun_mgt.h"    // tspPerformTunnelLoop()
+#include "tsp_trace.h"      // tspTracePhase()
+#include "tsp_netlink.h"    // tspNetlinkAdvertise()
+#include "tsp_pmtu.h"       // tspPmtuStart()
+#include "tsp_standby.h"    // tspStandbyStart()
 
 /* these globals are defined by US used by alot of things in  */
 
@@ -41,6 +45,7 @@ char *TspHomeDir = "/usr/local/etc/gogoc";
 char DirSeparator = '/';
 
 int indSigHUP = 0;    // Set to 1 when HUP signal is trapped.
+int indSigUSR1 = 0;   // Set to 1 when USR1 signal is trapped.
 
 
 #include <gogocmessaging/gogocuistrings.h>
@@ -50,6 +55,8 @@ error_t send_status_info( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_tunnel_info( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_broker_list( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_haccess_status_info( void ) { return GOGOCM_UIS__NOERROR; }
+// No GUI gets the connection traces here: read them in the log.
+error_t send_conn_trace( void ) { return GOGOCM_UIS__NOERROR; }
 
 
 // --------------------------------------------------------------------------
@@ -80,7 +87,37 @@ void tspSetEnv(char *Variable, char *Value, int Flag)
 }
 
 // --------------------------------------------------------------------------
-// Checks if the gogoCLIENT has been requested to stop and exit.
+// Changes the log levels on SIGUSR1, from the file named after the
+// configuration file with ".levels" appended (gogoc.conf.levels). It holds
+// the console, file and syslog levels, -1 to keep a level as it is, and the
+// seconds the change lasts, 0 for good: "3 3 -1 600" logs everything to the
+// console and the log file for ten minutes. See LogSetLevels.
+//
+static void tspReadLogLevels( void )
+{
+  char path[LOG_FILENAME_MAX_LENGTH + sizeof(".levels")];
+  FILE* f;
+  int console, file, syslog, seconds;
+
+  pal_snprintf( path, sizeof(path), "%s.levels", FileName );
+  if( (f = fopen( path, "r" )) == NULL )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspReadLogLevels", GOGO_STR_LOG_LEVELS_CANT_READ, path );
+    return;
+  }
+
+  if( fscanf( f, "%d %d %d %d", &console, &file, &syslog, &seconds ) != 4 )
+    Display( LOG_LEVEL_1, ELError, "tspReadLogLevels", GOGO_STR_LOG_LEVELS_BAD_FILE, path );
+  else
+    LogSetLevels( console, file, syslog, seconds );
+
+  fclose( f );
+}
+
+// --------------------------------------------------------------------------
+// Checks if the gogoCLIENT has been requested to stop and exit. A change of
+// the log levels requested meanwhile is applied, and the levels of a burst
+// that is over are restored.
 //
 // Returns 1 if gogoCLIENT is being requested to stop and exit.
 // Else, waits 'uiWaitMs' miliseconds and returns 0.
@@ -96,6 +133,13 @@ int tspCheckForStopOrWait( const unsigned int uiWaitMs )
     usleep( uiWaitMs * 1000 );
   }
 
+  if( indSigUSR1 != 0 )
+  {
+    indSigUSR1 = 0;
+    tspReadLogLevels();
+  }
+  LogBurstCheck();
+
   return indSigHUP;
 }
 
@@ -147,7 +191,6 @@ gogoc_status tspStartLocal(int socket, tConf *c, tTunnel *t, net_tools_t *nt)
   gogoc_status status = STATUS_SUCCESS_INIT;
   int ka_interval = 0;
   int tunfd = (-1);
-  int pid;
 
 
   // Check if we got root privileges.
@@ -202,63 +245,20 @@ gogoc_status tspStartLocal(int socket, tConf *c, tTunnel *t, net_tools_t *nt)
     }
   }
 
+  // The tunnel and TSP descriptors are not inherited by the scripts the
+  // setup may run.
+  fcntl( socket, F_SETFD, FD_CLOEXEC );
+
   while( 1 ) // Dummy loop. 'break' instruction at the end.
   {
-    // Run the config script in another thread, without giving it our tunnel
-    // descriptor. This is important because otherwise the tunnel will stay
-    // open if we get killed.
-    //
-    pid = fork();
-
-    if( pid < 0 )
+    // Configure the interface from this process. Only the template script,
+    // if one is used, runs in a process of its own (execScript()).
+    status = tspSetupInterface(c, t);
+    if( status_number(status) != SUCCESS )
     {
-      // fork() error
-      status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
       break;
     }
-    else if (pid == 0)
-    {
-      // Child processing: run template script.
-      if( tunfd != -1 )
-      {
-        close(tunfd);
-      }
-
-      status = tspSetupInterface(c, t);
-      exit(status);
-    }
-    else
-    {
-      // Parent processing
-      int s = 0;
-
-
-      // Wait for child process to exit.
-      Display( LOG_LEVEL_3, ELInfo, "tspStartLocal", GOGO_STR_WAITING_FOR_SETUP_SCRIPT );
-      if( wait(&s) != pid )
-      {
-        // Error occured: we have no other child
-        Display( LOG_LEVEL_1, ELError, "tspStartLocal", GOGO_STR_ERR_WAITING_SCRIPT );
-        status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
-        break;
-      }
-
-      // Check if process waited upon has exited.
-      if( !WIFEXITED(s) )
-      {
-        // Error: child has not exited properly. Maybe killed ?
-        Display( LOG_LEVEL_1, ELError, "tspStartLocal", STR_GEN_SCRIPT_EXEC_FAILED );
-        status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
-        break;
-      }
-
-      // Check child exit code.
-      status = WEXITSTATUS(s);
-      if( status_number(status) != SUCCESS )
-      {
-        break;
-      }
-    }
+    tspTracePhase(TRACE_PHASE_INTERFACE_SETUP);
 
 #ifdef ANDROID
     // Check if we're already daemon. Calling multiple times the daemon() messes up pthreads.
@@ -276,12 +276,42 @@ gogoc_status tspStartLocal(int socket, tConf *c, tTunnel *t, net_tools_t *nt)
     writepid();
 #endif
 
+#ifdef NETLINK_SUPPORT
+    // The router advertisements are sent by a thread of this process, so
+    // they are started after the daemon() fork.
+    if( c->use_template == FALSE )
+    {
+      status = tspNetlinkAdvertise(c, t);
+      if( status_number(status) != SUCCESS )
+      {
+        status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+        break;
+      }
+#ifdef PMTU_SUPPORT
+      // Without path MTU discovery the tunnel stays at the minimum MTU,
+      // so a failure to start it is not fatal.
+      tspPmtuStart(c, t);
+#endif
+#ifdef STANDBY_SUPPORT
+      // The client works without the standby tunnel.
+      tspStandbyStart(c, t);
+#endif
+    }
+#endif
+
     // Retrieve keepalive inteval, if found in tunnel parameters.
     if( t->keepalive_interval != NULL )
     {
       ka_interval = atoi(t->keepalive_interval);
     }
 
+    // Without keepalive, the attempt is over once the interface is up.
+    // Otherwise, it ends with the first keepalive reply.
+    if( ka_interval <= 0 )
+    {
+      tspTraceEnd(status);
+    }
+
     // Start the tunnel loop, depending on tunnel mode
     //
     if( strcasecmp(t->type, STR_CONFIG_TUNNELMODE_V6UDPV4) == 0 )
@@ -309,17 +339,38 @@ gogoc_status tspStartLocal(int socket, tConf *c, tTunnel *t, net_tools_t *nt)
   }
 
 
-  // Cleanup: Close tunnel descriptor, if it was opened.
-  if( tunfd != -1 )
+#ifdef STANDBY_SUPPORT
+  // The active tunnel is not watched past its loop.
+  tspStandbyUnwatch();
+#endif
+
+  // Cleanup: Handle tunnel teardown. When the client is about to reconnect,
+  // the tunnel is kept for the next setup to reconcile with. With
+  // keep_tunnel, it is kept whenever the tunnel did not end on a stop.
+  // After a keepalive timeout, a standby tunnel that is up takes over
+  // instead: the tunnel is torn down, so that its routes give way.
+  if( (status_number(status) == ERR_KEEPALIVE_TIMEOUT ||
+       status_number(status) == ERR_TUN_LEASE_EXPIRED ||
+       (c->keep_tunnel == TRUE && status_number(status) != SUCCESS)) &&
+#ifdef STANDBY_SUPPORT
+      !(status_number(status) == ERR_KEEPALIVE_TIMEOUT && tspStandbyTakeOver()) &&
+#endif
+      tspKeepTunnel( c, t ) )
+  {
+    // The interface of the TUN device lives as long as its descriptor.
+    if( tunfd != -1 )
+      TunKeep( tunfd, c->if_tunnel_v6udpv4 );
+  }
+  else
   {
     // The tunnel file descriptor should be closed before attempting to tear
     // down the tunnel. Destruction of the tunnel interface may fail if
     // descriptor is not closed.
-    close( tunfd );
-  }
+    if( tunfd != -1 )
+      close( tunfd );
 
-  // Cleanup: Handle tunnel teardown.
-  tspTearDownTunnel( c, t );
+    tspTearDownTunnel( c, t );
+  }
 
 
   return status;
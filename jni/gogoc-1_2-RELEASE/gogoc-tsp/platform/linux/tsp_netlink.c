@@ -0,0 +1,1660 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/fib_rules.h>
+
+#include "config.h"         // tConf
+#include "xml_tun.h"        // tTunnel
+#include "tsp_netlink.h"
+#include "tsp_rtadv.h"      // tspRtAdvStart()
+#include "tsp_pmtu.h"       // tspPmtuTunnelMtu()
+#include "tsp_tun.h"        // TunRelease()
+#include "log.h"            // Display
+#include "hex_strings.h"    // Various string constants
+
+
+#define NETLINK_SYSCTL_FORWARDING   "/proc/sys/net/ipv6/conf/all/forwarding"
+
+// IFLA_IPTUN_xxx values from linux/if_tunnel.h, which older headers lack.
+#define NETLINK_IPTUN_REMOTE        3
+#define NETLINK_IPTUN_TTL           4
+#define NETLINK_IPTUN_PMTUDISC      10
+
+// Socket option of linux/netlink.h (4.20) that makes the kernel filter the
+// dumps by the index given in the request. Older kernels ignore it, and the
+// replies are filtered here as well.
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK      12
+#endif
+#ifndef SOCK_CLOEXEC
+#define SOCK_CLOEXEC                O_CLOEXEC
+#endif
+
+// sit ioctls, for the kernels that cannot configure sit devices through
+// netlink.
+#ifndef SIOCDEVPRIVATE
+#define SIOCDEVPRIVATE              0x89F0
+#endif
+#define NETLINK_SIOCGETTUNNEL       (SIOCDEVPRIVATE + 0)
+#define NETLINK_SIOCADDTUNNEL       (SIOCDEVPRIVATE + 1)
+#define NETLINK_SIOCCHGTUNNEL       (SIOCDEVPRIVATE + 3)
+
+#ifndef IP_DF
+#define IP_DF                       0x4000
+#endif
+
+typedef struct stNetlinkTunnelParm
+{
+  char          name[IFNAMSIZ];
+  int           link;
+  uint16_t      i_flags;
+  uint16_t      o_flags;
+  uint32_t      i_key;
+  uint32_t      o_key;
+  struct iphdr  iph;
+} tNetlinkTunnelParm;
+
+
+// --------------------------------------------------------------------------
+// A batch of netlink requests. The requests are laid out one after the other
+// in 'buf', and sent with a single send(). Each request carries NLM_F_ACK, so
+// the kernel answers each one with its own acknowledgement, matched back by
+// sequence number.
+//
+typedef struct stNetlinkBatch
+{
+  int         fd;
+  uint32_t    seq;                          // Sequence number of the first request.
+  sint32_t    count;                        // Number of requests in the batch.
+  size_t      len;                          // Bytes used in buf.
+  size_t      last;                         // Offset of the last request in buf.
+  sint32_t    overflow;                     // Set when a request did not fit.
+  sint32_t    total;                        // Number of requests committed so far.
+  const char* what[NETLINK_BATCH_MAX];      // Description, for error messages.
+  sint32_t    check[NETLINK_BATCH_MAX];     // Whether a failure is an error.
+  int         error[NETLINK_BATCH_MAX];     // errno of each request, after nlCommit.
+  union {
+    struct nlmsghdr align;
+    char data[NETLINK_BATCH_SIZE];
+  } buf;
+} tNetlinkBatch;
+
+
+// --------------------------------------------------------------------------
+// The sockets, opened by the first batch and kept for the lifetime of the
+// process: the setup, the teardown and the path MTU thread all run in the
+// client process and share them, under nl_lock. The only fork left is the
+// daemon() of Android, after the first setup: the child then opens its own
+// sockets, so that it never reads the replies meant for the parent.
+//
+static struct
+{
+  int         fd;                           // Netlink socket.
+  int         ioctl_fd;                     // For the sit ioctls.
+  pid_t       pid;                          // Process that opened them.
+  uint32_t    seq;                          // Next sequence number.
+} nl_socket = { -1, -1, 0, 0 };
+
+// Held from nlOpen to nlClose: the path MTU thread changes the interface
+// MTU through the same socket.
+static pthread_mutex_t nl_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// --------------------------------------------------------------------------
+static sint32_t nlOpen( tNetlinkBatch* b )
+{
+  struct sockaddr_nl sa;
+  struct timeval tv;
+  int on = 1;
+
+  memset( b, 0, sizeof(tNetlinkBatch) );
+  b->fd = -1;
+
+  pthread_mutex_lock( &nl_lock );
+  if( nl_socket.fd >= 0 && nl_socket.pid == getpid() )
+  {
+    b->fd = nl_socket.fd;
+    b->seq = nl_socket.seq;
+    return 0;
+  }
+
+  // Inherited from the parent: leave them to it.
+  if( nl_socket.fd >= 0 )
+    close( nl_socket.fd );
+  if( nl_socket.ioctl_fd >= 0 )
+    close( nl_socket.ioctl_fd );
+  nl_socket.fd = -1;
+  nl_socket.ioctl_fd = -1;
+
+  b->fd = socket( AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE );
+  if( b->fd < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlOpen", GOGO_STR_NETLINK_CANT_OPEN, strerror(errno) );
+    pthread_mutex_unlock( &nl_lock );
+    return -1;
+  }
+
+  memset( &sa, 0, sizeof(sa) );
+  sa.nl_family = AF_NETLINK;
+  if( bind( b->fd, (struct sockaddr*)&sa, sizeof(sa) ) < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlOpen", GOGO_STR_NETLINK_CANT_OPEN, strerror(errno) );
+    close( b->fd );
+    b->fd = -1;
+    pthread_mutex_unlock( &nl_lock );
+    return -1;
+  }
+
+  // Do not wait forever for the kernel acknowledgements.
+  tv.tv_sec = NETLINK_REPLY_TIMEOUT;
+  tv.tv_usec = 0;
+  setsockopt( b->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+  setsockopt( b->fd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, &on, sizeof(on) );
+
+  b->seq = (uint32_t)pal_time(NULL);
+
+  nl_socket.fd = b->fd;
+  nl_socket.pid = getpid();
+  nl_socket.seq = b->seq;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Ends the use of the socket by the batch. The socket stays open; the next
+// batch starts past the sequence numbers used by this one, so that a late
+// reply is never taken for one of its own.
+//
+static void nlClose( tNetlinkBatch* b )
+{
+  if( b->fd < 0 )
+    return;
+
+  nl_socket.seq = b->seq + NETLINK_BATCH_MAX + 1;
+  b->fd = -1;
+  pthread_mutex_unlock( &nl_lock );
+}
+
+// --------------------------------------------------------------------------
+// Appends a request to the batch, and returns a pointer to its (zeroed)
+// family header, or NULL if the batch is full.
+//
+static void* nlRequest( tNetlinkBatch* b, uint16_t type, uint16_t flags, size_t hdrlen,
+                        const char* what, sint32_t check )
+{
+  struct nlmsghdr* n;
+
+  if( b->overflow || b->count == NETLINK_BATCH_MAX ||
+      b->len + NLMSG_SPACE(hdrlen) > sizeof(b->buf.data) )
+  {
+    b->overflow = 1;
+    return NULL;
+  }
+
+  n = (struct nlmsghdr*)(b->buf.data + b->len);
+  memset( n, 0, NLMSG_SPACE(hdrlen) );
+  n->nlmsg_len = NLMSG_LENGTH(hdrlen);
+  n->nlmsg_type = type;
+  n->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+  n->nlmsg_seq = b->seq + b->count;
+
+  b->what[b->count] = what;
+  b->check[b->count] = check;
+  b->error[b->count] = 0;
+  b->count++;
+  b->last = b->len;
+  b->len += NLMSG_ALIGN(n->nlmsg_len);
+
+  return NLMSG_DATA(n);
+}
+
+// --------------------------------------------------------------------------
+// Appends an attribute to the last request of the batch.
+//
+static struct rtattr* nlAttr( tNetlinkBatch* b, uint16_t type, const void* data, size_t len )
+{
+  struct nlmsghdr* n = (struct nlmsghdr*)(b->buf.data + b->last);
+  struct rtattr* rta;
+
+  if( b->overflow || b->count == 0 || b->len + RTA_SPACE(len) > sizeof(b->buf.data) )
+  {
+    b->overflow = 1;
+    return NULL;
+  }
+
+  rta = (struct rtattr*)(b->buf.data + b->len);
+  memset( rta, 0, RTA_SPACE(len) );
+  rta->rta_type = type;
+  rta->rta_len = RTA_LENGTH(len);
+  if( len > 0 )
+    memcpy( RTA_DATA(rta), data, len );
+
+  n->nlmsg_len = (b->len - b->last) + RTA_LENGTH(len);
+  b->len = b->last + NLMSG_ALIGN(n->nlmsg_len);
+
+  return rta;
+}
+
+// --------------------------------------------------------------------------
+static void nlAttrU32( tNetlinkBatch* b, uint16_t type, uint32_t value )
+{
+  nlAttr( b, type, &value, sizeof(value) );
+}
+
+// --------------------------------------------------------------------------
+static void nlAttrU8( tNetlinkBatch* b, uint16_t type, uint8_t value )
+{
+  nlAttr( b, type, &value, sizeof(value) );
+}
+
+// --------------------------------------------------------------------------
+// Closes a nested attribute opened with nlAttr( b, type, NULL, 0 ).
+//
+static void nlNestEnd( tNetlinkBatch* b, struct rtattr* nest )
+{
+  if( nest != NULL && !b->overflow )
+    nest->rta_len = (unsigned short)((b->buf.data + b->len) - (char*)nest);
+}
+
+// --------------------------------------------------------------------------
+// Sends all the requests of the batch at once, then reads the
+// acknowledgements. Failures of the requests that were added with 'check'
+// set are logged.
+//
+// Returns 0 if all the checked requests succeeded.
+//
+static sint32_t nlCommit( tNetlinkBatch* b )
+{
+  char reply[8192];
+  sint32_t acked = 0;
+  sint32_t failed = 0;
+  struct nlmsghdr* h;
+  struct nlmsgerr* err;
+  uint32_t i;
+  int n;
+
+  if( b->overflow )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlCommit", GOGO_STR_NETLINK_REQUEST_FAILED,
+             b->count > 0 ? b->what[b->count - 1] : "batch", strerror(ENOBUFS) );
+    failed = 1;
+  }
+  else if( b->count > 0 && send( b->fd, b->buf.data, b->len, 0 ) < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlCommit", GOGO_STR_NETLINK_REQUEST_FAILED,
+             b->what[0], strerror(errno) );
+    failed = 1;
+  }
+  else
+  {
+    while( acked < b->count )
+    {
+      n = recv( b->fd, reply, sizeof(reply), 0 );
+      if( n < 0 )
+      {
+        if( errno == EINTR )
+          continue;
+        Display( LOG_LEVEL_1, ELError, "nlCommit", GOGO_STR_NETLINK_NO_REPLY, b->what[acked] );
+        failed = 1;
+        break;
+      }
+
+      for( h = (struct nlmsghdr*)reply; NLMSG_OK(h, n); h = NLMSG_NEXT(h, n) )
+      {
+        i = h->nlmsg_seq - b->seq;
+        if( h->nlmsg_type != NLMSG_ERROR || i >= (uint32_t)b->count )
+          continue;
+
+        acked++;
+        err = (struct nlmsgerr*)NLMSG_DATA(h);
+        b->error[i] = -err->error;
+        if( err->error != 0 && b->check[i] )
+        {
+          Display( LOG_LEVEL_1, ELError, "nlCommit", GOGO_STR_NETLINK_REQUEST_FAILED,
+                   b->what[i], strerror(-err->error) );
+          failed = 1;
+        }
+      }
+    }
+  }
+
+  // Start the next batch past the sequence numbers used by this one, and
+  // the one reserved for dumps.
+  b->total += b->count;
+  b->seq += NETLINK_BATCH_MAX + 1;
+  b->count = 0;
+  b->len = 0;
+  b->last = 0;
+  b->overflow = 0;
+
+  return failed ? -1 : 0;
+}
+
+
+// --------------------------------------------------------------------------
+static void nlLinkSet( tNetlinkBatch* b, int ifindex, sint32_t up, sint32_t mtu,
+                       const char* what, sint32_t check )
+{
+  struct ifinfomsg* ifi;
+
+  ifi = (struct ifinfomsg*)nlRequest( b, RTM_NEWLINK, 0, sizeof(struct ifinfomsg), what, check );
+  if( ifi == NULL )
+    return;
+
+  ifi->ifi_family = AF_UNSPEC;
+  ifi->ifi_index = ifindex;
+  ifi->ifi_change = IFF_UP;
+  ifi->ifi_flags = up ? IFF_UP : 0;
+  if( mtu > 0 )
+    nlAttrU32( b, IFLA_MTU, (uint32_t)mtu );
+}
+
+// --------------------------------------------------------------------------
+static void nlLinkDel( tNetlinkBatch* b, const char* ifname, const char* what, sint32_t check )
+{
+  struct ifinfomsg* ifi;
+
+  ifi = (struct ifinfomsg*)nlRequest( b, RTM_DELLINK, 0, sizeof(struct ifinfomsg), what, check );
+  if( ifi == NULL )
+    return;
+
+  ifi->ifi_family = AF_UNSPEC;
+  nlAttr( b, IFLA_IFNAME, ifname, pal_strlen(ifname) + 1 );
+}
+
+// --------------------------------------------------------------------------
+// Creates a sit (6in4) device to the given IPv4 remote endpoint or, when
+// 'ifindex' is not 0, moves the existing one to that endpoint.
+//
+static void nlSit( tNetlinkBatch* b, int ifindex, const char* ifname, const struct in_addr* remote,
+                   const char* what, sint32_t check )
+{
+  struct ifinfomsg* ifi;
+  struct rtattr* linkinfo;
+  struct rtattr* data;
+
+  ifi = (struct ifinfomsg*)nlRequest( b, RTM_NEWLINK, ifindex == 0 ? NLM_F_CREATE | NLM_F_EXCL : 0,
+                                      sizeof(struct ifinfomsg), what, check );
+  if( ifi == NULL )
+    return;
+
+  ifi->ifi_family = AF_UNSPEC;
+  ifi->ifi_index = ifindex;
+  if( ifindex == 0 )
+    nlAttr( b, IFLA_IFNAME, ifname, pal_strlen(ifname) + 1 );
+  linkinfo = nlAttr( b, IFLA_LINKINFO, NULL, 0 );
+  nlAttr( b, IFLA_INFO_KIND, "sit", 3 );
+  data = nlAttr( b, IFLA_INFO_DATA, NULL, 0 );
+  nlAttr( b, NETLINK_IPTUN_REMOTE, remote, sizeof(struct in_addr) );
+  nlAttrU8( b, NETLINK_IPTUN_TTL, NETLINK_TUNNEL_TTL );
+  nlAttrU8( b, NETLINK_IPTUN_PMTUDISC, 1 );
+  nlNestEnd( b, data );
+  nlNestEnd( b, linkinfo );
+}
+
+// --------------------------------------------------------------------------
+// Same as nlSit, through the sit ioctls. Older kernels only know these.
+// 'cmd' is NETLINK_SIOCADDTUNNEL, NETLINK_SIOCCHGTUNNEL or
+// NETLINK_SIOCGETTUNNEL; the latter returns the remote endpoint.
+//
+static int nlSitIoctl( int cmd, const char* ifname, struct in_addr* remote )
+{
+  tNetlinkTunnelParm p;
+  struct ifreq ifr;
+  int error = 0;
+
+  if( pal_strlen(ifname) >= IFNAMSIZ )
+    return ENAMETOOLONG;
+
+  memset( &p, 0, sizeof(p) );
+  memset( &ifr, 0, sizeof(ifr) );
+  p.iph.version = 4;
+  p.iph.ihl = 5;
+  p.iph.frag_off = htons(IP_DF);
+  p.iph.protocol = IPPROTO_IPV6;
+  p.iph.ttl = NETLINK_TUNNEL_TTL;
+  p.iph.daddr = remote->s_addr;
+  strcpy( p.name, ifname );
+
+  // New devices are added through the sit0 fallback device.
+  strcpy( ifr.ifr_name, cmd == NETLINK_SIOCADDTUNNEL ? "sit0" : ifname );
+  ifr.ifr_ifru.ifru_data = (void*)&p;
+
+  // Opened with the netlink socket, by this process.
+  if( nl_socket.ioctl_fd < 0 )
+  {
+    nl_socket.ioctl_fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+    if( nl_socket.ioctl_fd < 0 )
+      return errno;
+  }
+  if( ioctl( nl_socket.ioctl_fd, cmd, &ifr ) < 0 )
+    error = errno;
+
+  if( error == 0 && cmd == NETLINK_SIOCGETTUNNEL )
+    remote->s_addr = p.iph.daddr;
+
+  return error;
+}
+
+// --------------------------------------------------------------------------
+static void nlAddr( tNetlinkBatch* b, uint16_t cmd, int ifindex, const struct in6_addr* addr,
+                    sint32_t plen, const char* what, sint32_t check )
+{
+  struct ifaddrmsg* ifa;
+
+  ifa = (struct ifaddrmsg*)nlRequest( b, cmd, cmd == RTM_NEWADDR ? NLM_F_CREATE | NLM_F_REPLACE : 0,
+                                      sizeof(struct ifaddrmsg), what, check );
+  if( ifa == NULL )
+    return;
+
+  ifa->ifa_family = AF_INET6;
+  ifa->ifa_prefixlen = (unsigned char)plen;
+  ifa->ifa_scope = RT_SCOPE_UNIVERSE;
+  ifa->ifa_index = ifindex;
+  nlAttr( b, IFA_LOCAL, addr, sizeof(struct in6_addr) );
+  nlAttr( b, IFA_ADDRESS, addr, sizeof(struct in6_addr) );
+}
+
+// --------------------------------------------------------------------------
+// Adds or deletes an IPv6 route in a table. A route is deleted whatever its
+// interface when 'ifindex' is 0, and whatever its metric when 'metric' is 0.
+//
+static void nlRoute( tNetlinkBatch* b, uint16_t cmd, uint32_t table, int ifindex,
+                     const struct in6_addr* dst, sint32_t plen, uint32_t metric,
+                     const char* what, sint32_t check )
+{
+  struct rtmsg* rtm;
+
+  rtm = (struct rtmsg*)nlRequest( b, cmd, cmd == RTM_NEWROUTE ? NLM_F_CREATE | NLM_F_REPLACE : 0,
+                                  sizeof(struct rtmsg), what, check );
+  if( rtm == NULL )
+    return;
+
+  rtm->rtm_family = AF_INET6;
+  rtm->rtm_dst_len = (unsigned char)plen;
+  rtm->rtm_table = (unsigned char)table;
+  rtm->rtm_type = RTN_UNICAST;
+  if( cmd == RTM_NEWROUTE )
+  {
+    rtm->rtm_protocol = RTPROT_BOOT;
+    rtm->rtm_scope = RT_SCOPE_UNIVERSE;
+  }
+  else
+  {
+    rtm->rtm_scope = RT_SCOPE_NOWHERE;
+  }
+
+  if( plen > 0 )
+    nlAttr( b, RTA_DST, dst, sizeof(struct in6_addr) );
+  if( ifindex != 0 )
+    nlAttrU32( b, RTA_OIF, (uint32_t)ifindex );
+  if( metric != 0 )
+    nlAttrU32( b, RTA_PRIORITY, metric );
+}
+
+// --------------------------------------------------------------------------
+// Adds or deletes an IPv6 rule of 'priority' to 'table': for the packets
+// marked with 'fwmark' if it is not 0, otherwise for the packets from
+// src/srclen.
+//
+static void nlRule( tNetlinkBatch* b, uint16_t cmd, uint32_t table, uint32_t priority,
+                    const struct in6_addr* src, sint32_t srclen, uint32_t fwmark,
+                    const char* what, sint32_t check )
+{
+  struct fib_rule_hdr* frh;
+
+  frh = (struct fib_rule_hdr*)nlRequest( b, cmd, cmd == RTM_NEWRULE ? NLM_F_CREATE : 0,
+                                         sizeof(struct fib_rule_hdr), what, check );
+  if( frh == NULL )
+    return;
+
+  frh->family = AF_INET6;
+  frh->table = (unsigned char)table;
+  frh->action = FR_ACT_TO_TBL;
+
+  nlAttrU32( b, FRA_PRIORITY, priority );
+  nlAttrU32( b, FRA_TABLE, table );
+  if( fwmark != 0 )
+  {
+    nlAttrU32( b, FRA_FWMARK, fwmark );
+    nlAttrU32( b, FRA_FWMASK, 0xFFFFFFFF );
+  }
+  else
+  {
+    frh->src_len = (unsigned char)srclen;
+    nlAttr( b, FRA_SRC, src, sizeof(struct in6_addr) );
+  }
+}
+
+// --------------------------------------------------------------------------
+// Sends a get request right away, and calls 'handler' on each reply. The
+// requests of the batch are not affected.
+//
+// Returns 0 on success, the errno returned by the kernel if the request
+// failed, or -1 if no reply could be read.
+//
+typedef void (*tNetlinkHandler)( tNetlinkBatch* b, struct nlmsghdr* h, void* ctx );
+
+static int nlQuery( tNetlinkBatch* b, struct nlmsghdr* req, const char* what,
+                    tNetlinkHandler handler, void* ctx )
+{
+  char reply[8192];
+  uint32_t seq = b->seq + NETLINK_BATCH_MAX;
+  struct nlmsghdr* h;
+  int n;
+
+  req->nlmsg_flags |= NLM_F_REQUEST;
+  req->nlmsg_seq = seq;
+
+  if( send( b->fd, req, req->nlmsg_len, 0 ) < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlQuery", GOGO_STR_NETLINK_REQUEST_FAILED, what, strerror(errno) );
+    return -1;
+  }
+
+  while( 1 )
+  {
+    n = recv( b->fd, reply, sizeof(reply), 0 );
+    if( n < 0 )
+    {
+      if( errno == EINTR )
+        continue;
+      Display( LOG_LEVEL_1, ELError, "nlQuery", GOGO_STR_NETLINK_NO_REPLY, what );
+      return -1;
+    }
+
+    for( h = (struct nlmsghdr*)reply; NLMSG_OK(h, n); h = NLMSG_NEXT(h, n) )
+    {
+      if( h->nlmsg_seq != seq )
+        continue;
+      if( h->nlmsg_type == NLMSG_DONE )
+        return 0;
+      if( h->nlmsg_type == NLMSG_ERROR )
+        return -((struct nlmsgerr*)NLMSG_DATA(h))->error;
+
+      handler( b, h, ctx );
+
+      // A request that is not a dump has a single reply.
+      if( (h->nlmsg_flags & NLM_F_MULTI) == 0 )
+        return 0;
+    }
+  }
+}
+
+
+// --------------------------------------------------------------------------
+// Current state of a network interface.
+//
+typedef struct stNetlinkLink
+{
+  int             index;              // 0 if the interface does not exist.
+  uint32_t        flags;              // IFF_xxx
+  uint32_t        mtu;
+  char            kind[16];           // Link type, empty if not known.
+  sint32_t        has_remote;         // Whether 'remote' is known.
+  struct in_addr  remote;             // Remote endpoint of a sit device.
+} tNetlinkLink;
+
+static void nlLinkHandler( tNetlinkBatch* b, struct nlmsghdr* h, void* ctx )
+{
+  tNetlinkLink* link = (tNetlinkLink*)ctx;
+  struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(h);
+  struct rtattr *rta, *info, *data;
+  int len, ilen, dlen;
+
+  (void)b;
+
+  if( h->nlmsg_type != RTM_NEWLINK )
+    return;
+
+  link->index = ifi->ifi_index;
+  link->flags = ifi->ifi_flags;
+
+  len = IFLA_PAYLOAD(h);
+  for( rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len) )
+  {
+    if( rta->rta_type == IFLA_MTU && RTA_PAYLOAD(rta) >= sizeof(uint32_t) )
+      memcpy( &link->mtu, RTA_DATA(rta), sizeof(uint32_t) );
+
+    if( rta->rta_type != IFLA_LINKINFO )
+      continue;
+
+    ilen = RTA_PAYLOAD(rta);
+    for( info = (struct rtattr*)RTA_DATA(rta); RTA_OK(info, ilen); info = RTA_NEXT(info, ilen) )
+    {
+      if( info->rta_type == IFLA_INFO_KIND )
+      {
+        pal_snprintf( link->kind, sizeof(link->kind), "%.*s",
+                      (int)RTA_PAYLOAD(info), (const char*)RTA_DATA(info) );
+      }
+      else if( info->rta_type == IFLA_INFO_DATA )
+      {
+        dlen = RTA_PAYLOAD(info);
+        for( data = (struct rtattr*)RTA_DATA(info); RTA_OK(data, dlen); data = RTA_NEXT(data, dlen) )
+        {
+          if( data->rta_type == NETLINK_IPTUN_REMOTE && RTA_PAYLOAD(data) >= sizeof(struct in_addr) )
+          {
+            memcpy( &link->remote, RTA_DATA(data), sizeof(struct in_addr) );
+            link->has_remote = 1;
+          }
+        }
+      }
+    }
+  }
+}
+
+// --------------------------------------------------------------------------
+// Reads the state of an interface. 'link->index' is 0 if it does not exist.
+//
+static sint32_t nlGetLink( tNetlinkBatch* b, const char* ifname, tNetlinkLink* link )
+{
+  struct {
+    struct nlmsghdr h;
+    struct ifinfomsg ifi;
+  } req;
+  int error;
+
+  memset( link, 0, sizeof(tNetlinkLink) );
+
+  memset( &req, 0, sizeof(req) );
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+  req.h.nlmsg_type = RTM_GETLINK;
+  req.ifi.ifi_family = AF_UNSPEC;
+  req.ifi.ifi_index = (int)if_nametoindex( ifname );
+  if( req.ifi.ifi_index == 0 )
+    return 0;
+
+  error = nlQuery( b, &req.h, "reading interface", nlLinkHandler, link );
+  if( error == ENODEV )
+  {
+    link->index = 0;
+    return 0;
+  }
+  if( error != 0 )
+  {
+    if( error > 0 )
+      Display( LOG_LEVEL_1, ELError, "nlGetLink", GOGO_STR_NETLINK_REQUEST_FAILED, "reading interface", strerror(error) );
+    return -1;
+  }
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// An address wanted on an interface, for nlSyncAddr and nlFlushAddrs.
+//
+typedef struct stNetlinkAddr
+{
+  int                     ifindex;
+  const struct in6_addr*  addr;         // NULL to remove them all.
+  sint32_t                plen;
+  sint32_t                exclusive;    // Remove the other global addresses.
+  sint32_t                found;
+} tNetlinkAddr;
+
+static void nlAddrHandler( tNetlinkBatch* b, struct nlmsghdr* h, void* ctx )
+{
+  tNetlinkAddr* want = (tNetlinkAddr*)ctx;
+  struct ifaddrmsg* ifa = (struct ifaddrmsg*)NLMSG_DATA(h);
+  struct rtattr* rta;
+  const struct in6_addr* addr = NULL;
+  int len;
+
+  if( h->nlmsg_type != RTM_NEWADDR || (int)ifa->ifa_index != want->ifindex ||
+      ifa->ifa_scope != RT_SCOPE_UNIVERSE )
+    return;
+
+  len = IFA_PAYLOAD(h);
+  for( rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len) )
+  {
+    if( rta->rta_type == IFA_ADDRESS )
+      addr = (const struct in6_addr*)RTA_DATA(rta);
+  }
+  if( addr == NULL )
+    return;
+
+  if( want->addr != NULL && ifa->ifa_prefixlen == want->plen &&
+      memcmp( addr, want->addr, sizeof(struct in6_addr) ) == 0 )
+    want->found = 1;
+  else if( want->exclusive )
+    nlAddr( b, RTM_DELADDR, want->ifindex, addr, ifa->ifa_prefixlen, "removing old address", 0 );
+}
+
+// --------------------------------------------------------------------------
+// Dumps the global IPv6 addresses of one interface: the kernel sends only
+// those of 'want->ifindex' when it supports strict checking.
+//
+static sint32_t nlDumpAddrs( tNetlinkBatch* b, tNetlinkAddr* want )
+{
+  struct {
+    struct nlmsghdr h;
+    struct ifaddrmsg ifa;
+  } req;
+  int error;
+
+  memset( &req, 0, sizeof(req) );
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+  req.h.nlmsg_type = RTM_GETADDR;
+  req.h.nlmsg_flags = NLM_F_DUMP;
+  req.ifa.ifa_family = AF_INET6;
+  req.ifa.ifa_index = want->ifindex;
+
+  error = nlQuery( b, &req.h, "listing addresses", nlAddrHandler, want );
+  if( error != 0 )
+  {
+    if( error > 0 )
+      Display( LOG_LEVEL_1, ELError, "nlDumpAddrs", GOGO_STR_NETLINK_REQUEST_FAILED, "listing addresses", strerror(error) );
+    return -1;
+  }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Adds to the batch what it takes to have the address on the interface:
+// nothing if it is already there. With 'exclusive', the other global IPv6
+// addresses of the interface are removed.
+//
+static sint32_t nlSyncAddr( tNetlinkBatch* b, int ifindex, const struct in6_addr* addr, sint32_t plen,
+                            sint32_t exclusive, const char* what )
+{
+  tNetlinkAddr want;
+
+  memset( &want, 0, sizeof(want) );
+  want.ifindex = ifindex;
+  want.addr = addr;
+  want.plen = plen;
+  want.exclusive = exclusive;
+
+  if( nlDumpAddrs( b, &want ) != 0 )
+    return -1;
+
+  if( !want.found )
+    nlAddr( b, RTM_NEWADDR, ifindex, addr, plen, what, 1 );
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Adds to the batch the removal of all the global IPv6 addresses of the
+// interface.
+//
+static sint32_t nlFlushAddrs( tNetlinkBatch* b, int ifindex )
+{
+  tNetlinkAddr want;
+
+  memset( &want, 0, sizeof(want) );
+  want.ifindex = ifindex;
+  want.exclusive = 1;
+
+  return nlDumpAddrs( b, &want );
+}
+
+
+// --------------------------------------------------------------------------
+// A route wanted, for nlSyncRoutes.
+//
+typedef struct stNetlinkRoute
+{
+  uint32_t          table;
+  struct in6_addr   dst;
+  sint32_t          plen;
+  int               ifindex;
+  sint32_t          exclusive;    // Remove the routes to dst through other interfaces.
+  const char*       what;
+  sint32_t          found;
+} tNetlinkRoute;
+
+typedef struct stNetlinkRoutes
+{
+  tNetlinkRoute*    routes;
+  sint32_t          count;
+  uint32_t          own_table;    // Table of the tunnels only, or 0.
+  uint32_t          metric;       // Metric of the routes of the tunnel.
+} tNetlinkRoutes;
+
+static void nlRouteHandler( tNetlinkBatch* b, struct nlmsghdr* h, void* ctx )
+{
+  tNetlinkRoutes* want = (tNetlinkRoutes*)ctx;
+  struct rtmsg* rtm = (struct rtmsg*)NLMSG_DATA(h);
+  struct rtattr* rta;
+  struct in6_addr dst;
+  uint32_t table, metric = 0;
+  int oif = 0, len;
+  sint32_t i, wanted = 0;
+
+  if( h->nlmsg_type != RTM_NEWROUTE || rtm->rtm_family != AF_INET6 ||
+      rtm->rtm_type != RTN_UNICAST || (rtm->rtm_flags & RTM_F_CLONED) != 0 )
+    return;
+
+  memset( &dst, 0, sizeof(dst) );
+  table = rtm->rtm_table;
+
+  len = RTM_PAYLOAD(h);
+  for( rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len) )
+  {
+    switch( rta->rta_type )
+    {
+    case RTA_DST:       memcpy( &dst, RTA_DATA(rta), sizeof(dst) ); break;
+    case RTA_OIF:       memcpy( &oif, RTA_DATA(rta), sizeof(oif) ); break;
+    case RTA_PRIORITY:  memcpy( &metric, RTA_DATA(rta), sizeof(metric) ); break;
+    case RTA_TABLE:     memcpy( &table, RTA_DATA(rta), sizeof(table) ); break;
+    }
+  }
+
+  for( i = 0; i < want->count; i++ )
+  {
+    tNetlinkRoute* r = &want->routes[i];
+
+    if( table != r->table || rtm->rtm_dst_len != r->plen ||
+        memcmp( &dst, &r->dst, sizeof(dst) ) != 0 )
+      continue;
+
+    if( oif == r->ifindex && metric == want->metric )
+      r->found = wanted = 1;
+    else if( r->exclusive && oif != r->ifindex && metric != NETLINK_STANDBY_METRIC )
+      nlRoute( b, RTM_DELROUTE, table, oif, &dst, r->plen, metric, "deleting old route", 0 );
+  }
+
+  // The table of the tunnels holds nothing else of this tunnel. The routes
+  // of the other tunnel have another metric.
+  if( !wanted && want->own_table != 0 && table == want->own_table && metric == want->metric )
+    nlRoute( b, RTM_DELROUTE, table, oif, &dst, rtm->rtm_dst_len, metric, "deleting stale route", 0 );
+}
+
+// --------------------------------------------------------------------------
+// Adds to the batch what it takes to have the routes, of metric 'metric':
+// the ones already there are left alone. If 'own_table' is not 0, the other
+// routes of that metric in that table are deleted.
+//
+static sint32_t nlSyncRoutes( tNetlinkBatch* b, tNetlinkRoute* routes, sint32_t count,
+                              uint32_t own_table, uint32_t metric )
+{
+  struct {
+    struct nlmsghdr h;
+    struct rtmsg rtm;
+  } req;
+  tNetlinkRoutes want;
+  sint32_t i;
+  int error;
+
+  memset( &req, 0, sizeof(req) );
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+  req.h.nlmsg_type = RTM_GETROUTE;
+  req.h.nlmsg_flags = NLM_F_DUMP;
+  req.rtm.rtm_family = AF_INET6;
+
+  want.routes = routes;
+  want.count = count;
+  want.own_table = own_table;
+  want.metric = metric;
+
+  error = nlQuery( b, &req.h, "listing routes", nlRouteHandler, &want );
+  if( error != 0 )
+  {
+    if( error > 0 )
+      Display( LOG_LEVEL_1, ELError, "nlSyncRoutes", GOGO_STR_NETLINK_REQUEST_FAILED, "listing routes", strerror(error) );
+    return -1;
+  }
+
+  for( i = 0; i < count; i++ )
+  {
+    if( !routes[i].found )
+      nlRoute( b, RTM_NEWROUTE, routes[i].table, routes[i].ifindex, &routes[i].dst, routes[i].plen,
+               metric, routes[i].what, 1 );
+  }
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// A rule wanted to the table of the tunnel, for nlSyncRules.
+//
+typedef struct stNetlinkRule
+{
+  struct in6_addr   src;
+  sint32_t          srclen;
+  uint32_t          fwmark;
+  const char*       what;
+  sint32_t          found;
+} tNetlinkRule;
+
+typedef struct stNetlinkRules
+{
+  tNetlinkRule*     rules;
+  sint32_t          count;
+  uint32_t          table;
+  uint32_t          priority;
+} tNetlinkRules;
+
+static void nlRuleHandler( tNetlinkBatch* b, struct nlmsghdr* h, void* ctx )
+{
+  tNetlinkRules* want = (tNetlinkRules*)ctx;
+  struct fib_rule_hdr* frh = (struct fib_rule_hdr*)NLMSG_DATA(h);
+  struct rtattr* rta;
+  struct in6_addr src;
+  uint32_t table, priority = 0, fwmark = 0;
+  int len;
+  sint32_t i;
+
+  if( h->nlmsg_type != RTM_NEWRULE || frh->family != AF_INET6 )
+    return;
+
+  memset( &src, 0, sizeof(src) );
+  table = frh->table;
+
+  len = (int)h->nlmsg_len - NLMSG_LENGTH(sizeof(struct fib_rule_hdr));
+  for( rta = (struct rtattr*)((char*)frh + NLMSG_ALIGN(sizeof(struct fib_rule_hdr)));
+       RTA_OK(rta, len); rta = RTA_NEXT(rta, len) )
+  {
+    switch( rta->rta_type )
+    {
+    case FRA_SRC:       memcpy( &src, RTA_DATA(rta), sizeof(src) ); break;
+    case FRA_PRIORITY:  memcpy( &priority, RTA_DATA(rta), sizeof(priority) ); break;
+    case FRA_FWMARK:    memcpy( &fwmark, RTA_DATA(rta), sizeof(fwmark) ); break;
+    case FRA_TABLE:     memcpy( &table, RTA_DATA(rta), sizeof(table) ); break;
+    }
+  }
+
+  // Only the rules of the client to the table are looked at.
+  if( priority != want->priority || table != want->table )
+    return;
+
+  for( i = 0; i < want->count; i++ )
+  {
+    tNetlinkRule* r = &want->rules[i];
+
+    if( fwmark == r->fwmark && frh->src_len == r->srclen &&
+        (fwmark != 0 || memcmp( &src, &r->src, sizeof(src) ) == 0) )
+    {
+      r->found = 1;
+      return;
+    }
+  }
+
+  nlRule( b, RTM_DELRULE, table, priority, &src, frh->src_len, fwmark, "deleting old rule", 0 );
+}
+
+// --------------------------------------------------------------------------
+// Adds to the batch what it takes to have exactly the rules of 'priority'
+// to the table: the ones already there are left alone, the others of the
+// client to the table with that priority are deleted.
+//
+static sint32_t nlSyncRules( tNetlinkBatch* b, uint32_t table, uint32_t priority,
+                             tNetlinkRule* rules, sint32_t count )
+{
+  struct {
+    struct nlmsghdr h;
+    struct fib_rule_hdr frh;
+  } req;
+  tNetlinkRules want;
+  sint32_t i;
+  int error;
+
+  memset( &req, 0, sizeof(req) );
+  req.h.nlmsg_len = NLMSG_LENGTH(sizeof(struct fib_rule_hdr));
+  req.h.nlmsg_type = RTM_GETRULE;
+  req.h.nlmsg_flags = NLM_F_DUMP;
+  req.frh.family = AF_INET6;
+
+  want.rules = rules;
+  want.count = count;
+  want.table = table;
+  want.priority = priority;
+
+  error = nlQuery( b, &req.h, "listing rules", nlRuleHandler, &want );
+  if( error != 0 )
+  {
+    if( error > 0 )
+      Display( LOG_LEVEL_1, ELError, "nlSyncRules", GOGO_STR_NETLINK_REQUEST_FAILED, "listing rules", strerror(error) );
+    return -1;
+  }
+
+  for( i = 0; i < count; i++ )
+  {
+    if( !rules[i].found )
+      nlRule( b, RTM_NEWRULE, table, priority, &rules[i].src, rules[i].srclen, rules[i].fwmark,
+              rules[i].what, 1 );
+  }
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Returns the tunnel interface for the tunnel mode, or NULL if the mode is
+// not supported.
+//
+static const char* nlTunnelInterface( const tConf* c, const tTunnel* t )
+{
+  if( pal_strcasecmp(t->type, STR_XML_TUNNELMODE_V6V4) == 0 )
+    return c->if_tunnel_v6v4;
+  if( pal_strcasecmp(t->type, STR_XML_TUNNELMODE_V6UDPV4) == 0 )
+    return c->if_tunnel_v6udpv4;
+
+  Display( LOG_LEVEL_1, ELError, "nlTunnelInterface", GOGO_STR_NO_V4V6_ON_PLATFORM );
+  return NULL;
+}
+
+// --------------------------------------------------------------------------
+// Returns the routing table of the tunnel routes, and the rules that select
+// it in 'rules', if it is not the main table.
+//
+static uint32_t nlTunnelTable( const tConf* c, const struct in6_addr* client,
+                               const struct in6_addr* prefix, sint32_t plen,
+                               tNetlinkRule* rules, sint32_t* nrules )
+{
+  *nrules = 0;
+  if( c->route_table <= 0 )
+    return RT_TABLE_MAIN;
+
+  memset( rules, 0, NETLINK_RULES_MAX * sizeof(tNetlinkRule) );
+  if( c->route_fwmark > 0 )
+  {
+    rules[0].fwmark = (uint32_t)c->route_fwmark;
+    rules[0].what = "adding fwmark rule";
+    *nrules = 1;
+  }
+  else
+  {
+    memcpy( &rules[0].src, client, sizeof(struct in6_addr) );
+    rules[0].srclen = 128;
+    rules[0].what = "adding tunnel address rule";
+    *nrules = 1;
+    if( prefix != NULL )
+    {
+      memcpy( &rules[1].src, prefix, sizeof(struct in6_addr) );
+      rules[1].srclen = plen;
+      rules[1].what = "adding delegated prefix rule";
+      *nrules = 2;
+    }
+  }
+
+  return (uint32_t)c->route_table;
+}
+
+// --------------------------------------------------------------------------
+// Parses the delegated prefix. Also returns the <prefix>::1/64 address that
+// goes on the advertising interface.
+//
+static sint32_t nlDelegatedPrefix( const tTunnel* t, struct in6_addr* prefix, sint32_t* plen,
+                                   struct in6_addr* router )
+{
+  sint32_t i;
+
+  *plen = atoi( t->prefix_length );
+  if( inet_pton( AF_INET6, t->prefix, prefix ) != 1 || *plen < 0 || *plen > 128 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlDelegatedPrefix", GOGO_STR_NETLINK_BAD_ADDRESS, t->prefix );
+    return -1;
+  }
+
+  // Clear the bits past the prefix length.
+  for( i = 0; i < 16; i++ )
+  {
+    if( *plen <= i * 8 )
+      prefix->s6_addr[i] = 0;
+    else if( *plen < (i + 1) * 8 )
+      prefix->s6_addr[i] &= (uint8_t)(0xFF << ((i + 1) * 8 - *plen));
+  }
+
+  memcpy( router, prefix, sizeof(struct in6_addr) );
+  memset( &router->s6_addr[8], 0, 8 );
+  router->s6_addr[15] = 1;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Sets a sysctl, unless it already has that value.
+//
+static sint32_t nlSetSysctl( const char* path, const char* value )
+{
+  char current[64];
+  FILE* f;
+
+  f = fopen( path, "r" );
+  if( f != NULL )
+  {
+    if( fgets( current, sizeof(current), f ) != NULL &&
+        strncmp( current, value, pal_strlen(value) ) == 0 &&
+        (current[pal_strlen(value)] == '\n' || current[pal_strlen(value)] == '\0') )
+    {
+      fclose( f );
+      return 0;
+    }
+    fclose( f );
+  }
+
+  f = fopen( path, "w" );
+  if( f == NULL || fputs( value, f ) < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlSetSysctl", GOGO_STR_NETLINK_CANT_SET_SYSCTL, path, strerror(errno) );
+    if( f != NULL )
+      fclose( f );
+    return -1;
+  }
+
+  if( fclose( f ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlSetSysctl", GOGO_STR_NETLINK_CANT_SET_SYSCTL, path, strerror(errno) );
+    return -1;
+  }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Returns 1 if the tunnel has a delegated prefix to advertise, and parses it.
+//
+static sint32_t nlRouterMode( const tConf* c, const tTunnel* t, struct in6_addr* prefix,
+                              sint32_t* plen, struct in6_addr* router )
+{
+  return pal_strcasecmp( c->host_type, "router" ) == 0 &&
+         t->prefix != NULL && t->prefix_length != NULL &&
+         nlDelegatedPrefix( t, prefix, plen, router ) == 0;
+}
+
+// --------------------------------------------------------------------------
+// Brings the sit device of a v6v4 tunnel to the server. A sit device that
+// already exists is moved to the new server, instead of being recreated.
+//
+static sint32_t nlSyncSit( tNetlinkBatch* b, const char* ifname, const struct in_addr* server,
+                           tNetlinkLink* link )
+{
+  int error;
+
+  if( nlGetLink( b, ifname, link ) != 0 )
+    return -1;
+
+  // Something else than a sit device has the name.
+  if( link->index != 0 && link->kind[0] != '\0' && strcmp( link->kind, "sit" ) != 0 )
+  {
+    nlLinkDel( b, ifname, "deleting tunnel", 1 );
+    if( nlCommit( b ) != 0 )
+      return -1;
+    link->index = 0;
+  }
+
+  // Kernels without netlink support for sit devices do not report the
+  // endpoint.
+  if( link->index != 0 && !link->has_remote &&
+      nlSitIoctl( NETLINK_SIOCGETTUNNEL, ifname, &link->remote ) == 0 )
+  {
+    link->has_remote = 1;
+  }
+
+  if( link->index != 0 && link->has_remote &&
+      memcmp( &link->remote, server, sizeof(struct in_addr) ) == 0 )
+  {
+    return 0;
+  }
+
+  nlSit( b, link->index, ifname, server, link->index == 0 ? "creating tunnel" : "moving tunnel", 0 );
+  if( nlCommit( b ) != 0 )
+    return -1;
+
+  error = b->error[0];
+  if( error == EOPNOTSUPP || error == EINVAL )
+  {
+    error = nlSitIoctl( link->index == 0 ? NETLINK_SIOCADDTUNNEL : NETLINK_SIOCCHGTUNNEL,
+                        ifname, (struct in_addr*)server );
+  }
+  if( error != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "nlSyncSit", GOGO_STR_NETLINK_REQUEST_FAILED,
+             link->index == 0 ? "creating tunnel" : "moving tunnel", strerror(error) );
+    return -1;
+  }
+
+  return nlGetLink( b, ifname, link );
+}
+
+
+// --------------------------------------------------------------------------
+// Configures the tunnel interface, its routes and, in router mode, the
+// delegated prefix. This is the netlink counterpart of running the linux
+// template script with TSP_OPERATION=TSP_TUNNEL_CREATION.
+//
+// The configuration is reconciled with what is already there: the state of
+// the interface, its addresses and routes are read from the kernel, and
+// only what differs is changed. 'previous' is the tunnel left configured
+// by the last connection, if any; what it configured that this tunnel does
+// not need is removed.
+//
+gogoc_status tspNetlinkSetupInterface( tConf *c, tTunnel *t, const tTunnel *previous )
+{
+  gogoc_status status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  tNetlinkBatch batch;
+  tNetlinkLink link;
+  tNetlinkRoute routes[5];
+  tNetlinkRule rules[NETLINK_RULES_MAX];
+  struct in6_addr client, prefix, router, old_prefix, old_router;
+  struct in_addr server;
+  const char* ifname;
+  sint32_t router_mode, old_router_mode = 0, plen = 0, old_plen = 0, nroutes, nrules, mtu;
+  uint32_t table;
+  int home_index = 0, lo_index = 0, index;
+
+
+  ifname = nlTunnelInterface( c, t );
+  if( ifname == NULL )
+    return status;
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_SETUP, ifname );
+
+  if( inet_pton( AF_INET6, t->client_address_ipv6, &client ) != 1 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_BAD_ADDRESS, t->client_address_ipv6 );
+    return status;
+  }
+
+  // A tunnel of another mode used another interface: remove it all.
+  if( previous != NULL && pal_strcasecmp( previous->type, t->type ) != 0 )
+  {
+    tspNetlinkTearDownTunnel( c, (tTunnel*)previous );
+    previous = NULL;
+  }
+
+  // Router mode needs a delegated prefix, and the interface to put it on.
+  router_mode = (pal_strcasecmp( c->host_type, "router" ) == 0 &&
+                 t->prefix != NULL && t->prefix_length != NULL);
+  if( router_mode )
+  {
+    if( nlDelegatedPrefix( t, &prefix, &plen, &router ) != 0 )
+      return status;
+
+    home_index = (int)if_nametoindex( c->if_prefix );
+    lo_index = (int)if_nametoindex( "lo" );
+    if( home_index == 0 )
+    {
+      Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_NO_INTERFACE, c->if_prefix );
+      return status;
+    }
+  }
+  if( previous != NULL )
+    old_router_mode = nlRouterMode( c, previous, &old_prefix, &old_plen, &old_router );
+
+  table = nlTunnelTable( c, &client, router_mode ? &prefix : NULL, plen, rules, &nrules );
+
+  if( nlOpen( &batch ) != 0 )
+    return status;
+
+  // In v6v4 mode, the sit device to the server.
+  if( pal_strcasecmp( t->type, STR_XML_TUNNELMODE_V6V4 ) == 0 )
+  {
+    if( inet_pton( AF_INET, t->server_address_ipv4, &server ) != 1 )
+    {
+      Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_BAD_ADDRESS, t->server_address_ipv4 );
+      goto done;
+    }
+
+    if( nlSyncSit( &batch, ifname, &server, &link ) != 0 )
+      goto done;
+  }
+  else if( nlGetLink( &batch, ifname, &link ) != 0 )
+  {
+    goto done;
+  }
+
+  if( link.index == 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_NO_INTERFACE, ifname );
+    goto done;
+  }
+
+  // Tunnel interface: link, address and routes. The MTU is the one found
+  // for the path to this server, if it was searched already.
+  mtu = tspPmtuTunnelMtu( t );
+  if( (link.flags & IFF_UP) == 0 || link.mtu != (uint32_t)mtu )
+    nlLinkSet( &batch, link.index, 1, mtu, "setting link up", 1 );
+  if( nlSyncAddr( &batch, link.index, &client, 128, 1, "adding tunnel address" ) != 0 )
+    goto done;
+
+  memset( routes, 0, sizeof(routes) );
+  routes[0].table = table;
+  routes[0].ifindex = link.index;
+  routes[0].exclusive = 1;
+  routes[0].what = "adding default route";
+  routes[1].table = table;
+  routes[1].dst.s6_addr[0] = 0x20;
+  routes[1].plen = 3;
+  routes[1].ifindex = link.index;
+  routes[1].exclusive = 1;
+  routes[1].what = "adding 2000::/3 route";
+  nroutes = 2;
+
+  // Delegated prefix: blackhole it when it is not a /64, and put
+  // <prefix>::1/64 on the advertising interface. In a table of its own,
+  // the tunnel also needs both routes there, or the rule on the prefix
+  // would send the traffic to the advertising interface in the tunnel.
+  if( router_mode )
+  {
+    if( nlSetSysctl( NETLINK_SYSCTL_FORWARDING, "1" ) != 0 )
+      goto done;
+
+    if( plen != 64 && lo_index != 0 )
+    {
+      routes[nroutes].table = RT_TABLE_MAIN;
+      memcpy( &routes[nroutes].dst, &prefix, sizeof(prefix) );
+      routes[nroutes].plen = plen;
+      routes[nroutes].ifindex = lo_index;
+      routes[nroutes].what = "blackholing delegated prefix";
+      nroutes++;
+      if( table != RT_TABLE_MAIN )
+      {
+        routes[nroutes] = routes[nroutes - 1];
+        routes[nroutes].table = table;
+        nroutes++;
+      }
+    }
+    if( table != RT_TABLE_MAIN )
+    {
+      routes[nroutes].table = table;
+      memcpy( &routes[nroutes].dst, &router, 8 );
+      routes[nroutes].plen = 64;
+      routes[nroutes].ifindex = home_index;
+      routes[nroutes].what = "adding delegated prefix route";
+      nroutes++;
+    }
+    if( nlSyncAddr( &batch, home_index, &router, 64, 0, "adding delegated prefix" ) != 0 )
+      goto done;
+  }
+
+  // The rules last: the routes of the table are there when they apply.
+  if( nlSyncRoutes( &batch, routes, nroutes, table != RT_TABLE_MAIN ? table : 0,
+                    NETLINK_ROUTE_METRIC ) != 0 )
+    goto done;
+  if( table != RT_TABLE_MAIN &&
+      nlSyncRules( &batch, table, NETLINK_RULE_PRIORITY, rules, nrules ) != 0 )
+    goto done;
+
+  // What the last tunnel delegated, and this one does not.
+  if( old_router_mode &&
+      (!router_mode || plen != old_plen || memcmp( &prefix, &old_prefix, sizeof(prefix) ) != 0) )
+  {
+    if( (index = (int)if_nametoindex( c->if_prefix )) != 0 )
+      nlAddr( &batch, RTM_DELADDR, index, &old_router, 64, "removing old delegated prefix", 0 );
+    if( old_plen != 64 && (index = (int)if_nametoindex( "lo" )) != 0 )
+      nlRoute( &batch, RTM_DELROUTE, RT_TABLE_MAIN, index, &old_prefix, old_plen,
+               NETLINK_ROUTE_METRIC, "removing old delegated prefix blackhole", 0 );
+  }
+
+  if( nlCommit( &batch ) != 0 )
+    goto done;
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_RECONCILED, ifname, batch.total );
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkSetupInterface", GOGO_STR_NETLINK_SETUP_DONE, ifname );
+  status = STATUS_SUCCESS_INIT;
+
+done:
+  nlClose( &batch );
+  return status;
+}
+
+
+// --------------------------------------------------------------------------
+// Removes what tspNetlinkSetupInterface configured. Failures are ignored,
+// as some of it may already be gone.
+//
+gogoc_status tspNetlinkTearDownTunnel( tConf *c, tTunnel *t )
+{
+  tNetlinkBatch batch;
+  struct in6_addr client, any, global, prefix, router;
+  const char* ifname;
+  sint32_t plen = 0;
+  int ifindex, index;
+
+
+  ifname = nlTunnelInterface( c, t );
+  if( ifname == NULL )
+    return make_status(CTX_GOGOCTEARDOWN, ERR_INTERFACE_SETUP_FAILED);
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkTearDownTunnel", GOGO_STR_NETLINK_TEARDOWN, ifname );
+
+  // Before nlOpen: the thread may be waiting for the socket.
+  tspPmtuStop();
+
+  if( nlOpen( &batch ) != 0 )
+    return make_status(CTX_GOGOCTEARDOWN, ERR_INTERFACE_SETUP_FAILED);
+
+  memset( &any, 0, sizeof(any) );
+  memset( &global, 0, sizeof(global) );
+  global.s6_addr[0] = 0x20;
+  ifindex = (int)if_nametoindex( ifname );
+
+  // In a table of its own, the tunnel is first switched off by removing
+  // the rules, then the table is emptied.
+  if( c->route_table > 0 )
+  {
+    nlSyncRules( &batch, (uint32_t)c->route_table, NETLINK_RULE_PRIORITY, NULL, 0 );
+    nlSyncRoutes( &batch, NULL, 0, (uint32_t)c->route_table, NETLINK_ROUTE_METRIC );
+  }
+  else
+  {
+    nlRoute( &batch, RTM_DELROUTE, RT_TABLE_MAIN, ifindex, &any, 0, NETLINK_ROUTE_METRIC,
+             "deleting default route", 0 );
+    nlRoute( &batch, RTM_DELROUTE, RT_TABLE_MAIN, ifindex, &global, 3, NETLINK_ROUTE_METRIC,
+             "deleting 2000::/3 route", 0 );
+  }
+
+  if( nlRouterMode( c, t, &prefix, &plen, &router ) )
+  {
+    tspRtAdvStop();
+
+    if( (index = (int)if_nametoindex( c->if_prefix )) != 0 )
+      nlAddr( &batch, RTM_DELADDR, index, &router, 64, "removing delegated prefix", 0 );
+    if( plen != 64 && (index = (int)if_nametoindex( "lo" )) != 0 )
+      nlRoute( &batch, RTM_DELROUTE, RT_TABLE_MAIN, index, &prefix, plen,
+               NETLINK_ROUTE_METRIC, "removing delegated prefix blackhole", 0 );
+  }
+
+  if( pal_strcasecmp( t->type, STR_XML_TUNNELMODE_V6V4 ) == 0 )
+  {
+    nlLinkDel( &batch, ifname, "deleting tunnel", 0 );
+  }
+  else if( ifindex != 0 )
+  {
+    // The tunnel address, and whatever else was put on the interface.
+    if( nlFlushAddrs( &batch, ifindex ) != 0 &&
+        inet_pton( AF_INET6, t->client_address_ipv6, &client ) == 1 )
+      nlAddr( &batch, RTM_DELADDR, ifindex, &client, 128, "removing tunnel address", 0 );
+    nlLinkSet( &batch, ifindex, 0, 0, "setting link down", 0 );
+  }
+
+  nlCommit( &batch );
+  nlClose( &batch );
+
+  // A tun device kept from the last connection goes with its interface.
+  if( pal_strcasecmp( t->type, STR_XML_TUNNELMODE_V6UDPV4 ) == 0 )
+    TunRelease( ifname );
+
+  return STATUS_SUCCESS_INIT;
+}
+
+
+// --------------------------------------------------------------------------
+// Configures the interface of the standby tunnel (tsp_standby.h) on
+// if_tunnel_standby: a v6v4 tunnel in host mode, whose routes have the
+// metric NETLINK_STANDBY_METRIC and its rules the priority
+// NETLINK_STANDBY_RULE_PRIORITY. They only carry traffic once the routes of
+// the active tunnel are gone. The echo address of the server is routed
+// through the standby tunnel, so that its keepalives do not take the
+// active one.
+//
+gogoc_status tspNetlinkSetupStandby( tConf *c, tTunnel *t )
+{
+  gogoc_status status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  tNetlinkBatch batch;
+  tNetlinkLink link;
+  tNetlinkRoute routes[4];
+  tNetlinkRule rules[NETLINK_RULES_MAX];
+  struct in6_addr client, echo;
+  struct in_addr server;
+  const char* ifname = c->if_tunnel_standby;
+  const char* echo_address;
+  sint32_t nroutes, nrules;
+  uint32_t table;
+
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkSetupStandby", GOGO_STR_NETLINK_SETUP, ifname );
+
+  echo_address = t->keepalive_address != NULL ? t->keepalive_address : t->server_address_ipv6;
+  if( inet_pton( AF_INET6, t->client_address_ipv6, &client ) != 1 ||
+      echo_address == NULL || inet_pton( AF_INET6, echo_address, &echo ) != 1 ||
+      inet_pton( AF_INET, t->server_address_ipv4, &server ) != 1 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupStandby", GOGO_STR_NETLINK_BAD_ADDRESS, t->client_address_ipv6 );
+    return status;
+  }
+
+  table = nlTunnelTable( c, &client, NULL, 0, rules, &nrules );
+
+  if( nlOpen( &batch ) != 0 )
+    return status;
+
+  if( nlSyncSit( &batch, ifname, &server, &link ) != 0 )
+    goto done;
+  if( link.index == 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspNetlinkSetupStandby", GOGO_STR_NETLINK_NO_INTERFACE, ifname );
+    goto done;
+  }
+
+  // The path MTU is only searched for the active tunnel.
+  if( (link.flags & IFF_UP) == 0 || link.mtu != PMTU_MIN_TUNNEL )
+    nlLinkSet( &batch, link.index, 1, PMTU_MIN_TUNNEL, "setting link up", 1 );
+  if( nlSyncAddr( &batch, link.index, &client, 128, 1, "adding tunnel address" ) != 0 )
+    goto done;
+
+  // Next to the routes of the active tunnel, not in place of them.
+  memset( routes, 0, sizeof(routes) );
+  routes[0].table = table;
+  routes[0].ifindex = link.index;
+  routes[0].what = "adding standby default route";
+  routes[1].table = table;
+  routes[1].dst.s6_addr[0] = 0x20;
+  routes[1].plen = 3;
+  routes[1].ifindex = link.index;
+  routes[1].what = "adding standby 2000::/3 route";
+  routes[2].table = RT_TABLE_MAIN;
+  memcpy( &routes[2].dst, &echo, sizeof(echo) );
+  routes[2].plen = 128;
+  routes[2].ifindex = link.index;
+  routes[2].what = "adding standby echo route";
+  nroutes = 3;
+  if( table != RT_TABLE_MAIN )
+  {
+    routes[nroutes] = routes[2];
+    routes[nroutes].table = table;
+    nroutes++;
+  }
+
+  if( nlSyncRoutes( &batch, routes, nroutes, table != RT_TABLE_MAIN ? table : 0,
+                    NETLINK_STANDBY_METRIC ) != 0 )
+    goto done;
+  if( table != RT_TABLE_MAIN &&
+      nlSyncRules( &batch, table, NETLINK_STANDBY_RULE_PRIORITY, rules, nrules ) != 0 )
+    goto done;
+
+  if( nlCommit( &batch ) != 0 )
+    goto done;
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkSetupStandby", GOGO_STR_NETLINK_RECONCILED, ifname, batch.total );
+  status = STATUS_SUCCESS_INIT;
+
+done:
+  nlClose( &batch );
+  return status;
+}
+
+
+// --------------------------------------------------------------------------
+// Removes what tspNetlinkSetupStandby configured. The routes in the main
+// table go with the sit device.
+//
+gogoc_status tspNetlinkTearDownStandby( tConf *c )
+{
+  tNetlinkBatch batch;
+
+
+  Display( LOG_LEVEL_2, ELInfo, "tspNetlinkTearDownStandby", GOGO_STR_NETLINK_TEARDOWN, c->if_tunnel_standby );
+
+  if( nlOpen( &batch ) != 0 )
+    return make_status(CTX_GOGOCTEARDOWN, ERR_INTERFACE_SETUP_FAILED);
+
+  if( c->route_table > 0 )
+  {
+    nlSyncRules( &batch, (uint32_t)c->route_table, NETLINK_STANDBY_RULE_PRIORITY, NULL, 0 );
+    nlSyncRoutes( &batch, NULL, 0, (uint32_t)c->route_table, NETLINK_STANDBY_METRIC );
+  }
+  nlLinkDel( &batch, c->if_tunnel_standby, "deleting tunnel", 0 );
+
+  nlCommit( &batch );
+  nlClose( &batch );
+
+  return STATUS_SUCCESS_INIT;
+}
+
+
+// --------------------------------------------------------------------------
+// Advertises the /64 of the delegated prefix on if_prefix, or stops the
+// advertisements when the tunnel has no prefix. The advertisements are
+// sent by a thread of the calling process, which must be the one that
+// lives as long as the tunnel.
+//
+gogoc_status tspNetlinkAdvertise( tConf *c, tTunnel *t )
+{
+  struct in6_addr prefix, router;
+  sint32_t plen;
+
+  if( !nlRouterMode( c, t, &prefix, &plen, &router ) )
+  {
+    tspRtAdvStop();
+    return STATUS_SUCCESS_INIT;
+  }
+
+  // The /64 advertised is the one of the <prefix>::1 address.
+  router.s6_addr[15] = 0;
+
+  return tspRtAdvStart( c->if_prefix, &router, c->ra_min_interval, c->ra_max_interval,
+                        tspPmtuTunnelMtu( t ) );
+}
+
+
+// --------------------------------------------------------------------------
+// Changes the MTU of an interface, once the path MTU is known.
+//
+gogoc_status tspNetlinkSetMtu( const char *ifname, sint32_t mtu )
+{
+  gogoc_status status = make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  tNetlinkBatch batch;
+  tNetlinkLink link;
+
+
+  if( nlOpen( &batch ) != 0 )
+    return status;
+
+  if( nlGetLink( &batch, ifname, &link ) == 0 && link.index != 0 )
+  {
+    if( link.mtu != (uint32_t)mtu )
+      nlLinkSet( &batch, link.index, (link.flags & IFF_UP) != 0, mtu, "setting MTU", 1 );
+    if( nlCommit( &batch ) == 0 )
+      status = STATUS_SUCCESS_INIT;
+  }
+
+  nlClose( &batch );
+  return status;
+}
@@ -0,0 +1,58 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef TSP_NETLINK_H
+#define TSP_NETLINK_H
+
+#include "config.h"
+#include "xml_tun.h"
+
+/*
+ * Tunnel interface configuration through rtnetlink.
+ *
+ * This does what the linux template script does, without running any
+ * external command: the interface (and the sit device in v6v4 mode), its
+ * address, MTU (tsp_pmtu.h), the default and 2000::/3 routes and, in router mode, the
+ * forwarding sysctl and the delegated prefix on if_prefix, which
+ * tspNetlinkAdvertise then advertises with the in-process router
+ * advertisement sender (tsp_rtadv.h). The requests are
+ * sent to the kernel in batches, and all acknowledgements read back at once.
+ *
+ * The setup is differential: the current state is read from the kernel,
+ * and only what differs from the tunnel given by the broker is changed. A
+ * reconnection that gets the same tunnel back changes nothing, and one
+ * that gets another server only moves the sit device to it.
+ *
+ * With route_table set, the tunnel routes go in that table, and rules of
+ * priority NETLINK_RULE_PRIORITY select the traffic that uses it: by
+ * fwmark, or by source address. The tunnel is then switched on and off
+ * next to native IPv6 by adding and removing the rules.
+ *
+ * A standby tunnel (tsp_standby.h) has routes of a higher metric, and
+ * rules of a lower priority, than the active tunnel: the active tunnel
+ * leaves them alone, and they take over as soon as it is torn down.
+ */
+
+#define NETLINK_BATCH_SIZE        4096    /* Bytes of requests per batch */
+#define NETLINK_BATCH_MAX         32      /* Requests per batch */
+#define NETLINK_REPLY_TIMEOUT     2       /* Seconds to wait for the acknowledgements */
+
+#define NETLINK_TUNNEL_TTL        64
+#define NETLINK_ROUTE_METRIC      1
+#define NETLINK_RULE_PRIORITY     30000
+#define NETLINK_STANDBY_METRIC    2
+#define NETLINK_STANDBY_RULE_PRIORITY 30001
+#define NETLINK_RULES_MAX         2       /* Source rules: tunnel address and delegated prefix */
+
+gogoc_status        tspNetlinkSetupInterface  ( tConf *c, tTunnel *t, const tTunnel *previous );
+gogoc_status        tspNetlinkTearDownTunnel  ( tConf *c, tTunnel *t );
+gogoc_status        tspNetlinkAdvertise       ( tConf *c, tTunnel *t );
+gogoc_status        tspNetlinkSetMtu          ( const char *ifname, sint32_t mtu );
+gogoc_status        tspNetlinkSetupStandby    ( tConf *c, tTunnel *t );
+gogoc_status        tspNetlinkTearDownStandby ( tConf *c );
+
+#endif /* TSP_NETLINK_H */
@@ -0,0 +1,553 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include <net/if.h>
+#include <fcntl.h>
+
+#include "tsp_pmtu.h"
+#include "tsp_netlink.h"    // tspNetlinkSetMtu()
+#include "tsp_rtadv.h"      // tspRtAdvSetMtu()
+#include "net_cksm.h"       // in_cksum()
+#include "log.h"            // Display
+#include "hex_strings.h"    // Various string constants
+
+
+// Older C libraries lack these.
+#ifndef IP_MTU_DISCOVER
+#define IP_MTU_DISCOVER           10
+#endif
+#ifndef IP_PMTUDISC_PROBE
+#define IP_PMTUDISC_PROBE         3       /* Set DF, ignore the cached path MTU */
+#endif
+#ifndef IP_MTU
+#define IP_MTU                    14
+#endif
+#ifndef SOCK_CLOEXEC
+#define SOCK_CLOEXEC              O_CLOEXEC
+#endif
+
+#define PMTU_ICMP_ECHO_REPLY      0
+#define PMTU_ICMP_UNREACH         3
+#define PMTU_ICMP_NEEDFRAG        4       /* Code of PMTU_ICMP_UNREACH */
+#define PMTU_ICMP_ECHO            8
+#define PMTU_ICMP_HEADER          8
+#define PMTU_MIN_NEXT_HOP         68      /* Smallest IPv4 MTU */
+
+// What pmtuRead found.
+#define PMTU_READ_NONE            0
+#define PMTU_READ_REPLY           1
+#define PMTU_READ_TOO_BIG         2
+
+
+// --------------------------------------------------------------------------
+// State of the prober, shared between the thread and its callers.
+//
+typedef struct stPmtu
+{
+  pal_thread_t      thread;
+  sint32_t          running;            // The thread was started.
+  int               fd;                 // Raw ICMP socket.
+  int               wake[2];            // Pipe to wake the thread up.
+  uint16_t          id;                 // ICMP echo identifier.
+  uint16_t          seq;                // Last ICMP echo sequence number.
+  pal_cs_t          lock;               // Protects what follows.
+
+  char              ifname[IFNAMSIZ];
+  struct in_addr    server;
+  sint32_t          overhead;           // Encapsulation headers, bytes.
+  sint32_t          path_mtu;           // Last path MTU found, 0 until then.
+  sint32_t          probe_now;          // Search the path MTU again.
+  sint32_t          hint;               // Next hop MTU reported by a router, or 0.
+  sint32_t          stop;
+} tPmtu;
+
+static tPmtu        pmtu;
+static sint32_t     pmtu_initialized = 0;
+
+
+// --------------------------------------------------------------------------
+// Bytes of encapsulation headers of the tunnel mode, or 0 if the path MTU
+// is not discovered for it.
+//
+static sint32_t pmtuOverhead( const char* type )
+{
+  if( pal_strcasecmp( type, STR_XML_TUNNELMODE_V6V4 ) == 0 )
+    return PMTU_OVERHEAD_V6V4;
+  if( pal_strcasecmp( type, STR_XML_TUNNELMODE_V6UDPV4 ) == 0 )
+    return PMTU_OVERHEAD_V6UDPV4;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+static sint32_t pmtuStopping( void )
+{
+  sint32_t stop;
+
+  pal_enter_cs( &pmtu.lock );
+  stop = pmtu.stop;
+  pal_leave_cs( &pmtu.lock );
+
+  return stop;
+}
+
+// --------------------------------------------------------------------------
+// Called with the lock held, so that the pipe cannot be closed meanwhile.
+//
+static void pmtuWake( void )
+{
+  char c = 0;
+
+  // The write end does not block: if the pipe is full, the write fails and
+  // the thread has a wake up pending anyway.
+  if( write( pmtu.wake[1], &c, 1 ) < 0 )
+    return;
+}
+
+// --------------------------------------------------------------------------
+// Sends an ICMP echo request of 'size' bytes, IPv4 header included, with
+// the DF bit set. Returns 0, or the errno of the failure: EMSGSIZE when
+// 'size' is larger than the MTU of the outgoing interface.
+//
+static int pmtuSend( sint32_t size )
+{
+  uint8_t buf[PMTU_MAX_PATH];
+  struct sockaddr_in dst;
+  size_t len = size - sizeof(struct iphdr);
+  uint16_t sum;
+
+  pmtu.seq++;
+  memset( buf, 0, len );
+  buf[0] = PMTU_ICMP_ECHO;
+  buf[4] = (uint8_t)(pmtu.id >> 8);
+  buf[5] = (uint8_t)pmtu.id;
+  buf[6] = (uint8_t)(pmtu.seq >> 8);
+  buf[7] = (uint8_t)pmtu.seq;
+  sum = in_cksum( (uint16_t*)buf, (sint32_t)len );
+  memcpy( buf + 2, &sum, sizeof(sum) );
+
+  memset( &dst, 0, sizeof(dst) );
+  dst.sin_family = AF_INET;
+  dst.sin_addr = pmtu.server;
+
+  if( sendto( pmtu.fd, buf, len, 0, (struct sockaddr*)&dst, sizeof(dst) ) < 0 )
+    return errno;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Reads a packet from the raw socket. Returns PMTU_READ_REPLY if it is the
+// reply to the last probe, PMTU_READ_TOO_BIG with the next hop MTU if a
+// router could not forward a packet to the server without fragmenting it.
+//
+static sint32_t pmtuRead( sint32_t* nexthop )
+{
+  uint8_t buf[PMTU_MAX_PATH + 64];
+  const struct iphdr *ip, *inner;
+  const uint8_t* icmp;
+  size_t hl;
+  ssize_t n;
+
+  n = recv( pmtu.fd, buf, sizeof(buf), 0 );
+  if( n < (ssize_t)sizeof(struct iphdr) )
+    return PMTU_READ_NONE;
+
+  ip = (const struct iphdr*)buf;
+  hl = ip->ihl * 4;
+  if( (size_t)n < hl + PMTU_ICMP_HEADER )
+    return PMTU_READ_NONE;
+  icmp = buf + hl;
+
+  if( icmp[0] == PMTU_ICMP_ECHO_REPLY && ip->saddr == pmtu.server.s_addr &&
+      ((icmp[4] << 8) | icmp[5]) == pmtu.id && ((icmp[6] << 8) | icmp[7]) == pmtu.seq )
+  {
+    return PMTU_READ_REPLY;
+  }
+
+  if( icmp[0] == PMTU_ICMP_UNREACH && icmp[1] == PMTU_ICMP_NEEDFRAG &&
+      (size_t)n >= hl + PMTU_ICMP_HEADER + sizeof(struct iphdr) )
+  {
+    inner = (const struct iphdr*)(icmp + PMTU_ICMP_HEADER);
+    if( inner->daddr == pmtu.server.s_addr )
+    {
+      *nexthop = (icmp[6] << 8) | icmp[7];
+      return PMTU_READ_TOO_BIG;
+    }
+  }
+
+  return PMTU_READ_NONE;
+}
+
+// --------------------------------------------------------------------------
+// Returns 1 if an echo request of 'size' bytes is answered by the server.
+// '*hi' is lowered when a router reports a smaller next hop MTU.
+//
+static sint32_t pmtuProbe( sint32_t size, sint32_t* hi )
+{
+  struct timespec start, now;
+  struct timeval tv;
+  fd_set fds;
+  sint32_t tries, left, nexthop = 0;
+  char drain[16];
+
+  for( tries = 0; tries < PMTU_PROBE_TRIES; tries++ )
+  {
+    if( pmtuSend( size ) != 0 )
+      return 0;
+
+    pal_gettime_monotonic( &start );
+    while( 1 )
+    {
+      pal_gettime_monotonic( &now );
+      left = PMTU_PROBE_TIMEOUT - (sint32_t)((now.tv_sec - start.tv_sec) * 1000 +
+                                             (now.tv_nsec - start.tv_nsec) / 1000000);
+      if( left <= 0 )
+        break;
+
+      FD_ZERO( &fds );
+      FD_SET( pmtu.fd, &fds );
+      FD_SET( pmtu.wake[0], &fds );
+      tv.tv_sec = left / 1000;
+      tv.tv_usec = (left % 1000) * 1000;
+      if( select( (pmtu.fd > pmtu.wake[0] ? pmtu.fd : pmtu.wake[0]) + 1, &fds, NULL, NULL, &tv ) <= 0 )
+        continue;
+
+      if( FD_ISSET( pmtu.wake[0], &fds ) && read( pmtu.wake[0], drain, sizeof(drain) ) > 0 &&
+          pmtuStopping() )
+        return 0;
+
+      if( !FD_ISSET( pmtu.fd, &fds ) )
+        continue;
+
+      switch( pmtuRead( &nexthop ) )
+      {
+      case PMTU_READ_REPLY:
+        return 1;
+
+      case PMTU_READ_TOO_BIG:
+        if( nexthop >= PMTU_MIN_NEXT_HOP && nexthop < *hi )
+          *hi = nexthop;
+        if( nexthop < size )
+          return 0;
+        break;
+      }
+    }
+  }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Returns the MTU of the route to the server, or PMTU_MAX_PATH if it
+// cannot be read.
+//
+static sint32_t pmtuRouteMtu( void )
+{
+  struct sockaddr_in dst;
+  socklen_t len = sizeof(int);
+  int fd, mtu = PMTU_MAX_PATH;
+
+  // A connected UDP socket is given the route, without sending anything.
+  fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0 );
+  if( fd < 0 )
+    return mtu;
+
+  memset( &dst, 0, sizeof(dst) );
+  dst.sin_family = AF_INET;
+  dst.sin_addr = pmtu.server;
+  dst.sin_port = htons(9);
+  if( connect( fd, (struct sockaddr*)&dst, sizeof(dst) ) != 0 ||
+      getsockopt( fd, IPPROTO_IP, IP_MTU, &mtu, &len ) != 0 )
+    mtu = PMTU_MAX_PATH;
+  close( fd );
+
+  return mtu;
+}
+
+// --------------------------------------------------------------------------
+// Searches the path MTU to the server: the largest size first, which is
+// the common case, then a binary search between the minimum and that.
+// 'hint' is a next hop MTU reported by a router, or 0.
+//
+// Returns the path MTU, or 0 if the search was stopped.
+//
+static sint32_t pmtuSearch( sint32_t hint )
+{
+  sint32_t lo = PMTU_MIN_TUNNEL + pmtu.overhead;
+  sint32_t hi = PMTU_MAX_PATH;
+  sint32_t mtu, mid;
+
+  mtu = pmtuRouteMtu();
+  if( mtu < hi )
+    hi = mtu;
+  if( hint > 0 && hint < hi )
+    hi = hint;
+
+  for( mid = hi; lo < hi; mid = (lo + hi + 1) / 2 )
+  {
+    if( pmtuProbe( mid, &hi ) )
+      lo = mid;
+    else if( hi >= mid )
+      hi = mid - 1;
+
+    if( pmtuStopping() )
+      return 0;
+  }
+
+  return lo;
+}
+
+// --------------------------------------------------------------------------
+// Sets the tunnel interface MTU from the path MTU found.
+//
+static void pmtuApply( sint32_t path_mtu )
+{
+  char ifname[IFNAMSIZ];
+  char server[INET_ADDRSTRLEN];
+  sint32_t mtu, changed;
+
+  pal_enter_cs( &pmtu.lock );
+  changed = (path_mtu != pmtu.path_mtu);
+  pmtu.path_mtu = path_mtu;
+  mtu = path_mtu - pmtu.overhead;
+  strcpy( ifname, pmtu.ifname );
+  pal_leave_cs( &pmtu.lock );
+
+  if( !changed )
+    return;
+
+  inet_ntop( AF_INET, &pmtu.server, server, sizeof(server) );
+  Display( LOG_LEVEL_2, ELInfo, "pmtuApply", GOGO_STR_PMTU_FOUND, server, path_mtu, ifname, mtu );
+
+  tspNetlinkSetMtu( ifname, mtu );
+  tspRtAdvSetMtu( mtu );
+}
+
+// --------------------------------------------------------------------------
+static pal_thread_ret_t PAL_THREAD_CALL pmtuThread( void* arg )
+{
+  char server[INET_ADDRSTRLEN];
+  struct timeval tv;
+  fd_set fds;
+  sint32_t probe, hint, found, nexthop = 0;
+  char drain[16];
+
+  (void)arg;
+
+  inet_ntop( AF_INET, &pmtu.server, server, sizeof(server) );
+
+  while( 1 )
+  {
+    pal_enter_cs( &pmtu.lock );
+    if( pmtu.stop )
+    {
+      pal_leave_cs( &pmtu.lock );
+      break;
+    }
+    probe = pmtu.probe_now;
+    hint = pmtu.hint;
+    pmtu.probe_now = 0;
+    pmtu.hint = 0;
+    pal_leave_cs( &pmtu.lock );
+
+    if( probe )
+    {
+      found = pmtuSearch( hint );
+      if( found > 0 )
+        pmtuApply( found );
+      continue;
+    }
+
+    // Between searches, watch for the routers that cannot forward the
+    // tunnel packets at the current path MTU.
+    FD_ZERO( &fds );
+    FD_SET( pmtu.fd, &fds );
+    FD_SET( pmtu.wake[0], &fds );
+    tv.tv_sec = PMTU_PROBE_TIMEOUT / 1000;
+    tv.tv_usec = 0;
+    if( select( (pmtu.fd > pmtu.wake[0] ? pmtu.fd : pmtu.wake[0]) + 1, &fds, NULL, NULL, &tv ) <= 0 )
+      continue;
+
+    if( FD_ISSET( pmtu.wake[0], &fds ) && read( pmtu.wake[0], drain, sizeof(drain) ) <= 0 )
+      continue;
+
+    if( FD_ISSET( pmtu.fd, &fds ) && pmtuRead( &nexthop ) == PMTU_READ_TOO_BIG )
+    {
+      pal_enter_cs( &pmtu.lock );
+      if( nexthop >= PMTU_MIN_NEXT_HOP && nexthop < pmtu.path_mtu )
+      {
+        Display( LOG_LEVEL_2, ELInfo, "pmtuThread", GOGO_STR_PMTU_TOO_BIG, server, nexthop );
+        pmtu.probe_now = 1;
+        pmtu.hint = nexthop;
+      }
+      pal_leave_cs( &pmtu.lock );
+    }
+  }
+
+  pal_thread_exit( 0 );
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Starts discovering the path MTU to the server of the tunnel. The thread
+// is kept when the tunnel goes to the same server over the same interface,
+// and searches again.
+//
+gogoc_status tspPmtuStart( tConf *c, tTunnel *t )
+{
+  struct in_addr server;
+  const char* ifname;
+  sint32_t overhead;
+  int mode = IP_PMTUDISC_PROBE;
+
+
+  if( !pmtu_initialized )
+  {
+    pal_init_cs( &pmtu.lock );
+    pmtu_initialized = 1;
+  }
+
+  overhead = pmtuOverhead( t->type );
+  if( overhead == 0 )
+  {
+    tspPmtuStop();
+    return STATUS_SUCCESS_INIT;
+  }
+  ifname = (overhead == PMTU_OVERHEAD_V6V4) ? c->if_tunnel_v6v4 : c->if_tunnel_v6udpv4;
+
+  if( inet_pton( AF_INET, t->server_address_ipv4, &server ) != 1 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspPmtuStart", GOGO_STR_NETLINK_BAD_ADDRESS, t->server_address_ipv4 );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+
+  if( pmtu.running && pmtu.server.s_addr == server.s_addr && pmtu.overhead == overhead &&
+      strcmp( pmtu.ifname, ifname ) == 0 )
+  {
+    tspPmtuReprobe();
+    return STATUS_SUCCESS_INIT;
+  }
+  tspPmtuStop();
+
+  if( pal_strlen(ifname) >= IFNAMSIZ )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspPmtuStart", GOGO_STR_NETLINK_NO_INTERFACE, ifname );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+
+  pmtu.fd = socket( AF_INET, SOCK_RAW | SOCK_CLOEXEC, IPPROTO_ICMP );
+  if( pmtu.fd < 0 || setsockopt( pmtu.fd, IPPROTO_IP, IP_MTU_DISCOVER, &mode, sizeof(mode) ) < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspPmtuStart", GOGO_STR_PMTU_CANT_START, strerror(errno) );
+    if( pmtu.fd >= 0 )
+      close( pmtu.fd );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  if( pipe( pmtu.wake ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspPmtuStart", GOGO_STR_PMTU_CANT_START, strerror(errno) );
+    close( pmtu.fd );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  fcntl( pmtu.wake[0], F_SETFD, FD_CLOEXEC );
+  fcntl( pmtu.wake[1], F_SETFD, FD_CLOEXEC );
+  // Wakers write while holding the lock: they must never block.
+  fcntl( pmtu.wake[1], F_SETFL, O_NONBLOCK );
+
+  // Not the keepalive identifier, which is the process id.
+  pmtu.id = (uint16_t)(getpid() ^ 0x5A5A);
+  pmtu.seq = 0;
+  strcpy( pmtu.ifname, ifname );
+  pmtu.server = server;
+  pmtu.overhead = overhead;
+  pmtu.path_mtu = 0;
+  pmtu.probe_now = 1;
+  pmtu.hint = 0;
+  pmtu.stop = 0;
+
+  if( pal_thread_create( &pmtu.thread, &pmtuThread, NULL ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspPmtuStart", GOGO_STR_PMTU_CANT_START, strerror(errno) );
+    close( pmtu.wake[0] );
+    close( pmtu.wake[1] );
+    close( pmtu.fd );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  pal_enter_cs( &pmtu.lock );
+  pmtu.running = 1;
+  pal_leave_cs( &pmtu.lock );
+
+  Display( LOG_LEVEL_2, ELInfo, "tspPmtuStart", GOGO_STR_PMTU_START, t->server_address_ipv4 );
+  return STATUS_SUCCESS_INIT;
+}
+
+// --------------------------------------------------------------------------
+// Returns the MTU to give the interface of the tunnel: the one found for
+// its server, if any, else the minimum.
+//
+sint32_t tspPmtuTunnelMtu( const tTunnel *t )
+{
+  struct in_addr server;
+  sint32_t mtu = PMTU_MIN_TUNNEL;
+
+  if( !pmtu_initialized || inet_pton( AF_INET, t->server_address_ipv4, &server ) != 1 )
+    return mtu;
+
+  pal_enter_cs( &pmtu.lock );
+  if( pmtu.running && pmtu.path_mtu > 0 && pmtu.server.s_addr == server.s_addr &&
+      pmtu.overhead == pmtuOverhead( t->type ) )
+  {
+    mtu = pmtu.path_mtu - pmtu.overhead;
+  }
+  pal_leave_cs( &pmtu.lock );
+
+  return mtu;
+}
+
+// --------------------------------------------------------------------------
+// Searches the path MTU again, from the largest size. Called from the
+// keepalive thread, while the main thread may stop the search.
+//
+void tspPmtuReprobe( void )
+{
+  if( !pmtu_initialized )
+    return;
+
+  pal_enter_cs( &pmtu.lock );
+  if( pmtu.running && !pmtu.stop )
+  {
+    pmtu.probe_now = 1;
+    pmtuWake();
+  }
+  pal_leave_cs( &pmtu.lock );
+}
+
+// --------------------------------------------------------------------------
+void tspPmtuStop( void )
+{
+  if( !pmtu.running )
+    return;
+
+  pal_enter_cs( &pmtu.lock );
+  pmtu.stop = 1;
+  pmtuWake();
+  pal_leave_cs( &pmtu.lock );
+
+  pal_thread_join( pmtu.thread, NULL );
+
+  pal_enter_cs( &pmtu.lock );
+  pmtu.running = 0;
+  pal_leave_cs( &pmtu.lock );
+
+  close( pmtu.wake[0] );
+  close( pmtu.wake[1] );
+  close( pmtu.fd );
+}
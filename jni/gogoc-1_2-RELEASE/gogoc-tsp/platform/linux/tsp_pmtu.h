@@ -0,0 +1,42 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef TSP_PMTU_H
+#define TSP_PMTU_H
+
+#include "config.h"
+#include "xml_tun.h"
+
+/*
+ * Path MTU discovery toward the tunnel server.
+ *
+ * Once the tunnel is up, a thread of the client sends ICMP echo requests
+ * with the DF bit set to the server, and searches the largest one that is
+ * answered: the largest size first, then a binary search. The tunnel
+ * interface MTU is then set to that path MTU less the encapsulation
+ * headers, and the router advertisements carry it.
+ *
+ * The search starts over when an ICMP "fragmentation needed" comes back
+ * for the server, and when keepalive replies are lost (tspPmtuReprobe).
+ * A server that does not answer the probes leaves the tunnel at the
+ * minimum IPv6 MTU.
+ */
+
+#define PMTU_MIN_TUNNEL           1280    /* IPv6 minimum MTU */
+#define PMTU_MAX_PATH             1500    /* Largest path MTU probed, bytes */
+#define PMTU_OVERHEAD_V6V4        20      /* IPv4 header */
+#define PMTU_OVERHEAD_V6UDPV4     28      /* IPv4 and UDP headers */
+#define PMTU_PROBE_TIMEOUT        1000    /* Milliseconds to wait for a probe reply */
+#define PMTU_PROBE_TRIES          2       /* Probes of a size before it is deemed too big */
+#define PMTU_REPROBE_LOSSES       2       /* Consecutive keepalive losses before a new search */
+
+gogoc_status        tspPmtuStart          ( tConf *c, tTunnel *t );
+sint32_t            tspPmtuTunnelMtu      ( const tTunnel *t );
+void                tspPmtuReprobe        ( void );
+void                tspPmtuStop           ( void );
+
+#endif /* TSP_PMTU_H */
@@ -0,0 +1,541 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include <net/if.h>
+#include <fcntl.h>
+
+#include "tsp_rtadv.h"
+#include "log.h"            // Display
+#include "hex_strings.h"    // Various string constants
+
+
+// Older C libraries lack these.
+#ifndef IPV6_ADD_MEMBERSHIP
+#define IPV6_ADD_MEMBERSHIP       IPV6_JOIN_GROUP
+#endif
+#ifndef IPV6_RECVHOPLIMIT
+#define IPV6_RECVHOPLIMIT         51
+#endif
+#ifndef IPV6_HOPLIMIT
+#define IPV6_HOPLIMIT             52
+#endif
+#ifndef SOCK_CLOEXEC
+#define SOCK_CLOEXEC              O_CLOEXEC
+#endif
+
+#define RTADV_ALL_NODES           "ff02::1"
+#define RTADV_ALL_ROUTERS         "ff02::2"
+#define RTADV_ND_HOP_LIMIT        255
+#define RTADV_SOLICIT_SIZE        8       /* Bytes of a router solicitation header */
+
+// The neighbor discovery messages are laid out here, since the Android C
+// library has no <netinet/icmp6.h> (RFC 4861, 4.1, 4.2 and 4.6).
+#define RTADV_ICMP6_FILTER        1       /* Socket option of <linux/icmpv6.h> */
+#define RTADV_TYPE_SOLICIT        133
+#define RTADV_TYPE_ADVERT         134
+#define RTADV_OPT_PREFIX          3
+#define RTADV_OPT_MTU             5
+#define RTADV_PREFIX_ONLINK       0x80
+#define RTADV_PREFIX_AUTO         0x40
+
+typedef struct stRtAdvHeader
+{
+  uint8_t           type;
+  uint8_t           code;
+  uint16_t          checksum;           // Computed by the kernel.
+  uint8_t           hop_limit;
+  uint8_t           flags;
+  uint16_t          router_lifetime;
+  uint32_t          reachable_time;
+  uint32_t          retrans_timer;
+} tRtAdvHeader;
+
+typedef struct stRtAdvMtu
+{
+  uint8_t           type;
+  uint8_t           len;                // In units of 8 bytes.
+  uint16_t          reserved;
+  uint32_t          mtu;
+} tRtAdvMtu;
+
+typedef struct stRtAdvPrefix
+{
+  uint8_t           type;
+  uint8_t           len;                // In units of 8 bytes.
+  uint8_t           prefix_len;
+  uint8_t           flags;
+  uint32_t          valid_time;
+  uint32_t          preferred_time;
+  uint32_t          reserved;
+  struct in6_addr   prefix;
+} tRtAdvPrefix;
+
+// ICMPv6 types the socket passes up: a set bit blocks its type.
+typedef struct stRtAdvFilter
+{
+  uint32_t          data[8];
+} tRtAdvFilter;
+
+
+// --------------------------------------------------------------------------
+// State of the sender, shared between the thread and its callers.
+//
+typedef struct stRtAdv
+{
+  pal_thread_t      thread;
+  sint32_t          running;            // The thread was started.
+  int               fd;                 // ICMPv6 socket.
+  int               wake[2];            // Pipe to wake the thread up.
+  pal_cs_t          lock;               // Protects what follows.
+
+  char              ifname[IFNAMSIZ];
+  int               ifindex;
+  struct in6_addr   prefix;             // Advertised /64.
+  struct in6_addr   old_prefix;         // Replaced /64, being deprecated.
+  sint32_t          old_count;          // Advertisements left for old_prefix.
+  sint32_t          min_interval;
+  sint32_t          max_interval;
+  sint32_t          mtu;
+  sint32_t          initial;            // Advertisements left at the initial rate.
+  sint32_t          send_now;           // Advertise without waiting.
+  sint32_t          stop;
+} tRtAdv;
+
+static tRtAdv       rtadv;
+static sint32_t     rtadv_initialized = 0;
+
+
+// --------------------------------------------------------------------------
+// Milliseconds from 'from' to 'to'.
+//
+static sint32_t rtAdvElapsed( const struct timespec* from, const struct timespec* to )
+{
+  return (sint32_t)((to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000);
+}
+
+// --------------------------------------------------------------------------
+// Milliseconds until the next unsolicited advertisement: a random time
+// between the min and max intervals, shorter for the first ones.
+//
+static sint32_t rtAdvNextDelay( void )
+{
+  sint32_t min = rtadv.min_interval * 1000;
+  sint32_t max = rtadv.max_interval * 1000;
+  sint32_t delay;
+
+  delay = min + (max > min ? rand() % (max - min + 1) : 0);
+  if( rtadv.initial > 0 )
+  {
+    rtadv.initial--;
+    if( delay > RTADV_INITIAL_INTERVAL * 1000 )
+      delay = RTADV_INITIAL_INTERVAL * 1000;
+  }
+
+  return delay;
+}
+
+// --------------------------------------------------------------------------
+static size_t rtAdvPrefixOption( uint8_t* buf, const struct in6_addr* prefix, uint32_t valid,
+                                 uint32_t preferred )
+{
+  tRtAdvPrefix pi;
+
+  memset( &pi, 0, sizeof(pi) );
+  pi.type = RTADV_OPT_PREFIX;
+  pi.len = sizeof(pi) / 8;
+  pi.prefix_len = 64;
+  pi.flags = RTADV_PREFIX_ONLINK | RTADV_PREFIX_AUTO;
+  pi.valid_time = htonl(valid);
+  pi.preferred_time = htonl(preferred);
+  memcpy( &pi.prefix, prefix, sizeof(struct in6_addr) );
+  memcpy( buf, &pi, sizeof(pi) );
+
+  return sizeof(pi);
+}
+
+// --------------------------------------------------------------------------
+// Sends a router advertisement to all the nodes of the link. A final one
+// has a zero router lifetime, and withdraws the prefix.
+//
+// Called with the lock held.
+//
+static void rtAdvSend( sint32_t final )
+{
+  uint8_t buf[sizeof(tRtAdvHeader) + sizeof(tRtAdvMtu) + 2 * sizeof(tRtAdvPrefix)];
+  tRtAdvHeader ra;
+  tRtAdvMtu mtu;
+  struct sockaddr_in6 dst;
+  uint32_t lifetime;
+  size_t len = 0;
+
+  // The router lifetime is 3 times the max interval, at most 9000 seconds.
+  lifetime = final ? 0 : (uint32_t)rtadv.max_interval * 3;
+  if( lifetime > 9000 )
+    lifetime = 9000;
+
+  memset( &ra, 0, sizeof(ra) );
+  ra.type = RTADV_TYPE_ADVERT;
+  ra.hop_limit = RTADV_CUR_HOP_LIMIT;
+  ra.router_lifetime = htons((uint16_t)lifetime);
+  memcpy( buf, &ra, sizeof(ra) );
+  len += sizeof(ra);
+
+  memset( &mtu, 0, sizeof(mtu) );
+  mtu.type = RTADV_OPT_MTU;
+  mtu.len = sizeof(mtu) / 8;
+  mtu.mtu = htonl((uint32_t)rtadv.mtu);
+  memcpy( buf + len, &mtu, sizeof(mtu) );
+  len += sizeof(mtu);
+
+  if( final )
+  {
+    len += rtAdvPrefixOption( buf + len, &rtadv.prefix, 0, 0 );
+  }
+  else
+  {
+    len += rtAdvPrefixOption( buf + len, &rtadv.prefix, RTADV_VALID_LIFETIME, RTADV_PREFERRED_LIFETIME );
+  }
+  if( rtadv.old_count > 0 )
+  {
+    len += rtAdvPrefixOption( buf + len, &rtadv.old_prefix, 0, 0 );
+    rtadv.old_count--;
+  }
+
+  memset( &dst, 0, sizeof(dst) );
+  dst.sin6_family = AF_INET6;
+  dst.sin6_scope_id = rtadv.ifindex;
+  inet_pton( AF_INET6, RTADV_ALL_NODES, &dst.sin6_addr );
+
+  // This fails until the interface has a link-local address. The next
+  // advertisement is the retry.
+  if( sendto( rtadv.fd, buf, len, 0, (struct sockaddr*)&dst, sizeof(dst) ) < 0 )
+  {
+    Display( LOG_LEVEL_3, ELWarning, "rtAdvSend", GOGO_STR_RTADV_CANT_SEND, rtadv.ifname, strerror(errno) );
+  }
+}
+
+// --------------------------------------------------------------------------
+// Reads a packet from the socket. Returns 1 if it is a valid router
+// solicitation.
+//
+static sint32_t rtAdvReadSolicit( void )
+{
+  uint8_t buf[1500];
+  uint8_t control[CMSG_SPACE(sizeof(int))];
+  struct sockaddr_in6 from;
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr* cmsg;
+  int hoplimit = -1;
+  ssize_t n;
+
+  iov.iov_base = buf;
+  iov.iov_len = sizeof(buf);
+  memset( &msg, 0, sizeof(msg) );
+  msg.msg_name = &from;
+  msg.msg_namelen = sizeof(from);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  n = recvmsg( rtadv.fd, &msg, 0 );
+  if( n < RTADV_SOLICIT_SIZE )
+    return 0;
+
+  for( cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg) )
+  {
+    if( cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_HOPLIMIT )
+      memcpy( &hoplimit, CMSG_DATA(cmsg), sizeof(int) );
+  }
+
+  // A solicitation must come from the link itself (RFC 4861, 6.1.1).
+  return buf[0] == RTADV_TYPE_SOLICIT && buf[1] == 0 &&
+         hoplimit == RTADV_ND_HOP_LIMIT && from.sin6_scope_id == (uint32_t)rtadv.ifindex;
+}
+
+// --------------------------------------------------------------------------
+static pal_thread_ret_t PAL_THREAD_CALL rtAdvThread( void* arg )
+{
+  struct timespec now, last, next;
+  struct timeval tv;
+  fd_set fds;
+  sint32_t delay, wait, sent = 0;
+  char drain[16];
+
+  (void)arg;
+
+  pal_gettime_monotonic( &next );
+  memset( &last, 0, sizeof(last) );
+
+  while( 1 )
+  {
+    pal_enter_cs( &rtadv.lock );
+
+    if( rtadv.stop )
+      break;
+
+    pal_gettime_monotonic( &now );
+
+    // Solicited or updated advertisements wait for MIN_DELAY_BETWEEN_RAS
+    // after the last one.
+    if( rtadv.send_now && (!sent || rtAdvElapsed( &last, &now ) >= RTADV_MIN_DELAY * 1000) )
+    {
+      rtadv.send_now = 0;
+      next = now;
+    }
+
+    if( rtAdvElapsed( &now, &next ) <= 0 )
+    {
+      rtAdvSend( 0 );
+      last = now;
+      sent = 1;
+
+      delay = rtAdvNextDelay();
+      next.tv_sec = now.tv_sec + delay / 1000;
+      next.tv_nsec = now.tv_nsec + (delay % 1000) * 1000000;
+      if( next.tv_nsec >= 1000000000 )
+      {
+        next.tv_sec++;
+        next.tv_nsec -= 1000000000;
+      }
+    }
+
+    wait = rtAdvElapsed( &now, &next );
+    if( rtadv.send_now )
+    {
+      delay = RTADV_MIN_DELAY * 1000 - rtAdvElapsed( &last, &now );
+      if( delay < wait )
+        wait = delay;
+    }
+    if( wait < 0 )
+      wait = 0;
+
+    pal_leave_cs( &rtadv.lock );
+
+    FD_ZERO( &fds );
+    FD_SET( rtadv.fd, &fds );
+    FD_SET( rtadv.wake[0], &fds );
+    tv.tv_sec = wait / 1000;
+    tv.tv_usec = (wait % 1000) * 1000;
+
+    if( select( (rtadv.fd > rtadv.wake[0] ? rtadv.fd : rtadv.wake[0]) + 1, &fds, NULL, NULL, &tv ) <= 0 )
+      continue;
+
+    if( FD_ISSET( rtadv.wake[0], &fds ) && read( rtadv.wake[0], drain, sizeof(drain) ) <= 0 )
+      continue;
+
+    if( FD_ISSET( rtadv.fd, &fds ) && rtAdvReadSolicit() )
+    {
+      pal_enter_cs( &rtadv.lock );
+      rtadv.send_now = 1;
+      pal_leave_cs( &rtadv.lock );
+    }
+  }
+
+  // Still holding the lock: tell the hosts the router is going away.
+  rtAdvSend( 1 );
+  pal_leave_cs( &rtadv.lock );
+
+  pal_thread_exit( 0 );
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Called with the lock held, so that the pipe cannot be closed meanwhile.
+//
+static void rtAdvWake( void )
+{
+  char c = 0;
+
+  // The write end does not block: if the pipe is full, the write fails and
+  // the thread has a wake up pending anyway.
+  if( write( rtadv.wake[1], &c, 1 ) < 0 )
+    return;
+}
+
+// --------------------------------------------------------------------------
+// Opens the ICMPv6 socket: sends to the link, and receives the router
+// solicitations only.
+//
+static int rtAdvOpen( int ifindex )
+{
+  tRtAdvFilter filter;
+  struct ipv6_mreq mreq;
+  int fd, on = 1, hops = RTADV_ND_HOP_LIMIT, loop = 0;
+
+  fd = socket( AF_INET6, SOCK_RAW | SOCK_CLOEXEC, IPPROTO_ICMPV6 );
+  if( fd < 0 )
+    return -1;
+
+  memset( &filter, 0xFF, sizeof(filter) );
+  filter.data[RTADV_TYPE_SOLICIT >> 5] &= ~(1U << (RTADV_TYPE_SOLICIT & 31));
+
+  memset( &mreq, 0, sizeof(mreq) );
+  inet_pton( AF_INET6, RTADV_ALL_ROUTERS, &mreq.ipv6mr_multiaddr );
+  mreq.ipv6mr_interface = ifindex;
+
+  if( setsockopt( fd, IPPROTO_ICMPV6, RTADV_ICMP6_FILTER, &filter, sizeof(filter) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, &ifindex, sizeof(ifindex) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops, sizeof(hops) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &hops, sizeof(hops) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof(loop) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_RECVHOPLIMIT, &on, sizeof(on) ) < 0 ||
+      setsockopt( fd, IPPROTO_IPV6, IPV6_ADD_MEMBERSHIP, &mreq, sizeof(mreq) ) < 0 )
+  {
+    close( fd );
+    return -1;
+  }
+
+  return fd;
+}
+
+
+// --------------------------------------------------------------------------
+// Starts advertising the /64 on the interface or, if it is already
+// advertised there, switches to the new prefix without interruption.
+//
+gogoc_status tspRtAdvStart( const char *ifname, const struct in6_addr *prefix,
+                            sint32_t min_interval, sint32_t max_interval, sint32_t mtu )
+{
+  char str[INET6_ADDRSTRLEN];
+  int ifindex;
+
+
+  if( !rtadv_initialized )
+  {
+    pal_init_cs( &rtadv.lock );
+    srand( (unsigned int)(pal_time(NULL) ^ getpid()) );
+    rtadv_initialized = 1;
+  }
+
+  inet_ntop( AF_INET6, prefix, str, sizeof(str) );
+
+  // Another interface: start over.
+  if( rtadv.running && strcmp( rtadv.ifname, ifname ) != 0 )
+    tspRtAdvStop();
+
+  if( rtadv.running )
+  {
+    pal_enter_cs( &rtadv.lock );
+    if( memcmp( &rtadv.prefix, prefix, sizeof(struct in6_addr) ) != 0 )
+    {
+      Display( LOG_LEVEL_2, ELInfo, "tspRtAdvStart", GOGO_STR_RTADV_UPDATE, str, ifname );
+      memcpy( &rtadv.old_prefix, &rtadv.prefix, sizeof(struct in6_addr) );
+      memcpy( &rtadv.prefix, prefix, sizeof(struct in6_addr) );
+      rtadv.old_count = RTADV_DEPRECATE_COUNT;
+      rtadv.initial = RTADV_INITIAL_COUNT;
+      rtadv.send_now = 1;
+    }
+    rtadv.min_interval = min_interval;
+    rtadv.max_interval = max_interval;
+    rtadv.mtu = mtu;
+    rtAdvWake();
+    pal_leave_cs( &rtadv.lock );
+
+    return STATUS_SUCCESS_INIT;
+  }
+
+  ifindex = (int)if_nametoindex( ifname );
+  if( ifindex == 0 || pal_strlen(ifname) >= IFNAMSIZ )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspRtAdvStart", GOGO_STR_NETLINK_NO_INTERFACE, ifname );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+
+  rtadv.fd = rtAdvOpen( ifindex );
+  if( rtadv.fd < 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspRtAdvStart", GOGO_STR_RTADV_CANT_OPEN, ifname, strerror(errno) );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  if( pipe( rtadv.wake ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspRtAdvStart", GOGO_STR_RTADV_CANT_OPEN, ifname, strerror(errno) );
+    close( rtadv.fd );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  fcntl( rtadv.wake[0], F_SETFD, FD_CLOEXEC );
+  fcntl( rtadv.wake[1], F_SETFD, FD_CLOEXEC );
+  // Wakers write while holding the lock: they must never block.
+  fcntl( rtadv.wake[1], F_SETFL, O_NONBLOCK );
+
+  strcpy( rtadv.ifname, ifname );
+  rtadv.ifindex = ifindex;
+  memcpy( &rtadv.prefix, prefix, sizeof(struct in6_addr) );
+  rtadv.old_count = 0;
+  rtadv.min_interval = min_interval;
+  rtadv.max_interval = max_interval;
+  rtadv.mtu = mtu;
+  rtadv.initial = RTADV_INITIAL_COUNT;
+  rtadv.send_now = 0;
+  rtadv.stop = 0;
+
+  if( pal_thread_create( &rtadv.thread, &rtAdvThread, NULL ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspRtAdvStart", GOGO_STR_RTADV_CANT_OPEN, ifname, strerror(errno) );
+    close( rtadv.wake[0] );
+    close( rtadv.wake[1] );
+    close( rtadv.fd );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  pal_enter_cs( &rtadv.lock );
+  rtadv.running = 1;
+  pal_leave_cs( &rtadv.lock );
+
+  Display( LOG_LEVEL_2, ELInfo, "tspRtAdvStart", GOGO_STR_RTADV_START, str, ifname );
+  return STATUS_SUCCESS_INIT;
+}
+
+// --------------------------------------------------------------------------
+// Changes the link MTU advertised, and advertises it right away. Called
+// from the path MTU thread, while the main thread may stop advertising.
+//
+void tspRtAdvSetMtu( sint32_t mtu )
+{
+  if( !rtadv_initialized )
+    return;
+
+  pal_enter_cs( &rtadv.lock );
+  if( rtadv.running && !rtadv.stop && rtadv.mtu != mtu )
+  {
+    rtadv.mtu = mtu;
+    rtadv.send_now = 1;
+    rtAdvWake();
+  }
+  pal_leave_cs( &rtadv.lock );
+}
+
+// --------------------------------------------------------------------------
+// Stops advertising, after a last advertisement that withdraws the router
+// and the prefix.
+//
+void tspRtAdvStop( void )
+{
+  if( !rtadv.running )
+    return;
+
+  pal_enter_cs( &rtadv.lock );
+  rtadv.stop = 1;
+  rtAdvWake();
+  pal_leave_cs( &rtadv.lock );
+
+  pal_thread_join( rtadv.thread, NULL );
+
+  pal_enter_cs( &rtadv.lock );
+  rtadv.running = 0;
+  pal_leave_cs( &rtadv.lock );
+
+  close( rtadv.wake[0] );
+  close( rtadv.wake[1] );
+  close( rtadv.fd );
+
+  Display( LOG_LEVEL_2, ELInfo, "tspRtAdvStop", GOGO_STR_RTADV_STOP, rtadv.ifname );
+}
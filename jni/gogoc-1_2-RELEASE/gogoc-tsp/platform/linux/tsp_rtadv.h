@@ -0,0 +1,37 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef TSP_RTADV_H
+#define TSP_RTADV_H
+
+/*
+ * Router advertisement sender, for router mode.
+ *
+ * A thread of the client advertises the /64 given to tspRtAdvStart on the
+ * interface, at a random interval between the min and max intervals, and
+ * answers router solicitations. Calling tspRtAdvStart again while it runs
+ * changes the advertised prefix in place: the new prefix is advertised
+ * right away, and the old one a few more times with a zero lifetime so
+ * that the hosts deprecate it. tspRtAdvStop sends a last advertisement
+ * with a zero router lifetime.
+ */
+
+#define RTADV_VALID_LIFETIME        86400   /* Seconds */
+#define RTADV_PREFERRED_LIFETIME    14400   /* Seconds */
+#define RTADV_CUR_HOP_LIMIT         64
+#define RTADV_INITIAL_COUNT         3       /* MAX_INITIAL_RTR_ADVERTISEMENTS */
+#define RTADV_INITIAL_INTERVAL      16      /* MAX_INITIAL_RTR_ADVERT_INTERVAL, seconds */
+#define RTADV_MIN_DELAY             3       /* MIN_DELAY_BETWEEN_RAS, seconds */
+#define RTADV_DEPRECATE_COUNT       3       /* Advertisements that still carry a replaced prefix */
+
+gogoc_status        tspRtAdvStart         ( const char *ifname, const struct in6_addr *prefix,
+                                            sint32_t min_interval, sint32_t max_interval,
+                                            sint32_t mtu );
+void                tspRtAdvSetMtu        ( sint32_t mtu );
+void                tspRtAdvStop          ( void );
+
+#endif /* TSP_RTADV_H */
@@ -0,0 +1,566 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include <stddef.h>             // offsetof
+
+#include "tsp_standby.h"
+#include "tsp_client.h"         // tspNegotiateTunnel()
+#include "tsp_net.h"            // tspClose()
+#include "tsp_redirect.h"       // tspReadBrokerListFromFile()
+#include "tsp_netlink.h"        // tspNetlinkSetupStandby()
+#include "icmp_echo_engine.h"
+#include "log.h"                // Display
+#include "hex_strings.h"        // Various string constants
+
+
+// State of the standby tunnel.
+typedef enum
+{
+  STANDBY_DOWN,                 // Not negotiated, or lost.
+  STANDBY_WARM,                 // Up, behind the active tunnel.
+  STANDBY_ACTIVE                // Up, and carrying the traffic.
+} tStandbyState;
+
+
+// --------------------------------------------------------------------------
+// State of the standby tunnel, shared between the thread and its callers.
+//
+typedef struct stStandby
+{
+  pal_thread_t      thread;
+  sint32_t          running;            // The thread was started.
+  tConf             conf;               // Configuration of the standby tunnel.
+  char*             client_v4;          // client_v4 of the configuration file.
+  pal_thread_t      watch_thread;
+  sint32_t          watching;           // The watch thread was started.
+  void*             watch;              // ICMP echo engine watching the active tunnel.
+  tFrame            frame;              // Receive buffer of the TSP sessions.
+  pal_cs_t          lock;               // Protects what follows.
+
+  char              server[MAX_REDIRECT_ADDRESS_LENGTH];    // Of the standby tunnel, if up.
+  char              active[MAX_REDIRECT_ADDRESS_LENGTH];    // Of the active tunnel.
+  char              home[MAX_REDIRECT_ADDRESS_LENGTH];      // First server of the active tunnel.
+  tStandbyState     state;
+  void*             echo;               // ICMP echo engine, while the tunnel is up.
+  sint32_t          active_lost;        // The active tunnel stopped answering.
+  sint32_t          restart;            // Choose the broker again.
+  sint32_t          stop;
+} tStandby;
+
+static tStandby     standby;
+static sint32_t     standby_initialized = 0;
+
+// The strings of the configuration the thread has its own copy of: the
+// ones of the main thread are freed or replaced while it negotiates. The
+// server and client_v4 are handled apart.
+static const size_t standby_strings[] = {
+  offsetof(tConf, tsp_dir),           offsetof(tConf, dslite_server),
+  offsetof(tConf, dslite_client),     offsetof(tConf, userid),
+  offsetof(tConf, passwd),            offsetof(tConf, auth_method),
+  offsetof(tConf, client_v6),         offsetof(tConf, protocol),
+  offsetof(tConf, if_tunnel_v6v4),    offsetof(tConf, if_tunnel_v6udpv4),
+  offsetof(tConf, if_tunnel_v4v6),    offsetof(tConf, if_tunnel_standby),
+  offsetof(tConf, standby_server),    offsetof(tConf, dns_server),
+  offsetof(tConf, routing_info),      offsetof(tConf, if_prefix),
+  offsetof(tConf, template),          offsetof(tConf, host_type),
+  offsetof(tConf, log_filename),      offsetof(tConf, log_event_filename),
+  offsetof(tConf, log_memory_filename), offsetof(tConf, last_server_file),
+  offsetof(tConf, haccess_document_root), offsetof(tConf, broker_list_file),
+  offsetof(tConf, resolv_cache_file)
+};
+
+#define STANDBY_STRING(C, I)    (*(char**)((char*)(C) + standby_strings[I]))
+
+
+// --------------------------------------------------------------------------
+// Frees the strings of the configuration of the standby tunnel.
+//
+static void standbyFreeConf( void )
+{
+  size_t i;
+
+  for( i = 0; i < sizeof(standby_strings) / sizeof(standby_strings[0]); i++ )
+  {
+    pal_free( STANDBY_STRING(&standby.conf, i) );
+    STANDBY_STRING(&standby.conf, i) = NULL;
+  }
+
+  if( standby.conf.client_v4 != standby.client_v4 )
+    pal_free( standby.conf.client_v4 );
+  pal_free( standby.client_v4 );
+  standby.conf.client_v4 = standby.client_v4 = NULL;
+  pal_free( standby.conf.server );
+  standby.conf.server = NULL;
+}
+
+// --------------------------------------------------------------------------
+// Makes the configuration of the standby tunnel from the one of the client:
+// a v6v4 tunnel over TCP, on the standby interface. Returns 0, or -1 if out
+// of memory.
+//
+static sint32_t standbyCopyConf( const tConf* c )
+{
+  size_t i;
+
+  memcpy( &standby.conf, c, sizeof(tConf) );
+  for( i = 0; i < sizeof(standby_strings) / sizeof(standby_strings[0]); i++ )
+  {
+    if( STANDBY_STRING(c, i) != NULL )
+      STANDBY_STRING(&standby.conf, i) = pal_strdup( STANDBY_STRING(c, i) );
+  }
+  standby.conf.server = NULL;
+  standby.client_v4 = pal_strdup( c->client_v4 );
+  standby.conf.client_v4 = standby.client_v4;
+
+  pal_free( standby.conf.if_tunnel_v6v4 );
+  standby.conf.if_tunnel_v6v4 = pal_strdup( c->if_tunnel_standby );
+
+  for( i = 0; i < sizeof(standby_strings) / sizeof(standby_strings[0]); i++ )
+  {
+    if( STANDBY_STRING(c, i) != NULL && STANDBY_STRING(&standby.conf, i) == NULL )
+      break;
+  }
+  if( i < sizeof(standby_strings) / sizeof(standby_strings[0]) ||
+      standby.client_v4 == NULL || standby.conf.if_tunnel_v6v4 == NULL )
+  {
+    standbyFreeConf();
+    return -1;
+  }
+
+  standby.conf.tunnel_mode = V6V4;
+  standby.conf.transport = NET_TOOLS_T_TCP;
+  standby.conf.proxy_client = FALSE;
+  standby.conf.keepalive = TRUE;
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Waits 'seconds', or less if the thread is asked to stop or to choose the
+// broker again. Returns 1 if it is asked to stop.
+//
+static sint32_t standbyWait( sint32_t seconds )
+{
+  sint32_t stop, restart;
+
+  while( 1 )
+  {
+    pal_enter_cs( &standby.lock );
+    stop = standby.stop;
+    restart = standby.restart;
+    pal_leave_cs( &standby.lock );
+
+    if( stop || restart || seconds-- <= 0 )
+      return stop;
+    pal_sleep( 1000 );
+  }
+}
+
+// --------------------------------------------------------------------------
+// Copies 'server' to 'buf' if it is set, and is not the server of the
+// active tunnel. Returns 1 if it did.
+//
+static sint32_t standbyCandidate( char* buf, const char* server )
+{
+  if( server == NULL || server[0] == '\0' || pal_strcasecmp( server, standby.active ) == 0 )
+    return 0;
+
+  pal_snprintf( buf, MAX_REDIRECT_ADDRESS_LENGTH, "%s", server );
+  return 1;
+}
+
+// --------------------------------------------------------------------------
+// Chooses the broker of the standby tunnel: standby_server, the first
+// server of the client, then the broker list, skipping the server of the
+// active tunnel. Returns 0 if there is none.
+//
+static sint32_t standbyChooseServer( char* buf )
+{
+  tBrokerList *list = NULL, *broker;
+  char* addr = NULL;
+  sint32_t found;
+
+  pal_enter_cs( &standby.lock );
+  found = standbyCandidate( buf, standby.conf.standby_server ) ||
+          standbyCandidate( buf, standby.home );
+  pal_leave_cs( &standby.lock );
+
+  if( found || tspReadBrokerListFromFile( standby.conf.broker_list_file, &list ) != TSP_REDIRECT_OK )
+    return found;
+
+  for( broker = list; broker != NULL && !found; broker = broker->next )
+  {
+    if( FormatBrokerListAddr( broker, &addr ) == 0 )
+    {
+      pal_enter_cs( &standby.lock );
+      found = standbyCandidate( buf, addr );
+      pal_leave_cs( &standby.lock );
+    }
+  }
+
+  pal_free( addr );
+  tspFreeBrokerList( list );
+  return found;
+}
+
+// --------------------------------------------------------------------------
+// Negotiates the standby tunnel with 'server' and configures it. On
+// success, the TSP session is left open in 'p_socket'. A redirection is a
+// failure: following it would rewrite the broker list of the client.
+//
+static gogoc_status standbyNegotiate( const char* server, net_tools_t* nt, pal_socket_t* p_socket,
+                                      tTunnel* t )
+{
+  gogoc_status status;
+
+  // The source address is found again for each server.
+  if( standby.conf.client_v4 != standby.client_v4 )
+    pal_free( standby.conf.client_v4 );
+  standby.conf.client_v4 = standby.client_v4;
+
+  pal_free( standby.conf.server );
+  standby.conf.server = pal_strdup( server );
+
+  Display( LOG_LEVEL_2, ELInfo, "standbyNegotiate", GOGO_STR_STANDBY_NEGOTIATING, server );
+  status = tspNegotiateTunnel( &standby.conf, nt, CLIENT_VERSION_INDEX_CURRENT, NULL,
+                               p_socket, t, &standby.frame, FALSE );
+  if( status_number(status) != SUCCESS )
+    return status;
+
+  if( pal_strcasecmp( t->type, STR_XML_TUNNELMODE_V6V4 ) != 0 ||
+      status_number(status = tspNetlinkSetupStandby( &standby.conf, t )) != SUCCESS )
+  {
+    tspClose( *p_socket, nt );
+    tspClearTunnelInfo( t );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+
+  return status;
+}
+
+// --------------------------------------------------------------------------
+// Keeps the standby tunnel up until its keepalives time out, or the thread
+// is asked to stop or to choose the broker again.
+//
+static void standbyKeepalive( tTunnel* t )
+{
+  const char* echo_address;
+  void* echo = NULL;
+  sint32_t interval = 0;
+
+  if( t->keepalive_interval != NULL )
+    interval = atoi( t->keepalive_interval );
+  if( interval <= 0 )
+    interval = STANDBY_ECHO_INTERVAL;
+
+  // The same address as tspNetlinkSetupStandby routes through the tunnel.
+  echo_address = t->keepalive_address != NULL ? t->keepalive_address : t->server_address_ipv6;
+  if( IEE_init( &echo, IEE_MODE_KA, (uint32_t)interval * 1000, 0, STANDBY_ECHO_TIMEOUT,
+                STANDBY_ECHO_LOST, t->client_address_ipv6, (char*)echo_address, AF_INET6,
+                NULL, NULL, NULL ) != IEE_SUCCESS )
+  {
+    Display( LOG_LEVEL_1, ELError, "standbyKeepalive", GOGO_STR_STANDBY_CANT_START, "keepalive" );
+    return;
+  }
+
+  pal_enter_cs( &standby.lock );
+  if( standby.stop || standby.restart )
+    IEE_stop( echo );
+  standby.echo = echo;
+  pal_leave_cs( &standby.lock );
+
+  if( IEE_process( echo ) == IEE_GENERAL_ECHO_TIMEOUT )
+    Display( LOG_LEVEL_1, ELWarning, "standbyKeepalive", GOGO_STR_STANDBY_LOST, standby.server );
+
+  pal_enter_cs( &standby.lock );
+  standby.echo = NULL;
+  pal_leave_cs( &standby.lock );
+
+  IEE_destroy( &echo );
+}
+
+// --------------------------------------------------------------------------
+static pal_thread_ret_t PAL_THREAD_CALL standbyThread( void* arg )
+{
+  net_tools_t nt[NET_TOOLS_T_SIZE];
+  pal_socket_t socket;
+  tTunnel tunnel;
+  char server[MAX_REDIRECT_ADDRESS_LENGTH];
+  gogoc_status status;
+  sint32_t delay;
+
+  (void)arg;
+
+  memset( nt, 0, sizeof(nt) );
+  InitNetToolsArray( nt );
+
+  while( 1 )
+  {
+    pal_enter_cs( &standby.lock );
+    standby.restart = 0;
+    pal_leave_cs( &standby.lock );
+
+    delay = 0;
+    if( !standbyChooseServer( server ) )
+    {
+      Display( LOG_LEVEL_2, ELWarning, "standbyThread", GOGO_STR_STANDBY_NO_BROKER, standby.active,
+               STANDBY_RETRY_DELAY );
+      delay = STANDBY_RETRY_DELAY;
+    }
+    else if( status_number(status = standbyNegotiate( server, &nt[NET_TOOLS_T_TCP], &socket, &tunnel )) != SUCCESS )
+    {
+      Display( LOG_LEVEL_1, ELWarning, "standbyThread", GOGO_STR_STANDBY_FAILED, server,
+               STANDBY_RETRY_DELAY );
+      delay = STANDBY_RETRY_DELAY;
+    }
+    else
+    {
+      pal_enter_cs( &standby.lock );
+      pal_snprintf( standby.server, sizeof(standby.server), "%s", server );
+      standby.state = STANDBY_WARM;
+      pal_leave_cs( &standby.lock );
+
+      Display( LOG_LEVEL_1, ELInfo, "standbyThread", GOGO_STR_STANDBY_UP, server,
+               standby.conf.if_tunnel_standby, tunnel.client_address_ipv6 );
+
+      standbyKeepalive( &tunnel );
+
+      pal_enter_cs( &standby.lock );
+      standby.server[0] = '\0';
+      standby.state = STANDBY_DOWN;
+      pal_leave_cs( &standby.lock );
+
+      tspNetlinkTearDownStandby( &standby.conf );
+      tspClose( socket, &nt[NET_TOOLS_T_TCP] );
+      tspClearTunnelInfo( &tunnel );
+      delay = STANDBY_RETRY_DELAY;
+    }
+
+    if( standbyWait( delay ) )
+      break;
+  }
+
+  pal_thread_exit( 0 );
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Echoes the active tunnel until it stops answering, or the watch is
+// stopped.
+//
+static pal_thread_ret_t PAL_THREAD_CALL standbyWatchThread( void* arg )
+{
+  (void)arg;
+
+  if( IEE_process( standby.watch ) == IEE_GENERAL_ECHO_TIMEOUT )
+  {
+    pal_enter_cs( &standby.lock );
+    standby.active_lost = 1;
+    pal_leave_cs( &standby.lock );
+
+    Display( LOG_LEVEL_1, ELWarning, "standbyWatchThread", GOGO_STR_STANDBY_ACTIVE_SILENT,
+             standby.active, STANDBY_WATCH_LOST );
+  }
+
+  pal_thread_exit( 0 );
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+// Starts watching the active tunnel 't', through the address its keepalives
+// use.
+//
+static void standbyWatch( tTunnel* t )
+{
+  char* address = t->keepalive_address != NULL ? t->keepalive_address : t->server_address_ipv6;
+
+  tspStandbyUnwatch();
+
+  pal_enter_cs( &standby.lock );
+  standby.active_lost = 0;
+  pal_leave_cs( &standby.lock );
+
+  if( IEE_init( &standby.watch, IEE_MODE_KA, STANDBY_WATCH_INTERVAL, 0, STANDBY_WATCH_TIMEOUT,
+                STANDBY_WATCH_LOST, t->client_address_ipv6, address, AF_INET6,
+                NULL, NULL, NULL ) != IEE_SUCCESS )
+  {
+    Display( LOG_LEVEL_1, ELError, "standbyWatch", GOGO_STR_STANDBY_CANT_START, "watch" );
+    IEE_destroy( &standby.watch );
+    return;
+  }
+
+  if( pal_thread_create( &standby.watch_thread, &standbyWatchThread, NULL ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "standbyWatch", GOGO_STR_STANDBY_CANT_START, strerror(errno) );
+    IEE_destroy( &standby.watch );
+    return;
+  }
+  standby.watching = 1;
+}
+
+// --------------------------------------------------------------------------
+// Returns 1 if the active tunnel is being watched: the tunnel loops then
+// check tspStandbyActiveLost every STANDBY_WATCH_POLL milliseconds.
+//
+sint32_t tspStandbyWatching( void )
+{
+  return standby.watching;
+}
+
+// --------------------------------------------------------------------------
+// Returns 1 if the active tunnel stopped answering while the standby tunnel
+// is up: the tunnel loop then ends as on a keepalive timeout.
+//
+sint32_t tspStandbyActiveLost( void )
+{
+  sint32_t lost;
+
+  if( !standby.watching )
+    return 0;
+
+  pal_enter_cs( &standby.lock );
+  lost = standby.active_lost && standby.state == STANDBY_WARM;
+  pal_leave_cs( &standby.lock );
+
+  return lost;
+}
+
+// --------------------------------------------------------------------------
+// Stops watching the active tunnel, which has ended.
+//
+void tspStandbyUnwatch( void )
+{
+  if( !standby.watching )
+    return;
+
+  IEE_stop( standby.watch );
+  pal_thread_join( standby.watch_thread, NULL );
+  IEE_destroy( &standby.watch );
+  standby.watching = 0;
+}
+
+// --------------------------------------------------------------------------
+// Starts the standby tunnel once the active tunnel is up, if
+// if_tunnel_standby is set. The thread is kept across reconnections of the
+// active tunnel; it only chooses another broker if the active tunnel is
+// now to the one of the standby tunnel.
+//
+gogoc_status tspStandbyStart( tConf *c, tTunnel *t )
+{
+  if( c->if_tunnel_standby == NULL || c->if_tunnel_standby[0] == '\0' )
+    return STATUS_SUCCESS_INIT;
+
+  if( pal_strcasecmp( c->host_type, "host" ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELWarning, "tspStandbyStart", GOGO_STR_STANDBY_HOST_ONLY );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+
+  if( !standby_initialized )
+  {
+    pal_init_cs( &standby.lock );
+    standby_initialized = 1;
+  }
+
+  pal_enter_cs( &standby.lock );
+  pal_snprintf( standby.active, sizeof(standby.active), "%s", c->server );
+  if( standby.home[0] == '\0' )
+    pal_snprintf( standby.home, sizeof(standby.home), "%s", c->server );
+
+  // The active tunnel has its routes in front again.
+  if( standby.state == STANDBY_ACTIVE )
+  {
+    Display( LOG_LEVEL_1, ELInfo, "tspStandbyStart", GOGO_STR_STANDBY_DEMOTED, c->server, standby.server );
+    standby.state = STANDBY_WARM;
+  }
+
+  // Two tunnels to the same broker do not survive its failure.
+  if( standby.server[0] != '\0' && pal_strcasecmp( standby.server, c->server ) == 0 )
+  {
+    Display( LOG_LEVEL_2, ELInfo, "tspStandbyStart", GOGO_STR_STANDBY_SAME_SERVER, c->server );
+    standby.restart = 1;
+    if( standby.echo != NULL )
+      IEE_stop( standby.echo );
+  }
+  pal_leave_cs( &standby.lock );
+
+  standbyWatch( t );
+
+  if( standby.running )
+    return STATUS_SUCCESS_INIT;
+
+  if( standbyCopyConf( c ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspStandbyStart", GOGO_STR_STANDBY_CANT_START, strerror(ENOMEM) );
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  standby.state = STANDBY_DOWN;
+  standby.server[0] = '\0';
+  standby.stop = 0;
+
+  if( pal_thread_create( &standby.thread, &standbyThread, NULL ) != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "tspStandbyStart", GOGO_STR_STANDBY_CANT_START, strerror(errno) );
+    standbyFreeConf();
+    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
+  }
+  standby.running = 1;
+
+  return STATUS_SUCCESS_INIT;
+}
+
+// --------------------------------------------------------------------------
+// Called when the active tunnel is lost to a keepalive timeout. Returns 1
+// if the standby tunnel is up and takes over: the active tunnel is then to
+// be torn down, so that its routes give way.
+//
+sint32_t tspStandbyTakeOver( void )
+{
+  sint32_t taken = 0;
+
+  if( !standby.running )
+    return 0;
+
+  pal_enter_cs( &standby.lock );
+  if( standby.state == STANDBY_WARM )
+  {
+    Display( LOG_LEVEL_1, ELWarning, "tspStandbyTakeOver", GOGO_STR_STANDBY_TAKEOVER, standby.server );
+    standby.state = STANDBY_ACTIVE;
+    taken = 1;
+  }
+  pal_leave_cs( &standby.lock );
+
+  return taken;
+}
+
+// --------------------------------------------------------------------------
+// Stops the thread, which tears the standby tunnel down. A negotiation in
+// progress is waited for.
+//
+void tspStandbyStop( void )
+{
+  tspStandbyUnwatch();
+
+  if( !standby.running )
+    return;
+
+  pal_enter_cs( &standby.lock );
+  standby.stop = 1;
+  if( standby.echo != NULL )
+    IEE_stop( standby.echo );
+  pal_leave_cs( &standby.lock );
+
+  pal_thread_join( standby.thread, NULL );
+  standby.running = 0;
+
+  standbyFreeConf();
+  tspFreeFrame( &standby.frame );
+}
@@ -0,0 +1,57 @@
+/*
+---------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+
+---------------------------------------------------------------------------
+*/
+
+#ifndef TSP_STANDBY_H
+#define TSP_STANDBY_H
+
+#include "config.h"
+#include "xml_tun.h"
+
+/*
+ * Standby tunnel to a second broker.
+ *
+ * With if_tunnel_standby set, once the active tunnel is up, a thread of the
+ * client negotiates a v6v4 tunnel over TCP with another broker, and
+ * configures it on if_tunnel_standby (tspNetlinkSetupStandby). Its routes
+ * sit behind the ones of the active tunnel, and it runs keepalives of its
+ * own; it is negotiated again when they time out.
+ *
+ * The keepalives of the active tunnel take seconds to notice that its broker
+ * is gone. While the standby tunnel is up, a second thread watches the
+ * active tunnel with echo requests every STANDBY_WATCH_INTERVAL: after
+ * STANDBY_WATCH_LOST of them go unanswered, tspStandbyActiveLost tells the
+ * tunnel loop, which ends as on a keepalive timeout, in well under a second.
+ *
+ * When the active tunnel ends on a keepalive timeout, tspStandbyTakeOver
+ * marks the standby tunnel active, and the active tunnel is torn down
+ * instead of being kept: the traffic takes the standby tunnel as soon as
+ * the routes of the active one are gone, while the client reconnects. The
+ * next active tunnel puts its routes back in front.
+ *
+ * The standby broker is standby_server if set, otherwise the first server
+ * the client used, or the first entry of the broker list, that is not the
+ * server of the active tunnel. Redirections are not followed for it: the
+ * broker list stays the one of the active tunnel.
+ */
+
+#define STANDBY_RETRY_DELAY       30      /* Seconds between attempts */
+#define STANDBY_ECHO_INTERVAL     30      /* Seconds between keepalives, if the broker gives none */
+#define STANDBY_ECHO_TIMEOUT      5000    /* Milliseconds to wait for a keepalive reply */
+#define STANDBY_ECHO_LOST         3       /* Consecutive keepalive timeouts before the tunnel is lost */
+#define STANDBY_WATCH_INTERVAL    100     /* Milliseconds between echo requests to the active tunnel */
+#define STANDBY_WATCH_TIMEOUT     300     /* Milliseconds to wait for their reply */
+#define STANDBY_WATCH_LOST        3       /* Consecutive timeouts before the active tunnel is lost */
+#define STANDBY_WATCH_POLL        100     /* Milliseconds between checks of the tunnel loops */
+
+gogoc_status        tspStandbyStart       ( tConf *c, tTunnel *t );
+sint32_t            tspStandbyWatching    ( void );
+sint32_t            tspStandbyActiveLost  ( void );
+void                tspStandbyUnwatch     ( void );
+sint32_t            tspStandbyTakeOver    ( void );
+void                tspStandbyStop        ( void );
+
+#endif /* TSP_STANDBY_H */
@@ -28,8 +28,17 @@ This source code copyright (c) gogo6 Inc. 2002-2006.
 #include "log.h"            // Display and logging prototypes and types.
 #include "hex_strings.h"    // String litterals
 
+#ifdef STANDBY_SUPPORT
+#include "tsp_standby.h"    // tspStandbyActiveLost()
+#endif
+
 #define TUN_BUFSIZE 2048    // Buffer size for TUN interface IO operations.
 
+// TUN device kept open between two connections. The interface lives as long
+// as its descriptor is open. See TunKeep().
+static sint32_t kept_tunfd = -1;
+static char     kept_tunname[IFNAMSIZ];
+
 
 // --------------------------------------------------------------------------
 // TunInit: Open and initialize the TUN interface.
@@ -41,6 +50,19 @@ sint32_t TunInit(char *TunDevice)
   char iftun[128];
   unsigned long ioctl_nochecksum = 1;
 
+  // Reuse the device kept from the last connection, if it is this one.
+  if( kept_tunfd != -1 )
+  {
+    if( strncmp(kept_tunname, TunDevice, IFNAMSIZ) == 0 )
+    {
+      Display(LOG_LEVEL_3, ELInfo, "TunInit", GOGO_STR_TUN_REUSED, TunDevice);
+      tunfd = kept_tunfd;
+      kept_tunfd = -1;
+      return tunfd;
+    }
+    TunRelease(kept_tunname);
+  }
+
   /* for linux, force the use of "tun" */
 #ifdef ANDROID
   strcpy(iftun,"/dev/tun");
@@ -48,7 +70,8 @@ sint32_t TunInit(char *TunDevice)
   strcpy(iftun,"/dev/net/tun");
 #endif
 
-  tunfd = open(iftun,O_RDWR);
+  // Not inherited by the scripts.
+  tunfd = open(iftun,O_RDWR|O_CLOEXEC);
   if (tunfd == -1) {
     Display(LOG_LEVEL_1, ELError, "TunInit", GOGO_STR_ERR_OPEN_DEV, iftun);
     Display(LOG_LEVEL_1, ELError, "TunInit", GOGO_STR_TRY_MODPROBE_TUN);
@@ -72,6 +95,35 @@ sint32_t TunInit(char *TunDevice)
 }
 
 
+// --------------------------------------------------------------------------
+// TunKeep: Keeps the TUN device open until the next TunInit, so that its
+//   interface and the configuration on it outlive the connection.
+//
+void TunKeep(sint32_t tunfd, char *TunDevice)
+{
+  if( kept_tunfd != -1 )
+    close(kept_tunfd);
+
+  kept_tunfd = tunfd;
+  strncpy(kept_tunname, TunDevice, IFNAMSIZ - 1);
+  kept_tunname[IFNAMSIZ - 1] = '\0';
+}
+
+
+// --------------------------------------------------------------------------
+// TunRelease: Closes the TUN device kept for the interface, if any. This
+//   removes the interface.
+//
+void TunRelease(const char *TunDevice)
+{
+  if( kept_tunfd != -1 && strncmp(kept_tunname, TunDevice, IFNAMSIZ) == 0 )
+  {
+    close(kept_tunfd);
+    kept_tunfd = -1;
+  }
+}
+
+
 // --------------------------------------------------------------------------
 // TunMainLoop: Initializes Keepalive engine and starts it. Then starts a
 //   loop to transfer data from/to the socket and tunnel.
@@ -156,10 +208,23 @@ gogoc_status TunMainLoop(sint32_t tunfd, pal_socket_t Socket,
         break;
       }
 
+#ifdef STANDBY_SUPPORT
+      // The standby tunnel takes over before the keepalives time out.
+      if( status_number(status) == SUCCESS  &&  tspStandbyActiveLost() )
+      {
+        KA_stop( p_ka_engine );
+        status = make_status(CTX_TUNNELLOOP, ERR_KEEPALIVE_TIMEOUT);
+      }
+#endif
+
       // Reinit select timeout variable; select modifies it.
       // Use 500ms because we need to re-check keepalive status.
       timeout.tv_sec = 0;
       timeout.tv_usec = 500000;    // 500 milliseconds.
+#ifdef STANDBY_SUPPORT
+      if( tspStandbyWatching() )
+        timeout.tv_usec = STANDBY_WATCH_POLL * 1000;
+#endif
     }
     else
     {
@@ -15,6 +15,8 @@ This source code copyright (c) gogo6 Inc. 2002-2005.
 #include "config.h"
 
 sint32_t            TunInit               (char *TunDevice);
+void                TunKeep               (sint32_t tunfd, char *TunDevice);
+void                TunRelease            (const char *TunDevice);
 gogoc_status         TunMainLoop           (sint32_t tunfd, pal_socket_t Socket, 
                                            tBoolean keepalive, sint32_t keepalive_interval,
 		                                       char *local_address_ipv6, char *keepalive_address);
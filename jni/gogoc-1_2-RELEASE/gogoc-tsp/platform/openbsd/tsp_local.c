@@ -50,6 +50,7 @@ error_t send_status_info( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_tunnel_info( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_broker_list( void ) { return GOGOCM_UIS__NOERROR; }
 error_t send_haccess_status_info( void ) { return GOGOCM_UIS__NOERROR; }
+error_t send_conn_trace( void ) { return GOGOCM_UIS__NOERROR; }
 
 
 // --------------------------------------------------------------------------
@@ -62,7 +63,8 @@ void tspSetEnv(char *Variable, char *Value, int Flag)
 }
 
 // --------------------------------------------------------------------------
-// Checks if the gogoCLIENT has been requested to stop and exit.
+// Checks if the gogoCLIENT has been requested to stop and exit. The levels
+// of a log level burst that is over are restored.
 //
 // Returns 1 if gogoCLIENT is being requested to stop and exit.
 // Else, waits 'uiWaitMs' miliseconds and returns 0.
@@ -78,6 +80,8 @@ int tspCheckForStopOrWait( const unsigned int uiWaitMs )
     usleep( uiWaitMs * 1000 );
   }
 
+  LogBurstCheck();
+
   return indSigHUP;
 }
 
@@ -24,6 +24,9 @@ Copyright (c) 2001-2006 gogo6 Inc. All rights reserved.
 #endif
 
 extern int indSigHUP; /* Declared in every unix platform tsp_local.c */
+#ifdef LOG_LEVELS_SIGNAL
+extern int indSigUSR1;
+#endif
 
 
 /* --------------------------------------------------------------------------
@@ -33,6 +36,10 @@ void signal_handler( int sigraised )
 {
   if( sigraised == SIGHUP )
     indSigHUP = 1;
+#ifdef LOG_LEVELS_SIGNAL
+  if( sigraised == SIGUSR1 )
+    indSigUSR1 = 1;
+#endif
 }
 
 
@@ -63,6 +70,10 @@ int main(int argc, char *argv[])
 #endif
   /* Install new signal handler for HUP signal. */
   signal( SIGHUP, &signal_handler );
+#ifdef LOG_LEVELS_SIGNAL
+  /* ... and for USR1, which changes the log levels. */
+  signal( SIGUSR1, &signal_handler );
+#endif
 
 #ifdef HACCESS
   /* Initialize the HACCESS module. */
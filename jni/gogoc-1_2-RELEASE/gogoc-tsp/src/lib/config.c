@@ -94,8 +94,20 @@ static sint32_t ParseSyslogFacility( tConf *pConf, char *facility )
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #define LINESIZE 256
+
+// Same bounds as the gogoc-config validation, which is not linked here.
+#define CFG_MIN_RAMININTERVAL   3
+#define CFG_MAX_RAMININTERVAL   1350
+#define CFG_MIN_RAMAXINTERVAL   4
+#define CFG_MAX_RAMAXINTERVAL   1800
+#define CFG_MIN_ROUTETABLE      0
+#define CFG_MAX_ROUTETABLE      252
+#define CFG_MIN_ROUTEFWMARK     0
+#define CFG_MAX_ROUTEFWMARK     2147483647
+
 static ssize_t readline(char **lineptr, size_t * len, FILE *input)
 {
   char *ptr;
@@ -134,8 +146,27 @@ static ssize_t readline(char **lineptr, size_t * len, FILE *input)
   return -1;
 }
 
+// Reads a decimal value between min and max, digits only. Returns 0, or 1
+// (with an error message) if the value is invalid.
+static int readnumber(const char *name, const char *value, long min, long max, sint32_t *number)
+{
+  char *end;
+  long v;
+
+  errno = 0;
+  v = (value != NULL) ? strtol(value, &end, 10) : 0;
+  if (value == NULL || *value < '0' || *value > '9' || *end != '\0' || errno != 0 || v < min || v > max) {
+    DirectErrorMessage(GOGO_STR_INVALID_VAL_FOR_KEY, name, (value != NULL) ? value : "");
+    return 1;
+  }
+
+  *number = (sint32_t)v;
+  return 0;
+}
+
 gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
 {
+  int errors = 0;
   size_t len = 0;
   ssize_t count;
   char *line = NULL;
@@ -148,6 +179,7 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
   pConf->template = pal_strdup("android");
   pConf->broker_list_file = pal_strdup("/data/data/com.googlecode.gogodroid/files/broker_list_file");
   pConf->last_server_file = pal_strdup("/data/data/com.googlecode.gogodroid/files/last_server_file");
+  pConf->resolv_cache_file = pal_strdup("/data/data/com.googlecode.gogodroid/files/resolv_cache_file");
 
   pConf->if_prefix = pal_strdup("");
   pConf->dns_server = pal_strdup("");
@@ -155,11 +187,17 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
   pConf->if_tunnel_v6v4 = pal_strdup("sit1");
   pConf->if_tunnel_v6udpv4 = pal_strdup("tun");
   pConf->if_tunnel_v4v6 = pal_strdup("sit0");
+  pConf->if_tunnel_standby = pal_strdup("");
+  pConf->standby_server = pal_strdup("");
   pConf->userid = pal_strdup("");
   pConf->passwd = pal_strdup("");
 
   pConf->host_type = pal_strdup("host");
   pConf->prefixlen = 64;
+  pConf->ra_min_interval = 198;
+  pConf->ra_max_interval = 600;
+  pConf->route_table = 0;
+  pConf->route_fwmark = 0;
 
   pConf->auto_retry_connect = TRUE;
   pConf->retry_delay = 30;
@@ -170,6 +208,8 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
   pConf->client_v4 = pal_strdup("auto");
   pConf->client_v6 = pal_strdup("auto");
   pConf->proxy_client = FALSE;
+  pConf->use_template = FALSE;
+  pConf->keep_tunnel = FALSE;
   pConf->always_use_same_server = FALSE;
 
   pConf->log_level_console = 0;
@@ -184,6 +224,18 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
   pConf->log_rotation = TRUE;
   pConf->log_rotation_size = 32;
   pConf->log_rotation_delete = TRUE;
+  pConf->log_rotation_count = 4;
+  pConf->log_rotation_compress = FALSE;
+  pConf->log_level_event = 0;
+  pConf->log_event_filename = pal_strdup("/data/data/com.googlecode.gogodroid/files/gogoc.evt");
+  pConf->log_event_size = 256;
+  pConf->log_level_memory = 0;
+  pConf->log_memory_filename = pal_strdup("/data/data/com.googlecode.gogodroid/cache/gogoc.ring");
+  pConf->log_memory_size = 64;
+  pConf->log_async = FALSE;
+  pConf->log_flush_interval = 200;
+  pConf->log_timestamp_precision = 3;
+  pConf->log_timestamp_iso8601 = FALSE;
 
   input = fopen(szFile, "r");
   while ((count = readline(&line, &len, input)) > 0) {
@@ -210,6 +262,8 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
       pConf->broker_list_file = pal_strdup(value);
     } else if (strcmp(name, "last_server") == 0) {
       pConf->last_server_file = pal_strdup(value);
+    } else if (strcmp(name, "resolv_cache") == 0) {
+      pConf->resolv_cache_file = pal_strdup(value);
     } else if (strcmp(name, "if_prefix") == 0) {
       pConf->if_prefix = pal_strdup(value);
     } else if (strcmp(name, "dns_server") == 0) {
@@ -232,12 +286,67 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
       pConf->if_tunnel_v6udpv4 = pal_strdup(value);
     } else if (strcmp(name, "if_tunnel_v4v6") == 0) {
       pConf->if_tunnel_v4v6 = pal_strdup(value);
+    } else if (strcmp(name, "ra_min_interval") == 0) {
+      errors += readnumber(name, value, CFG_MIN_RAMININTERVAL, CFG_MAX_RAMININTERVAL, &pConf->ra_min_interval);
+    } else if (strcmp(name, "ra_max_interval") == 0) {
+      errors += readnumber(name, value, CFG_MIN_RAMAXINTERVAL, CFG_MAX_RAMAXINTERVAL, &pConf->ra_max_interval);
+    } else if (strcmp(name, "route_table") == 0) {
+      errors += readnumber(name, value, CFG_MIN_ROUTETABLE, CFG_MAX_ROUTETABLE, &pConf->route_table);
+    } else if (strcmp(name, "route_fwmark") == 0) {
+      errors += readnumber(name, value, CFG_MIN_ROUTEFWMARK, CFG_MAX_ROUTEFWMARK, &pConf->route_fwmark);
+    } else if (strcmp(name, "if_tunnel_standby") == 0) {
+      pConf->if_tunnel_standby = pal_strdup(value);
+    } else if (strcmp(name, "standby_server") == 0) {
+      pConf->standby_server = pal_strdup(value);
+    } else if (strcmp(name, "keep_tunnel") == 0) {
+      if (value != NULL && (strcmp(value, "yes") == 0 || strcmp(value, "no") == 0)) {
+        pConf->keep_tunnel = (strcmp(value, "yes") == 0) ? TRUE : FALSE;
+      } else {
+        DirectErrorMessage(GOGO_STR_INVALID_VAL_FOR_KEY, name, (value != NULL) ? value : "");
+        errors++;
+      }
+    } else if (strcmp(name, "log_rotation_count") == 0) {
+      pConf->log_rotation_count = atoi(value);
+    } else if (strcmp(name, "log_rotation_compress") == 0) {
+      pConf->log_rotation_compress = (strcmp(value, "yes") == 0) ? TRUE : FALSE;
+    } else if (strcmp(name, "log_event") == 0) {
+      pConf->log_level_event = atoi(value);
+    } else if (strcmp(name, "log_event_filename") == 0) {
+      free(pConf->log_event_filename);
+      pConf->log_event_filename = pal_strdup(value);
+    } else if (strcmp(name, "log_event_size") == 0) {
+      pConf->log_event_size = atoi(value);
+    } else if (strcmp(name, "log_memory") == 0) {
+      pConf->log_level_memory = atoi(value);
+    } else if (strcmp(name, "log_memory_filename") == 0) {
+      free(pConf->log_memory_filename);
+      pConf->log_memory_filename = pal_strdup(value);
+    } else if (strcmp(name, "log_memory_size") == 0) {
+      pConf->log_memory_size = atoi(value);
+    } else if (strcmp(name, "log_async") == 0) {
+      pConf->log_async = (strcmp(value, "yes") == 0) ? TRUE : FALSE;
+    } else if (strcmp(name, "log_flush_interval") == 0) {
+      pConf->log_flush_interval = atoi(value);
+    } else if (strcmp(name, "log_timestamp_precision") == 0) {
+      pConf->log_timestamp_precision = (strcmp(value, "us") == 0) ? 6 : (strcmp(value, "ms") == 0) ? 3 : 0;
+    } else if (strcmp(name, "log_timestamp_iso8601") == 0) {
+      pConf->log_timestamp_iso8601 = (strcmp(value, "yes") == 0) ? TRUE : FALSE;
     }
   }
   if (input != NULL) {
     fclose(input);
   }
 
+  // As gogoc-config does: leave room for the random part of the interval.
+  if (pConf->ra_min_interval * 4 > pConf->ra_max_interval * 3) {
+    DirectErrorMessage(GOGO_STR_RA_MIN_INTERVAL_TOO_LARGE);
+    errors++;
+  }
+
+  if (errors > 0) {
+    return make_status(CTX_CFGVALIDATION, ERR_INVAL_CFG_FILE);
+  }
+
   return make_status(CTX_CFGVALIDATION, SUCCESS);
 }
 #else
@@ -315,6 +424,10 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
 
   get_template( &(pConf->template) );
 
+  get_use_template( &(pConf->use_template) );
+
+  get_keep_tunnel( &(pConf->keep_tunnel) );
+
   get_if_tun_v6v4( &(pConf->if_tunnel_v6v4) );
 
   get_if_tun_v6udpv4( &(pConf->if_tunnel_v6udpv4) );
@@ -346,10 +459,22 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
 #endif /* V4V6_SUPPORT */
   free( szValue );  szValue = NULL;
 
+  get_if_tun_standby( &(pConf->if_tunnel_standby) );
+
+  get_standby_server( &(pConf->standby_server) );
+
   get_dns_server( &(pConf->dns_server) );
 
   get_ifprefix( &(pConf->if_prefix) );
 
+  get_ra_min_interval( &(pConf->ra_min_interval) );
+
+  get_ra_max_interval( &(pConf->ra_max_interval) );
+
+  get_route_table( &(pConf->route_table) );
+
+  get_route_fwmark( &(pConf->route_fwmark) );
+
   get_prefixlen( &(pConf->prefixlen) );
 
   get_retry_delay( &(pConf->retry_delay) );
@@ -376,6 +501,26 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
 
   get_log_rotation_del( &(pConf->log_rotation_delete) );
 
+  get_log_rotation_count( &(pConf->log_rotation_count) );
+
+  get_log_rotation_compress( &(pConf->log_rotation_compress) );
+
+  get_log_event_filename( &(pConf->log_event_filename) );
+
+  get_log_event_size( &(pConf->log_event_size) );
+
+  get_log_memory_filename( &(pConf->log_memory_filename) );
+
+  get_log_memory_size( &(pConf->log_memory_size) );
+
+  get_log_async( &(pConf->log_async) );
+
+  get_log_flush_interval( &(pConf->log_flush_interval) );
+
+  get_log_timestamp_precision( &(pConf->log_timestamp_precision) );
+
+  get_log_timestamp_iso8601( &(pConf->log_timestamp_iso8601) );
+
   get_log( STR_CONFIG_LOG_DESTINATION_STDERR, &(pConf->log_level_stderr) );
 
   get_log( STR_CONFIG_LOG_DESTINATION_SYSLOG, &(pConf->log_level_syslog) );
@@ -384,6 +529,10 @@ gogoc_status tspReadConfigFile( char* szFile, tConf* pConf )
 
   get_log( STR_CONFIG_LOG_DESTINATION_FILE, &(pConf->log_level_file) );
 
+  get_log( STR_CONFIG_LOG_DESTINATION_EVENT, &(pConf->log_level_event) );
+
+  get_log( STR_CONFIG_LOG_DESTINATION_MEMORY, &(pConf->log_level_memory) );
+
   get_auto_retry_connect( &(pConf->auto_retry_connect) );
 
   get_last_server_file( &(pConf->last_server_file) );
@@ -428,6 +577,7 @@ gogoc_status tspInitialize(sint32_t argc, char *argv[], tConf *pConf)
   tConf CmdLine;
   gogoc_status status = STATUS_SUCCESS_INIT;
   const char* cszTemplDir = "template";
+  const char* cszResolvCache = "gogoc-resolv.cache";
 
 
   // Hard-coded parameters. Not configurable anymore.
@@ -498,5 +648,19 @@ gogoc_status tspInitialize(sint32_t argc, char *argv[], tConf *pConf)
     sprintf(ScriptDir, "%s%c%s", TspHomeDir, DirSeparator, cszTemplDir);
   }
 
+  /* --------------------------------------------------------------------- */
+  /* The server name cache is kept in the gogoCLIENT directory, unless the */
+  /* configuration says otherwise.                                         */
+  /* --------------------------------------------------------------------- */
+  if( pConf->resolv_cache_file == NULL )
+  {
+    if( (pConf->resolv_cache_file = (char*)malloc( (size_t)(strlen(TspHomeDir)+strlen(cszResolvCache)+2)) ) == NULL )
+    {
+      DirectErrorMessage( STR_GEN_MALLOC_ERROR );
+      return make_status(CTX_CFGVALIDATION, ERR_MEMORY_STARVATION);
+    }
+    sprintf(pConf->resolv_cache_file, "%s%c%s", TspHomeDir, DirSeparator, cszResolvCache);
+  }
+
   return make_status(CTX_CFGVALIDATION, SUCCESS);
 }
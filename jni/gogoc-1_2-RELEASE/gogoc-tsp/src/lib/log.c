@@ -13,16 +13,39 @@
 
 #include "log.h"
 #include "config.h"
-#include "buffer.h"
 #include "hex_strings.h"
 
+#ifdef LOG_COMPRESS_SUPPORT
+#include <zlib.h>
+#endif
+
+#ifdef LOG_EVENT_SUPPORT
+#include "log_event.h"
+#endif
+
+#ifdef LOG_MEMORY_SUPPORT
+#include "log_memory.h"
+#endif
+
 static FILE *Logfp;
+static long LogFileSize;                // Bytes in the log file.
 static tLogConfiguration *LogConfiguration = NULL;
-static Buffer LogBuffer;
 
 int LogMutexInitialized = 0;
 pal_cs_t logMutex;
 
+volatile sint32_t LogLevelEnabled = LOG_LEVEL_DISABLED;
+
+#ifdef LOG_EVENT_SUPPORT
+static volatile sint32_t LogTextLevel = LOG_LEVEL_DISABLED;   // Highest level of the text destinations.
+static volatile sint32_t LogEventLevel = LOG_LEVEL_DISABLED;  // Level of the event log, once it is open.
+static int LogEventOpened = 0;
+#endif
+
+#ifdef LOG_MEMORY_SUPPORT
+static int LogMemoryOpened = 0;
+#endif
+
 
 // --------------------------------------------------------------------------
 // Returns a printable character representing a severity level.
@@ -43,105 +66,170 @@ char SeverityToChar( const enum tSeverityLevel sLvl )
 
 
 // --------------------------------------------------------------------------
-/* Generate a name for the backed up ('rotated') log file. */
-static int GetLogFileBackupName(char *filename, char *backupname)
+/* Name of a rotated log file: generation 1 is the most recent one. */
+static void LogGenerationName(char *filename, int generation, int compressed, char *name, size_t size)
 {
-  time_t t;
-  struct tm *tm;
-  char smallname[LOG_FILENAME_MAX_LENGTH];
-  char extension[LOG_FILENAME_MAX_LENGTH];
-  char *lastdot;
+  pal_snprintf(name, size, "%s.%d%s", filename, generation, compressed ? LOG_COMPRESSED_SUFFIX : "");
+}
 
-  if ((filename == NULL) || (backupname == NULL)) {
-    return 1;
+// --------------------------------------------------------------------------
+/* Make room for a new generation: the oldest one is removed, the other */
+/* ones are renamed one generation up, and the log file becomes the */
+/* first one. Each step is a rename(), whatever the size of the files. */
+static int ShiftLogGenerations(char *filename, int count)
+{
+  char from[LOG_FILENAME_MAX_LENGTH + 16];
+  char to[LOG_FILENAME_MAX_LENGTH + 16];
+  int generation, compressed;
+
+  if (count < 1) {
+    count = 1;
   }
 
-  /* Create a timestamp with the current date and time. */
-    if ((t = pal_time(NULL)) == (time_t)-1) {
-    return 1;
+  /* The oldest generation falls off. */
+  for (compressed = 0; compressed <= 1; compressed++) {
+    LogGenerationName(filename, count, compressed, to, sizeof(to));
+    remove(to);
   }
 
-    if ((tm = pal_localtime(&t)) == NULL) {
+  /* Move up the other ones, compressed or not. */
+  for (generation = count - 1; generation >= 1; generation--) {
+    for (compressed = 0; compressed <= 1; compressed++) {
+      LogGenerationName(filename, generation, compressed, from, sizeof(from));
+      LogGenerationName(filename, generation + 1, compressed, to, sizeof(to));
+      rename(from, to);
+    }
+  }
+
+  /* And the log file becomes generation 1. */
+  LogGenerationName(filename, 1, 0, to, sizeof(to));
+  if (rename(filename, to) != 0) {
     return 1;
   }
 
-  memset(smallname, 0, LOG_FILENAME_MAX_LENGTH);
-  memset(extension, 0, LOG_FILENAME_MAX_LENGTH);
+  return 0;
+}
+
+#ifdef LOG_COMPRESS_SUPPORT
+// --------------------------------------------------------------------------
+/* Compression of the rotated log files.                                   */
+/*                                                                          */
+/* With 'log_rotation_compress', a thread compresses generation 1 once it  */
+/* is renamed, so that the rotation itself only renames files. The next    */
+/* rotation waits for that thread before it renames the generations, which */
+/* only happens if the log fills up again before the compression is done.  */
+/* The thread must not log: the rotation waits for it with the log mutex   */
+/* held.                                                                    */
+/*                                                                          */
+static struct
+{
+  char                name[LOG_FILENAME_MAX_LENGTH + 16];
+  volatile uint32_t   running;
+  pal_thread_t        thread;
+} LogCompressor;
 
-  /* Find the last dot, which should be where the extension starts. */
-  lastdot = strrchr(filename, '.');
+// --------------------------------------------------------------------------
+/* Compress a rotated log file to <name>.gz, and remove it. On failure, */
+/* the file is kept as it is. */
+static pal_thread_ret_t PAL_THREAD_CALL LogCompressThread( void *arg )
+{
+  char *name = (char *)arg;
+  char gzname[LOG_FILENAME_MAX_LENGTH + 16];
+  char buffer[LOG_FILE_BUFFER_SIZE];
+  FILE *in;
+  gzFile out;
+  size_t len;
+  int ok = 1;
 
-  /* If we find an extension, split the filename in two */
-  if (lastdot != NULL) {
-    strncpy(smallname, filename, lastdot - filename);
-    strncpy(extension, lastdot, pal_strlen(lastdot));
+  pal_snprintf(gzname, sizeof(gzname), "%s%s", name, LOG_COMPRESSED_SUFFIX);
 
-    pal_snprintf(backupname, LOG_FILENAME_MAX_LENGTH, "%s.%04d%02d%02d%02d%02d%02d%s",
-                            smallname,
-                            tm->tm_year + 1900,
-                            tm->tm_mon + 1,
-                            tm->tm_mday,
-                            tm->tm_hour,
-                            tm->tm_min,
-                            tm->tm_sec,
-                            extension);
+  if( (in = fopen(name, "rb")) == NULL )
+  {
+    pal_thread_exit( 0 );
+    return 0;
   }
-  else {
-    pal_snprintf(backupname, LOG_FILENAME_MAX_LENGTH, "%s.%04d%02d%02d%02d%02d%02d",
-                            filename,
-                            tm->tm_year + 1900,
-                            tm->tm_mon + 1,
-                            tm->tm_mday,
-                            tm->tm_hour,
-                            tm->tm_min,
-                            tm->tm_sec);
+
+  if( (out = gzopen(gzname, "wb")) == NULL )
+  {
+    fclose(in);
+    pal_thread_exit( 0 );
+    return 0;
   }
 
+  while( (len = fread(buffer, 1, sizeof(buffer), in)) > 0 )
+  {
+    if( gzwrite(out, buffer, (unsigned)len) != (int)len )
+    {
+      ok = 0;
+      break;
+    }
+  }
+
+  if( ferror(in) )
+  {
+    ok = 0;
+  }
+  fclose(in);
+
+  if( gzclose(out) != Z_OK )
+  {
+    ok = 0;
+  }
+
+  remove(ok ? name : gzname);
+
+  pal_thread_exit( 0 );
   return 0;
 }
 
 // --------------------------------------------------------------------------
-/* Copy the original log file to the backup ('rotated') file. */
-static int CopyLogFileToBackup(char *filename, char *backupname)
+/* Wait for the compression of the previous generation, if any. */
+static void LogCompressWait(void)
 {
-  FILE *from, *to;
-    char buffer[MAX_LOG_LINE_LENGTH];
-
-  if ((filename == NULL) || (backupname == NULL)) {
-    return 1;
+  if( LogCompressor.running == 0 )
+  {
+    return;
   }
 
-  /* Open the source and destination files. */
-  if ((from = fopen(filename, "r")) == NULL) {
-    return 1;
-  }
+  pal_thread_join(LogCompressor.thread, NULL);
+  LogCompressor.running = 0;
+}
 
-  if ((to = fopen(backupname, "w+")) == NULL) {
-    fclose(from);
-    return 1;
+// --------------------------------------------------------------------------
+/* Compress generation 1 of the log file in the background. */
+static void LogCompressStart(char *filename)
+{
+  LogCompressWait();
+
+  LogGenerationName(filename, 1, 0, LogCompressor.name, sizeof(LogCompressor.name));
+  if( pal_thread_create(&LogCompressor.thread, &LogCompressThread, LogCompressor.name) == 0 )
+  {
+    LogCompressor.running = 1;
   }
+}
+#endif
 
-  /* Loop, reading line after line from the source file. */
-    while (fgets(buffer, MAX_LOG_LINE_LENGTH, from)) {
-    /* Copy each read line to the destination file. */
-    if (fputs(buffer, to) == EOF) {
-      fclose(from);
-      fclose(to);
 
-      return 1;
-    }
-    }
+// --------------------------------------------------------------------------
+/* Open the log file, with a buffer large enough for a batch of lines. */
+/* LogFileSize starts from the size of the file, and the writes to the */
+/* log file add to it. */
+static FILE *LogOpenFile(char *filename, char *mode)
+{
+  FILE *fp;
+  long size = 0;
 
-  /* Check if we stopped looping because something went wrong. */
-    if (!feof(from)) {
-    return 1;
-    }
+  fp = fopen(filename, mode);
+  if (fp != NULL) {
+    setvbuf(fp, NULL, _IOFBF, LOG_FILE_BUFFER_SIZE);
 
-  /* Close the source and destination files. */
-  fclose(from);
-  fclose(to);
+    if (fseek(fp, 0, SEEK_END) == 0) {
+      size = ftell(fp);
+    }
+    LogFileSize = (size > 0) ? size : 0;
+  }
 
-  return 0;
+  return fp;
 }
 
 
@@ -178,11 +266,11 @@ static int RotationPendingHook()
 
   /* Try to write to the open log file, if any. */
   if (Logfp != NULL) {
-    if (fprintf(Logfp, "%s", concat_buffer) < 0) {
+    if (fputs(concat_buffer, Logfp) == EOF) {
       return 1;
     }
     else {
-      fflush(Logfp);
+      LogFileSize += pal_strlen(concat_buffer);
       return 0;
     }
   }
@@ -194,12 +282,12 @@ static int RotationPendingHook()
 // --------------------------------------------------------------------------
 /* Rotate the log file. This basically means moving the file to a */
 /* new name, and continuing to write to the same filename but with the */
-/* previous contents gone. */
+/* previous contents gone. The file is renamed, never copied, so this */
+/* does not take longer for a larger log. */
 static int RotateLogFile( char *filename, int max_size, char *log_line )
 {
-  char backup_file_name[LOG_FILENAME_MAX_LENGTH + 1];
   size_t delta = 0;
-  long pos;
+  int status = 0;
 
   /* Make sure there's a valid file pointer. */
   if (Logfp == NULL) {
@@ -212,310 +300,917 @@ static int RotateLogFile( char *filename, int max_size, char *log_line )
     return 1;
   }
 
-  /* Flush to make sure everything is in sync. */
-  if (fflush(Logfp) != 0) {
-    // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_CANT_FLUSH);
-    return 1;
+  /* Determine the size of what we want to add to the file. */
+  if (log_line != NULL) {
+    delta = pal_strlen(log_line);
+  }
+
+  /* If we're not going to blow the limit, there's nothing to do. The */
+  /* size of the file is counted as it is written. */
+  if (LogFileSize + (long)delta < (long)max_size * 1024) {
+    return 0;
+  }
+
+  /* Need to do something before we close the file for rotation? */
+  if (RotationPendingHook() != 0) {
+    // Nothing for now
   }
 
-  /* Stat the file to get its size. */
-  pos = ftell(Logfp);
-  if( pos == -1 )
+  /* Close the file. */
+  fclose(Logfp);
+  Logfp = NULL;
+
+  /* If we're configured to delete rotated logs, the file is simply */
+  /* started over. Otherwise it becomes the first backup generation. */
+  if( LogConfiguration->delete_rotated_log == FALSE )
   {
-    // An error occurred.
+#ifdef LOG_COMPRESS_SUPPORT
+    /* The generations can't move while one of them is compressed. */
+    LogCompressWait();
+#endif
+
+    if (ShiftLogGenerations(filename, LogConfiguration->rotation_count) != 0) {
+      // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_CANT_COPY);
+      status = 1;
+    }
+  }
+
+  /* Reopen the current file, and start from scratch. */
+  if ((Logfp = LogOpenFile(filename, "w")) == NULL) {
+    // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_CANT_OPEN_NEW);
     return 1;
   }
 
-  /* Determine the size of what we want to add to the file. */
-  if (log_line != NULL) {
-    delta = pal_strlen(log_line);
+#ifdef LOG_COMPRESS_SUPPORT
+  if( status == 0 && LogConfiguration->delete_rotated_log == FALSE &&
+      LogConfiguration->compress_rotated_log == TRUE )
+  {
+    LogCompressStart(filename);
   }
+#endif
+
+  return status;
+}
+
+// --------------------------------------------------------------------------
+/* Send a message to syslog. */
+static int LogToSyslog(enum tSeverityLevel SeverityLvl, const char *FunctionName, const char *text)
+{
+#if defined(_DEBUG) || defined(DEBUG)
+  char buffer[MAX_LOG_LINE_LENGTH];
 
-  /* If we're going to blow the limit... */
-  if ((int)(pos + delta) >= (max_size * 1024))
+  /* Prepend the function name if it's a debug build. */
+  pal_snprintf(buffer, sizeof(buffer),  " %s: %s", FunctionName, text);
+  text = buffer;
+#endif
+
+  /* Send the message to syslog using the platform-specific code. */
+  /* Made this a switch case in case we want to do more stuff based */
+  /* on the log level in the future. */
+  switch( SeverityLvl )
   {
-    /* Need to do something before we close the file for rotation? */
-    if (RotationPendingHook() != 0) {
-      // Nothing for now
-    }
+    case ELError:
+      pal_syslog(LOG_ERR, "%s", text); break;
 
-    /* Close the file. */
-    fclose(Logfp);
+    case ELWarning:
+      pal_syslog(ELWarning, "%s", text); break;
+
+    case ELInfo:
+    case ELDebug:
+      pal_syslog(LOG_DEBUG, "%s", text); break;
+  }
 
-    /* If we're configured to delete rotated logs, skip this step. */
-    if( LogConfiguration->delete_rotated_log == FALSE )
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+/* Early log buffer.                                                        */
+/*                                                                          */
+/* Until the name of the log file is known, the lines logged to file are   */
+/* kept in a ring of LOG_EARLY_BUFFER_SIZE bytes, allocated once. When it   */
+/* is full, the oldest lines are dropped to make room, and counted. The     */
+/* ring is written to the log file in one write when it is opened.          */
+/*                                                                          */
+static struct
+{
+  char                data[LOG_EARLY_BUFFER_SIZE];
+  uint32_t            start;            // Offset of the oldest line.
+  uint32_t            length;           // Bytes of lines.
+  uint32_t            dropped;          // Lines dropped to make room.
+} LogEarly;
+
+// --------------------------------------------------------------------------
+/* Keep a line until the log file is open, dropping the oldest lines if */
+/* there is no room for it. */
+static void LogEarlyAppend(const char *line, size_t len)
+{
+  uint32_t end, i;
+
+  if( len > LOG_EARLY_BUFFER_SIZE )
+  {
+    len = LOG_EARLY_BUFFER_SIZE;
+  }
+
+  /* Drop the oldest lines, up to their newline, until the line fits. */
+  while( LogEarly.length + len > LOG_EARLY_BUFFER_SIZE )
+  {
+    for( i = 0; i < LogEarly.length; i++ )
     {
-      /* Get a file name to save the current file under. */
-      if (GetLogFileBackupName(filename, backup_file_name) != 0) {
-        // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_BACKUP_NAME);
-        return 1;
+      if( LogEarly.data[(LogEarly.start + i) % LOG_EARLY_BUFFER_SIZE] == '\n' )
+      {
+        break;
       }
+    }
+    i = (i < LogEarly.length) ? i + 1 : LogEarly.length;
+
+    LogEarly.start = (LogEarly.start + i) % LOG_EARLY_BUFFER_SIZE;
+    LogEarly.length -= i;
+    LogEarly.dropped++;
+  }
+
+  /* Copy the line after the newest one, wrapping around the end. */
+  end = (LogEarly.start + LogEarly.length) % LOG_EARLY_BUFFER_SIZE;
+  i = LOG_EARLY_BUFFER_SIZE - end;
+  if( len <= i )
+  {
+    memcpy(LogEarly.data + end, line, len);
+  }
+  else
+  {
+    memcpy(LogEarly.data + end, line, i);
+    memcpy(LogEarly.data, line + i, len - i);
+  }
+  LogEarly.length += (uint32_t)len;
+}
+
+// --------------------------------------------------------------------------
+/* Reverse the bytes of the early buffer from 'first' to 'last' excluded. */
+static void LogEarlyReverse(uint32_t first, uint32_t last)
+{
+  char c;
+
+  while( first + 1 < last )
+  {
+    c = LogEarly.data[first];
+    LogEarly.data[first++] = LogEarly.data[--last];
+    LogEarly.data[last] = c;
+  }
+}
+
+// --------------------------------------------------------------------------
+/* Write the early buffer to the log file, in one write, and empty it. */
+/* Returns the number of lines that were dropped. */
+static uint32_t LogEarlyFlush(void)
+{
+  uint32_t dropped = LogEarly.dropped;
+
+  if( Logfp != NULL && LogEarly.length > 0 )
+  {
+    /* Bring the oldest line to the start, in place. */
+    LogEarlyReverse(0, LogEarly.start);
+    LogEarlyReverse(LogEarly.start, LOG_EARLY_BUFFER_SIZE);
+    LogEarlyReverse(0, LOG_EARLY_BUFFER_SIZE);
+
+    if( fwrite(LogEarly.data, 1, LogEarly.length, Logfp) != LogEarly.length ||
+        fflush(Logfp) != 0 )
+    {
+      DirectErrorMessage(GOGO_STR_CANT_WRITE_LOG_BUFFER_TO_FILE);
+    }
+    LogFileSize += LogEarly.length;
+  }
+
+  LogEarly.start = 0;
+  LogEarly.length = 0;
+  LogEarly.dropped = 0;
+
+  return dropped;
+}
+
+
+// --------------------------------------------------------------------------
+/* Log timestamps.                                                          */
+/*                                                                          */
+/* Messages are stamped with the monotonic clock, which any thread can     */
+/* read without a lock. They get their wall clock time when they are        */
+/* formatted, under the log mutex, from a pair of readings of the two       */
+/* clocks taken together; the pair is taken again every LOG_CLOCK_SYNC      */
+/* seconds, to follow changes of the wall clock. The date and time up to    */
+/* the second are formatted once per second, and the fraction of a second   */
+/* appended to this prefix.                                                 */
+/*                                                                          */
+static struct
+{
+  struct timespec     mono;             // Clock pair, 'synced' when taken.
+  struct timeval      wall;
+  int                 synced;
+  time_t              second;           // Of the cached prefix.
+  sint32_t            iso8601;
+  char                prefix[80];       // Date and time, without the fraction.
+  size_t              length;
+} LogClock;
+
+// --------------------------------------------------------------------------
+/* Get the wall clock time of a monotonic timestamp. */
+static void LogWallClock(const struct timespec *mono, time_t *sec, uint32_t *usec)
+{
+  long long t;
+
+  if( LogClock.synced == 0 || mono->tv_sec - LogClock.mono.tv_sec >= LOG_CLOCK_SYNC )
+  {
+    pal_gettime_monotonic(&LogClock.mono);
+    pal_gettimeofday(&LogClock.wall);
+    LogClock.synced = 1;
+  }
+
+  t = (long long)LogClock.wall.tv_sec * 1000000 + LogClock.wall.tv_usec +
+      (long long)(mono->tv_sec - LogClock.mono.tv_sec) * 1000000 +
+      (mono->tv_nsec - LogClock.mono.tv_nsec) / 1000;
+
+  *sec = (time_t)(t / 1000000);
+  *usec = (uint32_t)(t % 1000000);
+}
+
+// --------------------------------------------------------------------------
+/* Format the timestamp of a log line: local date and time, or the UTC */
+/* time in ISO 8601 form, with 'digits' digits of the fraction of a second. */
+/* Returns the length of the timestamp, or 0 if there is none. */
+static size_t LogFormatTime(const struct timespec *mono, sint32_t digits, sint32_t iso8601, char *buffer, size_t size)
+{
+  struct tm *tm;
+  time_t sec;
+  uint32_t usec;
+  size_t len;
+
+  LogWallClock(mono, &sec, &usec);
+
+  /* Format the date and time once per second. */
+  if( sec != LogClock.second || iso8601 != LogClock.iso8601 || LogClock.length == 0 )
+  {
+    tm = iso8601 ? pal_gmtime(&sec) : pal_localtime(&sec);
+    if( tm == NULL )
+    {
+      return 0;
+    }
+
+    LogClock.length = pal_snprintf(LogClock.prefix, sizeof(LogClock.prefix),
+      iso8601 ? "%04d-%02d-%02dT%02d:%02d:%02d" : "%04d/%02d/%02d %02d:%02d:%02d",
+      (tm->tm_year+1900),
+      (tm->tm_mon+1),
+      tm->tm_mday,
+      tm->tm_hour,
+      tm->tm_min,
+      tm->tm_sec);
+    LogClock.second = sec;
+    LogClock.iso8601 = iso8601;
+  }
+
+  if( LogClock.length + 9 > size )
+  {
+    return 0;
+  }
+  memcpy(buffer, LogClock.prefix, LogClock.length);
+  len = LogClock.length;
+
+  /* The fraction of a second, then the time zone of ISO 8601. */
+  if( digits == 3 )
+  {
+    len += pal_snprintf(buffer + len, size - len, ".%03u", usec / 1000);
+  }
+  else if( digits == 6 )
+  {
+    len += pal_snprintf(buffer + len, size - len, ".%06u", usec);
+  }
+  if( iso8601 )
+  {
+    buffer[len++] = 'Z';
+  }
+  buffer[len] = '\0';
+
+  return len;
+}
+
+// --------------------------------------------------------------------------
+/* Format a log line as it is written to the log file: timestamp, severity, */
+/* identity, then the message without its EOL characters, and a newline.   */
+/* Returns the length of the line, or 0 if there is no timestamp.           */
+static size_t LogFormatLine(enum tSeverityLevel SeverityLvl, const struct timespec *t, const char *FunctionName, const char *text, char *line, size_t size)
+{
+  size_t i, len;
+
+
+  /* Get a timestamp to prepend to the message */
+  len = LogFormatTime(t, LogConfiguration->timestamp_digits, LogConfiguration->timestamp_iso8601, line, size);
+  if( len == 0 )
+  {
+    return 0;
+  }
+
+  /* Put the origin of the message in the buffer. */
+  len += pal_snprintf(line + len,
+    size - len,
+#if defined(_DEBUG) || defined(DEBUG)
+    " %c %s: %s: ",
+#else
+    " %c %s: ",
+#endif
+    SeverityToChar( SeverityLvl ),
+    LogConfiguration->identity == NULL ? "" : LogConfiguration->identity
+#if defined(_DEBUG) || defined(DEBUG)
+    , FunctionName == NULL ? "" : FunctionName
+#endif
+    );
+
+  if( len > size - 2 )
+  {
+    len = size - 2;
+  }
 
-      /* Copy the current contents to that backup file. */
-      if (CopyLogFileToBackup(filename, backup_file_name) != 0) {
-        // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_CANT_COPY);
-        return 1;
+  /* Append the message, without its EOL characters. */
+  for( i = 0; text[i] != '\0' && len < size - 2; i++ )
+  {
+    if( text[i] != '\r' && text[i] != '\n' )
+    {
+      line[len++] = text[i];
+    }
+  }
+
+  line[len++] = '\n';
+  line[len] = '\0';
+
+  return len;
+}
+
+// --------------------------------------------------------------------------
+/* Write a log message to the log file. The stream is only flushed when */
+/* 'flush' is set: the log writer flushes once per batch instead. */
+static int LogToFile(int buffer, enum tSeverityLevel SeverityLvl, const struct timespec *t, const char *FunctionName, const char *text, int flush)
+{
+  size_t len;
+  char temp_buffer[MAX_LOG_LINE_LENGTH];
+
+
+  /* We don't want to use the temporary file logging buffer, but we don't */
+  /* have an open file. That won't work. */
+  if( (Logfp == NULL) && (buffer == 0) )
+  {
+    return 1;
+  }
+
+  len = LogFormatLine(SeverityLvl, t, FunctionName, text, temp_buffer, sizeof(temp_buffer));
+  if( len == 0 )
+  {
+    return 1;
+  }
+
+
+  if( buffer != 0 )
+  {
+    /* If we're using the log file buffer (logging to file, but we don't */
+    /* know the file name yet), add the message to the buffer. */
+    LogEarlyAppend(temp_buffer, len);
+  }
+  else
+  {
+    /* Rotate the log file if required. */
+    if( LogConfiguration->log_rotation == TRUE )
+    {
+      if( RotateLogFile(LogConfiguration->log_filename, LogConfiguration->log_rotation_size, temp_buffer) != 0 )
+      {
       }
     }
 
-    /* Reopen the current file, and start from scratch. */
-    if ((Logfp = fopen(filename, "w")) == NULL) {
-      // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_ROTATE_LOG_CANT_OPEN_NEW);
+    /* Write the line to the log file. */
+    if( fputs(temp_buffer, Logfp) == EOF )
+    {
       return 1;
     }
+    LogFileSize += len;
 
+    /* Make sure everything is there by flushing the log file. */
+    if( flush && fflush(Logfp) != 0 )
+    {
+      return 1;
+    }
   }
 
   return 0;
 }
 
 // --------------------------------------------------------------------------
-/* Send a message to syslog. */
-static int LogToSyslog(int VerboseLevel, enum tSeverityLevel SeverityLvl, const char *FunctionName, char *Format, ...)
+/* Send a message to the console (stdout) or stderr */
+static int LogToLocal(FILE *location, const char *text)
 {
-  va_list argp;
-  char buffer[MAX_LOG_LINE_LENGTH];
-  char line_to_log[MAX_LOG_LINE_LENGTH];
+  /* location should be stdout or stderr. Print to that. */
+  if (fprintf(location, "%s\n", text) < 0) {
+    return 1;
+  }
 
-  va_start(argp, Format);
-  pal_vsnprintf(line_to_log, sizeof(line_to_log), Format, argp);
-  va_end(argp);
+  return 0;
+}
 
-  /* Store what we want to send to syslog in a buffer, prepending */
-  /* the function name if it's a debug build. */
-#if defined(_DEBUG) || defined(DEBUG)
-  pal_snprintf(buffer, sizeof(buffer),  " %s: %s", FunctionName, line_to_log);
-#else
-  pal_snprintf(buffer, sizeof(buffer),  "%s", line_to_log);
+#ifdef LOG_MEMORY_SUPPORT
+// --------------------------------------------------------------------------
+/* Write a log message to the memory ring, as it would be to the log file. */
+static int LogToMemory(enum tSeverityLevel SeverityLvl, const struct timespec *t, const char *FunctionName, const char *text)
+{
+  size_t len;
+  char line[MAX_LOG_LINE_LENGTH];
+
+  len = LogFormatLine(SeverityLvl, t, FunctionName, text, line, sizeof(line));
+  if( len == 0 )
+  {
+    return 1;
+  }
+
+  LogMemoryWrite(line, len);
+  return 0;
+}
 #endif
 
-  /* Send the message to syslog using the platform-specific code. */
-  /* Made this a switch case in case we want to do more stuff based */
-  /* on the log level in the future. */
-  switch( SeverityLvl )
+// --------------------------------------------------------------------------
+/* Send a formatted message to every destination whose level lets it */
+/* through. The log mutex must be held. */
+static void LogWrite(sint32_t VerboseLevel, enum tSeverityLevel SeverityLvl, const struct timespec *t, const char *func, const char *text, int flush)
+{
+  /* Level says we should log the message to the console. */
+  if( VerboseLevel <= LogConfiguration->log_level_console )
   {
-    case ELError:
-      pal_syslog(LOG_ERR, "%s", buffer); break;
+    /* Log to the console. */
+    LogToLocal( stdout, text );
+  }
 
-    case ELWarning:
-      pal_syslog(ELWarning, "%s", buffer); break;
+  /* Level says we should log the message to stderr. */
+  if( VerboseLevel <= LogConfiguration->log_level_stderr )
+  {
+    /* Log to stderr. */
+    LogToLocal( stderr, text );
+  }
+
+  /* Level says we should log the message to file. */
+  if( VerboseLevel <= LogConfiguration->log_level_file )
+  {
+    /* Log to file. */
+    LogToFile( LogConfiguration->buffer, SeverityLvl, t, func, text, flush );
+  }
+
+  /* Level says we should log the message to syslog. */
+  if( VerboseLevel <= LogConfiguration->log_level_syslog )
+  {
+    /* Log to syslog. */
+    LogToSyslog( SeverityLvl, func, text );
+  }
+
+#ifdef LOG_MEMORY_SUPPORT
+  /* Level says we should log the message to the memory ring. */
+  if( LogMemoryOpened && VerboseLevel <= LogConfiguration->log_level_memory )
+  {
+    /* Log to memory. */
+    LogToMemory( SeverityLvl, t, func, text );
+  }
+#endif
+}
+
+// --------------------------------------------------------------------------
+/* Asynchronous logging.                                                    */
+/*                                                                          */
+/* With 'log_async', Display() does not write: it formats the message on   */
+/* the calling thread, copies it in a slot of a bounded queue and returns.  */
+/* The log writer thread wakes up every 'log_flush_interval' milliseconds,  */
+/* writes the queued messages in order, and flushes the destinations once   */
+/* for the whole batch.                                                     */
+/*                                                                          */
+/* The queue takes no lock. Each slot has a sequence number: a producer     */
+/* owns slot 'pos' once it moved 'enqueue' past it, and hands it over by    */
+/* setting the sequence to pos + 1; the writer gives it back for the next   */
+/* round by setting it to pos + LOG_ASYNC_SLOTS. When the writer is behind  */
+/* and the queue is full, the message is dropped and counted instead of     */
+/* blocking the caller.                                                     */
+/*                                                                          */
+/* A message longer than a slot (the TSP exchanges) takes several          */
+/* consecutive slots, claimed at once, so that the caller never allocates.  */
+/* The first one holds the fields and the number of slots; the others only  */
+/* the rest of the text.                                                    */
+/*                                                                          */
+/* The request was for one ring per thread. The client creates and ends    */
+/* threads without any hook to register them, so the threads share one     */
+/* queue instead, which takes no lock either.                               */
+/*                                                                          */
+typedef struct stLogRecord
+{
+  volatile uint32_t   sequence;
+  uint32_t            parts;            // Slots of the message, first slot only.
+  sint32_t            level;
+  enum tSeverityLevel severity;
+  struct timespec     time;             // Monotonic clock.
+  const char *        func;
+  char                text[LOG_ASYNC_SLOT_SIZE];
+} tLogRecord;
+
+#define LOG_ASYNC_RECORD(pos)   (&LogQueue.slots[(pos) & (LOG_ASYNC_SLOTS - 1)])
+
+static struct
+{
+  tLogRecord *        slots;
+  volatile uint32_t   enqueue;          // Next slot to fill, shared by producers.
+  uint32_t            dequeue;          // Next slot to write, writer only.
+  volatile uint32_t   dropped;          // Messages lost to a full queue.
+  volatile uint32_t   running;          // Display() queues messages.
+  volatile uint32_t   producers;        // Display() calls queuing a message.
+  volatile uint32_t   stop;             // The writer must exit.
+  sint32_t            flush_interval;   // Milliseconds between batches.
+  pal_thread_t        thread;
+} LogQueue;
+
+
+// --------------------------------------------------------------------------
+/* Queue a formatted message for the log writer. */
+static void LogAsyncPush(sint32_t VerboseLevel, enum tSeverityLevel SeverityLvl, const char *func, const char *text)
+{
+  tLogRecord *record;
+  uint32_t pos, seq, parts, i;
+  size_t len, chunk;
+
+  /* The text and its nul, in slots of LOG_ASYNC_SLOT_SIZE bytes. */
+  len = pal_strlen(text) + 1;
+  parts = (uint32_t)((len + LOG_ASYNC_SLOT_SIZE - 1) / LOG_ASYNC_SLOT_SIZE);
+
+  /* Claim the next free slots. The writer frees them in order, so they */
+  /* are all free once the last one is. */
+  pos = pal_atomic_get(&LogQueue.enqueue);
+  for( ;; )
+  {
+    seq = pal_atomic_get(&LOG_ASYNC_RECORD(pos + parts - 1)->sequence);
+
+    if( seq == pos + parts - 1 )
+    {
+      if( pal_atomic_cas(&LogQueue.enqueue, pos, pos + parts) )
+      {
+        break;
+      }
+    }
+    else if( (sint32_t)(seq - (pos + parts - 1)) < 0 )
+    {
+      /* The queue is full. */
+      pal_atomic_add(&LogQueue.dropped, 1);
+      return;
+    }
+
+    pos = pal_atomic_get(&LogQueue.enqueue);
+  }
+
+  record = LOG_ASYNC_RECORD(pos);
+  record->parts = parts;
+  record->level = VerboseLevel;
+  record->severity = SeverityLvl;
+  pal_gettime_monotonic(&record->time);
+  record->func = func;
+
+  /* Copy the message, and hand the slots to the writer, the first one */
+  /* last: the writer starts from it. */
+  for( i = parts; i-- > 0; )
+  {
+    chunk = len - i * LOG_ASYNC_SLOT_SIZE;
+    if( chunk > LOG_ASYNC_SLOT_SIZE )
+    {
+      chunk = LOG_ASYNC_SLOT_SIZE;
+    }
+    memcpy(LOG_ASYNC_RECORD(pos + i)->text, text + i * LOG_ASYNC_SLOT_SIZE, chunk);
+    pal_atomic_set(&LOG_ASYNC_RECORD(pos + i)->sequence, pos + i + 1);
+  }
+}
+
+// --------------------------------------------------------------------------
+/* Write the queued messages, and flush the destinations once. */
+/* Returns the number of messages written. */
+static int LogAsyncDrain(void)
+{
+  tLogRecord *record;
+  uint32_t dropped, parts, i;
+  struct timespec now;
+  int written = 0;
+  char buffer[MAX_LOG_LINE_LENGTH];
+  char message[MAX_LOG_MESSAGE_LENGTH];
+  const char *text;
+
+  pal_enter_cs(&logMutex);
+
+  for( ;; )
+  {
+    record = LOG_ASYNC_RECORD(LogQueue.dequeue);
+    if( pal_atomic_get(&record->sequence) != LogQueue.dequeue + 1 )
+    {
+      /* Empty, or the producer is still copying the message. */
+      break;
+    }
+
+    /* A long message is put back together from its slots. */
+    parts = record->parts;
+    text = record->text;
+    if( parts > 1 )
+    {
+      for( i = 0; i < parts; i++ )
+      {
+        memcpy(message + i * LOG_ASYNC_SLOT_SIZE, LOG_ASYNC_RECORD(LogQueue.dequeue + i)->text,
+               sizeof(message) - i * LOG_ASYNC_SLOT_SIZE < LOG_ASYNC_SLOT_SIZE ?
+               sizeof(message) - i * LOG_ASYNC_SLOT_SIZE : LOG_ASYNC_SLOT_SIZE);
+      }
+      message[sizeof(message) - 1] = '\0';
+      text = message;
+    }
+
+    LogWrite(record->level, record->severity, &record->time, record->func, text, 0);
+
+    /* Give the slots back to the producers. */
+    for( i = 0; i < parts; i++ )
+    {
+      pal_atomic_set(&LOG_ASYNC_RECORD(LogQueue.dequeue)->sequence, LogQueue.dequeue + LOG_ASYNC_SLOTS);
+      LogQueue.dequeue++;
+    }
+    written++;
+  }
+
+  /* Report the messages that were dropped. */
+  do
+  {
+    dropped = pal_atomic_get(&LogQueue.dropped);
+  } while( dropped != 0 && !pal_atomic_cas(&LogQueue.dropped, dropped, 0) );
+
+  if( dropped != 0 )
+  {
+    pal_gettime_monotonic(&now);
+    pal_snprintf(buffer, sizeof(buffer), GOGO_STR_LOG_DROPPED, dropped);
+    LogWrite(LOG_LEVEL_1, ELWarning, &now, "LogAsyncDrain", buffer, 0);
+    written++;
+  }
 
-    case ELInfo:
-    case ELDebug:
-      pal_syslog(LOG_DEBUG, "%s", buffer); break;
+  /* One write per destination for the whole batch. */
+  if( written > 0 )
+  {
+    if( Logfp != NULL )
+    {
+      fflush(Logfp);
+    }
+    fflush(stdout);
   }
 
-  return 0;
+  pal_leave_cs(&logMutex);
+
+  return written;
 }
 
 // --------------------------------------------------------------------------
-/* Dump a line of log that was stored in a buffer to file. */
-static int LogBufferLineToFile(char *LogLine, tLogConfiguration *configuration, int *OutputBufferChars)
+/* The log writer thread. It comes back sooner when the queue was */
+/* more than half full, to keep up with bursts. */
+static pal_thread_ret_t PAL_THREAD_CALL LogWriterThread( void *arg )
 {
-  char buffer[MAX_LOG_LINE_LENGTH];
-  int output_chars;
+  (void)arg;
 
-  /* No configuration is bad. */
-  if (configuration == NULL) {
-    // [Temp removal] DirectErrorMessage(GOGO_STR_NO_CONFIG_CANNOT_LOG_TO_FILE);
-    *OutputBufferChars = 0;
-    return 1;
+  while( pal_atomic_get(&LogQueue.stop) == 0 )
+  {
+    if( LogAsyncDrain() >= LOG_ASYNC_SLOTS / 2 )
+    {
+      pal_sleep(1);
+    }
+    else
+    {
+      pal_sleep(LogQueue.flush_interval);
+    }
   }
 
-  /* No log filename in the configuration is bad. */
-  if (configuration->log_filename == NULL) {
-    // [Temp removal] DirectErrorMessage(GOGO_STR_NO_LOG_FILENAME_IN_CONFIG);
-    *OutputBufferChars = 0;
-    return 1;
-  }
+  /* Write what was queued before the stop. */
+  LogAsyncDrain();
 
-  /* A closed logging file is bad. */
-  if (Logfp == NULL) {
-    // [Temp removal] DirectErrorMessage(GOGO_STR_LOG_FILE_CLOSED, configuration->log_filename);
-    *OutputBufferChars = 0;
-    return 1;
-  }
+  pal_thread_exit( 0 );
+  return 0;
+}
 
-  /* Trying to dump nothing is bad. */
-  if (LogLine == NULL) {
-    *OutputBufferChars = 0;
-    return 1;
-  }
+// --------------------------------------------------------------------------
+/* Start queuing messages for the log writer. */
+static int LogAsyncStart(sint32_t flush_interval)
+{
+  uint32_t i;
 
-  /* Write to a local temporary buffer */
-  output_chars = pal_snprintf(buffer, sizeof(buffer), "%s", LogLine);
+  if( LogQueue.slots == NULL )
+  {
+    LogQueue.slots = (tLogRecord *)pal_malloc(LOG_ASYNC_SLOTS * sizeof(tLogRecord));
+    if( LogQueue.slots == NULL )
+    {
+      return 1;
+    }
 
-  /* Rotate the log file (if needed) before we write this new line. */
-  if (configuration->log_rotation == TRUE) {
-    if (RotateLogFile(configuration->log_filename, configuration->log_rotation_size, buffer) != 0) {
-      // [Temp removal] DirectErrorMessage(GOGO_STR_ERR_ROTATING_LOG_FILE);
+    for( i = 0; i < LOG_ASYNC_SLOTS; i++ )
+    {
+      LogQueue.slots[i].sequence = i;
     }
+    LogQueue.enqueue = 0;
+    LogQueue.dequeue = 0;
   }
 
-  /* Write the contents of the local temporary buffer to the log file. */
-  if (fprintf(Logfp, "%s", buffer) < 0) {
-    // [Temp removal] DirectErrorMessage(GOGO_STR_CANT_FPRINTF_TO_LOG);
-    *OutputBufferChars = 0;
-    return 1;
-  }
+  LogQueue.flush_interval = flush_interval > 0 ? flush_interval : DEFAULT_LOG_FLUSH_INTERVAL;
+  LogQueue.stop = 0;
 
-  /* Flush to make sure everything is in the file. */
-  if (fflush(Logfp) != 0) {
-    *OutputBufferChars = 0;
+  if( pal_thread_create(&LogQueue.thread, &LogWriterThread, NULL) != 0 )
+  {
     return 1;
   }
 
-  *OutputBufferChars = output_chars;
-
+  pal_atomic_set(&LogQueue.running, 1);
   return 0;
 }
 
-
 // --------------------------------------------------------------------------
-/* Write a log message to the log file. */
-static int LogToFile(int buffer, enum tSeverityLevel SeverityLvl, const char *FunctionName, char *Format, ...)
+/* Stop the log writer, once the queued messages are written. Display() */
+/* writes synchronously again. The writer is stopped once the Display() */
+/* calls that saw it running are done queuing, so that its last drain */
+/* writes their messages, and no slot is used after LogClose frees them. */
+static void LogAsyncStop(void)
 {
-  va_list argp;
-  time_t t;
-  struct tm *tm;
-  char *s1, *s2;
-  size_t i, j;
-  char line_to_log[MAX_LOG_LINE_LENGTH];
-  char temp_buffer[MAX_LOG_LINE_LENGTH];
-
-
-  /* We don't want to use the temporary file logging buffer, but we don't */
-  /* have an open file. That won't work. */
-  if( (Logfp == NULL) && (buffer == 0) )
+  if( pal_atomic_get(&LogQueue.running) == 0 )
   {
-    return 1;
+    return;
   }
 
-  va_start(argp, Format);
-  pal_vsnprintf(line_to_log, sizeof(line_to_log), Format, argp);
-  va_end(argp);
-
-  /* Get a timestamp to prepend to the message */
-  t = pal_time(NULL);
-  if( t == (time_t)-1 )
+  pal_atomic_set(&LogQueue.running, 0);
+  while( pal_atomic_get(&LogQueue.producers) != 0 )
   {
-    return 1;
+    pal_sleep(1);
   }
 
-  tm = pal_localtime(&t);
-  if( tm == NULL )
+  pal_atomic_set(&LogQueue.stop, 1);
+  pal_thread_join(LogQueue.thread, NULL);
+}
+
+// --------------------------------------------------------------------------
+/* Rate limits.                                                             */
+/*                                                                          */
+/* A message goes through the limit of its call site (tLogSite, in the     */
+/* Display() macro), then through the token bucket of its severity: the    */
+/* bucket gains LOG_RATE_PER_SECOND tokens a second, up to LOG_RATE_BURST,  */
+/* and a message takes one. What is over a limit is counted and dropped     */
+/* before it is formatted, so that a failure loop costs a few atomic        */
+/* operations per message instead of a write. The counts are logged with   */
+/* the next message that gets through. The limits take no lock; under       */
+/* contention they are approximate.                                         */
+/*                                                                          */
+static struct
+{
+  volatile uint32_t   tokens;
+  volatile uint32_t   refill;           // Second of the last refill.
+  volatile uint32_t   dropped;          // Messages without a token, not reported yet.
+} LogBucket[ELDebug + 1];
+
+// --------------------------------------------------------------------------
+/* Take the count of a counter, and reset it. */
+static uint32_t LogTakeCount(volatile uint32_t *counter)
+{
+  uint32_t count;
+
+  do
   {
-    return 1;
-  }
+    count = pal_atomic_get(counter);
+  } while( count != 0 && !pal_atomic_cas(counter, count, 0) );
+
+  return count;
+}
 
-  i = pal_strlen(line_to_log);
-  s1 = s2 = malloc(i + 1);
+// --------------------------------------------------------------------------
+/* Count a message against the limit of its call site. */
+/* Returns 1 if it may be logged, 0 if it is over the limit. */
+static int LogSiteAllow(tLogSite *site, uint32_t now)
+{
+  uint32_t period = pal_atomic_get(&site->period);
 
-  if( s1 == NULL )
+  /* A new period starts over. */
+  if( now - period >= LOG_SITE_PERIOD && pal_atomic_cas(&site->period, period, now) )
   {
-    return 1;
+    pal_atomic_set(&site->count, 0);
   }
 
-  /* Remove EOL characters from the message */
-  for( j = 0;j < i; j++ )
+  if( pal_atomic_add(&site->count, 1) > LOG_SITE_BURST )
   {
-    if( line_to_log[j] != '\r' && line_to_log[j] != '\n' )
-    {
-      *s1++ = line_to_log[j];
-    }
+    pal_atomic_add(&site->suppressed, 1);
+    return 0;
   }
 
-  *s1++ = '\0';
-
-  /* Concatenate everything into one single local buffer. */
-  pal_snprintf(temp_buffer,
-    sizeof(temp_buffer),
-#if defined(_DEBUG) || defined(DEBUG)
-    "%04d/%02d/%02d %02d:%02d:%02d %c %s: %s: %s\n",
-#else
-    "%04d/%02d/%02d %02d:%02d:%02d %c %s: %s\n",
-#endif
-    (tm->tm_year+1900),
-    (tm->tm_mon+1),
-    tm->tm_mday,
-    tm->tm_hour,
-    tm->tm_min,
-    tm->tm_sec,
-    SeverityToChar( SeverityLvl ),
-    LogConfiguration->identity == NULL ? "" : LogConfiguration->identity,
-#if defined(_DEBUG) || defined(DEBUG)
-    FunctionName == NULL ? "" : FunctionName,
-#endif
-    s2 );
-
-  free(s2);
+  return 1;
+}
 
+// --------------------------------------------------------------------------
+/* Take a token from the bucket of a severity. */
+/* Returns 1 if there was one, 0 if the message must be dropped. */
+static int LogBucketAllow(enum tSeverityLevel SeverityLvl, uint32_t now)
+{
+  uint32_t refill, tokens, added;
 
-  if( buffer != 0 )
+  /* Add the tokens of the seconds since the last refill. */
+  refill = pal_atomic_get(&LogBucket[SeverityLvl].refill);
+  if( now != refill && pal_atomic_cas(&LogBucket[SeverityLvl].refill, refill, now) )
   {
-    /* If we're using the log file buffer (logging to file, but we don't */
-    /* know the file name yet), add the message to the buffer. */
-    buffer_append(&LogBuffer, (void *)temp_buffer, pal_strlen(temp_buffer) + 1);
+    added = (now - refill < LOG_RATE_BURST / LOG_RATE_PER_SECOND + 1) ?
+      (now - refill) * LOG_RATE_PER_SECOND : LOG_RATE_BURST;
+    do
+    {
+      tokens = pal_atomic_get(&LogBucket[SeverityLvl].tokens);
+    } while( !pal_atomic_cas(&LogBucket[SeverityLvl].tokens, tokens,
+      (tokens + added > LOG_RATE_BURST) ? LOG_RATE_BURST : tokens + added) );
   }
-  else
+
+  do
   {
-    /* Rotate the log file if required. */
-    if( LogConfiguration->log_rotation == TRUE )
+    tokens = pal_atomic_get(&LogBucket[SeverityLvl].tokens);
+    if( tokens == 0 )
     {
-      if( RotateLogFile(LogConfiguration->log_filename, LogConfiguration->log_rotation_size, temp_buffer) != 0 )
-      {
-      }
+      pal_atomic_add(&LogBucket[SeverityLvl].dropped, 1);
+      return 0;
     }
+  } while( !pal_atomic_cas(&LogBucket[SeverityLvl].tokens, tokens, tokens - 1) );
 
-    /* Write the concatenated string to the log file. */
-    if( fprintf(Logfp, "%s", temp_buffer) < 0 )
-    {
-      return 1;
-    }
+  return 1;
+}
 
-    /* Make sure everything is there by flushing the log file. */
-    if( fflush(Logfp) != 0 )
-    {
-      return 1;
-    }
-  }
+// --------------------------------------------------------------------------
+/* Runtime log levels.                                                      */
+/*                                                                          */
+/* LogSetLevels changes the levels of the console, the log file and syslog */
+/* while the client runs, and recomputes the level of the Display() macro   */
+/* under the log mutex, so that a message sees either the old levels or     */
+/* the new ones. A destination the configuration left disabled stays so:    */
+/* its file or syslog is not open. With a duration, the change is a burst:  */
+/* the levels in place before it come back with the first message logged   */
+/* once it is over.                                                         */
+/*                                                                          */
+static struct
+{
+  sint32_t            file_open;        // The configuration enabled the destination.
+  sint32_t            syslog_open;
+  volatile uint32_t   active;           // A burst is running.
+  struct timespec     until;            // End of the burst, monotonic clock.
+  sint32_t            console;          // Levels to restore at the end of the burst.
+  sint32_t            file;
+  sint32_t            syslog;
+} LogBurst;
 
-  return 0;
-}
+static void LogUpdateLevelEnabled(void);
 
 // --------------------------------------------------------------------------
-/* Send a message to the console (stdout) or stderr */
-static int LogToLocal(FILE *location, char *Format, ...)
+/* End the burst if it is over, and restore the levels it replaced. */
+/* Returns 1 if it ended. */
+static int LogBurstEnd(void)
 {
-  static char buffer[MAX_LOG_LINE_LENGTH];
-  va_list argp;
+  struct timespec now;
+  sint32_t console = 0, file = 0, syslog = 0;
+  int ended = 0;
 
-  va_start(argp, Format);
+  pal_gettime_monotonic(&now);
+  if( now.tv_sec < LogBurst.until.tv_sec ||
+      (now.tv_sec == LogBurst.until.tv_sec && now.tv_nsec < LogBurst.until.tv_nsec) )
+  {
+    return 0;
+  }
 
-  pal_vsnprintf(buffer, sizeof(buffer), Format, argp);
+  pal_enter_cs(&logMutex);
 
-  va_end(argp);
+  /* Another thread may have ended it first. */
+  if( pal_atomic_get(&LogBurst.active) != 0 && LogConfiguration != NULL )
+  {
+    LogConfiguration->log_level_console = LogBurst.console;
+    LogConfiguration->log_level_file = LogBurst.file;
+    LogConfiguration->log_level_syslog = LogBurst.syslog;
+    console = LogBurst.console;
+    file = LogBurst.file;
+    syslog = LogBurst.syslog;
+    pal_atomic_set(&LogBurst.active, 0);
+    LogUpdateLevelEnabled();
+    ended = 1;
+  }
 
-  /* location should be stdout or stderr. Print to that. */
-  if (fprintf(location, "%s\n", buffer) < 0) {
-    return 1;
+  pal_leave_cs(&logMutex);
+
+  if( ended )
+  {
+    LogDisplay(NULL, LOG_LEVEL_1, ELInfo, "LogBurstEnd", GOGO_STR_LOG_BURST_ENDED,
+      console, file, syslog);
   }
 
-  return 0;
+  return ended;
 }
 
 // --------------------------------------------------------------------------
-// This function is the main logging function.
+// This function is the main logging function, called through the Display()
+// macro once the level is known to be enabled.
 // Input:
+// - site:         The rate limit of the call site, NULL for none.
 // - VerboseLevel: The internal verbosity level assigned to the message.
 // - SeverityLvl:  The message severity
 //
-void Display(int VerboseLevel, enum tSeverityLevel SeverityLvl, const char *func, char *format, ...)
+void LogDisplay(tLogSite *site, int VerboseLevel, enum tSeverityLevel SeverityLvl, const char *func, char *format, ...)
 {
   va_list argp;
   int i, j;
-  char fmt[5000];
-  char clean[5000];
+  uint32_t now, count;
+  struct timespec stamp;
+  char fmt[MAX_LOG_MESSAGE_LENGTH];
+  char clean[MAX_LOG_MESSAGE_LENGTH];
 
 #if !defined(_DEBUG) && !defined(DEBUG)
   // This is a RELEASE build. Remove debug messages.
@@ -525,8 +1220,49 @@ void Display(int VerboseLevel, enum tSeverityLevel SeverityLvl, const char *func
   }
 #endif
 
+  /* The message may only have been let through by a burst that is over. */
+  if( pal_atomic_get(&LogBurst.active) != 0 && LogBurstEnd() != 0 &&
+      VerboseLevel > LogLevelEnabled )
+  {
+    return;
+  }
 
-  pal_enter_cs(&logMutex);
+  if( site != NULL )
+  {
+    now = (uint32_t)pal_time(NULL);
+    if( LogSiteAllow(site, now) == 0 || LogBucketAllow(SeverityLvl, now) == 0 )
+    {
+      return;
+    }
+
+    /* Report what the limits held back. */
+    if( (count = LogTakeCount(&LogBucket[SeverityLvl].dropped)) != 0 )
+    {
+      LogDisplay(NULL, LOG_LEVEL_1, ELWarning, "LogDisplay", GOGO_STR_LOG_RATE_DROPPED,
+        count, SeverityToChar(SeverityLvl), LOG_RATE_PER_SECOND);
+    }
+    if( (count = LogTakeCount(&site->suppressed)) != 0 )
+    {
+      LogDisplay(NULL, VerboseLevel, SeverityLvl, func, GOGO_STR_LOG_REPEATED,
+        func == NULL ? "" : func, count);
+    }
+  }
+
+#ifdef LOG_EVENT_SUPPORT
+  /* The event log takes the arguments as they are. */
+  if( VerboseLevel <= LogEventLevel )
+  {
+    va_start(argp, format);
+    LogEventWrite( VerboseLevel, SeverityLvl, format, argp );
+    va_end(argp);
+  }
+
+  /* No need to format what no text destination logs. */
+  if( VerboseLevel > LogTextLevel )
+  {
+    return;
+  }
+#endif
 
   va_start(argp, format);
   pal_vsnprintf(fmt, sizeof(fmt), format, argp);
@@ -547,40 +1283,28 @@ void Display(int VerboseLevel, enum tSeverityLevel SeverityLvl, const char *func
     }
   }
 
-  if( LogConfiguration == NULL )
+  /* Leave the writing to the log writer thread. */
+  pal_atomic_add(&LogQueue.producers, 1);
+  if( pal_atomic_get(&LogQueue.running) != 0 )
   {
-    pal_leave_cs(&logMutex);
+    LogAsyncPush( VerboseLevel, SeverityLvl, func, clean );
+    pal_atomic_add(&LogQueue.producers, -1);
     return;
   }
+  pal_atomic_add(&LogQueue.producers, -1);
 
+  /* Stamp the message before waiting for the log mutex. */
+  pal_gettime_monotonic(&stamp);
 
-  /* Level says we should log the message to the console. */
-  if( VerboseLevel <= LogConfiguration->log_level_console )
-  {
-    /* Log to the console. */
-    LogToLocal( stdout, clean );
-  }
-
-  /* Level says we should log the message to stderr. */
-  if( VerboseLevel <= LogConfiguration->log_level_stderr )
-  {
-    /* Log to stderr. */
-    LogToLocal( stderr, clean );
-  }
+  pal_enter_cs(&logMutex);
 
-  /* Level says we should log the message to file. */
-  if( VerboseLevel <= LogConfiguration->log_level_file )
+  if( LogConfiguration == NULL )
   {
-    /* Log to file. */
-    LogToFile( LogConfiguration->buffer, SeverityLvl, func, clean );
+    pal_leave_cs(&logMutex);
+    return;
   }
 
-  /* Level says we should log the message to syslog. */
-  if( VerboseLevel <= LogConfiguration->log_level_syslog )
-  {
-    /* Log to syslog. */
-    LogToSyslog( VerboseLevel, SeverityLvl, func, clean );
-  }
+  LogWrite( VerboseLevel, SeverityLvl, &stamp, func, clean, 1 );
 
   pal_leave_cs(&logMutex);
 }
@@ -648,6 +1372,7 @@ int DirectErrorMessage(char *message, ...)
   /* Try to write to the open log file, if any. */
   if (Logfp != NULL) {
     if (fprintf(Logfp, "%s", concat_buffer) >= 0) {
+      LogFileSize += pal_strlen(concat_buffer);
       fflush(Logfp);
       pal_leave_cs(&logMutex);
       return 0;
@@ -690,6 +1415,33 @@ int DirectErrorMessage(char *message, ...)
 }
 
 
+// --------------------------------------------------------------------------
+/* Recompute the highest level of the destinations, for the Display() */
+/* macro. */
+static void LogUpdateLevelEnabled(void)
+{
+  sint32_t level = LOG_LEVEL_DISABLED;
+
+  if (LogConfiguration != NULL) {
+    if (LogConfiguration->log_level_console > level) level = LogConfiguration->log_level_console;
+    if (LogConfiguration->log_level_stderr > level) level = LogConfiguration->log_level_stderr;
+    if (LogConfiguration->log_level_file > level) level = LogConfiguration->log_level_file;
+    if (LogConfiguration->log_level_syslog > level) level = LogConfiguration->log_level_syslog;
+#ifdef LOG_MEMORY_SUPPORT
+    if (LogMemoryOpened && LogConfiguration->log_level_memory > level) level = LogConfiguration->log_level_memory;
+#endif
+  }
+
+#ifdef LOG_EVENT_SUPPORT
+  LogTextLevel = level;
+  LogEventLevel = (LogEventOpened && LogConfiguration != NULL) ? LogConfiguration->log_level_event : LOG_LEVEL_DISABLED;
+  if (LogEventLevel > level) level = LogEventLevel;
+#endif
+
+  LogLevelEnabled = level;
+}
+
+
 // --------------------------------------------------------------------------
 /* Free a logging configuration object that we have allocated. */
 static void FreeLogConfiguration(tLogConfiguration *configuration)
@@ -704,6 +1456,14 @@ static void FreeLogConfiguration(tLogConfiguration *configuration)
     if (configuration->log_filename != NULL) {
       free(configuration->log_filename);
     }
+    /* 'event_filename' comes from a strdup(). */
+    if (configuration->event_filename != NULL) {
+      free(configuration->event_filename);
+    }
+    /* 'memory_filename' comes from a strdup(). */
+    if (configuration->memory_filename != NULL) {
+      free(configuration->memory_filename);
+    }
 
     free(configuration);
   }
@@ -713,17 +1473,7 @@ static void FreeLogConfiguration(tLogConfiguration *configuration)
 /* Configure the logging system with the values in the configuration structure. */
 int LogConfigure(tLogConfiguration *configuration)
 {
-  /* We have to initialize the file logging buffer once. */
-  /* Once we've done it, remember it. */
-  static int LogBufferInitialized = 0;
-  int OutputBufferChars = 0;
-
-  /* If we haven't done so already, initialize the */
-  /* file logging buffer. */
-  if (LogBufferInitialized == 0) {
-    buffer_init(&LogBuffer);
-    LogBufferInitialized = 1;
-  }
+  uint32_t dropped = 0;
 
   /* If we haven't done so already, initialize the */
   /* logging mutex. */
@@ -732,6 +1482,10 @@ int LogConfigure(tLogConfiguration *configuration)
     LogMutexInitialized = 1;
   }
 
+  /* Write what is queued with the current configuration, and log */
+  /* synchronously until the new one is in place. */
+  LogAsyncStop();
+
   /* We expect to be sent a configuration to use... */
   if (configuration == NULL) {
     DirectErrorMessage(GOGO_STR_LOG_CFG_RECEIVED_NULL_CFG);
@@ -762,7 +1516,7 @@ int LogConfigure(tLogConfiguration *configuration)
 
           /* We then need to open the logging file again using the new */
           /* logging file name. */
-          if ((Logfp = fopen(configuration->log_filename, "a")) == NULL) {
+          if ((Logfp = LogOpenFile(configuration->log_filename, "a")) == NULL) {
                 DirectErrorMessage(GOGO_STR_CANNOT_OPEN_LOG_FILE, configuration->log_filename);
 
             if (LogConfiguration != NULL) {
@@ -779,7 +1533,7 @@ int LogConfigure(tLogConfiguration *configuration)
       /* Otherwise, there's no configuration file currently open. */
       else {
         /* Therefore, we open the file using the file name specified in the configuration. */
-        if ((Logfp = fopen(configuration->log_filename, "a")) == NULL) {
+        if ((Logfp = LogOpenFile(configuration->log_filename, "a")) == NULL) {
           DirectErrorMessage(GOGO_STR_CANNOT_OPEN_LOG_FILE, configuration->log_filename);
 
           if (LogConfiguration != NULL) {
@@ -794,25 +1548,16 @@ int LogConfigure(tLogConfiguration *configuration)
       }
 
 
-      /* While there's something in the buffer... */
-      while (buffer_len(&LogBuffer) > 0) {
-        /* Write the next line of logging data to the log file */
-        if (LogBufferLineToFile(buffer_ptr(&LogBuffer), configuration, &OutputBufferChars) != 0) {
-          DirectErrorMessage(GOGO_STR_CANT_WRITE_LOG_BUFFER_TO_FILE);
-        }
-        OutputBufferChars++;
-        /* And 'consume' the characters we just dumped to file */
-        buffer_consume(&LogBuffer, OutputBufferChars);
-      }
-
-      /* Reset the log file buffer. */
-      buffer_clear(&LogBuffer);
+      /* Write what was logged before the file was known. */
+      dropped = LogEarlyFlush();
     }
   }
   /* If the configuration to apply says we don't want to log to file... */
   else {
     /* Reset the log file buffer. */
-    buffer_clear(&LogBuffer);
+    LogEarly.start = 0;
+    LogEarly.length = 0;
+    LogEarly.dropped = 0;
 
     /* If the log file is currently open, flush the contents and close it. */
     if (Logfp != NULL) {
@@ -859,26 +1604,174 @@ int LogConfigure(tLogConfiguration *configuration)
     }
   }
 
+#ifdef LOG_EVENT_SUPPORT
+  /* If the configuration to apply says we want the event log... */
+  if ((configuration->log_level_event > LOG_LEVEL_DISABLED) && (configuration->event_filename != NULL)) {
+    /* Keep the ring that is open, unless its file or size changed. */
+    if ((LogEventOpened == 0) || (LogConfiguration == NULL) || (LogConfiguration->event_filename == NULL) ||
+    (strcmp(LogConfiguration->event_filename, configuration->event_filename) != 0) ||
+    (LogConfiguration->event_size != configuration->event_size)) {
+      LogEventLevel = LOG_LEVEL_DISABLED;
+      LogEventOpened = (LogEventOpen(configuration->event_filename, configuration->event_size) == 0);
+      if (LogEventOpened == 0) {
+        DirectErrorMessage(GOGO_STR_CANNOT_OPEN_EVENT_LOG, configuration->event_filename);
+      }
+    }
+  }
+  /* If it says we don't, close the event log. */
+  else if (LogEventOpened) {
+    LogEventLevel = LOG_LEVEL_DISABLED;
+    LogEventClose();
+    LogEventOpened = 0;
+  }
+#endif
+
+#ifdef LOG_MEMORY_SUPPORT
+  /* If the configuration to apply says we want the memory ring... */
+  if ((configuration->log_level_memory > LOG_LEVEL_DISABLED) && (configuration->memory_filename != NULL)) {
+    /* Keep the ring that is open, unless its file or size changed. */
+    if ((LogMemoryOpened == 0) || (LogConfiguration == NULL) || (LogConfiguration->memory_filename == NULL) ||
+    (strcmp(LogConfiguration->memory_filename, configuration->memory_filename) != 0) ||
+    (LogConfiguration->memory_size != configuration->memory_size)) {
+      /* The log mutex keeps the writers off the ring while it changes. */
+      pal_enter_cs(&logMutex);
+      LogMemoryOpened = (LogMemoryOpen(configuration->memory_filename, configuration->memory_size) == 0);
+      pal_leave_cs(&logMutex);
+
+      if (LogMemoryOpened == 0) {
+        DirectErrorMessage(GOGO_STR_CANNOT_OPEN_MEMORY_LOG, configuration->memory_filename);
+      }
+    }
+  }
+  /* If it says we don't, close the memory ring. */
+  else if (LogMemoryOpened) {
+    pal_enter_cs(&logMutex);
+    LogMemoryClose();
+    LogMemoryOpened = 0;
+    pal_leave_cs(&logMutex);
+  }
+#endif
+
   /* Free the previous configuration if there was one. */
   if (LogConfiguration != NULL) {
     FreeLogConfiguration(LogConfiguration);
   }
 
-  /* The current configuration is now the new one. */
+  /* The current configuration is now the new one, and ends a burst. */
   LogConfiguration = configuration;
+  LogBurst.file_open = (configuration->log_level_file > LOG_LEVEL_DISABLED);
+  LogBurst.syslog_open = (configuration->log_level_syslog > LOG_LEVEL_DISABLED);
+  pal_atomic_set(&LogBurst.active, 0);
+  LogUpdateLevelEnabled();
+
+  /* Report the lines the early log buffer had no room for. */
+  if (dropped != 0) {
+    Display(LOG_LEVEL_1, ELWarning, "LogConfigure", GOGO_STR_LOG_EARLY_DROPPED, dropped);
+  }
+
+  /* Hand the writing over to the log writer thread, if requested. */
+  if (configuration->async == TRUE) {
+    if (LogAsyncStart(configuration->flush_interval) != 0) {
+      Display(LOG_LEVEL_1, ELWarning, "LogConfigure", GOGO_STR_LOG_CANT_START_WRITER);
+    }
+  }
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+/* Change the levels of the console, the log file and syslog while the */
+/* client runs. */
+/* Input: */
+/* - console, file, syslog: The new levels, -1 to keep a level as it is. */
+/* - seconds:               How long the new levels last, 0 for good. */
+/* Returns 0, or 1 if a level is out of range or its destination is */
+/* disabled in the configuration. */
+int LogSetLevels(sint32_t console, sint32_t file, sint32_t syslog, sint32_t seconds)
+{
+  if (console < -1 || console > LOG_LEVEL_MAX || file < -1 || file > LOG_LEVEL_MAX ||
+      syslog < -1 || syslog > LOG_LEVEL_MAX || seconds < 0 || seconds > LOG_BURST_MAX) {
+    Display(LOG_LEVEL_1, ELError, "LogSetLevels", GOGO_STR_LOG_LEVELS_REJECTED, console, file, syslog);
+    return 1;
+  }
+
+  if (LogMutexInitialized == 0) {
+    return 1;
+  }
+
+  pal_enter_cs(&logMutex);
+
+  if ((LogConfiguration == NULL) ||
+      (file > LOG_LEVEL_DISABLED && LogBurst.file_open == 0) ||
+      (syslog > LOG_LEVEL_DISABLED && LogBurst.syslog_open == 0)) {
+    pal_leave_cs(&logMutex);
+    Display(LOG_LEVEL_1, ELError, "LogSetLevels", GOGO_STR_LOG_LEVELS_REJECTED, console, file, syslog);
+    return 1;
+  }
+
+  /* A burst restores the levels from before the first burst. A change */
+  /* for good ends the burst instead. */
+  if (seconds > 0) {
+    if (pal_atomic_get(&LogBurst.active) == 0) {
+      LogBurst.console = LogConfiguration->log_level_console;
+      LogBurst.file = LogConfiguration->log_level_file;
+      LogBurst.syslog = LogConfiguration->log_level_syslog;
+    }
+    pal_gettime_monotonic(&LogBurst.until);
+    LogBurst.until.tv_sec += seconds;
+  }
+
+  if (console != -1) LogConfiguration->log_level_console = console;
+  if (file != -1) LogConfiguration->log_level_file = file;
+  if (syslog != -1) LogConfiguration->log_level_syslog = syslog;
+
+  console = LogConfiguration->log_level_console;
+  file = LogConfiguration->log_level_file;
+  syslog = LogConfiguration->log_level_syslog;
+
+  pal_atomic_set(&LogBurst.active, seconds > 0);
+  LogUpdateLevelEnabled();
+
+  pal_leave_cs(&logMutex);
+
+  if (seconds > 0) {
+    Display(LOG_LEVEL_1, ELInfo, "LogSetLevels", GOGO_STR_LOG_BURST_STARTED, console, file, syslog, seconds);
+  }
+  else {
+    Display(LOG_LEVEL_1, ELInfo, "LogSetLevels", GOGO_STR_LOG_LEVELS_SET, console, file, syslog);
+  }
 
   return 0;
 }
 
 
+// --------------------------------------------------------------------------
+/* End the burst started by LogSetLevels() if its time is over. LogDisplay() */
+/* only notices it when a message comes, which never happens when the burst */
+/* lowered the levels: the client calls this as it waits. */
+void LogBurstCheck(void)
+{
+  if (pal_atomic_get(&LogBurst.active) != 0) {
+    LogBurstEnd();
+  }
+}
+
+
 // --------------------------------------------------------------------------
 /* Close the logging system. */
 void LogClose(void)
 {
-  /* Free the log file buffer. */
-  buffer_free(&LogBuffer);
+  /* Write what is queued, and stop the log writer. */
+  LogAsyncStop();
+  if (LogQueue.slots != NULL) {
+    free(LogQueue.slots);
+    LogQueue.slots = NULL;
+  }
 
   /* If there's a logging configuration object floating around, free it. */
+  LogLevelEnabled = LOG_LEVEL_DISABLED;
+  pal_atomic_set(&LogBurst.active, 0);
   if (LogConfiguration != NULL) {
     FreeLogConfiguration(LogConfiguration);
     LogConfiguration = NULL;
@@ -890,6 +1783,28 @@ void LogClose(void)
     Logfp = NULL;
   }
 
+#ifdef LOG_COMPRESS_SUPPORT
+  /* Let the compression of the last rotated file finish. */
+  LogCompressWait();
+#endif
+
+#ifdef LOG_EVENT_SUPPORT
+  /* Close the event log. */
+  LogEventLevel = LOG_LEVEL_DISABLED;
+  LogEventClose();
+  LogEventOpened = 0;
+#endif
+
+#ifdef LOG_MEMORY_SUPPORT
+  /* Close the memory ring. */
+  if (LogMemoryOpened) {
+    pal_enter_cs(&logMutex);
+    LogMemoryClose();
+    LogMemoryOpened = 0;
+    pal_leave_cs(&logMutex);
+  }
+#endif
+
   /* Close syslog. */
   pal_closelog();
 }
@@ -112,9 +112,10 @@ typedef struct __ICMP_ECHO_ENGINE_PARMS
   // Engine echo send and receive callbacks.
   iee_send_clbk   clbk_send;
   iee_recv_clbk   clbk_recv;
+  iee_lost_clbk   clbk_lost;
 
   // Engine socket variables.
-  uint32_t        icmp_echo_id;     // ICMP ECHO identifier (this process id).
+  uint32_t        icmp_echo_id;     // ICMP ECHO identifier (from the process id).
   pal_socket_t    icmp_sfd;         // ICMP raw socket file descriptor.
   sint32_t        icmp_saf;         // ICMP raw socket address family.
   union {
@@ -151,6 +152,12 @@ typedef enum {
 } iee_priv_ret_t;
 
 
+// Engines started so far. Each engine gets an echo identifier of its own,
+// so that it does not take the replies of another engine of the process
+// for its own: the standby tunnel echoes next to the keepalives.
+static volatile uint32_t iee_instances = 0;
+
+
 // --------------------------------------------------------------------------
 // Local private function prototypes.
 iee_ret_t           _do_send_wrap         ( PICMP_ECHO_ENGINE_PARMS p_engine );
@@ -187,6 +194,10 @@ double              _compare_tv           ( struct timeval* tv_1, struct timeval
 //   src: Source address used for sending ICMP echo requests.
 //   dst: Destination address at which ICMP echo requests will be sent.
 //   family: address family (INET or INET6)
+//   send_clbk, recv_clbk: Called when a request is sent, and when its
+//     reply is received.
+//   lost_clbk: Called when a request times out, with the number of
+//     consecutive timeouts. May be NULL.
 //
 // Return values:
 //   IEE_SUCCESS on success.
@@ -196,7 +207,8 @@ iee_ret_t IEE_init( void** pp_config, iee_mode_t eng_mode,
                    uint32_t send_interval, uint32_t echo_num,
                    uint32_t echo_timeout, uint8_t echo_timeout_threshold,
                    char* src, char* dst, sint32_t af,
-                   iee_send_clbk send_clbk, iee_recv_clbk recv_clbk )
+                   iee_send_clbk send_clbk, iee_recv_clbk recv_clbk,
+                   iee_lost_clbk lost_clbk )
 {
   PICMP_ECHO_ENGINE_PARMS p_engine = NULL;
 
@@ -236,9 +248,10 @@ iee_ret_t IEE_init( void** pp_config, iee_mode_t eng_mode,
   // Set engine callback functions.
   p_engine->clbk_send = send_clbk;
   p_engine->clbk_recv = recv_clbk;
+  p_engine->clbk_lost = lost_clbk;
 
   // Initialize engine socket variables.
-  p_engine->icmp_echo_id = pal_getpid();
+  p_engine->icmp_echo_id = (uint16_t)(pal_getpid() + pal_atomic_add( &iee_instances, 1 ));
   p_engine->icmp_saf = af;
   switch( p_engine->icmp_saf )
   {
@@ -714,6 +727,8 @@ iee_ret_t _do_read_wrap( PICMP_ECHO_ENGINE_PARMS p_engine, struct timeval* tv_re
           p_engine->count_late++;
           p_engine->count_consec_late++;
           DBG_PRINT("--> Echo timeout detected! count_consec_late:%d\n",p_engine->count_consec_late);
+          if( p_engine->clbk_lost != NULL )
+            p_engine->clbk_lost( p_engine->count_consec_late );
           // => Remove the echo event from the list.
           _remove_free_echo_event( p_engine, p_engine->event_list->echo_seq );
         }
@@ -13,6 +13,7 @@
 
 #include "tsp_net.h"
 #include "net.h"
+#include "net_resolv.h"
 #include "log.h"
 #include "hex_strings.h"
 
@@ -109,18 +110,13 @@ sint32_t parse_addr_port( const char* addr_port, char** addr, uint16_t* port, ui
  */
 struct in_addr *NetText2Addr(char *Address, struct in_addr *in_p)
 {
-  struct addrinfo hints;
-  struct addrinfo *res=NULL, *result=NULL;
+  tResolvAddr resolved;
   char addr_cp[MAXSERVER];
   char *addr;
 
   if (NULL == Address || NULL == in_p)
     return NULL;
 
-  /* Prepare hints structure */
-  memset(&hints, 0, sizeof(struct addrinfo));
-  hints.ai_family = PF_UNSPEC;
-
   /* copy the string before using strtok */
   strcpy(addr_cp, Address);
 
@@ -141,27 +137,16 @@ struct in_addr *NetText2Addr(char *Address, struct in_addr *in_p)
   addr = addr_cp;
   strtok(addr_cp, ":");
 
-  if( (getaddrinfo(addr, NULL, &hints, &res)) == 0 )
+  if( NetResolv(addr, AF_INET, &resolved, 1) == 1 )
   {
-    for(result = res; result; result = result->ai_next)
-    {
-      if (result->ai_family != AF_INET)
-        continue;
-      memcpy(in_p,
-       &((struct sockaddr_in *)result->ai_addr)->sin_addr,
-       sizeof(struct in_addr));
-      freeaddrinfo(res);
-      return in_p;
-    }
+    memcpy(in_p, &resolved.u.in, sizeof(struct in_addr));
+    return in_p;
   }
 
  error_v4:
   /* Cannot resolve */
   Display(LOG_LEVEL_3, ELWarning, "NetText2Addr", GOGO_STR_SERVER_NOT_IPV4);
 
-  if (res != NULL)
-    freeaddrinfo(res);
-
   return NULL;
 }
 
@@ -182,9 +167,7 @@ struct in_addr *NetText2Addr(char *Address, struct in_addr *in_p)
  */
 struct in6_addr *NetText2Addr6(char *Address, struct in6_addr *in6_p)
 {
-  struct addrinfo hints;
-  struct addrinfo *res    = NULL;
-  struct addrinfo *result = NULL;
+  tResolvAddr resolved;
   char addr[MAXSERVER];
   char *p;
   int c = 0;
@@ -192,9 +175,6 @@ struct in6_addr *NetText2Addr6(char *Address, struct in6_addr *in6_p)
   if (NULL == Address || NULL == in6_p)
     return NULL;
 
-  memset(&hints, 0, sizeof(struct addrinfo));
-  hints.ai_family = PF_INET6;
-
   /* Copy the address before stripping */
   addr[sizeof(addr) - 1] = '\0';
   strncpy(addr, Address, sizeof(addr) - 1);
@@ -209,9 +189,7 @@ struct in6_addr *NetText2Addr6(char *Address, struct in6_addr *in6_p)
   p = addr;
 
   if (c > 1) {
-    /* Numeric address */
-    hints.ai_flags = AI_NUMERICHOST;
-    /* Strip the bracket and port information if any */
+    /* Numeric address: strip the bracket and port information if any */
     if ('[' == *p) {
       strtok(p, "]");
       p++; /* Skip [ */
@@ -221,26 +199,14 @@ struct in6_addr *NetText2Addr6(char *Address, struct in6_addr *in6_p)
     strtok(p, ":");
   }
 
-  if ((getaddrinfo(p, NULL, &hints, &res)) == 0) {
-
-    for (result = res; result; result = result->ai_next) {
-      if (result->ai_family != AF_INET6)
-        continue;
-      memcpy(in6_p,
-       &((struct sockaddr_in6 *)result->ai_addr)->sin6_addr,
-       sizeof(struct in6_addr));
-      freeaddrinfo(res);
-      return in6_p;
-    }
-
+  if (NetResolv(p, AF_INET6, &resolved, 1) == 1) {
+    memcpy(in6_p, &resolved.u.in6, sizeof(struct in6_addr));
+    return in6_p;
   }
 
   /* Cannot resolve */
   Display(LOG_LEVEL_3, ELWarning, "NetText2Addr6", GOGO_STR_SERVER_NOT_IPV6);
 
-  if (res != NULL)
-    freeaddrinfo(res);
-
   return NULL;
 
 }
@@ -14,6 +14,7 @@
 #include "net_rudp.h"
 #include "tsp_net.h"
 #include "net.h"
+#include "net_resolv.h"
 #include "log.h"
 #include "hex_strings.h"
 #include "tsp_redirect.h"
@@ -239,11 +240,9 @@ tRedirectStatus timeEchoRequestReply(pal_socket_t sfd, char *address, rttengine_
   char data_in[ECHO_REQUEST_IN_BUF_SIZE];
   char data_out[ECHO_REQUEST_OUT_BUF_SIZE];
   sint32_t data_in_size = 0;
-  size_t data_out_size = 0;
-  rudp_msghdr_t *imh = NULL;
-  rudp_msghdr_t *omh = NULL;
-  void *om = NULL;
-  void *im = NULL;
+  sint32_t data_out_size = 0;
+  rudp_msghdr_t imh;
+  rudp_msghdr_t omh;
   sint32_t length_sent = 0;
   sint32_t ret = 0;
   fd_set fs;
@@ -252,52 +251,37 @@ tRedirectStatus timeEchoRequestReply(pal_socket_t sfd, char *address, rttengine_
   /* The receive buffer is empty */
   memset(data_in, 0, sizeof(data_in));
   /* The send buffer contains the "ECHO REQUEST" command */
-  pal_snprintf(data_out, sizeof(data_out), ECHO_REQUEST_COMMAND);
+  data_out_size = pal_snprintf(data_out, sizeof(data_out), ECHO_REQUEST_COMMAND);
 
-  /* Calculate the buffer sizes */
-  data_in_size = sizeof(data_in);
-  data_out_size = pal_strlen(data_out);
+  /* Keep the last byte of the receive buffer for the terminating NUL */
+  data_in_size = sizeof(data_in) - 1;
 
-  /* Prepare RUDP messages */
-  im = internal_prepare_message(&imh, data_in_size);
-  om = internal_prepare_message(&omh, data_out_size);
-
-  /* A NULL message is an error */
-  if ((im == NULL) || (om == NULL)) {
-    rttengine_deinit(engine, im, om);
-    *distance += ECHO_REQUEST_ERROR_ADJUST;
-    Display(LOG_LEVEL_1, ELError, "timeEchoRequestReply", GOGO_STR_RDR_ERROR_PREPARING_RUDP_MSG, address);
-    return TSP_REDIRECT_ECHO_REQUEST_ERROR;
-  }
-
-  /* Zero them out */
-  memset(im, 0, data_in_size);
-  memset(om, 0, data_out_size);
-
-  /* Copy the outgoing data to the data part of the outgoing message */
-  memcpy((char*)om + sizeof(rudp_msghdr_t), data_out, data_out_size);
+  /* The RUDP headers are sent and received alongside the data buffers, */
+  /* no intermediate message is built */
+  memset(&imh, 0, sizeof(rudp_msghdr_t));
+  memset(&omh, 0, sizeof(rudp_msghdr_t));
 
   /* Set the outgoing message's sequence number */
-  omh->sequence = htonl(engine->sequence++ | 0xf0000000);
+  omh.sequence = htonl(engine->sequence++ | 0xf0000000);
 
 send_loop:
 
   /* Fail if we have reached the maximum number of echo request attempts */
   if (engine->retries == ECHO_REQUEST_ATTEMPTS) {
-    rttengine_deinit(engine, im, om);
+    rttengine_deinit(engine);
     *distance += ECHO_REQUEST_TIMEOUT_ADJUST;
     Display(LOG_LEVEL_3, ELWarning, "timeEchoRequestReply", GOGO_STR_RDR_MAX_ECHO_REPLY_ATTEMPTS, ECHO_REQUEST_ATTEMPTS, address);
     return TSP_REDIRECT_ECHO_REQUEST_TIMEOUT;
   }
 
   /* Set the timestamp for the outgoing message */
-  omh->timestamp = htonl(internal_get_timestamp(engine));
+  omh.timestamp = htonl(internal_get_timestamp(engine));
 
   /* Try to send the outgoing message */
   Display(LOG_LEVEL_3, ELInfo, "timeEchoRequestReply", GOGO_STR_RDR_SENDING_ECHO_REQUEST, (engine->retries + 1), address);
 
-  if ((length_sent = send(sfd, om, (sint32_t)(data_out_size + sizeof(rudp_msghdr_t)), 0)) == -1) {
-    rttengine_deinit(engine, im, om);
+  if ((length_sent = internal_send_message(sfd, &omh, data_out, data_out_size)) == -1) {
+    rttengine_deinit(engine);
     *distance += ECHO_REQUEST_ERROR_ADJUST;
     Display(LOG_LEVEL_1, ELError, "timeEchoRequestReply", GOGO_STR_RDR_SEND_ECHO_REQUEST_FAILED, address);
     return TSP_REDIRECT_ECHO_REQUEST_ERROR;
@@ -329,20 +313,20 @@ select_loop:
     case 1:
       Display(LOG_LEVEL_3, ELWarning, "timeEchoRequestReply", GOGO_STR_RDR_RECEIVING_RUDP_MESSAGE, address);
 
-      /* Receive the incoming data, and store it in the incoming message */
-      ret = recv(sfd, im, (sizeof(rudp_msghdr_t) + data_in_size), 0);
+      /* Receive the incoming header and data directly in place */
+      ret = internal_recv_message(sfd, &imh, data_in, data_in_size);
 
       /* This is a fatal read error */
       if (ret == -1) {
-        rttengine_deinit(engine, im, om);
+        rttengine_deinit(engine);
         *distance += ECHO_REQUEST_ERROR_ADJUST;
         Display(LOG_LEVEL_1, ELError, "timeEchoRequestReply", GOGO_STR_RDR_ERR_RECEIVING_RUDP_FROM, address);
         return TSP_REDIRECT_ECHO_REQUEST_ERROR;
       }
 
       /* If we have the same sequence number, this is the message we want */
-      if (imh->sequence == omh->sequence) {
-        *distance += internal_get_timestamp(engine) - ntohl(omh->timestamp);
+      if ((ret >= (sint32_t)sizeof(rudp_msghdr_t)) && (imh.sequence == omh.sequence)) {
+        *distance += internal_get_timestamp(engine) - ntohl(omh.timestamp);
         ret = ret - sizeof(rudp_msghdr_t);
         Display(LOG_LEVEL_3, ELInfo, "timeEchoRequestReply", GOGO_STR_RDR_RECEIVED_RUDP_OK, address);
         break;
@@ -355,21 +339,17 @@ select_loop:
       }
     /* This is an unknown error */
     default:
-      rttengine_deinit(engine, im, om);
+      rttengine_deinit(engine);
       *distance += ECHO_REQUEST_ERROR_ADJUST;
       Display(LOG_LEVEL_1, ELError, "timeEchoRequestReply", GOGO_STR_RDR_ERR_WAITING_ECHO_REPLY, address);
       return TSP_REDIRECT_ECHO_REQUEST_ERROR;
   }
 
   /* Update the stat engine */
-  rttengine_update(engine, (internal_get_timestamp(engine) - ntohl(imh->timestamp)));
-
-  /* Copy the data part of the incoming message to the receiving buffer */
-  memcpy(data_in, (char*)im + sizeof(rudp_msghdr_t), ret);
+  rttengine_update(engine, (internal_get_timestamp(engine) - ntohl(imh.timestamp)));
 
-  /* Free the messages */
-  internal_discard_message(im);
-  internal_discard_message(om);
+  /* The data part of the incoming message is already in the receiving buffer */
+  data_in[ret] = '\0';
 
   engine->retries = 0;
 
@@ -392,6 +372,10 @@ tSocketAddressStatus getSocketAddress(char *server, tBrokerAddressType address_t
   struct addrinfo *result_index = NULL;
   sint32_t need_v6_endpoint = 0;
   sint32_t found_family_address = 0;
+  tResolvAddr resolved[RESOLV_MAX_ADDRS];
+  sint32_t resolved_count = 0;
+  sint32_t resolved_index = 0;
+  char numeric[INET6_ADDRSTRLEN];
 
   /* Zero out the hints */
   memset(&hints, 0, sizeof(struct addrinfo));
@@ -419,7 +403,29 @@ tSocketAddressStatus getSocketAddress(char *server, tBrokerAddressType address_t
       hints.ai_flags |= AI_NUMERICHOST;
       break;
     case TSP_REDIRECT_BROKER_TYPE_FQDN:
-      hints.ai_family = AF_UNSPEC;
+      /* The name is resolved through the resolver cache, and the address */
+      /* structure is built from the numeric address it returns. */
+      if ((resolved_count = NetResolv(server, AF_UNSPEC, resolved, RESOLV_MAX_ADDRS)) == 0) {
+        return SOCKET_ADDRESS_PROBLEM_RESOLVING;
+      }
+
+      /* Take the first address of the family we need, if there is one */
+      for (resolved_index = 0; resolved_index < resolved_count; resolved_index++) {
+        if ((resolved[resolved_index].family == AF_INET6) == (need_v6_endpoint != 0)) {
+          break;
+        }
+      }
+      if (resolved_index == resolved_count) {
+        resolved_index = 0;
+      }
+
+      if (inet_ntop(resolved[resolved_index].family, &resolved[resolved_index].u, numeric, sizeof(numeric)) == NULL) {
+        return SOCKET_ADDRESS_ERROR;
+      }
+
+      server = numeric;
+      hints.ai_family = resolved[resolved_index].family;
+      hints.ai_flags |= AI_NUMERICHOST;
       break;
   }
 
@@ -570,7 +576,7 @@ tRedirectStatus tspDoEchoRequest(char *address, tBrokerAddressType address_type,
   destroySocket(sfd);
 
   /* Uninitialize the stat engine */
-  rttengine_deinit(engine, NULL, NULL);
+  rttengine_deinit(engine);
 
   /* Free the stat engine */
   pal_free(engine);
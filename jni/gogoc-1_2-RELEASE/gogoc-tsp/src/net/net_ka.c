@@ -9,12 +9,18 @@
 */
 
 #include "platform.h"
+#include "gogoc_status.h"
 
 #include "net_ka.h"
+#include "tsp_trace.h"
 #include "icmp_echo_engine.h"
 #include "log.h"
 #include "hex_strings.h"
 
+#ifdef PMTU_SUPPORT
+#include "tsp_pmtu.h"         // tspPmtuReprobe()
+#endif
+
 
 #define KA_ECHO_REPLY_TIMEOUT         5000  // 5 seconds timeout.
 #define KA_NUM_CONSEC_TIMEOUT         3     // 3 consecutive timeouts.
@@ -53,6 +59,7 @@ ka_priv_ret_t       _destroy_ka_engine    ( PKA_ENGINE_PARMS *pp_engine );
 pal_thread_ret_t PAL_THREAD_CALL _ka_start_thread( void *arg );
 void                _ka_send_callback     ( void );
 void                _ka_recv_callback     ( double rtt );
+void                _ka_lost_callback     ( uint32_t consec_late );
 
 
 // --------------------------------------------------------------------------
@@ -104,7 +111,7 @@ ka_ret_t KA_init( void ** pp_engine, uint32_t ka_send_interval, char* ka_src_add
                       IEE_MODE_KA, ka_send_interval, 0, 
                       KA_ECHO_REPLY_TIMEOUT, KA_NUM_CONSEC_TIMEOUT, 
                       ka_src_addr, ka_dst_addr, ka_af,
-                      &_ka_send_callback, &_ka_recv_callback );
+                      &_ka_send_callback, &_ka_recv_callback, &_ka_lost_callback );
   switch( iee_ret )
   {
   case IEE_SUCCESS:
@@ -464,4 +471,30 @@ void _ka_send_callback( void )
 void _ka_recv_callback( double rtt )
 {
   LOG_MESSAGE( LOG_LEVEL_3, ELInfo, STR_KA_RECV_INFO, rtt );
+
+  // The first reply completes the connection attempt. This is a no-op for
+  // the following ones.
+  tspTracePhase(TRACE_PHASE_FIRST_KEEPALIVE);
+  tspTraceEnd(STATUS_SUCCESS_INIT);
+}
+
+
+// --------------------------------------------------------------------------
+// _ka_lost_callback: Function called back from the ICMP echo engine when
+//   a keepalive request times out.
+//
+// Parameter:
+//   consec_late: Number of consecutive timeouts.
+//
+// Return value: (none)
+//
+void _ka_lost_callback( uint32_t consec_late )
+{
+  LOG_MESSAGE( LOG_LEVEL_3, ELWarning, STR_KA_LOST_INFO, consec_late );
+
+#ifdef PMTU_SUPPORT
+  // The replies may be lost because the path MTU went down.
+  if( consec_late == PMTU_REPROBE_LOSSES )
+    tspPmtuReprobe();
+#endif
 }
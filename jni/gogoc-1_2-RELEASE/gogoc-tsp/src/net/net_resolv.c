@@ -0,0 +1,507 @@
+/*
+-----------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+-----------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include "tsp_net.h"
+#include "net_resolv.h"
+#include "log.h"
+#include "hex_strings.h"
+
+
+/*
+ * A cache slot. A slot is free when its name is empty. 'busy' is set while
+ * a lookup for the name is running, and the slot is neither reused nor
+ * updated by anyone else in the mean time. A slot updated by a background
+ * lookup keeps the thread identifier until the thread is joined.
+ */
+typedef struct stResolvEntry {
+  char          name[RESOLV_NAME_SIZE];
+  time_t        expires;        /* Addresses are valid until then */
+  time_t        refresh;        /* No new lookup is done before then */
+  time_t        used;           /* Last access, to pick the slot to reuse */
+  sint32_t      count;          /* Number of addresses, 0 if the name did not resolve */
+  tResolvAddr   addrs[RESOLV_MAX_ADDRS];
+  sint32_t      busy;
+  sint32_t      joinable;
+  pal_thread_t  thread;
+} tResolvEntry;
+
+static tResolvEntry resolv_cache[RESOLV_CACHE_SIZE];
+static pal_cs_t     resolv_lock;
+static pal_cs_t     resolv_file_lock;
+static char        *resolv_file = NULL;
+static sint32_t     resolv_initialized = 0;
+
+
+/*
+ * Convert a numeric address. Names that are already addresses never go
+ * through the cache.
+ */
+static sint32_t NetResolvNumeric(const char *name, tResolvAddr *addr)
+{
+  if (pal_inet_pton(AF_INET, name, &addr->u.in) == 1) {
+    addr->family = AF_INET;
+    return 1;
+  }
+
+  if (pal_inet_pton(AF_INET6, name, &addr->u.in6) == 1) {
+    addr->family = AF_INET6;
+    return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Resolve a name through the system resolver. This blocks for as long as
+ * the DNS takes to answer. Addresses of both families are returned, in the
+ * order given by getaddrinfo.
+ */
+static sint32_t NetResolvQuery(const char *name, tResolvAddr *addrs, sint32_t max)
+{
+  struct addrinfo hints;
+  struct addrinfo *res = NULL, *result;
+  sint32_t count = 0, i;
+
+  memset(&hints, 0, sizeof(struct addrinfo));
+  hints.ai_family = PF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  if (getaddrinfo(name, NULL, &hints, &res) != 0) {
+    if (res != NULL)
+      freeaddrinfo(res);
+    return 0;
+  }
+
+  for (result = res; result != NULL && count < max; result = result->ai_next) {
+    tResolvAddr *a = &addrs[count];
+
+    if (result->ai_family == AF_INET) {
+      a->family = AF_INET;
+      memcpy(&a->u.in, &((struct sockaddr_in *)result->ai_addr)->sin_addr, sizeof(struct in_addr));
+    } else if (result->ai_family == AF_INET6) {
+      a->family = AF_INET6;
+      memcpy(&a->u.in6, &((struct sockaddr_in6 *)result->ai_addr)->sin6_addr, sizeof(struct in6_addr));
+    } else {
+      continue;
+    }
+
+    /* Skip duplicates */
+    for (i = 0; i < count; i++) {
+      if (addrs[i].family == a->family && memcmp(&addrs[i].u, &a->u, sizeof(a->u)) == 0)
+        break;
+    }
+    if (i == count)
+      count++;
+  }
+
+  freeaddrinfo(res);
+  return count;
+}
+
+/* Copy the addresses of the requested family (AF_UNSPEC for all) */
+static sint32_t NetResolvSelect(const tResolvAddr *src, sint32_t count, sint32_t family, tResolvAddr *dst, sint32_t max)
+{
+  sint32_t i, n = 0;
+
+  for (i = 0; i < count && n < max; i++) {
+    if (family == AF_UNSPEC || src[i].family == family)
+      dst[n++] = src[i];
+  }
+
+  return n;
+}
+
+/* Look for a name in the cache. The cache lock must be held. */
+static tResolvEntry *NetResolvFind(const char *name)
+{
+  sint32_t i;
+
+  for (i = 0; i < RESOLV_CACHE_SIZE; i++) {
+    if (resolv_cache[i].name[0] != '\0' && pal_strcasecmp(resolv_cache[i].name, name) == 0)
+      return &resolv_cache[i];
+  }
+
+  return NULL;
+}
+
+/*
+ * Join the thread that last updated this slot. Its lookup is over, so the
+ * join does not wait. The cache lock must be held.
+ */
+static void NetResolvReap(tResolvEntry *e)
+{
+  if (e->joinable && !e->busy) {
+    pal_thread_join(e->thread, NULL);
+    e->joinable = 0;
+  }
+}
+
+/*
+ * Get a slot for a new name, reusing the least recently used one if the
+ * cache is full. Returns NULL if every slot has a lookup running. The cache
+ * lock must be held.
+ */
+static tResolvEntry *NetResolvSlot(const char *name)
+{
+  tResolvEntry *e = NULL;
+  sint32_t i;
+
+  if (pal_strlen(name) >= RESOLV_NAME_SIZE)
+    return NULL;
+
+  for (i = 0; i < RESOLV_CACHE_SIZE; i++) {
+    if (resolv_cache[i].busy)
+      continue;
+    if (resolv_cache[i].name[0] == '\0') {
+      e = &resolv_cache[i];
+      break;
+    }
+    if (e == NULL || resolv_cache[i].used < e->used)
+      e = &resolv_cache[i];
+  }
+
+  if (e == NULL)
+    return NULL;
+
+  NetResolvReap(e);
+  memset(e, 0, sizeof(tResolvEntry));
+  pal_strcpy(e->name, name);
+
+  return e;
+}
+
+/*
+ * Record the result of a lookup. A failed lookup leaves the addresses
+ * found before in place, so they remain usable until they are too old.
+ * The cache lock must be held.
+ */
+static void NetResolvUpdate(tResolvEntry *e, const tResolvAddr *addrs, sint32_t count, time_t now)
+{
+  if (count > 0) {
+    memcpy(e->addrs, addrs, count * sizeof(tResolvAddr));
+    e->count = count;
+    e->expires = now + RESOLV_TTL;
+    e->refresh = e->expires;
+  } else {
+    e->refresh = now + RESOLV_NEGATIVE_TTL;
+  }
+}
+
+/*
+ * Write the names that resolved to the cache file, one address per line:
+ *
+ *   <name> <expiration time> <address>
+ *
+ * The file is written aside and renamed, so a reader never sees it partly
+ * written.
+ */
+static void NetResolvSave(void)
+{
+  tResolvEntry *snapshot;
+  char tmp_file[MAXNAME];
+  char text[INET6_ADDRSTRLEN];
+  FILE *file;
+  sint32_t i, j, ok = 1;
+
+  if (resolv_file == NULL || *resolv_file == '\0')
+    return;
+
+  if ((snapshot = (tResolvEntry *)pal_malloc(sizeof(resolv_cache))) == NULL)
+    return;
+
+  pal_enter_cs(&resolv_file_lock);
+
+  pal_enter_cs(&resolv_lock);
+  memcpy(snapshot, resolv_cache, sizeof(resolv_cache));
+  pal_leave_cs(&resolv_lock);
+
+  pal_snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", resolv_file);
+
+  if ((file = fopen(tmp_file, "w")) == NULL) {
+    Display(LOG_LEVEL_3, ELWarning, "NetResolvSave", GOGO_STR_RESOLV_CANT_SAVE_CACHE, resolv_file);
+    pal_leave_cs(&resolv_file_lock);
+    pal_free(snapshot);
+    return;
+  }
+
+  for (i = 0; i < RESOLV_CACHE_SIZE && ok; i++) {
+    for (j = 0; j < snapshot[i].count && ok; j++) {
+      if (inet_ntop(snapshot[i].addrs[j].family, &snapshot[i].addrs[j].u, text, sizeof(text)) == NULL)
+        continue;
+      ok = fprintf(file, "%s %ld %s\n", snapshot[i].name, (long)snapshot[i].expires, text) >= 0;
+    }
+  }
+
+  if (fclose(file) != 0 || !ok || rename(tmp_file, resolv_file) != 0) {
+    Display(LOG_LEVEL_3, ELWarning, "NetResolvSave", GOGO_STR_RESOLV_CANT_SAVE_CACHE, resolv_file);
+    pal_unlink(tmp_file);
+  }
+
+  pal_leave_cs(&resolv_file_lock);
+  pal_free(snapshot);
+}
+
+/* Read back the cache file written by NetResolvSave */
+static void NetResolvLoad(void)
+{
+  char line[RESOLV_NAME_SIZE + 64];
+  char name[RESOLV_NAME_SIZE];
+  char text[INET6_ADDRSTRLEN + 1];
+  tResolvEntry *e;
+  tResolvAddr addr;
+  time_t now = pal_time(NULL);
+  long expires;
+  sint32_t loaded = 0;
+  FILE *file;
+
+  if (resolv_file == NULL || *resolv_file == '\0')
+    return;
+
+  if ((file = fopen(resolv_file, "r")) == NULL)
+    return;
+
+  while (fgets(line, sizeof(line), file)) {
+    if (sscanf(line, "%255s %ld %46s", name, &expires, text) != 3)
+      continue;
+
+    /* Too old to be of any use */
+    if ((time_t)expires + RESOLV_STALE_GRACE <= now)
+      continue;
+
+    if (NetResolvNumeric(text, &addr) == 0)
+      continue;
+
+    if ((e = NetResolvFind(name)) == NULL) {
+      if ((e = NetResolvSlot(name)) == NULL)
+        break;
+      e->expires = e->refresh = (time_t)expires;
+      loaded++;
+    }
+
+    if (e->count < RESOLV_MAX_ADDRS)
+      e->addrs[e->count++] = addr;
+  }
+
+  fclose(file);
+
+  if (loaded > 0)
+    Display(LOG_LEVEL_3, ELInfo, "NetResolvLoad", GOGO_STR_RESOLV_LOADED_CACHE, loaded, resolv_file);
+}
+
+/* Background lookup, started by NetResolvStart */
+static pal_thread_ret_t PAL_THREAD_CALL NetResolvWorker(void *arg)
+{
+  tResolvEntry *e = (tResolvEntry *)arg;
+  tResolvAddr addrs[RESOLV_MAX_ADDRS];
+  char name[RESOLV_NAME_SIZE];
+  sint32_t count;
+
+  /* The slot is ours while busy is set, the name does not change. */
+  pal_strcpy(name, e->name);
+
+  count = NetResolvQuery(name, addrs, RESOLV_MAX_ADDRS);
+
+  pal_enter_cs(&resolv_lock);
+  NetResolvUpdate(e, addrs, count, pal_time(NULL));
+  pal_leave_cs(&resolv_lock);
+
+  if (count > 0)
+    NetResolvSave();
+
+  /* Release the slot last: from now on, a join does not wait. */
+  pal_enter_cs(&resolv_lock);
+  e->busy = 0;
+  pal_leave_cs(&resolv_lock);
+
+  pal_thread_exit(0);
+  return 0;
+}
+
+/* Start a background lookup for a slot. The cache lock must be held. */
+static void NetResolvStart(tResolvEntry *e)
+{
+  NetResolvReap(e);
+
+  e->busy = 1;
+  if (pal_thread_create(&e->thread, &NetResolvWorker, (void *)e) != 0) {
+    Display(LOG_LEVEL_1, ELError, "NetResolvStart", GOGO_STR_RESOLV_CANT_CREATE_THREAD, e->name);
+    e->busy = 0;
+    return;
+  }
+  e->joinable = 1;
+}
+
+
+/* --------------------------------------------------------------------------
+ * Initialize the resolver and load the names saved by a previous run.
+ * 'cache_file' may be NULL or empty, in which case the cache is not saved.
+ */
+void NetResolvInit(const char *cache_file)
+{
+  if (resolv_initialized)
+    return;
+
+  memset(resolv_cache, 0, sizeof(resolv_cache));
+  pal_init_cs(&resolv_lock);
+  pal_init_cs(&resolv_file_lock);
+
+  resolv_file = (cache_file != NULL) ? pal_strdup(cache_file) : NULL;
+  resolv_initialized = 1;
+
+  NetResolvLoad();
+}
+
+/* --------------------------------------------------------------------------
+ * Wait for the background lookups and release the resolver.
+ */
+void NetResolvDestroy(void)
+{
+  sint32_t i, busy;
+
+  if (!resolv_initialized)
+    return;
+
+  do {
+    busy = 0;
+    pal_enter_cs(&resolv_lock);
+    for (i = 0; i < RESOLV_CACHE_SIZE; i++) {
+      busy |= resolv_cache[i].busy;
+      NetResolvReap(&resolv_cache[i]);
+    }
+    pal_leave_cs(&resolv_lock);
+
+    if (busy)
+      pal_sleep(RESOLV_POLL_INTERVAL);
+  } while (busy);
+
+  resolv_initialized = 0;
+  pal_free_cs(&resolv_lock);
+  pal_free_cs(&resolv_file_lock);
+
+  if (resolv_file != NULL) {
+    pal_free(resolv_file);
+    resolv_file = NULL;
+  }
+}
+
+/* --------------------------------------------------------------------------
+ * Start resolving a name in the background, unless the cache already has a
+ * valid answer or a lookup is already running for it. Returns immediately.
+ */
+void NetResolvPrefetch(const char *name)
+{
+  tResolvEntry *e;
+  tResolvAddr addr;
+  time_t now;
+
+  if (name == NULL || !resolv_initialized || NetResolvNumeric(name, &addr))
+    return;
+
+  pal_enter_cs(&resolv_lock);
+
+  now = pal_time(NULL);
+  if ((e = NetResolvFind(name)) == NULL)
+    e = NetResolvSlot(name);
+
+  if (e != NULL && !e->busy && now >= e->refresh) {
+    Display(LOG_LEVEL_3, ELInfo, "NetResolvPrefetch", GOGO_STR_RESOLV_PREFETCH, name);
+    NetResolvStart(e);
+  }
+
+  pal_leave_cs(&resolv_lock);
+}
+
+/* --------------------------------------------------------------------------
+ * Resolve a name to at most 'max' addresses of the requested family
+ * (AF_INET, AF_INET6 or AF_UNSPEC for both).
+ *
+ * A name resolved less than RESOLV_TTL seconds ago is answered from the
+ * cache. An older one is answered from the cache too, for up to
+ * RESOLV_STALE_GRACE seconds more, while it is resolved again in the
+ * background. Otherwise the lookup is done here, or, if a lookup for the
+ * same name is already running, its result is waited for.
+ *
+ * Returns the number of addresses copied in 'addrs', 0 if there is none.
+ */
+sint32_t NetResolv(const char *name, sint32_t family, tResolvAddr *addrs, sint32_t max)
+{
+  tResolvAddr found[RESOLV_MAX_ADDRS];
+  tResolvEntry *e;
+  sint32_t count, usable;
+  time_t now;
+
+  if (name == NULL || addrs == NULL || max <= 0)
+    return 0;
+
+  if (NetResolvNumeric(name, &found[0]))
+    return NetResolvSelect(found, 1, family, addrs, max);
+
+  if (!resolv_initialized) {
+    count = NetResolvQuery(name, found, RESOLV_MAX_ADDRS);
+    return NetResolvSelect(found, count, family, addrs, max);
+  }
+
+  while (1) {
+    pal_enter_cs(&resolv_lock);
+
+    now = pal_time(NULL);
+    if ((e = NetResolvFind(name)) == NULL && (e = NetResolvSlot(name)) == NULL) {
+      /* No slot to spare, do without the cache. */
+      pal_leave_cs(&resolv_lock);
+      count = NetResolvQuery(name, found, RESOLV_MAX_ADDRS);
+      return NetResolvSelect(found, count, family, addrs, max);
+    }
+
+    e->used = now;
+    usable = (e->count > 0 && now < e->expires + RESOLV_STALE_GRACE);
+
+    /* Recent answer, good or bad */
+    if (now < e->refresh) {
+      count = usable ? NetResolvSelect(e->addrs, e->count, family, addrs, max) : 0;
+      pal_leave_cs(&resolv_lock);
+      if (count > 0)
+        Display(LOG_LEVEL_3, ELInfo, "NetResolv", GOGO_STR_RESOLV_USING_CACHE, name);
+      return count;
+    }
+
+    /* Expired, but recent enough to be used while it is refreshed */
+    if (usable) {
+      if (!e->busy)
+        NetResolvStart(e);
+      count = NetResolvSelect(e->addrs, e->count, family, addrs, max);
+      pal_leave_cs(&resolv_lock);
+      Display(LOG_LEVEL_3, ELInfo, "NetResolv", GOGO_STR_RESOLV_USING_STALE_CACHE, name);
+      return count;
+    }
+
+    if (!e->busy)
+      break;
+
+    /* Someone is resolving this name already, wait for the answer. */
+    pal_leave_cs(&resolv_lock);
+    pal_sleep(RESOLV_POLL_INTERVAL);
+  }
+
+  /* Resolve the name here, holding the slot. */
+  NetResolvReap(e);
+  e->busy = 1;
+  pal_leave_cs(&resolv_lock);
+
+  count = NetResolvQuery(name, found, RESOLV_MAX_ADDRS);
+
+  pal_enter_cs(&resolv_lock);
+  NetResolvUpdate(e, found, count, pal_time(NULL));
+  e->busy = 0;
+  pal_leave_cs(&resolv_lock);
+
+  if (count > 0)
+    NetResolvSave();
+
+  return NetResolvSelect(found, count, family, addrs, max);
+}
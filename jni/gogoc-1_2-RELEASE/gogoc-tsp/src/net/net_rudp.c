@@ -35,7 +35,7 @@ sint32_t NetRUDPInit(void)
 /* */
 sint32_t NetRUDPDestroy(void) 
 {
-	if ( rttengine_deinit(&rttengine_stats, NULL, NULL) == 0)
+	if ( rttengine_deinit(&rttengine_stats) == 0)
 		return 1;
 	return 0;
 }
@@ -108,13 +108,21 @@ sint32_t NetRUDPWrite(pal_socket_t sock, char *b, sint32_t l)
 sint32_t NetRUDPPrintf(pal_socket_t sock, char *out, sint32_t ol, char *Format, ...)
 {
   va_list argp;
+  sint32_t Length;
   char Data[1024];
 
+  /* Format once and send straight from the stack buffer; the formatted
+   * length comes from vsnprintf so the string is not rescanned. */
   va_start(argp, Format);
-  pal_vsnprintf((char*)Data, sizeof Data, Format, argp);
+  Length = pal_vsnprintf((char*)Data, sizeof Data, Format, argp);
   va_end(argp);
 
-  return NetRUDPReadWrite(sock, Data, pal_strlen(Data), out, ol);
+  if( Length < 0 )
+    return -1;
+  if( Length >= (sint32_t)sizeof Data )
+    Length = sizeof Data - 1;
+
+  return NetRUDPReadWrite(sock, Data, Length, out, ol);
 }
 
 
@@ -131,29 +139,20 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 {
 	fd_set fs;
 	sint32_t ret, ls;	/* return code, length sent */
-	rudp_msghdr_t *omh = NULL; /* outoing message header */
-	rudp_msghdr_t *imh = NULL; /* incoming message header */
-	void *om = NULL;
-	void *im = NULL;       /* outgoing and incoming messages raw data */
+	rudp_msghdr_t omh; /* outoing message header */
+	rudp_msghdr_t imh; /* incoming message header */
 	struct timeval tv_sel, tv_beg;
 	
 
 	if ( rttengine_stats.initiated == 0 )
 		return -1;
 
-	om = internal_prepare_message(&omh,il);
-	im = internal_prepare_message(&imh,ol);
-
-	memset(om, 0, il);
-	memset(im, 0, ol);
-	
-	if (om == NULL || im == NULL) { /* something in the memory allocation failed */
-		/* cleanup */
-		rttengine_deinit(&rttengine_stats, om, im);
-		return -1;
-	}
+	/* The payload is never copied: the header lives on the stack and
+	 * is sent along the caller's buffer using scatter/gather I/O, and
+	 * the reply is received directly in the caller's buffer. */
 
-	memcpy((char*)om+sizeof(rudp_msghdr_t), in, il);
+	memset(&omh, 0, sizeof(rudp_msghdr_t));
+	memset(&imh, 0, sizeof(rudp_msghdr_t));
 
 	/* Bug 3334: Byte ordering is important when sending 32 bit
 	 * values on the network: local and remote machines may not
@@ -166,7 +165,7 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 
 	/* stamp in the sequence number */
 
-	omh->sequence = htonl(rttengine_stats.sequence++ | 0xf0000000);
+	omh.sequence = htonl(rttengine_stats.sequence++ | 0xf0000000);
 		
 
  sendloop: /* if we have no peer yet - that means retries = MAXRTT with no replies, quit it.
@@ -175,7 +174,7 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 
 	if (rttengine_stats.retries == RTTENGINE_MAXRTT) {
 		if (rttengine_stats.has_peer == 0) {
-			rttengine_deinit(&rttengine_stats, om, im);
+			rttengine_deinit(&rttengine_stats);
 			return -1;
 		} else rttengine_stats.apply_backoff = 1;
 	}
@@ -183,21 +182,21 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 	
 	if (rttengine_stats.retries == RTTENGINE_MAXRT) {
 		/* cleanup */
-		rttengine_deinit(&rttengine_stats, om, im);		
+		rttengine_deinit(&rttengine_stats);
 		return -1;
 	}
 
 	/* update the timestamp of the message */
 	
-	omh->timestamp = htonl(internal_get_timestamp(&rttengine_stats));
+	omh.timestamp = htonl(internal_get_timestamp(&rttengine_stats));
 
-	Display(LOG_LEVEL_3, ELInfo, "internal_send_recv", GOGO_STR_RUDP_PACKET,rttengine_stats.retries, rttengine_stats.rto, ntohl(omh->sequence), ntohl(omh->timestamp));
+	Display(LOG_LEVEL_3, ELInfo, "internal_send_recv", GOGO_STR_RUDP_PACKET,rttengine_stats.retries, rttengine_stats.rto, ntohl(omh.sequence), ntohl(omh.timestamp));
 
         /* send the message */
 
-	if ( ( ls = send(fd, om, il+sizeof(rudp_msghdr_t), 0)) == -1) {
+	if ( ( ls = internal_send_message(fd, &omh, in, il)) == -1) {
 		/* cleanup */
-		rttengine_deinit(&rttengine_stats, om, im);
+		rttengine_deinit(&rttengine_stats);
 		return -1; /* if the send fails, quit it */ /* XXX check for a ICMP port unreachable here */
 	}
 
@@ -230,17 +229,17 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 		   * lets read everything the server is sending and see
 		   */
 		
-		ret = recv(fd, im, sizeof(rudp_msghdr_t)+ol, 0);
+		ret = internal_recv_message(fd, &imh, out, ol);
 
-		Display(LOG_LEVEL_3, ELInfo, "internal_send_recv", GOGO_STR_REPLY_RUDP_PACKET,rttengine_stats.retries, rttengine_stats.rto, ntohl(imh->sequence), ntohl(imh->timestamp));
+		Display(LOG_LEVEL_3, ELInfo, "internal_send_recv", GOGO_STR_REPLY_RUDP_PACKET,rttengine_stats.retries, rttengine_stats.rto, ntohl(imh.sequence), ntohl(imh.timestamp));
 		
 		if (ret == -1) { /* fatal read error */
 			/* cleanup */
-			rttengine_deinit(&rttengine_stats, om, im);
+			rttengine_deinit(&rttengine_stats);
 			return -1;
 		}
 		
-		if ( imh->sequence == omh->sequence ) {
+		if ( ret >= (sint32_t)sizeof(rudp_msghdr_t) && imh.sequence == omh.sequence ) {
 			ret = ret - sizeof(rudp_msghdr_t);	/* we keep the lenght received minus the headers */
 			break; /* yes it is what we are waiting for */
 		} else {
@@ -261,7 +260,7 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 		
 	default: { /* error of unknown origin, ret contains the ERRNO compatible error released by select() */
 		/* cleanup */
-		rttengine_deinit(&rttengine_stats, om, im);
+		rttengine_deinit(&rttengine_stats);
 		return -1;
 	}
 
@@ -269,18 +268,9 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 
 	/* update our stat engine, the RTT and compute the new RTO */
 
-	rttengine_update(&rttengine_stats, internal_get_timestamp(&rttengine_stats) - ntohl(imh->timestamp));
+	rttengine_update(&rttengine_stats, internal_get_timestamp(&rttengine_stats) - ntohl(imh.timestamp));
 
-	/* get the reply in a safe place */
-
-	memcpy(out, (char*)im+sizeof(rudp_msghdr_t), ret);
-	
-	/* free the memory */
-	
-	internal_discard_message(om);
-	internal_discard_message(im);
-
-	/* and *goodbye* */
+	/* the reply is already in the caller's buffer, and *goodbye* */
 
 	rttengine_stats.has_peer = 1;	/* we have a peer it seems */
 	rttengine_stats.retries = 0;	/* next packet can retry like it wishes to */
@@ -290,6 +280,44 @@ sint32_t internal_send_recv(pal_socket_t fd, void *in, sint32_t il, void *out, s
 }
 
 
+/* */
+sint32_t internal_send_message(pal_socket_t fd, rudp_msghdr_t *hdr, void *data, sint32_t len)
+{
+	struct iovec iov[2];
+	struct msghdr msg;
+
+	iov[0].iov_base = (void *)hdr;
+	iov[0].iov_len = sizeof(rudp_msghdr_t);
+	iov[1].iov_base = data;
+	iov[1].iov_len = (data == NULL || len < 0) ? 0 : (size_t)len;
+
+	memset(&msg, 0, sizeof(struct msghdr));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	return (sint32_t)sendmsg(fd, &msg, 0);
+}
+
+
+/* */
+sint32_t internal_recv_message(pal_socket_t fd, rudp_msghdr_t *hdr, void *data, sint32_t len)
+{
+	struct iovec iov[2];
+	struct msghdr msg;
+
+	iov[0].iov_base = (void *)hdr;
+	iov[0].iov_len = sizeof(rudp_msghdr_t);
+	iov[1].iov_base = data;
+	iov[1].iov_len = (data == NULL || len < 0) ? 0 : (size_t)len;
+
+	memset(&msg, 0, sizeof(struct msghdr));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	return (sint32_t)recvmsg(fd, &msg, 0);
+}
+
+
 /* */
 sint32_t rttengine_init(rttengine_stat_t *s) 
 {
@@ -357,23 +385,13 @@ sint32_t rttengine_init(rttengine_stat_t *s)
 
 
 /* */
-sint32_t rttengine_deinit(rttengine_stat_t *s, void *im, void *om) 
+sint32_t rttengine_deinit(rttengine_stat_t *s) 
 {
 	if (s->sai != NULL) {
 		free(s->sai);
 		s->sai = NULL;
 	}
 
-	if (im != NULL) {
-		internal_discard_message(im);
-		im = NULL;
-	}
-
-	if (om != NULL) {
-		internal_discard_message(om);
-		om = NULL;
-	}
-	
 	s->initiated = 0;
 	return s->initiated;
 }
@@ -400,31 +418,6 @@ float rttengine_update(rttengine_stat_t *s, uint32_t rtt)
 }
 
 
-/* */
-void *internal_prepare_message(rudp_msghdr_t **hdr, size_t msglen) 
-{
-	void *buf;
-
-	if (msglen == 0)
-		buf = (rudp_msghdr_t *) malloc(sizeof(rudp_msghdr_t));
-	else buf = (void *) malloc(msglen+sizeof(rudp_msghdr_t));
-
-	if (buf!=NULL)
-		*hdr = buf;
-	return buf;
-	
-}
-
-
-/* */
-void internal_discard_message(void *m) 
-{
-	if (m != NULL)
-		free(m);
-	return;
-}
-
-
 /* */
 uint32_t internal_get_timestamp(rttengine_stat_t *s)
 {
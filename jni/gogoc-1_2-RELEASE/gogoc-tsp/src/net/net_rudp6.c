@@ -34,7 +34,7 @@ sint32_t NetRUDP6Init(void)
 
 sint32_t NetRUDP6Destroy(void) 
 {
-	if ( rttengine_deinit(&rttengine_stats, NULL, NULL) == 0)
+	if ( rttengine_deinit(&rttengine_stats) == 0)
 		return 1;
 	return 0;
 }
@@ -112,12 +112,15 @@ sint32_t NetRUDP6Printf( pal_socket_t sock, char *out, sint32_t ol, char *Format
   char Data[1024];
 
   va_start(argp, Format);
-  pal_vsnprintf(Data, sizeof Data, Format, argp);
+  Length = pal_vsnprintf(Data, sizeof Data, Format, argp);
   va_end(argp);
 
-  Length = pal_strlen(Data);
+  if( Length < 0 )
+    return -1;
+  if( Length >= (sint32_t)sizeof Data )
+    Length = sizeof Data - 1;
 
-  return NetRUDP6ReadWrite(sock, Data, pal_strlen(Data), out, ol);
+  return NetRUDP6ReadWrite(sock, Data, Length, out, ol);
 }
 
 /* */
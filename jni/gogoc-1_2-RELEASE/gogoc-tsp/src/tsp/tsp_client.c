@@ -22,6 +22,7 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #include "net_tcp6.h"
 
 #include "net.h"
+#include "net_resolv.h"
 #include "config.h"
 #include "tsp_cap.h"
 #include "tsp_auth.h"
@@ -29,6 +30,8 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #include "xml_tun.h"
 #include "xml_req.h"
 #include "tsp_redirect.h"
+#include "tsp_trace.h"
+#include "tsp_setup.h"
 
 #include "version.h"
 #include "log.h"
@@ -44,6 +47,10 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #include "haccess.h"
 #endif
 
+#ifdef STANDBY_SUPPORT
+#include "tsp_standby.h"
+#endif
+
 #define CONSEC_RETRY_TO_DOUBLE_WAIT   3   // Consecutive failed connection retries before doubling wait time.
 #define TSP_VERSION_FALLBACK_DELAY    5
 
@@ -104,9 +111,16 @@ gogocTunnelInfo gTunnelInfo;       // Declared `extern' in gogoc_c_wrapper.h
 char* gszBrokerListFile = NULL;   // Local only. NOT USED
 HACCESSStatusInfo gHACCESSStatusInfo;   // Declared `extern' in gogoc_c_wrapper.h
 
+// The tunnel requests are built in static buffers (xml_req.c), and the
+// standby tunnel negotiates from a thread of its own.
+static pal_cs_t request_lock;
+
+// Receive buffer of the TSP sessions of the main thread, reused across
+// reconnections and freed when the client exits.
+static tFrame session_frame;
+
 // --------------------------------------------------------------------------
 // Local function prototypes:
-void                InitNetToolsArray     ( net_tools_t nt_array[] );
 sint32_t            InitLogSystem         ( const tConf* p_config );
 void                tspLogOSInfo          ( void );
 char *              tspAddPayloadString   ( tPayload *, char * );
@@ -114,7 +128,8 @@ gogoc_status         tspUpdateSourceAddr   ( tConf *Conf, pal_socket_t fd );
 gogoc_status         tspTunnelNegotiation  ( pal_socket_t socket, tTunnel *t,
                                             tConf *conf, net_tools_t* nt,
                                             sint32_t version_index,
-                                            tBrokerList **broker_list );
+                                            tBrokerList **broker_list,
+                                            tFrame *frame );
 gogoc_status         tspSetupTunnel        ( tConf *, net_tools_t *,
                                             sint32_t version_index,
                                             tBrokerList **broker_list );
@@ -134,7 +149,10 @@ sint32_t tspExtractPayload(char *Payload, tTunnel *t)
   if((p = strchr(strchr(Payload, '\n'), '<')) == NULL)
     return 1;
   if((rc = tspXMLParse(p, t)) != 0)
+  {
+    tspClearTunnelInfo(t);
     return 1;
+  }
 
   return(0);
 }
@@ -304,61 +322,43 @@ gogoc_status tspUpdateSourceAddr( tConf *pConf, pal_socket_t fd )
 // --------------------------------------------------------------------------
 // tspTunnelNegotiation: Builds and sends a tunnel request to the server.
 //   The server will then offer a tunnel. The tunnel settings will be put
-//   in the tunnel structure(t).
+//   in the tunnel structure(t). The reply is received in the session
+//   receive buffer 'frame'.
 //
-gogoc_status tspTunnelNegotiation( pal_socket_t socket, tTunnel *tunnel_info, tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list )
+gogoc_status tspTunnelNegotiation( pal_socket_t socket, tTunnel *tunnel_info, tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list, tFrame *frame )
 {
   tPayload plin;
-  tPayload plout;
   sint32_t tsp_status;
   sint32_t ret;
 
 
   memset(&plin, 0, sizeof(plin));
-  memset(&plout, 0, sizeof(plout));
 
   // Prepare TSP tunnel request.
+  pal_enter_cs(&request_lock);
   plin.payload = tspAddPayloadString(&plin, tspBuildCreateRequest(conf));
-
-  // Prepare receive buffer.
-  plout.size = REDIRECT_RECEIVE_BUFFER_SIZE;
-  plout.payload = (char *)pal_malloc(REDIRECT_RECEIVE_BUFFER_SIZE);
-  if( plout.payload == NULL )
-  {
-    return make_status(CTX_TSPTUNNEGOTIATION, ERR_MEMORY_STARVATION);
-  }
-  memset(plout.payload, 0, plout.size);
+  pal_leave_cs(&request_lock);
 
   // Send TSP tunnel request over to the server.
-  ret = tspSendRecv(socket, &plin, &plout, nt);
+  ret = tspSendRecv(socket, &plin, frame, nt);
+  pal_free(plin.payload);
+  plin.size = 0;
   if(ret <= 0)
   {
-    pal_free(plout.payload);
-    pal_free(plin.payload);
-    plout.size = plin.size = 0;
-
     Display(LOG_LEVEL_1, ELError, "tspTunnelNegotiation", STR_NET_FAIL_RW_SOCKET);
     return make_status(CTX_TSPTUNNEGOTIATION, ERR_SOCKET_IO);
   }
 
   // Process tunnel reply from server.
-  tsp_status = tspGetStatusCode(plout.payload);
+  tsp_status = tspGetStatusCode(frame->payload);
   if( tspIsRedirectStatus(tsp_status) )
   {
-    if( tspHandleRedirect(plout.payload, conf, broker_list) == TSP_REDIRECT_OK )
+    if( tspHandleRedirect(frame->payload, conf, broker_list) == TSP_REDIRECT_OK )
     {
-      pal_free(plout.payload);
-      pal_free(plin.payload);
-      plout.size = plin.size = 0;
-
       return make_status(CTX_TSPTUNNEGOTIATION, EVNT_BROKER_REDIRECTION);
     }
     else
     {
-      pal_free(plout.payload);
-      pal_free(plin.payload);
-      plout.size = plin.size = 0;
-
       return make_status(CTX_TSPTUNNEGOTIATION, ERR_BROKER_REDIRECTION);
     }
   }
@@ -368,34 +368,32 @@ gogoc_status tspTunnelNegotiation( pal_socket_t socket, tTunnel *tunnel_info, tC
     return make_status(CTX_TSPTUNNEGOTIATION, ERR_TSP_GENERIC_ERROR);
   }
 
-  // Extract the tunnel information from the XML payload.
-  tspExtractPayload(plout.payload, tunnel_info);
-
-  // free some memory
-  pal_free(plout.payload);
-  pal_free(plin.payload);
-  plout.size = plin.size = 0;
-
   // Version 1.0.1 requires that we immediatly jump in tunnel mode.
   // No need to acknowledge the tunnel offered by server.
-  if( version_index == CLIENT_VERSION_INDEX_1_0_1 )
+  // Other versions acknowledge the offer as soon as the success status is
+  // known, so that the server processes the acknowledge while we parse the
+  // offer.
+  if( version_index != CLIENT_VERSION_INDEX_1_0_1 )
   {
-    // Successful operation.
-    return make_status(CTX_TSPTUNNEGOTIATION, SUCCESS);
-  }
+    // Acknowledge TSP tunnel offer to server.
+    memset(&plin, 0, sizeof(plin));
+    pal_enter_cs(&request_lock);
+    plin.payload = tspAddPayloadString(&plin, tspBuildCreateAcknowledge());
+    pal_leave_cs(&request_lock);
+    if( tspSend(socket, &plin, nt) == -1 )
+    {
+      pal_free(plin.payload);
+      Display(LOG_LEVEL_1, ELError, "tspTunnelNegotiation", STR_NET_FAIL_W_SOCKET);
+      return make_status(CTX_TSPTUNNEGOTIATION, ERR_SOCKET_IO);
+    }
 
-  // Acknowledge TSP tunnel offer to server.
-  memset(&plin, 0, sizeof(plin));
-  plin.payload = tspAddPayloadString(&plin, tspBuildCreateAcknowledge());
-  if( tspSend(socket, &plin, nt) == -1 )
-  {
-    Display(LOG_LEVEL_1, ELError, "tspTunnelNegotiation", STR_NET_FAIL_W_SOCKET);
-    return make_status(CTX_TSPTUNNEGOTIATION, ERR_SOCKET_IO);
+    // Free the last of the memory
+    pal_free(plin.payload);
+    plin.size=0;
   }
 
-  // Free the last of the memory
-  pal_free(plin.payload);
-  plin.size=0;
+  // Extract the tunnel information from the XML payload, in place.
+  tspExtractPayload(frame->payload, tunnel_info);
 
   // Successful operation.
   return make_status(CTX_TSPTUNNEGOTIATION, SUCCESS);
@@ -403,13 +401,23 @@ gogoc_status tspTunnelNegotiation( pal_socket_t socket, tTunnel *tunnel_info, tC
 
 
 // --------------------------------------------------------------------------
-// Attempts to negotiate and setup a tunnel with the broker.
+// Connects to the broker, then goes through the TSP capabilities,
+// authentication and tunnel negotiation. On success, the TSP session is
+// left open in 'p_socket' and the tunnel offered is in 'tunnel_params';
+// otherwise, the socket is closed.
 //
-gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list)
+// The replies are received in 'frame', which the caller keeps and reuses
+// across negotiations.
+//
+// With 'trace', the end of each phase is marked in the connection trace
+// and the GUI is told of the connection. The standby tunnel
+// (tsp_standby.h) negotiates without either.
+//
+gogoc_status tspNegotiateTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list,
+                                pal_socket_t *p_socket, tTunnel *tunnel_params, tFrame *frame, tBoolean trace)
 {
   pal_socket_t socket;
   tCapability cap;
-  tTunnel tunnel_params;
   gogoc_status status = STATUS_SUCCESS_INIT;
 
 
@@ -429,9 +437,12 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
   // -----------------------------------------------------------
   // Send(update) connectivity status to GUI.
   // -----------------------------------------------------------
-  gStatusInfo.eStatus = GOGOC_CLISTAT__CONNECTING;
-  gStatusInfo.nStatus = GOGOCM_UIS__NOERROR;
-  send_status_info();
+  if( trace == TRUE )
+  {
+    gStatusInfo.eStatus = GOGOC_CLISTAT__CONNECTING;
+    gStatusInfo.nStatus = GOGOCM_UIS__NOERROR;
+    send_status_info();
+  }
 
 
   // ----------------------------------------------------------------------
@@ -457,6 +468,8 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
     }
     pal_free( srvname );
   }
+  if( trace == TRUE )
+    tspTracePhase(TRACE_PHASE_CONNECT);
   if( conf->transport == NET_TOOLS_T_TCP || conf->transport == NET_TOOLS_T_TCP6 )
   {
     // Only display the 'Connected' message when we're using TCP or TCPv6.
@@ -514,6 +527,8 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
   // --------------------------------------------
   // Perform TSP authentication on the server.
   // --------------------------------------------
+  if( trace == TRUE )
+    tspTracePhase(TRACE_PHASE_CAPABILITIES);
   Display(LOG_LEVEL_3, ELInfo, "tspSetupTunnel", STR_TSP_AUTHENTICATING);
   status = tspAuthenticate(socket, cap, nt, conf, broker_list, version_index);
   switch( status_number(status) )
@@ -530,6 +545,8 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
     return status;
   }
   Display(LOG_LEVEL_2, ELInfo, "tspSetupTunnel", STR_TSP_AUTH_SUCCESSFUL);
+  if( trace == TRUE )
+    tspTracePhase(TRACE_PHASE_AUTHENTICATION);
 
 
   // -------------------------------------------------------------------
@@ -549,7 +566,7 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
   // Build and send TSP tunnel request. Then, get tunnel parameters.
   // ----------------------------------------------------------------
   Display(LOG_LEVEL_3, ELInfo, "tspSetupTunnel", STR_TSP_NEGOTIATING_TUNNEL);
-  status = tspTunnelNegotiation( socket, &tunnel_params, conf, nt, version_index, broker_list );
+  status = tspTunnelNegotiation( socket, tunnel_params, conf, nt, version_index, broker_list, frame );
   switch( status_number(status) )
   {
   case SUCCESS:
@@ -565,15 +582,24 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
     return status;
   }
   Display(LOG_LEVEL_2, ELInfo, "tspSetupTunnel", STR_TSP_TUNNEL_NEGO_SUCCESSFUL);
+  if( trace == TRUE )
+    tspTracePhase(TRACE_PHASE_NEGOTIATION);
 
 #ifdef DSLITE_SUPPORT
   }
   else
   {
-      memset(&tunnel_params, 0, sizeof(tunnel_params));
-      tunnel_params.type = pal_strdup(STR_CONFIG_TUNNELMODE_V4V6);
-      tunnel_params.lifetime = pal_strdup("0");
-      tunnel_params.keepalive_interval = pal_strdup("0");
+      memset(tunnel_params, 0, sizeof(tTunnel));
+      if( tspTunnelAllocArena(tunnel_params, sizeof(STR_CONFIG_TUNNELMODE_V4V6) + 4 +
+                              (INET6_ADDRSTRLEN + 1) + pal_strlen(conf->client_v6) + 1 +
+                              pal_strlen(conf->dslite_server) + 1 + pal_strlen(conf->dslite_client) + 1) != 0 )
+      {
+        tspClose( socket, nt );
+        return make_status(CTX_UNSPECIFIED, ERR_MEMORY_STARVATION);
+      }
+      tunnel_params->type = tspTunnelStrdup(tunnel_params, STR_CONFIG_TUNNELMODE_V4V6);
+      tunnel_params->lifetime = tspTunnelStrdup(tunnel_params, "0");
+      tunnel_params->keepalive_interval = tspTunnelStrdup(tunnel_params, "0");
 
       status = tspUpdateSourceAddr(conf, socket);
       if( status_number(status) != SUCCESS )
@@ -594,16 +620,38 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
               return make_status(CTX_UNSPECIFIED, ERR_INVAL_GOGOC_ADDRESS);
           }
       
-          tunnel_params.server_address_ipv6 = pal_strdup(addr_str);
+          tunnel_params->server_address_ipv6 = tspTunnelStrdup(tunnel_params, addr_str);
       }
       
-      tunnel_params.client_address_ipv6 = pal_strdup(conf->client_v6);
+      tunnel_params->client_address_ipv6 = tspTunnelStrdup(tunnel_params, conf->client_v6);
 
-      tunnel_params.server_address_ipv4 = pal_strdup(conf->dslite_server);
-      tunnel_params.client_address_ipv4 = pal_strdup(conf->dslite_client);
+      tunnel_params->server_address_ipv4 = tspTunnelStrdup(tunnel_params, conf->dslite_server);
+      tunnel_params->client_address_ipv4 = tspTunnelStrdup(tunnel_params, conf->dslite_client);
   }
 #endif
-  
+
+  *p_socket = socket;
+  return status;
+}
+
+
+// --------------------------------------------------------------------------
+// Attempts to negotiate and setup a tunnel with the broker. The end of each
+// setup phase is marked in the connection trace.
+//
+static gogoc_status tspSetupTunnelAttempt(tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list)
+{
+  pal_socket_t socket;
+  tTunnel tunnel_params;
+  gogoc_status status;
+
+
+  status = tspNegotiateTunnel(conf, nt, version_index, broker_list, &socket, &tunnel_params, &session_frame, TRUE);
+  if( status_number(status) != SUCCESS )
+  {
+    return status;
+  }
+
 
   // -------------------------------------------------------------------
   // Save the current server address to the last-tsp-server.txt file.
@@ -632,6 +680,34 @@ gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index
 }
 
 
+// --------------------------------------------------------------------------
+// Attempts to negotiate and setup a tunnel with the broker, and records the
+// attempt in the connection trace.
+//
+// The trace is normally closed earlier, by the platform code, once the tunnel
+// is up. If it is still open here, the attempt failed or ended before that.
+//
+// A tunnel kept configured by the previous attempt is only worth keeping
+// until the next one sets the interface up again. If this attempt did not
+// get that far, the kept tunnel is torn down, unless keep_tunnel asks to
+// keep it across failed attempts and broker redirections.
+//
+gogoc_status tspSetupTunnel(tConf *conf, net_tools_t* nt, sint32_t version_index, tBrokerList **broker_list)
+{
+  gogoc_status status;
+  uint32_t kept_serial = tspKeptTunnelSerial();
+
+  tspTraceBegin(conf->server, conf->transport);
+  status = tspSetupTunnelAttempt(conf, nt, version_index, broker_list);
+  tspTraceEnd(status);
+
+  if( tspKeptTunnelSerial() == kept_serial && conf->keep_tunnel == FALSE )
+    tspReleaseTunnel();
+
+  return status;
+}
+
+
 // --------------------------------------------------------------------------
 // Function : RetrieveStatusInfo
 //
@@ -783,6 +859,49 @@ error_t RetrieveHACCESSStatusInfo( HACCESSStatusInfo** ppHACCESSStatusInfo )
 #endif
 }
 
+// --------------------------------------------------------------------------
+// Function : RetrieveConnTrace
+//
+// Description:
+//   Will allocate and populate ppConnTrace with the last connection attempt.
+//
+// Arguments:
+//   ppConnTrace: gogocConnTrace** [IN,OUT], The connection trace.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: Successfully retrieved the last connection attempt.
+//   GOGOCM_UIS_ERRUNKNOWN: No attempt was traced yet, or out of memory.
+//
+// --------------------------------------------------------------------------
+error_t RetrieveConnTrace( gogocConnTrace** ppConnTrace )
+{
+  tTraceRecord record;
+  gogocConnTrace* pTrace;
+  int i;
+
+  assert( *ppConnTrace == NULL );
+
+  if( tspTraceGetRecords( &record, 1 ) != 1 )
+    return GOGOCM_UIS_ERRUNKNOWN;
+
+  pTrace = (gogocConnTrace*) pal_malloc( sizeof(gogocConnTrace) );
+  if( pTrace == NULL )
+    return GOGOCM_UIS_ERRUNKNOWN;
+
+  pTrace->nAttempt = record.attempt;
+  pTrace->attemptTime = record.started;
+  pTrace->nTransport = record.transport;
+  pTrace->szBrokerName = pal_strdup( record.broker );
+  pTrace->nStatus = record.status;
+  for( i = 0; i < GOGOC_CONNTRACE_PHASES && i < TRACE_PHASE_COUNT; i++ )
+    pTrace->nPhaseMs[i] = record.phase_ms[i];
+  pTrace->nTotalMs = record.total_ms;
+
+  *ppConnTrace = pTrace;
+
+  return GOGOCM_UIS__NOERROR;
+}
+
 // --------------------------------------------------------------------------
 void FreeStatusInfo( gogocStatusInfo** ppStatusInfo )
 {
@@ -817,6 +936,17 @@ void FreeBrokerList( gogocBrokerList** ppBrokerList )
   }
 }
 
+// --------------------------------------------------------------------------
+void FreeConnTrace( gogocConnTrace** ppConnTrace )
+{
+  if( *ppConnTrace != NULL )
+  {
+    pal_free( (*ppConnTrace)->szBrokerName );
+    pal_free( *ppConnTrace );
+    *ppConnTrace = NULL;
+  }
+}
+
 // --------------------------------------------------------------------------
 void FreeHACCESSStatusInfo( HACCESSStatusInfo** ppHACCESSStatusInfo )
 {
@@ -855,6 +985,34 @@ error_t NotifyhaccessConfigInfo( const HACCESSConfigInfo* aHACCESSConfigInfo )
 }
 
 
+// --------------------------------------------------------------------------
+// Function : NotifyLogConfigInfo
+//
+// Description:
+//   CALLBACK function from the Messaging Subsystem upon reception of a
+//   Log Config Info message. Changes the log levels without a restart.
+//
+// Arguments:
+//   aLogConfigInfo: gogocLogConfigInfo* [IN], The log levels from the GUI.
+//
+// Return values:
+//   GOGOCM_UIS__NOERROR: The log levels were changed.
+//   GOGOCM_UIS_ERRCFGDATA: A log level is invalid.
+//
+// --------------------------------------------------------------------------
+error_t NotifyLogConfigInfo( const gogocLogConfigInfo* aLogConfigInfo )
+{
+  if( aLogConfigInfo->nDuration > LOG_BURST_MAX ||
+      LogSetLevels( aLogConfigInfo->nLogLevelConsole, aLogConfigInfo->nLogLevelFile,
+                    aLogConfigInfo->nLogLevelSyslog, (sint32_t)aLogConfigInfo->nDuration ) != 0 )
+  {
+    return GOGOCM_UIS_ERRCFGDATA;
+  }
+
+  return GOGOCM_UIS__NOERROR;
+}
+
+
 // --------------------------------------------------------------------------
 // Function: FormatBrokerListAddr
 //
@@ -962,6 +1120,14 @@ sint32_t tspMain(sint32_t argc, char *argv[])
   // Log the OS information through the log system.
   tspLogOSInfo();
 
+  // Start the resolver, with the server names cached by the previous runs.
+  NetResolvInit( c.resolv_cache_file );
+
+  // Start tracing the connection attempts.
+  tspTraceInit();
+
+  pal_init_cs(&request_lock);
+
   // Keep track of the broker list.
   gszBrokerListFile = c.broker_list_file; // For BROKER_LIST gogocmessaging message.
 
@@ -1435,6 +1601,9 @@ sint32_t tspMain(sint32_t argc, char *argv[])
 
                 tspLogRedirectionList(broker_list, 0);
 
+                // Resolve all the brokers while we try the first one.
+                tspPrefetchBrokerList(broker_list);
+
                 // We're going through a broker list.
                 trying_broker_list = 1;
                 // We're not trying the original server anymore.
@@ -1757,6 +1926,17 @@ sint32_t tspMain(sint32_t argc, char *argv[])
   } while (!c.boot_mode);
 
 endtspc:
+#ifdef STANDBY_SUPPORT
+  // The standby tunnel is of no use without the client.
+  tspStandbyStop();
+#endif
+
+  // Tear down the tunnel kept for a reconnection that will not happen.
+  tspReleaseTunnel();
+
+  // Free the receive buffer of the TSP sessions.
+  tspFreeFrame(&session_frame);
+
   // Send final status to GUI.
   send_status_info();
 
@@ -1778,6 +1958,9 @@ endtspc:
   else
     Display(LOG_LEVEL_1, ELInfo, "tspMain", STR_GEN_FINISHED);
 
+  // Wait for the background lookups.
+  NetResolvDestroy();
+
   // Close the log system
   LogClose();
 
@@ -1876,10 +2059,22 @@ sint32_t InitLogSystem( const tConf* p_config )
   p_log_config->log_level_console = p_config->log_level_console;
   p_log_config->log_level_syslog = p_config->log_level_syslog;
   p_log_config->log_level_file = p_config->log_level_file;
+  p_log_config->log_level_event = p_config->log_level_event;
+  p_log_config->event_filename = pal_strdup(p_config->log_event_filename);
+  p_log_config->event_size = p_config->log_event_size;
+  p_log_config->log_level_memory = p_config->log_level_memory;
+  p_log_config->memory_filename = pal_strdup(p_config->log_memory_filename);
+  p_log_config->memory_size = p_config->log_memory_size;
   p_log_config->syslog_facility = p_config->syslog_facility;
   p_log_config->log_rotation = p_config->log_rotation;
   p_log_config->log_rotation_size = p_config->log_rotation_size;
   p_log_config->delete_rotated_log = p_config->log_rotation_delete;
+  p_log_config->rotation_count = p_config->log_rotation_count;
+  p_log_config->compress_rotated_log = p_config->log_rotation_compress;
+  p_log_config->async = p_config->log_async;
+  p_log_config->flush_interval = p_config->log_flush_interval;
+  p_log_config->timestamp_digits = p_config->log_timestamp_precision;
+  p_log_config->timestamp_iso8601 = p_config->log_timestamp_iso8601;
   p_log_config->buffer = 0;
 
   // Configure the logging system with the values provided above.
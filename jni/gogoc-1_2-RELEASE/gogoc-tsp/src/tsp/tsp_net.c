@@ -15,6 +15,7 @@
 #include "net.h"
 #include "log.h"
 #include "hex_strings.h"
+#include "tsp_redirect.h"    // REDIRECT_RECEIVE_BUFFER_SIZE
 
 
 // --------------------------------------------------------------------------
@@ -55,86 +56,177 @@ gogoc_status tspClose(pal_socket_t sock, net_tools_t *nt)
 }
 
 
+// --------------------------------------------------------------------------
+// tspGrowFrame: Makes sure the frame buffer can hold 'size' bytes.
+//
+static sint32_t tspGrowFrame( tFrame *frame, long size )
+{
+  char *buffer;
+
+  if( size <= frame->capacity )
+    return 0;
+
+  if( (buffer = (char *)pal_realloc(frame->buffer, size)) == NULL )
+  {
+    Display(LOG_LEVEL_1, ELError, "tspGrowFrame", STR_GEN_MALLOC_ERROR);
+    return -1;
+  }
+
+  frame->buffer = buffer;
+  frame->capacity = size;
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// tspParseFrameHeader: Looks for the 'Content-length: n' line in the bytes
+//   received so far. Can be called again as more bytes come in.
+//
+// Return values:
+//   >0: Length of the header line, frame->size is set.
+//    0: The header line is not complete yet.
+//   -1: Invalid header.
+//
+static sint32_t tspParseFrameHeader( tFrame *frame )
+{
+  char *eol;
+  long cmp_len = (frame->length < 15) ? frame->length : 15;
+
+  // Validate that we got 'Content-Length', even partially.
+  if( memcmp(frame->buffer, "Content-length:", cmp_len) )
+  {
+    frame->buffer[frame->length] = 0;
+    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_EXPECTED_CONTENT_LENGTH, frame->buffer);
+    return -1;
+  }
+
+  if( (eol = memchr(frame->buffer, '\n', frame->length)) == NULL )
+  {
+    // test if valid data received (see bug 3295)
+    if( frame->length >= PROTOCOLMAXHEADER )
+    {
+      Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_RECV_INVALID_TSP_DATA);
+      return -1;
+    }
+    return 0;
+  }
+
+  // validate received data using Content-Length (see bug: 3164)
+  if( (frame->size = atol(frame->buffer + 15)) <= 0L )
+  {
+    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_INVALID_PAYLOAD_SIZE);
+    return -1;
+  }
+
+  // The frame buffer is grown to the announced size: do not let the server
+  // make it allocate whatever it likes.
+  if( frame->size > PROTOCOLMAXPAYLOAD )
+  {
+    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_PAYLOAD_TOO_LARGE, frame->size, PROTOCOLMAXPAYLOAD);
+    return -1;
+  }
+
+  return (sint32_t)(eol - frame->buffer) + 1;
+}
+
+
 // --------------------------------------------------------------------------
 // tspSendRecv: Sends a payload to server and receives reply payload.
-//   NOTE: plin is data to be sent and plout->payload is a buffer for data to
-//         be received.
+//   NOTE: plin is data to be sent and the reply is received in the frame
+//         buffer, which is reused for the whole session. The reply payload
+//         is left in place (frame->payload), no copy is made.
 //
-sint32_t tspSendRecv(pal_socket_t socket, tPayload *plin, tPayload *plout, net_tools_t *nt)
+sint32_t tspSendRecv(pal_socket_t socket, tPayload *plin, tFrame *frame, net_tools_t *nt)
 {
   char string[] = "Content-length: %ld\r\n";
   char buffer[PROTOCOLFRAMESIZE];
-  char *ptr_b, *ptr_c;
-  sint32_t read, ret, size, left;
+  sint32_t read, ret, size, header = 0;
 
 
   // add in content-length to data to be sent.
   pal_snprintf(buffer, PROTOCOLFRAMESIZE, string, plin->size);
   size = pal_strlen(buffer);
+  if( size + plin->size >= PROTOCOLFRAMESIZE )
+  {
+    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_PAYLOAD_BIGGER_PROTOFRMSIZE);
+    return -1;
+  }
   memcpy(buffer + size, plin->payload, plin->size);
 
   buffer[size + plin->size] = 0;
   Display(LOG_LEVEL_3, ELInfo, "tspSendRecv", STR_NET_SENDING, buffer);
 
-  // Send 'buffer', recv in 'plout->payload'.
-  ret = nt->netsendrecv(socket, buffer, size + plin->size, plout->payload, plout->size);
+  // The first read must be able to hold a complete datagram.
+  if( tspGrowFrame(frame, REDIRECT_RECEIVE_BUFFER_SIZE) != 0 )
+    return -1;
+  frame->length = 0;
+  frame->payload = NULL;
+  frame->size = 0;
+
+  // Send 'buffer', recv in the frame buffer (keep room for the last 0).
+  ret = nt->netsendrecv(socket, buffer, size + plin->size, frame->buffer, frame->capacity - 1);
   if( ret <= 0 )
   {
     Display(LOG_LEVEL_1, ELError, "tspSendRecv", STR_NET_FAIL_RW_SOCKET);
     return ret;
   }
+  frame->length = ret;
 
-  // Validate that we got 'Content-Length'.
-  if( memcmp(plout->payload, "Content-length:", 15) )
-  {
-    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_EXPECTED_CONTENT_LENGTH, plout->payload);
-    return -1;
-  }
-
-  /* strip it from the returned string */
-  ptr_c = strchr(plout->payload, '\n');
-
-  /* test if valid data received (see bug 3295) */
-  if( ptr_c == NULL )
+  // Read until the whole header line is in, then until the whole payload is.
+  while( 1 )
   {
-    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_RECV_INVALID_TSP_DATA);
-    return -1;
-  }
-  ptr_c++;
-  size = pal_strlen(ptr_c);
+    if( header == 0 )
+    {
+      if( (header = tspParseFrameHeader(frame)) < 0 )
+        return -1;
+
+      if( header > 0 )
+      {
+        if( frame->length - header > frame->size )
+        {
+          Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_INVALID_PAYLOAD_SIZE);
+          return -1;
+        }
+
+        // need space for a little 0 at the end.
+        if( tspGrowFrame(frame, header + frame->size + 1) != 0 )
+          return -1;
+      }
+    }
 
-  /* validate received data using Content-Length (see bug: 3164) */
-  if( ((plout->size = atol(plout->payload + 15)) <= 0L) || (size > plout->size) )
-  {
-    Display(LOG_LEVEL_1, ELError, "tspSendRecv", GOGO_STR_INVALID_PAYLOAD_SIZE);
-    return -1;
-  }
+    if( header > 0 && frame->length - header == frame->size )
+      break;
 
-  left = plout->size - size;
-  while( left > 0 )
-  {
-    if( (read = nt->netrecv(socket, (ptr_c + size), left)) <= 0 )
+    read = (header > 0) ? (header + frame->size - frame->length) : (frame->capacity - 1 - frame->length);
+    if( (read = nt->netrecv(socket, frame->buffer + frame->length, read)) <= 0 )
     {
       Display(LOG_LEVEL_1, ELError, "tspSendRecv", STR_NET_FAIL_R_SOCKET);
       return PROTOCOL_ERROR;
     }
-    size += read;
-    left -= read;
+    frame->length += read;
   }
 
-  ptr_b = (char *)pal_malloc(++size); // need space for a little 0 at the end */
-  memset(ptr_b, 0, size);
-  memcpy(ptr_b, ptr_c, --size);   /* but need not to overwrite that little 0 */
+  frame->buffer[frame->length] = 0;
+  frame->payload = frame->buffer + header;
 
-  pal_free(plout->payload);
-  plout->payload = ptr_b;
-
-  Display(LOG_LEVEL_3, ELInfo, "tspSendRecv", STR_NET_RECEIVED, plout->payload);
+  Display(LOG_LEVEL_3, ELInfo, "tspSendRecv", STR_NET_RECEIVED, frame->payload);
 
   return ret;
 }
 
 
+// --------------------------------------------------------------------------
+// tspFreeFrame: Releases the session receive buffer.
+//
+void tspFreeFrame(tFrame *frame)
+{
+  if( frame->buffer != NULL )
+    pal_free(frame->buffer);
+
+  memset(frame, 0, sizeof(tFrame));
+}
+
+
 // --------------------------------------------------------------------------
 // tspSend:
 //
@@ -16,6 +16,7 @@ Copyright (c) 2001-2008 gogo6 Inc. All rights reserved.
 #include "tsp_redirect.h"
 #include "tsp_client.h"
 #include "xml_tun.h"
+#include "net_resolv.h"
 #include "hex_strings.h"
 
 /* Determine if a TSP status code means that */
@@ -38,6 +39,19 @@ tRedirectStatus tspFreeBrokerList(tBrokerList *broker_list) {
 	return TSP_REDIRECT_OK;
 }
 
+/* Start resolving the names in a broker list, all at once, in the background */
+tRedirectStatus tspPrefetchBrokerList(tBrokerList *broker_list) {
+	tBrokerList *current_broker = NULL;
+
+	for (current_broker = broker_list; current_broker != NULL; current_broker = current_broker->next) {
+		if (current_broker->address_type == TSP_REDIRECT_BROKER_TYPE_FQDN) {
+			NetResolvPrefetch(current_broker->address);
+		}
+	}
+
+	return TSP_REDIRECT_OK;
+}
+
 /* Add a new broker element to a list of brokers */
 tRedirectStatus tspAddBrokerToList(tBrokerList **broker_list, char *address, tBrokerAddressType address_type, uint32_t distance) {
 	tBrokerList *new_broker = NULL;
@@ -351,6 +365,12 @@ tRedirectStatus tspHandleRedirect(char *payload, tConf *conf, tBrokerList **brok
 
 	tspLogReceivedRedirection(payload, conf);
 
+	/* The caller does not follow redirections (the standby tunnel) */
+	if (broker_list == NULL) {
+		Display(LOG_LEVEL_2, ELInfo, "tspHandleRedirect", GOGO_STR_RDR_NOT_FOLLOWED);
+		return TSP_REDIRECT_NOT_FOLLOWED;
+	}
+
 	/* Parse the XML data in the payload */
 	if (tspExtractPayload(payload, &tunnel_info) != 0) {
 		Display(LOG_LEVEL_1, ELError, "tspHandleRedirect", GOGO_STR_RDR_CANT_EXTRACT_PAYLOAD);
@@ -359,10 +379,17 @@ tRedirectStatus tspHandleRedirect(char *payload, tConf *conf, tBrokerList **brok
 
 	/* Create a broker list from that information */
 	if (tspCreateBrokerList(&tunnel_info, broker_list, &broker_count) != TSP_REDIRECT_OK) {
+		tspClearTunnelInfo(&tunnel_info);
 		Display(LOG_LEVEL_1, ELError, "tspHandleRedirect", GOGO_STR_RDR_CANT_CREATE_LIST);
 		return TSP_REDIRECT_CANT_CREATE_LIST;
 	}
 
+	/* The broker list holds its own copy of the addresses */
+	tspClearTunnelInfo(&tunnel_info);
+
+	/* Resolve the brokers while the list is logged and timed */
+	tspPrefetchBrokerList(*broker_list);
+
 	/* Log the redirection message and details */
 	if (tspLogRedirectionList(*broker_list, 0) != TSP_REDIRECT_OK) {
 		Display(LOG_LEVEL_1, ELError, "tspHandleRedirect", GOGO_STR_RDR_CANT_LOG);
@@ -8,6 +8,8 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 -----------------------------------------------------------------------------
 */
 
+#define _GNU_SOURCE             // pipe2()
+
 #include "platform.h"
 #include "gogoc_status.h"       // Error codes
 
@@ -20,6 +22,18 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #include "hex_strings.h"  // Strings for Display()
 #include "lib.h"          // IsAll, IPv4Addr, IPv6Addr, IPAddrAny, Numeric.
 
+#ifdef NETLINK_SUPPORT
+#include "tsp_netlink.h"  // tspNetlinkSetupInterface()
+#endif
+
+#ifdef SPAWN_SUPPORT
+#include <spawn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
 // gogoCLIENT Messaging Subsystem.
 #include <gogocmessaging/gogoc_c_wrapper.h>
 
@@ -33,265 +47,324 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #endif
 
 
-#ifdef ANDROID
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <sys/ioctl.h>
-#include <linux/if.h>
-#include <linux/route.h>
-
-struct in6_rtmsg {
-  struct in6_addr rtmsg_dst;
-  struct in6_addr rtmsg_src;
-  struct in6_addr rtmsg_gateway;
-  __u32           rtmsg_type;
-  __u16           rtmsg_dst_len;
-  __u16           rtmsg_src_len;
-  __u32           rtmsg_metric;
-  unsigned long   rtmsg_info;
-  __u32           rtmsg_flags;
-  int             rtmsg_ifindex;
-};
-
-static int ifup(const char *name, const char *host, int prefix, int mtu)
+// Tunnel left configured by the last connection, that the next tunnel setup
+// reconciles against. See tspKeepTunnel().
+static tTunnel    kept_tunnel;
+static tConf*     kept_conf = NULL;
+static uint32_t   kept_serial = 0;
+
+
+// --------------------------------------------------------------------------
+// Adds a variable to the environment of the next script run.
+//
+static void scriptSetEnv( tScriptEnv *env, char *name, char *value )
 {
-  int retcode = -1;
-  struct ifreq ifr;
-  struct in6_ifreq ifr6;
+#ifdef SPAWN_SUPPORT
+  int n;
 
-  int sock;
-  if ((sock = socket(AF_INET6, SOCK_DGRAM, 0)) < 0) {
-    fprintf(stderr, "Cannot Create Socket\n");
-    return -1;
-  }
+  if( value == NULL || env->count >= SCRIPT_ENV_MAX )
+    return;
 
-  strncpy(ifr.ifr_name, name, IFNAMSIZ);
-  if (ioctl(sock, SIOGIFINDEX, &ifr) < 0) {
-    perror("SIOGIFINDEX");
-    goto error;
-  }
+  n = pal_snprintf( env->buf + env->len, sizeof(env->buf) - env->len, "%s=%s", name, value );
+  if( n < 0 || (size_t)n >= sizeof(env->buf) - env->len )
+    return;
 
-  ifr6.ifr6_ifindex = ifr.ifr_ifindex;
-  ifr6.ifr6_prefixlen = prefix;
-  inet_pton(AF_INET6, host, &ifr6.ifr6_addr);
+  env->vars[env->count++] = env->buf + env->len;
+  env->vars[env->count] = NULL;
+  env->len += n + 1;
+  Display( LOG_LEVEL_3, ELInfo, "scriptSetEnv", GOGO_STR_SCRIPT_ENV, name, value );
+#else
+  (void)env;
+  tspSetEnv( name, value, 1 );
+#endif
+}
 
-  if(ioctl(sock, SIOCSIFADDR, &ifr6) < 0) {
-    perror("SIOCSIFADDR");
-    goto error;
+// --------------------------------------------------------------------------
+// Logs a line of output of the template script. The output is logged in
+// full: it is not held to the rate limit of a Display() call site, which
+// would drop most of the lines of a verbose script.
+//
+static void scriptLogLine( const char *line )
+{
+  if( LOG_ENABLED( LOG_LEVEL_MAX, ELInfo ) )
+  {
+    LogDisplay( NULL, LOG_LEVEL_MAX, ELInfo, "execScript", "%s", line );
   }
+}
 
-  if (ioctl(sock, SIOCGIFFLAGS, &ifr)) {
-    perror("SIOCGIFFLAGS");
-    goto error;
-  }
 
-  ifr.ifr_flags |= IFF_UP;
-  ifr.ifr_flags |= IFF_RUNNING;
-  if (ioctl(sock, SIOCSIFFLAGS, &ifr)) {
-    perror("SIOCSIFFLAGS");
-    goto error;
-  }
+#ifdef SPAWN_SUPPORT
+// Serializes the creation of the output pipes with the spawns, so that no
+// script inherits the pipe of another.
+static pthread_mutex_t spawn_lock = PTHREAD_MUTEX_INITIALIZER;
 
-  ifr.ifr_mtu = mtu;
-  if(ioctl(sock, SIOCSIFMTU, &ifr) < 0) {
-    perror("SIOCSIFMTU");
-    goto error;
-  }
+// --------------------------------------------------------------------------
+// Returns the environment of a script: the variables of 'env', then those
+// of the client that 'env' does not override. Free with pal_free().
+//
+static char** scriptEnvp( const tScriptEnv *env )
+{
+  char **envp, **e;
+  size_t len;
+  sint32_t n = 0, i;
 
-  retcode = 0;
+  for( e = environ; *e != NULL; e++ )
+    n++;
 
-error:
-  close(sock);
-  return retcode;
-}
+  envp = (char**)pal_malloc( (n + env->count + 1) * sizeof(char*) );
+  if( envp == NULL )
+    return NULL;
 
-#define IFINET6 "/proc/net/if_inet6"
-static int ifdown(char *name, int down) {
-  int sock;
-  FILE *f;
-  char addr6[40], devname[20];
-  int plen, scope, dad_status, if_idx = -1;
-  char addr6p[8][5];
-  struct in6_ifreq ifr6;
-  struct ifreq ifr;
-
-  if ((sock = socket(AF_INET6, SOCK_DGRAM, 0)) < 0) {
-    fprintf(stderr, "Cannot Create Socket\n");
-    return -1;
-  }
-  f = fopen(IFINET6, "r");
-  if (f == NULL)
-    return -1;
-  while (fscanf(f, "%4s%4s%4s%4s%4s%4s%4s%4s %08x %02x %02x %02x %20s\n",
-        addr6p[0], addr6p[1], addr6p[2], addr6p[3],
-        addr6p[4], addr6p[5], addr6p[6], addr6p[7],
-        &if_idx, &plen, &scope, &dad_status, devname) != EOF) {
-    if (!strcmp(devname, name)) {
-      sprintf(addr6, "%s:%s:%s:%s:%s:%s:%s:%s",
-          addr6p[0], addr6p[1], addr6p[2], addr6p[3],
-          addr6p[4], addr6p[5], addr6p[6], addr6p[7]);
-      ifr6.ifr6_ifindex = if_idx;
-      ifr6.ifr6_prefixlen = plen;
-      inet_pton(AF_INET6, addr6, &ifr6.ifr6_addr);
-      if(ioctl(sock, SIOCDIFADDR, &ifr6) < 0) {
-        perror("SIOCDIFADDR");
-      }
-    }
-  }
-  if (if_idx != -1 && down) {
-    strncpy(ifr.ifr_name, name, IFNAMSIZ);
-    if (ioctl(sock, SIOCGIFFLAGS, &ifr)) {
-      perror("SIOCGIFFLAGS");
-    }
+  n = 0;
+  for( i = 0; i < env->count; i++ )
+    envp[n++] = env->vars[i];
 
-    ifr.ifr_flags &= ~IFF_UP;
-    if (ioctl(sock, SIOCSIFFLAGS, &ifr)) {
-      perror("SIOCSIFFLAGS");
+  for( e = environ; *e != NULL; e++ )
+  {
+    len = strcspn( *e, "=" );
+    for( i = 0; i < env->count; i++ )
+    {
+      if( strncmp( env->vars[i], *e, len + 1 ) == 0 )
+        break;
     }
+    if( i == env->count )
+      envp[n++] = *e;
   }
-  close(sock);
-  fclose(f);
-  return 0;
+  envp[n] = NULL;
+
+  return envp;
 }
 
-static int route(const char *name, const char *host, int prefix, int action)
+// --------------------------------------------------------------------------
+// Logs the complete lines at the start of 'buf', and moves what is left to
+// the start. What is left is logged as well with 'flush', or when it fills
+// the buffer: a line longer than the buffer is logged in pieces.
+//
+static void scriptLogLines( char *buf, size_t size, size_t *len, sint32_t flush )
 {
-  int sock;
-  int retcode = -1;
-  struct ifreq ifr;
-  struct in6_rtmsg rt;
+  char *line = buf, *end;
 
-  memset(&rt, 0, sizeof(rt));
-  inet_pton(AF_INET6, host, &rt.rtmsg_dst);
+  while( (end = memchr( line, '\n', *len - (line - buf) )) != NULL )
+  {
+    *end = '\0';
+    scriptLogLine( line );
+    line = end + 1;
+  }
 
-  rt.rtmsg_dst_len = prefix;
-  rt.rtmsg_flags = ((prefix == 128) ? (RTF_UP|RTF_HOST) : RTF_UP);
-  rt.rtmsg_metric = 1;
+  *len -= line - buf;
+  memmove( buf, line, *len );
 
-  if ((sock = socket(AF_INET6, SOCK_DGRAM, 0)) < 0) {
-    fprintf(stderr, "Cannot Create Socket\n");
-    return -1;
+  if( *len > 0 && (flush || *len == size - 1) )
+  {
+    buf[*len] = '\0';
+    scriptLogLine( buf );
+    *len = 0;
   }
+}
 
-  if (name && strncpy(ifr.ifr_name, name, IFNAMSIZ)
-    && ioctl(sock, SIOGIFINDEX, &ifr) == 0) {
-    rt.rtmsg_ifindex = ifr.ifr_ifindex;
-  }
+// --------------------------------------------------------------------------
+// Milliseconds left until the deadline of a script. On the deadline, kills
+// the script with the processes it started, and returns 0.
+//
+static long scriptTimeLeft( const struct timespec *deadline, pid_t pid )
+{
+  struct timespec now;
+  long left;
 
-  if (ioctl(sock, action ? SIOCADDRT : SIOCDELRT, &rt) < 0) {
-    perror(action ? "SIOCADDRT" : "SIOCDELRT");
-  } else {
-    retcode = 0;
-  }
-  close(sock);
+  pal_gettime_monotonic( &now );
+  left = (deadline->tv_sec - now.tv_sec) * 1000 + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+  if( left > 0 )
+    return left;
 
-  return retcode;
+  Display( LOG_LEVEL_1, ELError, "spawnScript", GOGO_STR_SCRIPT_TIMEOUT, SCRIPT_TIMEOUT );
+  kill( -pid, SIGKILL );
+  return 0;
 }
 
-static void addroute(const char *interface) {
-  route(interface, "::", 0, 1);
-  route(interface, "2000::", 3, 1);
-}
+// --------------------------------------------------------------------------
+// Runs 'cmd' through the shell in a new process, with 'env' added to its
+// environment, and logs what it writes as it comes. The calling process
+// is not forked, and nothing it shares with other threads is changed:
+// several scripts may run at once.
+//
+// A script that is still running after SCRIPT_TIMEOUT seconds is killed,
+// with the processes it started.
+//
+// Returns the exit status of the shell, as system() does, or -1.
+//
+static sint32_t spawnScript( const char *cmd, const tScriptEnv *env )
+{
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  sigset_t mask;
+  struct timespec deadline;
+  struct timeval tv;
+  fd_set fds;
+  char *argv[4], **envp;
+  char buf[1024];
+  size_t len = 0;
+  pid_t pid;
+  int out[2], s = 0, error, exited = 0, timed_out = 0, n;
+  long left;
 
-static void delroute() {
-  route(NULL, "::", 0, 0);
-  route(NULL, "2000::", 3, 0);
-}
+  envp = scriptEnvp( env );
+  if( envp == NULL )
+    return -1;
 
-#ifndef IP_DF
-#define IP_DF 0x4000
+  argv[0] = "sh";
+  argv[1] = "-c";
+  argv[2] = (char*)cmd;
+  argv[3] = NULL;
+
+  // The script and the processes it starts get a group of their own, with
+  // the default signal mask.
+  sigemptyset( &mask );
+  posix_spawnattr_init( &attr );
+  posix_spawnattr_setflags( &attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK );
+  posix_spawnattr_setpgroup( &attr, 0 );
+  posix_spawnattr_setsigmask( &attr, &mask );
+
+  // The pipe is close-on-exec from the start: the keepalive, path MTU and
+  // standby threads may fork meanwhile. Without pipe2, the flag is only
+  // set afterwards, and the spawns of this function are serialized.
+  pthread_mutex_lock( &spawn_lock );
+#ifdef O_CLOEXEC
+  if( pipe2( out, O_CLOEXEC ) != 0 )
+#else
+  if( pipe( out ) != 0 )
 #endif
-
-#ifndef SIOCDEVPRIVATE
-#define SIOCDEVPRIVATE 0x89F0
+  {
+    error = errno;
+  }
+  else
+  {
+#ifndef O_CLOEXEC
+    fcntl( out[0], F_SETFD, FD_CLOEXEC );
+    fcntl( out[1], F_SETFD, FD_CLOEXEC );
 #endif
-#define SIOCADDTUNNEL (SIOCDEVPRIVATE + 1)
-#define SIOCDELTUNNEL (SIOCDEVPRIVATE + 2)
-struct ip_tunnel_parm {
-  char        name[IFNAMSIZ];
-  int         link;
-  __be16      i_flags;
-  __be16      o_flags;
-  __be32      i_key;
-  __be32      o_key;
- struct iphdr iph;
-};
-
-static int del_tunnel(const char *name)
-{
-  int sock, code;
-  struct ifreq ifr;
-  struct ip_tunnel_parm p;
 
-  if (!name || !name[0]) {
-    return -EINVAL;
+    posix_spawn_file_actions_init( &actions );
+    posix_spawn_file_actions_adddup2( &actions, out[1], STDOUT_FILENO );
+    posix_spawn_file_actions_adddup2( &actions, out[1], STDERR_FILENO );
+    error = posix_spawn( &pid, "/bin/sh", &actions, &attr, argv, envp );
+    posix_spawn_file_actions_destroy( &actions );
+    close( out[1] );
+    if( error != 0 )
+      close( out[0] );
+  }
+  pthread_mutex_unlock( &spawn_lock );
+
+  posix_spawnattr_destroy( &attr );
+  pal_free( envp );
+
+  if( error != 0 )
+  {
+    Display( LOG_LEVEL_1, ELError, "spawnScript", GOGO_STR_CANT_SPAWN, strerror(error) );
+    return -1;
   }
 
-  memset(&p, 0, sizeof(p));
-  p.iph.version = 4;
-  p.iph.ihl = 5;
-  p.iph.frag_off = htons(IP_DF);
-  strncpy(p.name, name, IFNAMSIZ);
+  pal_gettime_monotonic( &deadline );
+  deadline.tv_sec += SCRIPT_TIMEOUT;
+
+  // Log the output until the script exits. Processes it leaves running may
+  // keep the pipe open, so the exit of the shell is checked along the way.
+  while( 1 )
+  {
+    if( (left = scriptTimeLeft( &deadline, pid )) == 0 )
+    {
+      timed_out = 1;
+      break;
+    }
+    if( exited || left > SCRIPT_POLL_INTERVAL )
+      left = exited ? 0 : SCRIPT_POLL_INTERVAL;
+
+    FD_ZERO( &fds );
+    FD_SET( out[0], &fds );
+    tv.tv_sec = left / 1000;
+    tv.tv_usec = (left % 1000) * 1000;
+    n = select( out[0] + 1, &fds, NULL, NULL, &tv );
+    if( n < 0 && errno != EINTR )
+      break;
+
+    if( n > 0 )
+    {
+      n = read( out[0], buf + len, sizeof(buf) - 1 - len );
+      if( n < 0 && errno == EINTR )
+        continue;
+      if( n <= 0 )
+        break;
+
+      len += n;
+      scriptLogLines( buf, sizeof(buf), &len, 0 );
+    }
+    else if( exited )
+    {
+      // Nothing left to read from the shell.
+      break;
+    }
+    else if( waitpid( pid, &s, WNOHANG ) == pid )
+    {
+      exited = 1;
+    }
+  }
+  scriptLogLines( buf, sizeof(buf), &len, 1 );
+  close( out[0] );
 
-  strncpy(ifr.ifr_name, name, IFNAMSIZ);
-  ifr.ifr_ifru.ifru_data = &p;
+  // The shell closed its output, but it may still be running: it is waited
+  // for until the deadline as well.
+  while( !exited && !timed_out )
+  {
+    n = waitpid( pid, &s, WNOHANG );
+    if( n == pid )
+    {
+      exited = 1;
+    }
+    else if( n < 0 && errno != EINTR )
+    {
+      Display( LOG_LEVEL_1, ELError, "spawnScript", GOGO_STR_ERR_WAITING_SCRIPT );
+      return -1;
+    }
+    else if( (left = scriptTimeLeft( &deadline, pid )) == 0 )
+    {
+      timed_out = 1;
+    }
+    else
+    {
+      pal_sleep( left < SCRIPT_POLL_INTERVAL ? left : SCRIPT_POLL_INTERVAL );
+    }
+  }
 
-  sock = socket(AF_INET, SOCK_DGRAM, 0);
-  code = ioctl(sock, SIOCDELTUNNEL, &ifr);
-  if (code) {
-    fprintf(stderr, "delete tunnel %s failed: %s\n",
-        ifr.ifr_name, strerror(errno));
+  // Reap the shell, killed if it timed out.
+  while( !exited && waitpid( pid, &s, 0 ) < 0 )
+  {
+    if( errno != EINTR )
+    {
+      Display( LOG_LEVEL_1, ELError, "spawnScript", GOGO_STR_ERR_WAITING_SCRIPT );
+      return -1;
+    }
   }
-  close(sock);
-  return code;
-}
 
-static int add_tunnel(const char *name, const char *remote, const char *local)
-{
-  int sock, code;
-  struct ifreq ifr;
-  struct ip_tunnel_parm p;
-
-  if (!name || !name[0] || !remote || !remote[0]) {
-    return -EINVAL;
-  }
-
-  memset(&p, 0, sizeof(p));
-  p.iph.version = 4;
-  p.iph.ihl = 5;
-  p.iph.frag_off = htons(IP_DF);
-  p.iph.protocol = IPPROTO_IPV6;
-  p.iph.ttl = 64;
-  inet_pton(AF_INET, remote, &(p.iph.daddr));
-  if (local && local[0]) {
-    inet_pton(AF_INET, local, &(p.iph.saddr));
-  }
-  strncpy(p.name, name, IFNAMSIZ);
-
-  strncpy(ifr.ifr_name, "sit0", IFNAMSIZ);
-  ifr.ifr_ifru.ifru_data = &p;
-  sock = socket(AF_INET, SOCK_DGRAM, 0);
-  code = ioctl(sock, SIOCADDTUNNEL, &ifr);
-  if (code) {
-    fprintf(stderr, "add tunnel %s failed: %s\n",
-        ifr.ifr_name, strerror(errno));
-  }
-  close(sock);
-  return code;
+  if( timed_out )
+    return -1;
+
+  return s;
 }
-#else
+#endif
+
+
 /* Execute cmd and send output to log subsystem */
-sint32_t execScript( const char *cmd )
+sint32_t execScript( const char *cmd, const tScriptEnv *env )
 {
+#ifdef SPAWN_SUPPORT
+  return spawnScript( cmd, env );
+#else
   char buf[1024];
   FILE* f_log;
   sint32_t retVal;
 
+  // The variables were set in the environment of the client (tspSetEnv).
+  (void)env;
+
   // Run the command.
   memset( buf, 0, sizeof(buf) );
   pal_snprintf( buf, sizeof(buf), "%s > %s", cmd, SCRIPT_TMP_FILE );
@@ -310,7 +383,7 @@ sint32_t execScript( const char *cmd )
   {
     if( fgets( buf, sizeof(buf), f_log ) != NULL )
     {
-      Display( LOG_LEVEL_MAX, ELInfo, "execScript", "%s", buf );
+      scriptLogLine( buf );
     }
   }
   // Close file
@@ -320,8 +393,8 @@ sint32_t execScript( const char *cmd )
   pal_unlink( SCRIPT_TMP_FILE );
 
   return retVal;
-}
 #endif
+}
 
 
 // --------------------------------------------------------------------------
@@ -389,80 +462,80 @@ sint32_t validate_tunnel_info( const tTunnel* pTunnelInfo )
 
 // --------------------------------------------------------------------------
 
-void set_tsp_env_variables( const tConf* pConfig, const tTunnel* pTunnelInfo )
+void set_tsp_env_variables( tScriptEnv* env, const tConf* pConfig, const tTunnel* pTunnelInfo )
 {
   char buffer[8];
 
   // Specify log verbosity (MAXIMAL).
   pal_snprintf( buffer, sizeof buffer, "%d", LOG_LEVEL_MAX );
-  tspSetEnv("TSP_VERBOSE", buffer, 1);
+  scriptSetEnv( env, "TSP_VERBOSE", buffer );
 
   // Specify gogoCLIENT installation directory.
-  tspSetEnv("TSP_HOME_DIR", TspHomeDir, 1);
+  scriptSetEnv( env, "TSP_HOME_DIR", TspHomeDir );
 
   // Specify the tunnel mode.
-  tspSetEnv("TSP_TUNNEL_MODE", pTunnelInfo->type, 1);
+  scriptSetEnv( env, "TSP_TUNNEL_MODE", pTunnelInfo->type );
 
   // Specify host type {router, host}
-  tspSetEnv("TSP_HOST_TYPE", pConfig->host_type, 1);
+  scriptSetEnv( env, "TSP_HOST_TYPE", pConfig->host_type );
 
   // Specify tunnel interface, for setup.
   if (pal_strcasecmp(pTunnelInfo->type, STR_XML_TUNNELMODE_V6V4) == 0 )
   {
-    tspSetEnv("TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v6v4, 1);
+    scriptSetEnv( env, "TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v6v4 );
     gTunnelInfo.eTunnelType = TUNTYPE_V6V4;
   }
   else if (pal_strcasecmp(pTunnelInfo->type, STR_XML_TUNNELMODE_V6UDPV4) == 0 )
   {
-    tspSetEnv("TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v6udpv4, 1);
+    scriptSetEnv( env, "TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v6udpv4 );
     gTunnelInfo.eTunnelType = TUNTYPE_V6UDPV4;
   }
 #ifdef V4V6_SUPPORT
   else if (pal_strcasecmp(pTunnelInfo->type, STR_XML_TUNNELMODE_V4V6) == 0 )
   {
-    tspSetEnv("TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v4v6, 1);
+    scriptSetEnv( env, "TSP_TUNNEL_INTERFACE", pConfig->if_tunnel_v4v6 );
     gTunnelInfo.eTunnelType = TUNTYPE_V4V6;
   }
 #endif /* V4V6_SUPPORT */
 
   // Specify what interface will be used for routing advertizement,
   // if enabled.
-  tspSetEnv("TSP_HOME_INTERFACE", pConfig->if_prefix, 1);
+  scriptSetEnv( env, "TSP_HOME_INTERFACE", pConfig->if_prefix );
 
   // Specify local endpoint IPv4 address
-  tspSetEnv("TSP_CLIENT_ADDRESS_IPV4", pTunnelInfo->client_address_ipv4, 1);
+  scriptSetEnv( env, "TSP_CLIENT_ADDRESS_IPV4", pTunnelInfo->client_address_ipv4 );
   gTunnelInfo.szIPV4AddrLocalEndpoint = pTunnelInfo->client_address_ipv4;
 
   // Specify local endpoint IPv6 address
-  tspSetEnv("TSP_CLIENT_ADDRESS_IPV6", pTunnelInfo->client_address_ipv6, 1);
+  scriptSetEnv( env, "TSP_CLIENT_ADDRESS_IPV6", pTunnelInfo->client_address_ipv6 );
   gTunnelInfo.szIPV6AddrLocalEndpoint = pTunnelInfo->client_address_ipv6;
 
   // Specify client dns IPv6 address
-  tspSetEnv("TSP_CLIENT_DNS_ADDRESS_IPV6", pTunnelInfo->client_dns_server_address_ipv6, 1);
+  scriptSetEnv( env, "TSP_CLIENT_DNS_ADDRESS_IPV6", pTunnelInfo->client_dns_server_address_ipv6 );
   gTunnelInfo.szIPV6AddrDns = pTunnelInfo->client_dns_server_address_ipv6;
 
   // Specify local endpoint domain name
   if( pTunnelInfo->client_dns_name != NULL)
   {
-    tspSetEnv("TSP_CLIENT_DNS_NAME", pTunnelInfo->client_dns_name, 1);
+    scriptSetEnv( env, "TSP_CLIENT_DNS_NAME", pTunnelInfo->client_dns_name );
     gTunnelInfo.szUserDomain = pTunnelInfo->client_dns_name;
   }
 
   // Specify remote endpoint IPv4 address.
-  tspSetEnv("TSP_SERVER_ADDRESS_IPV4", pTunnelInfo->server_address_ipv4, 1);
+  scriptSetEnv( env, "TSP_SERVER_ADDRESS_IPV4", pTunnelInfo->server_address_ipv4 );
   gTunnelInfo.szIPV4AddrRemoteEndpoint = pTunnelInfo->server_address_ipv4;
 
   // Specify remote endpoint IPv6 address.
-  tspSetEnv("TSP_SERVER_ADDRESS_IPV6", pTunnelInfo->server_address_ipv6, 1);
+  scriptSetEnv( env, "TSP_SERVER_ADDRESS_IPV6", pTunnelInfo->server_address_ipv6 );
   gTunnelInfo.szIPV6AddrRemoteEndpoint = pTunnelInfo->server_address_ipv6;
 
   // Specify prefix for tunnel endpoint.
   if ((pal_strcasecmp(pTunnelInfo->type, STR_XML_TUNNELMODE_V6V4) == 0) ||
       (pal_strcasecmp(pTunnelInfo->type, STR_XML_TUNNELMODE_V6UDPV4) == 0))
-    tspSetEnv("TSP_TUNNEL_PREFIXLEN", "128", 1);
+    scriptSetEnv( env, "TSP_TUNNEL_PREFIXLEN", "128" );
 #ifdef V4V6_SUPPORT
   else
-    tspSetEnv("TSP_TUNNEL_PREFIXLEN", "32", 1);
+    scriptSetEnv( env, "TSP_TUNNEL_PREFIXLEN", "32" );
 #endif /* V4V6_SUPPORT */
 
 
@@ -497,12 +570,12 @@ void set_tsp_env_variables( const tConf* pConfig, const tTunnel* pTunnelInfo )
     memcpy(chPrefix, pTunnelInfo->prefix, len+sep);
 
     // Specify delegated prefix for routing advertizement, if enabled.
-    tspSetEnv("TSP_PREFIX", chPrefix, 1);
+    scriptSetEnv( env, "TSP_PREFIX", chPrefix );
     gTunnelInfo.szDelegatedPrefix = (char*) pal_malloc( pal_strlen(chPrefix) + 10/*To append prefix_length*/ );
     strcpy( gTunnelInfo.szDelegatedPrefix, chPrefix );
 
     // Specify prefix length for routing advertizement, if enabled.
-    tspSetEnv("TSP_PREFIXLEN", pTunnelInfo->prefix_length, 1);
+    scriptSetEnv( env, "TSP_PREFIXLEN", pTunnelInfo->prefix_length );
     strcat( gTunnelInfo.szDelegatedPrefix, "/" );
     strcat( gTunnelInfo.szDelegatedPrefix, pTunnelInfo->prefix_length );
   }
@@ -567,6 +640,7 @@ static char* get_template_script( const tConf* pConfig )
 gogoc_status tspSetupInterface(tConf *c, tTunnel *t)
 {
   gogoc_status status = STATUS_SUCCESS_INIT;
+  tScriptEnv env;
   char* template_script;
 
 
@@ -580,10 +654,11 @@ gogoc_status tspSetupInterface(tConf *c, tTunnel *t)
 
 
   // Specify TSP Operation: Tunnel Creation.
-  tspSetEnv("TSP_OPERATION", TSP_OPERATION_CREATETUNNEL, 1 );
+  memset( &env, 0, sizeof(env) );
+  scriptSetEnv( &env, "TSP_OPERATION", TSP_OPERATION_CREATETUNNEL );
 
   // Set environment variable for script execution.
-  set_tsp_env_variables( c, t );
+  set_tsp_env_variables( &env, c, t );
 
 
   // Do some platform-specific stuff before tunnel setup script is launched.
@@ -595,50 +670,44 @@ gogoc_status tspSetupInterface(tConf *c, tTunnel *t)
   }
 
 
+#ifdef NETLINK_SUPPORT
 #ifndef ANDROID
-  // Get interface configuration script command string.
-  template_script = get_template_script( c );
-  if( template_script == NULL )
+  // Configure the interface ourselves, unless the template is asked for.
+  if( c->use_template == FALSE )
+#endif
   {
-    // Failed to get filename/directory.
-    return make_status(CTX_TUNINTERFACESETUP, ERR_INVAL_CFG_FILE);
+    // Only what differs from the current configuration of the interface,
+    // or from the tunnel kept from the last connection, is changed.
+    status = tspNetlinkSetupInterface( c, t, kept_conf != NULL ? &kept_tunnel : NULL );
+    if( status_number(status) != SUCCESS )
+      return status;
   }
+#ifndef ANDROID
+  else
+#endif
+#endif
+#ifndef ANDROID
+  {
+    // Get interface configuration script command string.
+    template_script = get_template_script( c );
+    if( template_script == NULL )
+    {
+      // Failed to get filename/directory.
+      return make_status(CTX_TUNINTERFACESETUP, ERR_INVAL_CFG_FILE);
+    }
 
 
-  // ---------------------------------------------------------------
-  // Run the interface configuration script to bring the tunnel up.
-  // ---------------------------------------------------------------
-  Display( LOG_LEVEL_2, ELInfo, "tspSetupInterface", STR_GEN_EXEC_CFG_SCRIPT, template_script );
-  if( execScript( template_script ) != 0 )
-  {
-    // Error executing script.
-    Display(LOG_LEVEL_1, ELError, "tspSetupInterface", STR_GEN_SCRIPT_EXEC_FAILED);
-    return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
-  }
-  Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", STR_GEN_SCRIPT_EXEC_SUCCESS);
-#else
-  {
-    char *interface = NULL;
-    Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", "...");
-    if (pal_strcasecmp(t->type, STR_XML_TUNNELMODE_V6V4) == 0)
+    // ---------------------------------------------------------------
+    // Run the interface configuration script to bring the tunnel up.
+    // ---------------------------------------------------------------
+    Display( LOG_LEVEL_2, ELInfo, "tspSetupInterface", STR_GEN_EXEC_CFG_SCRIPT, template_script );
+    if( execScript( template_script, &env ) != 0 )
     {
-      interface = c->if_tunnel_v6v4;
-      del_tunnel(interface);
-      sleep(1);
-      add_tunnel(interface, t->server_address_ipv4, NULL);
-      Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", "v6v4");
-    } else if (pal_strcasecmp(t->type, STR_XML_TUNNELMODE_V6UDPV4) == 0) {
-      interface = c->if_tunnel_v6udpv4;
-      Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", "v6udpv4");
-    } else {
+      // Error executing script.
+      Display(LOG_LEVEL_1, ELError, "tspSetupInterface", STR_GEN_SCRIPT_EXEC_FAILED);
       return make_status(CTX_TUNINTERFACESETUP, ERR_INTERFACE_SETUP_FAILED);
     }
-    Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", interface);
-    ifdown(interface, 0);
-    Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", t->client_address_ipv6);
-    ifup(interface, t->client_address_ipv6, 128, 1280);
-    delroute();
-    addroute(interface);
+    Display(LOG_LEVEL_2, ELInfo, "tspSetupInterface", STR_GEN_SCRIPT_EXEC_SUCCESS);
   }
 #endif
 
@@ -682,18 +751,32 @@ gogoc_status tspSetupInterface(tConf *c, tTunnel *t)
 // be used when invoking the template script to tear down the existing
 // tunnel.
 //
-gogoc_status tspTearDownTunnel( tConf* pConf, tTunnel* pTunInfo )
+static gogoc_status tspTearDownInterface( tConf* pConf, tTunnel* pTunInfo )
 {
+  tScriptEnv env;
+#ifndef ANDROID
   char* scriptName;
+#endif
 
 
   // Specify TSP Operation: Tunnel Teardown.
-  tspSetEnv( "TSP_OPERATION", TSP_OPERATION_TEARDOWNTUNNEL, 1 );
+  memset( &env, 0, sizeof(env) );
+  scriptSetEnv( &env, "TSP_OPERATION", TSP_OPERATION_TEARDOWNTUNNEL );
 
   // Set environment variables (They may be not set).
-  set_tsp_env_variables( pConf, pTunInfo );
+  set_tsp_env_variables( &env, pConf, pTunInfo );
 
-#ifndef ANDROID 
+#ifdef NETLINK_SUPPORT
+#ifndef ANDROID
+  // Undo what tspNetlinkSetupInterface did, unless the template is used.
+  if( pConf->use_template == FALSE )
+#endif
+  {
+    return tspNetlinkTearDownTunnel( pConf, pTunInfo );
+  }
+#endif
+
+#ifndef ANDROID
   // Format path to script.
   scriptName = get_template_script( pConf );
   if( scriptName == NULL )
@@ -703,24 +786,140 @@ gogoc_status tspTearDownTunnel( tConf* pConf, tTunnel* pTunInfo )
 
   // Run the template script to tear the tunnel down.
   Display(LOG_LEVEL_2, ELInfo, "tspTearDownTunnel", STR_GEN_EXEC_CFG_SCRIPT, scriptName );
-  if( execScript( scriptName ) != 0 )
+  if( execScript( scriptName, &env ) != 0 )
   {
     // Error executing script.
     Display(LOG_LEVEL_1, ELError, "tspTearDownTunnel", STR_GEN_SCRIPT_EXEC_FAILED );
     return make_status(CTX_GOGOCTEARDOWN, ERR_INTERFACE_SETUP_FAILED);
   }
   Display(LOG_LEVEL_2, ELInfo, "tspTearDownTunnel", STR_GEN_SCRIPT_EXEC_SUCCESS );
-#else
-  delroute();
-  if (pal_strcasecmp(pTunInfo->type, STR_XML_TUNNELMODE_V6V4) == 0)
-  {
-      del_tunnel(pConf->if_tunnel_v6v4);
-  } else if (pal_strcasecmp(pTunInfo->type, STR_XML_TUNNELMODE_V6UDPV4) == 0) {
-      del_tunnel(pConf->if_tunnel_v6udpv4);
-  }
 #endif
 
 
   // Return script execution return code.
   return STATUS_SUCCESS_INIT;
 }
+
+
+// --------------------------------------------------------------------------
+// Returns the name of the tunnel interface used by the tunnel.
+//
+static const char* tspTunnelInterface( const tConf* pConf, const tTunnel* pTunInfo )
+{
+  if( pal_strcasecmp(pTunInfo->type, STR_XML_TUNNELMODE_V6UDPV4) == 0 )
+    return pConf->if_tunnel_v6udpv4;
+#ifdef V4V6_SUPPORT
+  if( pal_strcasecmp(pTunInfo->type, STR_XML_TUNNELMODE_V4V6) == 0 )
+    return pConf->if_tunnel_v4v6;
+#endif
+  return pConf->if_tunnel_v6v4;
+}
+
+
+// --------------------------------------------------------------------------
+// Returns 1 if tearing down one tunnel also removes everything the other
+// configured: same tunnel mode, and same delegated prefix, if any.
+//
+static sint32_t tspSameInterface( const tTunnel* a, const tTunnel* b )
+{
+  if( pal_strcasecmp(a->type, b->type) != 0 )
+    return 0;
+  if( (a->prefix == NULL) != (b->prefix == NULL) )
+    return 0;
+  if( a->prefix != NULL &&
+      (pal_strcasecmp(a->prefix, b->prefix) != 0 ||
+       pal_strcasecmp(a->prefix_length, b->prefix_length) != 0) )
+    return 0;
+  return 1;
+}
+
+
+// --------------------------------------------------------------------------
+// Drops the tunnel kept from the last connection, leaving the interface as
+// it is.
+//
+static void tspForgetTunnel( void )
+{
+  if( kept_conf != NULL )
+  {
+    tspClearTunnelInfo( &kept_tunnel );
+    kept_conf = NULL;
+  }
+}
+
+
+// --------------------------------------------------------------------------
+// Tears the tunnel down. A tunnel kept from an earlier connection is torn
+// down as well, if it configured anything this one did not.
+//
+gogoc_status tspTearDownTunnel( tConf* pConf, tTunnel* pTunInfo )
+{
+  if( kept_conf != NULL )
+  {
+    if( !tspSameInterface( &kept_tunnel, pTunInfo ) )
+    {
+      tspTearDownInterface( kept_conf, &kept_tunnel );
+    }
+    tspForgetTunnel();
+  }
+
+  return tspTearDownInterface( pConf, pTunInfo );
+}
+
+
+// --------------------------------------------------------------------------
+// Called instead of tspTearDownTunnel when the client is about to reconnect.
+// If the next tunnel setup can reconcile the interface with what the broker
+// gives next, the tunnel is left configured: the next setup then changes
+// only what differs, and traffic keeps its routes in the meantime.
+//
+// Returns 1 if the tunnel is kept. Otherwise, the caller tears it down.
+//
+sint32_t tspKeepTunnel( tConf* pConf, tTunnel* pTunInfo )
+{
+#ifdef NETLINK_SUPPORT
+#ifndef ANDROID
+  if( pConf->use_template == FALSE )
+#endif
+  {
+    // This tunnel was set up over the one kept before, if any.
+    tspForgetTunnel();
+
+    if( tspCopyTunnelInfo( &kept_tunnel, pTunInfo ) == 0 )
+    {
+      kept_conf = pConf;
+      kept_serial++;
+      Display( LOG_LEVEL_2, ELInfo, "tspKeepTunnel", GOGO_STR_TUNNEL_KEPT,
+               tspTunnelInterface( pConf, pTunInfo ) );
+      return 1;
+    }
+  }
+#endif
+
+  return 0;
+}
+
+
+// --------------------------------------------------------------------------
+// Tears down the tunnel kept from the last connection, if any. Called when
+// the client does not reconnect right away, or exits.
+//
+void tspReleaseTunnel( void )
+{
+  if( kept_conf != NULL )
+  {
+    Display( LOG_LEVEL_2, ELInfo, "tspReleaseTunnel", GOGO_STR_TUNNEL_RELEASED,
+             tspTunnelInterface( kept_conf, &kept_tunnel ) );
+    tspTearDownInterface( kept_conf, &kept_tunnel );
+    tspForgetTunnel();
+  }
+}
+
+
+// --------------------------------------------------------------------------
+// Returns a number that changes each time a tunnel is kept.
+//
+uint32_t tspKeptTunnelSerial( void )
+{
+  return kept_serial;
+}
@@ -0,0 +1,185 @@
+/*
+-----------------------------------------------------------------------------
+  For license information refer to CLIENT-LICENSE.TXT
+-----------------------------------------------------------------------------
+*/
+
+#include "platform.h"
+#include "gogoc_status.h"
+
+#include "net.h"
+#include "tsp_trace.h"
+#include "log.h"
+#include "hex_strings.h"
+
+#include <gogocmessaging/gogoc_c_wrapper.h>
+
+
+/* Printable names of the NET_TOOLS_T_xxx transports */
+static const char *trace_transport[NET_TOOLS_T_SIZE] = {
+  "RUDP", "UDP", "TCP", "TCPv6", "RUDPv6"
+};
+
+static tTraceRecord     trace_ring[TRACE_RING_SIZE];
+static tTraceRecord     trace_current;
+static uint32_t         trace_attempts = 0;
+static sint32_t         trace_open = 0;
+static struct timespec  trace_start;
+static struct timespec  trace_mark;
+static pal_cs_t         trace_lock;
+static sint32_t         trace_initialized = 0;
+
+
+/* Milliseconds elapsed between two readings of the monotonic clock */
+static sint32_t tspTraceElapsed(const struct timespec *from, const struct timespec *to)
+{
+  return (sint32_t)((to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000);
+}
+
+/* Log a finished attempt */
+static void tspTraceLog(const tTraceRecord *r)
+{
+  const char *transport = "?";
+
+  if (r->transport >= 0 && r->transport < NET_TOOLS_T_SIZE)
+    transport = trace_transport[r->transport];
+
+  if (status_number(r->status) == SUCCESS) {
+    Display(LOG_LEVEL_2, ELInfo, "tspTraceEnd", GOGO_STR_TRACE_ATTEMPT_OK,
+            r->attempt, r->broker, transport, r->total_ms);
+  } else if (status_number(r->status) == EVNT_BROKER_REDIRECTION) {
+    Display(LOG_LEVEL_2, ELInfo, "tspTraceEnd", GOGO_STR_TRACE_ATTEMPT_REDIRECTED,
+            r->attempt, r->broker, transport, r->total_ms);
+  } else {
+    Display(LOG_LEVEL_2, ELWarning, "tspTraceEnd", GOGO_STR_TRACE_ATTEMPT_FAILED,
+            r->attempt, r->broker, transport, r->total_ms,
+            status_number(r->status), GOGOCStatusContext[status_context(r->status)]);
+  }
+
+  Display(LOG_LEVEL_3, ELInfo, "tspTraceEnd", GOGO_STR_TRACE_PHASES, r->attempt,
+          r->phase_ms[TRACE_PHASE_CONNECT], r->phase_ms[TRACE_PHASE_CAPABILITIES],
+          r->phase_ms[TRACE_PHASE_AUTHENTICATION], r->phase_ms[TRACE_PHASE_NEGOTIATION],
+          r->phase_ms[TRACE_PHASE_INTERFACE_SETUP], r->phase_ms[TRACE_PHASE_FIRST_KEEPALIVE]);
+}
+
+
+/* --------------------------------------------------------------------------
+ * Initialize the trace. Must be called before the first attempt.
+ */
+void tspTraceInit(void)
+{
+  if (trace_initialized)
+    return;
+
+  pal_init_cs(&trace_lock);
+  trace_initialized = 1;
+}
+
+/* --------------------------------------------------------------------------
+ * Start tracing a new attempt. An attempt still open is dropped.
+ */
+void tspTraceBegin(const char *broker, sint32_t transport)
+{
+  sint32_t i;
+
+  if (!trace_initialized)
+    return;
+
+  pal_enter_cs(&trace_lock);
+
+  memset(&trace_current, 0, sizeof(trace_current));
+  trace_current.attempt = ++trace_attempts;
+  trace_current.started = pal_time(NULL);
+  trace_current.transport = transport;
+  pal_snprintf(trace_current.broker, sizeof(trace_current.broker), "%s", broker != NULL ? broker : "");
+  for (i = 0; i < TRACE_PHASE_COUNT; i++)
+    trace_current.phase_ms[i] = -1;
+
+  pal_gettime_monotonic(&trace_start);
+  trace_mark = trace_start;
+  trace_open = 1;
+
+  pal_leave_cs(&trace_lock);
+}
+
+/* --------------------------------------------------------------------------
+ * Mark the end of a phase of the current attempt. The phase lasted since the
+ * end of the previous one, or since the start of the attempt.
+ */
+void tspTracePhase(tTracePhase phase)
+{
+  struct timespec now;
+
+  if (!trace_initialized)
+    return;
+
+  pal_enter_cs(&trace_lock);
+
+  if (trace_open) {
+    pal_gettime_monotonic(&now);
+    trace_current.phase_ms[phase] = tspTraceElapsed(&trace_mark, &now);
+    trace_mark = now;
+  }
+
+  pal_leave_cs(&trace_lock);
+}
+
+/* --------------------------------------------------------------------------
+ * Close the current attempt with its outcome, and report it. Nothing is done
+ * if the attempt has already been closed.
+ */
+void tspTraceEnd(gogoc_status status)
+{
+  struct timespec now;
+  tTraceRecord record;
+
+  if (!trace_initialized)
+    return;
+
+  pal_enter_cs(&trace_lock);
+
+  if (!trace_open) {
+    pal_leave_cs(&trace_lock);
+    return;
+  }
+
+  pal_gettime_monotonic(&now);
+  trace_current.total_ms = tspTraceElapsed(&trace_start, &now);
+  trace_current.status = status;
+  trace_open = 0;
+
+  trace_ring[(trace_current.attempt - 1) % TRACE_RING_SIZE] = trace_current;
+  record = trace_current;
+
+  pal_leave_cs(&trace_lock);
+
+  tspTraceLog(&record);
+  send_conn_trace();
+}
+
+/* --------------------------------------------------------------------------
+ * Copy the last finished attempts, most recent first. Returns the number of
+ * records copied.
+ */
+sint32_t tspTraceGetRecords(tTraceRecord *records, sint32_t max)
+{
+  uint32_t last;
+  sint32_t n = 0;
+
+  if (!trace_initialized || records == NULL)
+    return 0;
+
+  pal_enter_cs(&trace_lock);
+
+  /* The current attempt, if still open, is not in the ring yet. */
+  last = trace_open ? trace_attempts - 1 : trace_attempts;
+
+  while (n < max && n < TRACE_RING_SIZE && (uint32_t)n < last) {
+    records[n] = trace_ring[(last - 1 - n) % TRACE_RING_SIZE];
+    n++;
+  }
+
+  pal_leave_cs(&trace_lock);
+
+  return n;
+}
@@ -20,6 +20,10 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #include "tsp_lease.h"        // Tunnel lifetime functions.
 #include "log.h"              // Log
 
+#ifdef STANDBY_SUPPORT
+#include "tsp_standby.h"      // tspStandbyActiveLost().
+#endif
+
 #define LOOP_WAIT_MS  500
 
 #ifdef WIN32
@@ -98,8 +102,16 @@ gogoc_status tspPerformTunnelLoop( const PTUNNEL_LOOP_CONFIG pTunLoopCfg )
   //
   while( status_number(status) == SUCCESS  &&  ongoing == 1 )
   {
+    sint32_t wait_ms = LOOP_WAIT_MS;
+
+#ifdef STANDBY_SUPPORT
+    // The watch of the active tunnel is checked more often.
+    if( tspStandbyWatching() )
+      wait_ms = STANDBY_WATCH_POLL;
+#endif
+
     // Check if we've been notified to stop processing.
-    if( tspCheckForStopOrWait( LOOP_WAIT_MS ) != 0 )
+    if( tspCheckForStopOrWait( wait_ms ) != 0 )
     {
       // We've been notified to stop.
       ongoing = 0;
@@ -133,6 +145,15 @@ gogoc_status tspPerformTunnelLoop( const PTUNNEL_LOOP_CONFIG pTunLoopCfg )
         KA_stop( p_ka_engine );
         break;
       }
+
+#ifdef STANDBY_SUPPORT
+      // The standby tunnel takes over before the keepalives time out.
+      if( status_number(status) == SUCCESS  &&  tspStandbyActiveLost() )
+      {
+        status = make_status(CTX_TUNNELLOOP, ERR_KEEPALIVE_TIMEOUT);
+        KA_stop( p_ka_engine );
+      }
+#endif
     }
 
     // Check for tunnel lease expiration.
@@ -8,9 +8,13 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 -----------------------------------------------------------------------------
 */
 
+#include <stddef.h>
+
 #include "platform.h"
 
 #include "xmlparse.h"
+#include "log.h"
+#include "hex_strings.h"
 
 #define   XMLTUN
 #include "xml_tun.h"
@@ -18,142 +22,137 @@ Copyright (c) 2001-2007 gogo6 Inc. All rights reserved.
 #define TEST 0
 
 /*
- * Here are declarations of the appropriate treatment functions, taking care
- * of the content of the nodes parsed. This is required to insure binding to the
- * procedures in the node structure.
- *
- * Use the PROC macro to help insure proper declaration.
+ * Identifiers of the tags and attributes found in a TSP tunnel reply.
  */
 
-PROC(tunnel);
-
-PROC(server);
-PROC(client);
-PROC(broker);
-
-PROC(address);
-PROC(dns_server);
-PROC(router);
-PROC(prefix);
-PROC(as);
-PROC(keepalive);
+enum {
+  TAG_TUNNEL,
+  TAG_SERVER,
+  TAG_CLIENT,
+  TAG_BROKER,
+  TAG_ADDRESS,
+  TAG_DNS_SERVER,
+  TAG_ROUTER,
+  TAG_PREFIX,
+  TAG_AS,
+  TAG_KEEPALIVE
+};
+
+enum {
+  ATTR_ACTION,
+  ATTR_TYPE,
+  ATTR_LIFETIME,
+  ATTR_PROXY,
+  ATTR_MTU,
+  ATTR_PROTOCOL,
+  ATTR_LENGTH,
+  ATTR_NUMBER,
+  ATTR_INTERVAL
+};
 
 /*
- * Here we define a simple node structure containing only one entry
- * corresponding to the root node.
- *
- * Such a structure must be created for each level of information that
- * is part of the expected xml content.
+ * Name tables, indexed by XML_HASH(name). Every name of the vocabulary has
+ * its own slot, so a lookup is a single comparison. The slots are computed
+ * at compile time, and a name added that collides with another one fails
+ * the build (see XML_CHECK_SLOTS).
  */
 
-tNode Root[] =
-
-  STARTLIST
-    NODE(tunnel) ATTR(action) ATTR(type) ATTR(lifetime) ATTR(proxy) ATTR(mtu) ENDNODE
-  ENDLIST
-
-tNode Tunnel[] =
-
-  STARTLIST
-    NODE(server)                  ENDNODE
-    NODE(client)                  ENDNODE
-    NODE(broker)                  ENDNODE
-  ENDLIST
-
-tNode Server[] =
-
-  STARTLIST
-    NODE(address) ATTR(type)      ENDNODE
-    NODE(router)  ATTR(protocol)  ENDNODE
-  ENDLIST
+#define TUN_TAGS(XML_NAME)                              \
+  XML_NAME("client",     'c', 't', TAG_CLIENT    )      \
+  XML_NAME("tunnel",     't', 'l', TAG_TUNNEL    )      \
+  XML_NAME("broker",     'b', 'r', TAG_BROKER    )      \
+  XML_NAME("prefix",     'p', 'x', TAG_PREFIX    )      \
+  XML_NAME("dns_server", 'd', 'r', TAG_DNS_SERVER)      \
+  XML_NAME("as",         'a', 's', TAG_AS        )      \
+  XML_NAME("address",    'a', 's', TAG_ADDRESS   )      \
+  XML_NAME("router",     'r', 'r', TAG_ROUTER    )      \
+  XML_NAME("server",     's', 'r', TAG_SERVER    )      \
+  XML_NAME("keepalive",  'k', 'e', TAG_KEEPALIVE )
+
+#define TUN_ATTRIBUTES(XML_NAME)                        \
+  XML_NAME("protocol",   'p', 'l', ATTR_PROTOCOL )      \
+  XML_NAME("length",     'l', 'h', ATTR_LENGTH   )      \
+  XML_NAME("action",     'a', 'n', ATTR_ACTION   )      \
+  XML_NAME("number",     'n', 'r', ATTR_NUMBER   )      \
+  XML_NAME("proxy",      'p', 'y', ATTR_PROXY    )      \
+  XML_NAME("mtu",        'm', 'u', ATTR_MTU      )      \
+  XML_NAME("interval",   'i', 'l', ATTR_INTERVAL )      \
+  XML_NAME("lifetime",   'l', 'e', ATTR_LIFETIME )      \
+  XML_NAME("type",       't', 'e', ATTR_TYPE     )
+
+XML_CHECK_SLOTS(Tags, TUN_TAGS);
+XML_CHECK_SLOTS(Attributes, TUN_ATTRIBUTES);
+
+static const tXMLName Tags[XML_HASH_SIZE] = { TUN_TAGS(XML_TABLE_ENTRY) };
+
+static const tXMLName Attributes[XML_HASH_SIZE] = { TUN_ATTRIBUTES(XML_TABLE_ENTRY) };
+
+typedef struct stTunnelParser {
+  tTunnel *t;
+  tXMLSpan address_type;        /* type of the <address> being parsed */
+} tTunnelParser;
 
-tNode Client[] =
-
-  STARTLIST
-    NODE(address) ATTR(type)       ENDNODE
-    NODE(dns_server) ATTR(type)    ENDNODE
-    NODE(router)  ATTR(protocol)   ENDNODE
-    NODE(keepalive) ATTR(interval) ENDNODE
-  ENDLIST
-
-tNode Router[] =
-
-  STARTLIST
-    NODE(prefix)     ATTR(length) ENDNODE
-    NODE(dns_server) ATTR(type)   ENDNODE
-    NODE(as)         ATTR(number) ENDNODE
-  ENDLIST
-
-tNode DNSServer[] =
-
-  STARTLIST
-    NODE(address) ATTR(type)      ENDNODE
-  ENDLIST
-
-tNode Broker[] =
+/*
+ * Arena support functions
+ */
 
-  STARTLIST
-    NODE(address) ATTR(type) ENDNODE
-  ENDLIST
+static void *ArenaAlloc(tTunnel *t, size_t size, size_t align)
+{
+  size_t offset;
 
-tNode Keepalive[] =
+  if (t->arena == NULL) return NULL;
 
-  STARTLIST
-    NODE(address) ATTR(type) ENDNODE
-  ENDLIST
+  offset = (t->arena_used + align - 1) & ~(align - 1);
+  if (offset + size > t->arena_size) return NULL;
 
-/*
- * Support functions
- */
+  t->arena_used = offset + size;
+  return t->arena + offset;
+}
 
-static int Assign(char *str, char **toStr)
+static char *ArenaCopy(tTunnel *t, const char *str, size_t len, int lower)
 {
-  char *tol;
+  char *copy;
+  size_t i;
 
-  if (str == NULL) return 0;
+  if ((copy = (char *) ArenaAlloc(t, len + 1, 1)) == NULL) {
+    printf("ArenaCopy: Memory allocation error!\n");
+    return NULL;
+  }
 
   /* turn answer to lower case */
   /* should help homogenize    */
-  /* scripting				   */
+  /* scripting                 */
 
-  tol = str;
-  while (*tol != '\0') {
-	  *tol = (char)tolower((int)*tol);
-	  tol++;
+  for (i = 0; i < len; i++) {
+    copy[i] = lower ? (char)tolower((int)str[i]) : str[i];
   }
+  copy[len] = '\0';
 
-  *toStr = (char *) malloc(strlen(str) + 1);
+  return copy;
+}
 
-  if (*toStr == NULL) {
-    printf("Assign: Memory allocation error!\n");
-    return -1;
-  }
+static int Assign(tTunnel *t, const tXMLSpan *str, char **toStr)
+{
+  if (str == NULL) return 0;
 
-  strcpy(*toStr, str);
+  if ((*toStr = ArenaCopy(t, str->ptr, str->len, 1)) == NULL) return -1;
 
   return 0;
 }
 
-static int AssignToList(char *str, tLinkedList **toList)
+static int AssignToList(tTunnel *t, const tXMLSpan *str, tLinkedList **toList)
 {
   tLinkedList *ll;
 
   if (str == NULL) return 0;
 
-  ll = (tLinkedList *) malloc(sizeof(tLinkedList));
+  ll = (tLinkedList *) ArenaAlloc(t, sizeof(tLinkedList), sizeof(void *));
   if (ll == NULL) {
     printf("AssignToList: Memory allocation error!\n");
     return -1;
   }
 
-  ll->Value = (char *) malloc(strlen(str) + 1);
-
-  if (ll->Value == NULL) {
-    printf("AssignToList: Memory allocation error!\n");
-    return -1;
-  }
-
-  strcpy(ll->Value, str);
+  if ((ll->Value = ArenaCopy(t, str->ptr, str->len, 0)) == NULL) return -1;
 
   ll->next = *toList;
   *toList  = ll;
@@ -161,221 +160,280 @@ static int AssignToList(char *str, tLinkedList **toList)
   return 0;
 }
 
-/*
- * Here are defined every treatment functions required. use the PROC
- * macro to help insure proper declaration.
- *
- * These event functions update the contain of the tTunnel instance with the
- * information that is part of the XML structure.
- */
+static const tXMLSpan *FindAttribute(const tXMLAttribute *attrs, sint32_t nattrs, sint32_t id)
+{
+  sint32_t i;
 
-static tTunnel *theTunnelInfo;
+  for (i = 0; i < nattrs; i++) {
+    if (attrs[i].id == id) return &attrs[i].value;
+  }
 
-static int
-  client,
-  server,
-  router,
-  dns_server,
-  broker,
-  keepalive;
+  return NULL;
+}
 
-PROC(default)
+static int IsType(const tXMLSpan *type, const char *value)
 {
-  printf("Found <%s>%.10s%s</%s>\n", n->name, content, strlen(content) > 10 ? "..." : "", n->name);
-  return 0;
+  return type->ptr != NULL &&
+         (size_t)type->len == strlen(value) &&
+         strncmp(type->ptr, value, type->len) == 0;
 }
 
-PROC(tunnel)
-{
-  Assign(n->attributes[0].value, &theTunnelInfo->action  );
-  Assign(n->attributes[1].value, &theTunnelInfo->type    );
-  Assign(n->attributes[2].value, &theTunnelInfo->lifetime);
-  Assign(n->attributes[3].value, &theTunnelInfo->proxy   );
-  Assign(n->attributes[4].value, &theTunnelInfo->mtu	 );
+/*
+ * Event functions. They update the content of the tTunnel instance with the
+ * information that is part of the XML structure, depending on where in the
+ * structure the element was found.
+ */
 
-  return XMLParse(content, Tunnel);
-}
+#define PARENT(n) (depth >= (n) ? stack[depth - (n)] : XML_UNKNOWN)
 
-PROC(server)
+static sint32_t StartElement(void *ctx, const sint32_t *stack, sint32_t depth, sint32_t tag, const tXMLAttribute *attrs, sint32_t nattrs)
 {
-  int res;
+  tTunnelParser *p = (tTunnelParser *) ctx;
+  tTunnel *t = p->t;
+  int res = 0;
+
+  switch (tag) {
+
+  case TAG_TUNNEL:
+    if (depth != 0) break;
+    res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_ACTION),   &t->action  );
+    res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_TYPE),     &t->type    );
+    res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_LIFETIME), &t->lifetime);
+    res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_PROXY),    &t->proxy   );
+    res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_MTU),      &t->mtu     );
+    break;
+
+  case TAG_ROUTER:
+    if (PARENT(1) == TAG_CLIENT || PARENT(1) == TAG_SERVER) {
+      res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_PROTOCOL), &t->router_protocol);
+    }
+    break;
+
+  case TAG_AS:
+    if (PARENT(1) != TAG_ROUTER) break;
+    if (PARENT(2) == TAG_CLIENT) {
+      res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_NUMBER), &t->client_as);
+    } else if (PARENT(2) == TAG_SERVER) {
+      res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_NUMBER), &t->server_as);
+    }
+    break;
 
-  server = 1;
-  res = XMLParse(content, Server);
-  server = 0;
-  return res;
-}
+  case TAG_KEEPALIVE:
+    if (PARENT(1) == TAG_CLIENT) {
+      res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_INTERVAL), &t->keepalive_interval);
+    }
+    break;
 
-PROC(broker)
-{
-  int res;
+  case TAG_PREFIX:
+    if (PARENT(1) == TAG_ROUTER) {
+      res |= Assign(t, FindAttribute(attrs, nattrs, ATTR_LENGTH), &t->prefix_length);
+    }
+    break;
 
-  broker = 1;
-  res = XMLParse(content, Broker);
-  broker = 0;
-  return res;
+  case TAG_ADDRESS:
+    {
+      const tXMLSpan *type = FindAttribute(attrs, nattrs, ATTR_TYPE);
+
+      p->address_type.ptr = type ? type->ptr : NULL;
+      p->address_type.len = type ? type->len : 0;
+    }
+    break;
+  }
+
+  return res ? -1 : 0;
 }
 
-PROC(client)
+static sint32_t ElementContent(void *ctx, const sint32_t *stack, sint32_t depth, sint32_t tag, const tXMLSpan *content)
 {
-  int res;
+  tTunnelParser *p = (tTunnelParser *) ctx;
+  tTunnel *t = p->t;
+  const tXMLSpan *type = &p->address_type;
+  int res = 0;
+
+  if (tag == TAG_PREFIX) {
+    if (PARENT(1) == TAG_ROUTER) {
+      res = Assign(t, content, &t->prefix);
+    }
+    return res;
+  }
 
-  client = 1;
-  res = XMLParse(content, Client);
-  client = 0;
+  if (tag != TAG_ADDRESS) return 0;
 
-  return res;
-}
+  switch (PARENT(1)) {
 
-PROC(dns_server)
-{
-  int res;
+  case TAG_KEEPALIVE:
+    if (PARENT(2) == TAG_CLIENT && (IsType(type, "ipv6") || IsType(type, "ipv4"))) {
+      res = Assign(t, content, &t->keepalive_address);
+    }
+    break;
+
+  case TAG_DNS_SERVER:
+    if (PARENT(2) == TAG_ROUTER && PARENT(3) == TAG_CLIENT) {
+      if (IsType(type, "ipv4")) {
+        res = AssignToList(t, content, &t->dns_server_address_ipv4);
+      } else if (IsType(type, "ipv6")) {
+        res = AssignToList(t, content, &t->dns_server_address_ipv6);
+      }
+    } else if (PARENT(2) == TAG_CLIENT) {
+      if (IsType(type, "ipv6")) {
+        res = Assign(t, content, &t->client_dns_server_address_ipv6);
+      }
+    }
+    break;
+
+  case TAG_CLIENT:
+    if (IsType(type, "ipv4")) {
+      res = Assign(t, content, &t->client_address_ipv4);
+    } else if (IsType(type, "ipv6")) {
+      res = Assign(t, content, &t->client_address_ipv6);
+    } else if (IsType(type, "dn")) {
+      res = Assign(t, content, &t->client_dns_name);
+    }
+    break;
 
-  dns_server = 1;
-  res = XMLParse(content, DNSServer);
-  dns_server = 0;
+  case TAG_SERVER:
+    if (IsType(type, "ipv4")) {
+      res = Assign(t, content, &t->server_address_ipv4);
+    } else if (IsType(type, "ipv6")) {
+      res = Assign(t, content, &t->server_address_ipv6);
+    }
+    break;
+
+  case TAG_BROKER:
+    if (IsType(type, "ipv4")) {
+      res = AssignToList(t, content, &t->broker_redirect_ipv4);
+    } else if (IsType(type, "ipv6")) {
+      res = AssignToList(t, content, &t->broker_redirect_ipv6);
+    } else if (IsType(type, "dn")) {
+      res = AssignToList(t, content, &t->broker_redirect_dn);
+    }
+    break;
+  }
 
   return res;
 }
 
-PROC(router)
-{
-  int res;
+#undef PARENT
 
-  router = 1;
-  Assign(n->attributes[0].value, &theTunnelInfo->router_protocol);
-  res = XMLParse(content, Router);
-  router = 0;
+static const tXMLHandler TunnelHandler = {
+  Tags,
+  Attributes,
+  StartElement,
+  ElementContent
+};
 
-  return res;
-}
+/* Put here any relevant code... */
 
-PROC(as)
+sint32_t tspTunnelAllocArena(tTunnel *Tunnel, size_t size)
 {
-  if (client) {
-    Assign(n->attributes[0].value, &theTunnelInfo->client_as);
-  } else if (server) {
-    Assign(n->attributes[0].value, &theTunnelInfo->server_as);
+  Tunnel->arena = (char *) malloc(size);
+  if (Tunnel->arena == NULL) {
+    Tunnel->arena_size = 0;
+    return -1;
   }
+
+  Tunnel->arena_size = size;
+  Tunnel->arena_used = 0;
+
   return 0;
 }
 
-PROC(keepalive)
+char *tspTunnelStrdup(tTunnel *Tunnel, const char *str)
 {
-  int res;
-  Assign(n->attributes[0].value, &theTunnelInfo->keepalive_interval);
-  keepalive = 1;
-  res = XMLParse(content, Keepalive);
-  keepalive = 0;
-  return res;
+  if (str == NULL) return NULL;
+
+  return ArenaCopy(Tunnel, str, strlen(str), 0);
 }
 
+static size_t ListSize(const tLinkedList *ll)
+{
+  size_t size = 0;
 
-PROC(prefix) {
-  Assign(n->attributes[0].value, &theTunnelInfo->prefix_length);
-  Assign(content, &theTunnelInfo->prefix);
-  return 0;
+  for (; ll != NULL; ll = ll->next)
+    size += sizeof(tLinkedList) + sizeof(void *) + strlen(ll->Value) + 1;
+
+  return size;
 }
 
-PROC(address)
+static int CopyList(tTunnel *t, const tLinkedList *from, tLinkedList **toList)
 {
-  if (client) {
-    if (keepalive) {
-      if ((!strcmp(n->attributes[0].value, "ipv6")) ||
-	  (!strcmp(n->attributes[0].value, "ipv4"))) {
-	Assign(content, &theTunnelInfo->keepalive_address);
-      }
-    }
-    else if (router) {
-      if (dns_server) {
-        if (!strcmp(n->attributes[0].value, "ipv4")) {
-          AssignToList(content, &theTunnelInfo->dns_server_address_ipv4);
-        } else if (!strcmp(n->attributes[0].value, "ipv6")) {
-          AssignToList(content, &theTunnelInfo->dns_server_address_ipv6);
-        }
-      }
-    } else if (dns_server) {
-      if (!strcmp(n->attributes[0].value, "ipv6")) {
-        Assign(content, &theTunnelInfo->client_dns_server_address_ipv6);
-      }
-    } else {
-      if (!strcmp(n->attributes[0].value, "ipv4")) {
-        Assign(content, &theTunnelInfo->client_address_ipv4);
-      } else if (!strcmp(n->attributes[0].value, "ipv6")) {
-        Assign(content, &theTunnelInfo->client_address_ipv6);
-      } else if (!strcmp(n->attributes[0].value, "dn")) {
-        Assign(content, &theTunnelInfo->client_dns_name);
-      }
-    }
-  } else if (server) {
-    if (!strcmp(n->attributes[0].value, "ipv4")) {
-      Assign(content, &theTunnelInfo->server_address_ipv4);
-    } else if (!strcmp(n->attributes[0].value, "ipv6")) {
-      Assign(content, &theTunnelInfo->server_address_ipv6);
-    }
-  } else if (broker) {
-	if (!strcmp(n->attributes[0].value, "ipv4")) {
-		AssignToList(content, &theTunnelInfo->broker_redirect_ipv4);
-	}
-	else if (!strcmp(n->attributes[0].value, "ipv6")) {
-		AssignToList(content, &theTunnelInfo->broker_redirect_ipv6);
-	}
-	else if (!strcmp(n->attributes[0].value, "dn")) {
-		AssignToList(content, &theTunnelInfo->broker_redirect_dn);
-	}
+  tLinkedList *ll;
+
+  for (; from != NULL; from = from->next) {
+    if ((ll = (tLinkedList *) ArenaAlloc(t, sizeof(tLinkedList), sizeof(void *))) == NULL)
+      return -1;
+    if ((ll->Value = tspTunnelStrdup(t, from->Value)) == NULL)
+      return -1;
+    ll->next = NULL;
+    *toList = ll;
+    toList = &ll->next;
   }
+
   return 0;
 }
 
-/* Put here any relevant code... */
-
-void tspFree(char *var)
+/* Offsets of the string members of tTunnel */
+static const size_t StringMembers[] = {
+  offsetof(tTunnel, action), offsetof(tTunnel, type), offsetof(tTunnel, lifetime),
+  offsetof(tTunnel, proxy), offsetof(tTunnel, mtu), offsetof(tTunnel, client_address_ipv4),
+  offsetof(tTunnel, client_address_ipv6), offsetof(tTunnel, client_dns_server_address_ipv6),
+  offsetof(tTunnel, client_dns_name), offsetof(tTunnel, server_address_ipv4),
+  offsetof(tTunnel, server_address_ipv6), offsetof(tTunnel, router_protocol),
+  offsetof(tTunnel, prefix_length), offsetof(tTunnel, prefix), offsetof(tTunnel, client_as),
+  offsetof(tTunnel, server_as), offsetof(tTunnel, keepalive_interval),
+  offsetof(tTunnel, keepalive_address)
+};
+
+#define MEMBER(t, offset) (*(char **)((char *)(t) + (offset)))
+
+/* Make a copy of Src, with its own arena, that outlives it. */
+sint32_t tspCopyTunnelInfo(tTunnel *Dst, const tTunnel *Src)
 {
-  if (var) free(var);
-}
+  const char *str;
+  size_t size = 0;
+  size_t i;
 
-void tspFreeLinkedList(tLinkedList *list)
-{
-  if(list) {
-    if(list->next) {
-      tspFreeLinkedList(list->next);
-      free(list->next);
-      list->next = NULL;
-    }
-    if(list->Value) {
-      free(list->Value);
-      list->Value = NULL;
-    }
+  memset(Dst, 0, sizeof(tTunnel));
+
+  for (i = 0; i < sizeof(StringMembers) / sizeof(StringMembers[0]); i++)
+    if ((str = MEMBER(Src, StringMembers[i])) != NULL) size += strlen(str) + 1;
+  size += ListSize(Src->dns_server_address_ipv4) + ListSize(Src->dns_server_address_ipv6) +
+          ListSize(Src->broker_address_ipv4) + ListSize(Src->broker_address_ipv6) +
+          ListSize(Src->broker_redirect_ipv4) + ListSize(Src->broker_redirect_ipv6) +
+          ListSize(Src->broker_redirect_dn);
+
+  if (tspTunnelAllocArena(Dst, size + 1) != 0)
+    return -1;
+
+  for (i = 0; i < sizeof(StringMembers) / sizeof(StringMembers[0]); i++) {
+    if ((str = MEMBER(Src, StringMembers[i])) != NULL &&
+        (MEMBER(Dst, StringMembers[i]) = tspTunnelStrdup(Dst, str)) == NULL)
+      goto error;
   }
+
+  if (CopyList(Dst, Src->dns_server_address_ipv4, &Dst->dns_server_address_ipv4) != 0 ||
+      CopyList(Dst, Src->dns_server_address_ipv6, &Dst->dns_server_address_ipv6) != 0 ||
+      CopyList(Dst, Src->broker_address_ipv4, &Dst->broker_address_ipv4) != 0 ||
+      CopyList(Dst, Src->broker_address_ipv6, &Dst->broker_address_ipv6) != 0 ||
+      CopyList(Dst, Src->broker_redirect_ipv4, &Dst->broker_redirect_ipv4) != 0 ||
+      CopyList(Dst, Src->broker_redirect_ipv6, &Dst->broker_redirect_ipv6) != 0 ||
+      CopyList(Dst, Src->broker_redirect_dn, &Dst->broker_redirect_dn) != 0)
+    goto error;
+
+  return 0;
+
+error:
+  tspClearTunnelInfo(Dst);
+  return -1;
 }
 
+#undef MEMBER
+
 void tspClearTunnelInfo(tTunnel *Tunnel)
 {
   if (Tunnel) {
-    tspFree(Tunnel->action);
-    tspFree(Tunnel->type);
-    tspFree(Tunnel->lifetime);
-    tspFree(Tunnel->proxy);
-    tspFree(Tunnel->mtu);
-    tspFree(Tunnel->client_address_ipv4);
-    tspFree(Tunnel->client_address_ipv6);
-    tspFree(Tunnel->client_dns_server_address_ipv6);
-    tspFree(Tunnel->client_dns_name);
-    tspFree(Tunnel->server_address_ipv4);
-    tspFree(Tunnel->server_address_ipv6);
-    tspFree(Tunnel->router_protocol);
-    tspFree(Tunnel->prefix_length);
-    tspFree(Tunnel->prefix);
-    tspFree(Tunnel->client_as);
-    tspFree(Tunnel->server_as);
-    tspFree(Tunnel->keepalive_interval);
-    tspFree(Tunnel->keepalive_address);
-    tspFreeLinkedList(Tunnel->dns_server_address_ipv4);
-    tspFreeLinkedList(Tunnel->dns_server_address_ipv6);
-    tspFreeLinkedList(Tunnel->broker_address_ipv4);
-	tspFreeLinkedList(Tunnel->broker_redirect_ipv4);
-	tspFreeLinkedList(Tunnel->broker_redirect_ipv6);
-	tspFreeLinkedList(Tunnel->broker_redirect_dn);
+    if (Tunnel->arena) free(Tunnel->arena);
+    memset(Tunnel, 0, sizeof(tTunnel));
   }
 }
 
@@ -422,15 +480,47 @@ void tspXMLShowInfo(tTunnel *Tunnel)
   printf("  broker redirect dn             = ["); ShowList(Tunnel->broker_redirect_dn);       printf("]\n");
 }
 
-int tspXMLParse(char *Data, tTunnel *Tunnel)
+int tspXMLParse(const char *Data, tTunnel *Tunnel)
 {
+  tTunnelParser parser;
+  const char *c;
+  size_t elements = 0;
+
   tspClearTunnelInfo(Tunnel);
 
-  client = server = router = dns_server = broker = 0;
+  /*
+   * Every value is a part of Data followed by at least one delimiter, so
+   * the strings fit in strlen(Data) + 1 bytes. A list element is created
+   * at most once per tag.
+   */
+
+  for (c = Data; (c = strchr(c, '<')) != NULL; c++) elements++;
+
+  if (tspTunnelAllocArena(Tunnel, strlen(Data) + 1 + elements * (sizeof(tLinkedList) + sizeof(void *))) != 0) {
+    printf("tspXMLParse: Memory allocation error!\n");
+    return -1;
+  }
+
+#if defined(_DEBUG) || defined(DEBUG)
+  {
+    /* The characters given to XML_NAME are those of the names. */
+    static int checked = 0;
+    sint32_t i;
+
+    if (!checked) {
+      checked = 1;
+      if ((i = XMLCheckNames(Tags)) != -1)
+        Display(LOG_LEVEL_1, ELError, "tspXMLParse", GOGO_STR_XML_NAME_MISPLACED, Tags[i].name);
+      if ((i = XMLCheckNames(Attributes)) != -1)
+        Display(LOG_LEVEL_1, ELError, "tspXMLParse", GOGO_STR_XML_NAME_MISPLACED, Attributes[i].name);
+    }
+  }
+#endif
 
-  theTunnelInfo = Tunnel;
+  memset(&parser, 0, sizeof(parser));
+  parser.t = Tunnel;
 
-  return XMLParse(Data, Root);
+  return XMLTokenize(Data, &TunnelHandler, &parser);
 }
 
 #if TEST
@@ -479,6 +569,7 @@ main()
   }
 
   tspXMLShowInfo(&t);
+  tspClearTunnelInfo(&t);
 
   return 0;
 }
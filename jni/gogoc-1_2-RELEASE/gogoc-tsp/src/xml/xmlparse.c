@@ -10,7 +10,7 @@ Copyright (c) 2001-2005 gogo6 Inc. All rights reserved.
 
 #include "platform.h"
 
-#define _XMLParse_
+#define XMLPARSE
 #include "xmlparse.h"
 
 #ifndef XML_DEBUG
@@ -19,317 +19,244 @@ Copyright (c) 2001-2005 gogo6 Inc. All rights reserved.
 
 int debug = XML_DEBUG;
 
-static tNode * findNode(char *name, tNode nodes[])
+static int SkipBlanks(const char *str, int pos)
 {
-  tNode *n;
+  while (str[pos] &&
+	 ((str[pos] == ' ') || (str[pos] == '\t') || (str[pos] == '\r') || (str[pos] == '\n'))) {
+    pos += 1;
+  }
 
-  n = nodes;
+  return pos;
+}
 
-  while (n->name[0]) {
-    if (strcmp(name, n->name) == 0) return n;
-    n++;
+static int SkipName(const char *str, int pos)
+{
+  while (str[pos] && (isalnum(str[pos]) || (str[pos] == '_'))) {
+    pos += 1;
   }
 
-  return 0;
+  return pos;
 }
 
-static tAttribute *findAttribute(char *name, tAttribute attributes[])
+/*
+ * Lookup a name in a table built for XML_HASH. The name is not nul
+ * terminated.
+ */
+
+sint32_t XMLLookup(const tXMLName table[], const char *name, sint32_t len)
 {
-  tAttribute *a;
+  const tXMLName *e;
 
-  a = attributes;
+  if (table == NULL || len <= 0) return XML_UNKNOWN;
 
-  while (a->name[0]) {
-    if (strcmp(name, a->name) == 0) return a;
-    a++;
+  e = &table[XML_HASH(name, len)];
+
+  if (e->name != NULL && strncmp(e->name, name, len) == 0 && e->name[len] == 0) {
+    return e->id;
   }
 
-  return 0;
+  return XML_UNKNOWN;
 }
 
-static int SkipBlanks(char *str, int pos)
+/*
+ * Check that every name of a table is at the slot of its hash.
+ *
+ * return values:
+ *
+ *   -1 : Success
+ *    n : Index of the misplaced name
+ */
+
+sint32_t XMLCheckNames(const tXMLName table[])
 {
-  while (str[pos] && 
-	 ((str[pos] == ' ') || (str[pos] == '\t') || (str[pos] == '\r') || (str[pos] == '\n'))) {
-    pos += 1;
+  sint32_t i;
+
+  if (table == NULL) return -1;
+
+  for (i = 0; i < XML_HASH_SIZE; i++) {
+    if (table[i].name != NULL &&
+        XML_HASH(table[i].name, (sint32_t)strlen(table[i].name)) != i) {
+      return i;
+    }
   }
 
-  return pos;
+  return -1;
 }
 
 /*
  * return values:
  *
  *    0 : Success
+ *   -1 : Error returned by an event handler
  *    n : Parsing error (position in the string where the parsing error occured)
  */
 
-int XMLParse(char *str, tNode nodes[])
+sint32_t XMLTokenize(const char *string, const tXMLHandler *h, void *ctx)
 {
-  char       *string;
-  int         pos;
-  int         simple;  /* 1 = complete node in a single <> like <name ..../> */
-  char       *tagName;
-  char       *attrName;
-  char       *attrValue;
-  char       *endTag;
-  tNode      *n;
-  tAttribute *a;
-  char        endToken[100];
-  int         res;
-  
-  if (debug) printf("Beginning of XMLParse\n");
-  
-  string = (char *) malloc(strlen(str) + 1);
-  
-  if (!string) {
-    fprintf(stderr, "xmlparse: Error malloc\n");
-    return -1;
-  }
-  
-  strcpy(string, str);
-  
-  pos = 0;
+  int           pos;
+  int           depth;
+  int           simple;  /* 1 = complete node in a single <> like <name ..../> */
+  int           nattrs;
+  int           res;
+  int           len;
+  int           id;
+  tXMLSpan      content;
+  tXMLAttribute attrs[MAX_ATTRIBUTES];
 
-  while (string[pos]) {
+  /* Per depth: element identifier, name, start of content and leaf flag */
+  sint32_t      stack[MAX_DEPTH];
+  tXMLSpan      names[MAX_DEPTH];
+  int           contentStart[MAX_DEPTH];
+  int           hasChild[MAX_DEPTH];
 
-    simple = 0;
-  
-    pos = SkipBlanks(string, pos);
+  if (debug) printf("Beginning of XMLTokenize\n");
+
+  pos   = 0;
+  depth = 0;
+
+  while (1) {
 
     /*
-     * If not at the beginning of a node tag, return with current position
-     */
-  
-    if (string[pos] == 0) { free(string); return 0; }
-  
-    if (string[pos] != '<') { free(string); return pos; }
-  
-    pos += 1;
-  
-    /*
-     * We are not expecting here the end node (like </...> )
-     */
-  
-    if (!isalpha(string[pos])) { free(string); return pos; }
-  
-    /*
-     * We now retrieve the node name and the attributes.
-     * It must be ended by a space when there is some attributes,
-     * a '/' if it's a simple node, or '>'.
+     * Skip character data up to the next tag. Outside of any element, only
+     * blanks are allowed.
      */
-  
-    tagName = &string[pos];
-    while (string[pos] && (isalnum(string[pos]) || (string[pos] == '_'))) {
-      pos += 1;
-    }
-  
-    if (!string[pos]) { free(string); return pos; }
-  
-    if (string[pos] == '/') {
-  
-      simple      = 1;
-      string[pos] = 0;
-      pos        += 1;
 
-      if (string[pos] != '>') { free(string); return pos; }
+    if (depth == 0) {
+      pos = SkipBlanks(string, pos);
+      if (string[pos] == 0) return 0;
+      if (string[pos] != '<') return pos;
+    } else {
+      while (string[pos] && string[pos] != '<') pos += 1;
+      if (string[pos] == 0) return pos;
+    }
 
-      string[pos] = 0;
+    pos += 1;
 
-    } else if (string[pos] == ' ') {
-  
-      string[pos]  = 0;
-      pos         += 1;
-  
-    } else if (string[pos] == '>') {
-  
-      string[pos] = 0; /* we do not advance pos as it will indicate if '>' found */
+    if (string[pos] == '?' || string[pos] == '!') {
 
-    } else {
+      /*
+       * Processing instruction or comment, skip it.
+       */
 
-      free(string);
-      return pos;
+      while (string[pos] && string[pos] != '>') pos += 1;
+      if (string[pos] == 0) return pos;
+      pos += 1;
+      continue;
     }
-  
-    /*
-     * The nodename must at least contain one character
-     */
-     
-    if (!tagName[0]) { free(string); return pos; }
 
-    if (debug) printf("tagName = %s\n", tagName);
-        
-    /*
-     * Here we try to find the node structure corresponding to the
-     * tag read from the xml containt
-     */
-  
-    if ((n = findNode(tagName, nodes)) != NULL) {
-  
-      /*
-       * We found the node structure...
-       */
-  
-      if (debug) printf("Found corresponding structure: %s\n", n->name);
+    if (string[pos] == '/') {
 
       /*
-       * A null character indicate that there is no attribute available
+       * End tag. It must close the element on top of the stack.
        */
-      
-      if (string[pos] == 0) {
 
-        pos += 1;
+      pos += 1;
+      if (depth == 0) return pos;
 
-      } else {
-      
-        /*
-         * There may be some attributes. Parse them...
-         */
+      len = SkipName(string, pos) - pos;
+      if (len != names[depth - 1].len ||
+          strncmp(&string[pos], names[depth - 1].ptr, len) != 0) return pos;
 
-        pos = SkipBlanks(string, pos);
+      content.ptr = &string[contentStart[depth - 1]];
+      content.len = (pos - 2) - contentStart[depth - 1];
 
-        while (isalpha(string[pos])) {
+      pos = SkipBlanks(string, pos + len);
+      if (string[pos] != '>') return pos;
+      pos += 1;
 
-          attrName = &string[pos];
+      depth -= 1;
 
-          while (string[pos] && 
-		 (isalnum(string[pos]) || (string[pos] == '_'))) pos += 1;
+      if (!hasChild[depth] && stack[depth] != XML_UNKNOWN && h->text != NULL) {
+        if (debug) printf("Content of %.*s: %.*s\n", names[depth].len, names[depth].ptr, content.len, content.ptr);
 
-          if (string[pos] != '=') { free(string); return pos; }
+        res = (*h->text)(ctx, stack, depth, stack[depth], &content);
+        if (res) return res;
+      }
 
-          string[pos] = 0;
-          pos        += 1;
+      continue;
+    }
 
-          a = findAttribute(attrName, n->attributes);
+    /*
+     * Start tag. We now retrieve the node name and the attributes.
+     */
 
-          if (debug) printf("Attribute %sfound in structure: %s", a == NULL ? "not " : "", attrName);
-          
-          if (string[pos] != '"') { free(string); return pos; }
+    if (!isalpha(string[pos])) return pos;
 
-          pos += 1;
+    if (depth == MAX_DEPTH) return pos;
 
-          attrValue = &string[pos];
+    names[depth].ptr = &string[pos];
+    pos = SkipName(string, pos);
+    names[depth].len = (int)(&string[pos] - names[depth].ptr);
 
-          while (string[pos] && 
-		 (string[pos] != '\n') &&
-		 (string[pos] != '\r') &&
-		 (string[pos] != '>' ) &&
-		 (string[pos] != '"' )) pos += 1;
+    id = XMLLookup(h->tags, names[depth].ptr, names[depth].len);
 
-          if (string[pos] != '"') { free(string); return pos; }
-            
-	  string[pos] = 0;
-          pos        += 1;
-          
-          if (a != NULL) {
-	    a->value = attrValue;
-	  }
-      
-          pos = SkipBlanks(string, pos);
-	}
+    if (debug) printf("tagName = %.*s (%d)\n", names[depth].len, names[depth].ptr, id);
 
-        if (string[pos] == '/') {
+    nattrs = 0;
+    simple = 0;
 
-          simple  = 1;
-          pos    += 1;
-        }
+    pos = SkipBlanks(string, pos);
 
-        if (string[pos] == '>') {
+    while (isalpha(string[pos])) {
 
-          pos += 1;
+      const char *attrName = &string[pos];
+      int         attrId;
 
-        } else {
+      pos = SkipName(string, pos);
+      len = (int)(&string[pos] - attrName);
 
-          free(string);
-          return pos;
-	}
-      }
+      if (string[pos] != '=') return pos;
+      pos += 1;
 
-    } else {
-  
-      /*
-       * There is no node structure entry corresponding to the tag found
-       * we just skip the contain of the node up to the end of it.
-       */
-  
-      if (debug) printf("No structure definition: %s\n", tagName);
+      if (string[pos] != '"') return pos;
+      pos += 1;
+
+      content.ptr = &string[pos];
+
+      while (string[pos] &&
+	     (string[pos] != '\n') &&
+	     (string[pos] != '\r') &&
+	     (string[pos] != '>' ) &&
+	     (string[pos] != '"' )) pos += 1;
 
-      if (string[pos] == 0) {
+      if (string[pos] != '"') return pos;
 
-        pos += 1;
+      content.len = (int)(&string[pos] - content.ptr);
+      pos += 1;
 
-      } else {
+      attrId = (id == XML_UNKNOWN) ? XML_UNKNOWN : XMLLookup(h->attributes, attrName, len);
 
-        while (string[pos] && (string[pos] != '>')) pos += 1;
-        if (string[pos] == '>') {
-          pos += 1;
-        }
+      if (attrId != XML_UNKNOWN && nattrs < MAX_ATTRIBUTES) {
+        attrs[nattrs].id    = attrId;
+        attrs[nattrs].value = content;
+        nattrs += 1;
       }
-  
-      if ((string[pos] == 0) && !simple) { free(string); return pos; }
+
+      pos = SkipBlanks(string, pos);
     }
-    
-    if (simple) {
-      
-      /*
-       * Call the processing function, if it exists...
-       */
-  
-      if (n && n->p) {
-        res = (*n->p)(n, &string[pos]);
-        if (res) {
-          free(string);
-	  if (res > 0) res += pos;
-	  return res;
-	}
-      }
-      
-    } else {
 
-      strcpy(endToken, "</");
-      strcat(endToken, tagName);
-      strcat(endToken, ">");
-  
-      endTag = strstr(&string[pos], endToken);
-    
-      if (debug) printf("Computed end tag: %s\n", endToken);
-    
-      if (endTag) {
-      
-        if (debug) printf("Found node end: %s\n", endToken);
-      
-        *endTag = 0;
-    
-        /*
-         * Call the processing function, if it exists...
-         */
-  
-        if (n && n->p) {
-	  res = (*n->p)(n, &string[pos]);
-	  if (res) {
-	    free(string);
-	    if (res > 0) res += pos;
-	    return res;
-	  }
-	}
-       
-        pos = (int)(endTag - string) + (int)strlen(endToken);
-      
-      } else {
-      
-        free(string);
-        return pos;
-      }
+    if (string[pos] == '/') {
+      simple = 1;
+      pos   += 1;
+    }
+
+    if (string[pos] != '>') return pos;
+    pos += 1;
+
+    if (depth > 0) hasChild[depth - 1] = 1;
 
+    if (id != XML_UNKNOWN && h->start != NULL) {
+      res = (*h->start)(ctx, stack, depth, id, attrs, nattrs);
+      if (res) return res;
     }
-  
-    //return 0;
+
+    if (simple) continue;
+
+    stack[depth]        = id;
+    contentStart[depth] = pos;
+    hasChild[depth]     = 0;
+    depth += 1;
   }
-  
-  free(string);
-  
-  return 0;
 }
 
 /*----- xmlparse.c --------------------------------------------------------------------*/
-